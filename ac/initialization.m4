@@ -19,5 +19,5 @@ PKG_PROG_PKG_CONFIG
 
 dnl Check for headers
 AC_HEADER_STDC()
-AC_CHECK_HEADERS([inttypes.h stdint.h sys/types.h sys/syscall.h stropts.h])
-AC_CHECK_FUNCS([vsscanf syscall],,)
+AC_CHECK_HEADERS([inttypes.h stdint.h sys/types.h sys/syscall.h sys/sendfile.h stropts.h])
+AC_CHECK_FUNCS([vsscanf syscall copy_file_range sendfile],,)
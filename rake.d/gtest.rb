@@ -1,6 +1,6 @@
 #!/usr/bin/env ruby
 
-$gtest_apps     = %w{common merge propedit}
+$gtest_apps     = %w{common extract merge propedit}
 $gtest_internal = c(:GTEST_TYPE) == "internal"
 
 namespace :tests do
@@ -24,6 +24,7 @@ $build_system_modules[:gtest] = {
   :define_tasks => lambda do
     gtest_libs = {
       'common'   => [],
+      'extract'  => [ :mtxextract ],
       'propedit' => [ :mtxpropedit ],
       'merge'    => [ :mtxmerge ],
     }
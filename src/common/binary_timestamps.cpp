@@ -0,0 +1,103 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   compact binary format for external timestamp files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/binary_timestamps.h"
+#include "common/mm_io_x.h"
+
+namespace mtx { namespace binary_timestamps {
+
+std::string const g_magic{"MTXTSV2B"};
+
+bool
+probe(mm_io_c &in) {
+  try {
+    std::string magic;
+
+    in.setFilePointer(0, seek_beginning);
+    auto num_read = in.read(magic, g_magic.size());
+    in.setFilePointer(0, seek_beginning);
+
+    return (num_read == g_magic.size()) && (magic == g_magic);
+
+  } catch (mtx::mm_io::exception &) {
+    return false;
+  }
+}
+
+/** \brief Read and verify the header
+
+   Returns \c false if the magic doesn't match or if the file is too
+   small for the number of timestamps the header announces. The file
+   pointer is left at the first timestamp.
+*/
+bool
+read_header(mm_io_c &in,
+            header_t &header) {
+  try {
+    std::string magic;
+
+    in.setFilePointer(0, seek_beginning);
+    if ((in.read(magic, g_magic.size()) != g_magic.size()) || (magic != g_magic))
+      return false;
+
+    header.default_duration = static_cast<int64_t>(in.read_uint64_be());
+    header.num_timestamps   = in.read_uint64_be();
+
+    return header.num_timestamps <= ((in.get_size() - header_size) / 8);
+
+  } catch (mtx::mm_io::exception &) {
+    return false;
+  }
+}
+
+void
+write(mm_io_c &out,
+      std::vector<int64_t> const &timestamps,
+      int64_t default_duration) {
+  out.write(g_magic.c_str(), g_magic.size());
+  out.write_uint64_be(default_duration);
+  out.write_uint64_be(timestamps.size());
+
+  for (auto timestamp : timestamps)
+    out.write_uint64_be(timestamp);
+}
+
+/** \brief Determine the most common difference between consecutive timestamps
+
+   This is the same value mkvmerge uses as the default duration for
+   timestamp files in format v2. If several differences occur equally
+   often then the smallest one is used. Returns 0 if there are fewer
+   than two timestamps.
+*/
+int64_t
+determine_default_duration(std::vector<int64_t> const &timestamps) {
+  std::map<int64_t, int64_t> num_occurrences;
+
+  for (auto idx = 1u; idx < timestamps.size(); ++idx)
+    ++num_occurrences[timestamps[idx] - timestamps[idx - 1]];
+
+  auto default_duration = int64_t{};
+  auto max_occurrences  = int64_t{};
+
+  for (auto const &entry : num_occurrences)
+    if (entry.second > max_occurrences) {
+      default_duration = entry.first;
+      max_occurrences  = entry.second;
+    }
+
+  return std::max<int64_t>(default_duration, 0);
+}
+
+}}
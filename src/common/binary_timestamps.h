@@ -0,0 +1,50 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   compact binary format for external timestamp files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_BINARY_TIMESTAMPS_H
+#define MTX_COMMON_BINARY_TIMESTAMPS_H
+
+#include "common/common_pch.h"
+
+/* The binary format contains the same information as a timestamp
+   file in format v2: one timestamp per frame. Its header contains the
+   number of timestamps and the default duration so that they don't
+   have to be determined by reading the whole file.
+
+   All values are stored in big endian byte order:
+
+     8 bytes  magic 'MTXTSV2B'
+     8 bytes  default duration in ns (0 if unknown)
+     8 bytes  number of timestamps
+     8 bytes  for each timestamp in ns
+*/
+
+namespace mtx { namespace binary_timestamps {
+
+extern std::string const g_magic;
+std::size_t const header_size = 24;
+
+struct header_t {
+  int64_t default_duration{};
+  uint64_t num_timestamps{};
+};
+
+bool probe(mm_io_c &in);
+bool read_header(mm_io_c &in, header_t &header);
+void write(mm_io_c &out, std::vector<int64_t> const &timestamps, int64_t default_duration);
+
+int64_t determine_default_duration(std::vector<int64_t> const &timestamps);
+
+}}
+
+#endif  // MTX_COMMON_BINARY_TIMESTAMPS_H
@@ -0,0 +1,91 @@
+/*
+  mkvmerge -- utility for splicing together matroska files
+  from component media subtypes
+
+  Distributed under the GPL v2
+  see the file COPYING for details
+  or visit http://www.gnu.org/copyleft/gpl.html
+
+  process-wide cache of parsed BluRay playlist and clip info files
+
+  Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_BLURAY_PARSE_CACHE_H
+#define MTX_COMMON_BLURAY_PARSE_CACHE_H
+
+#include "common/common_pch.h"
+
+#include <mutex>
+#include <unordered_map>
+
+#include "common/cache.h"
+
+namespace mtx { namespace bluray {
+
+// Identifying all the playlists of a disc parses the same clip info
+// files over and over again, and the MPEG TS reader parses them once
+// more for each file. Parsed files are therefore kept around for the
+// lifetime of the process. The identification server fills the caches
+// before creating the process for a request; see prime_parse_caches().
+// An entry is only used as long as the file's size and modification
+// time haven't changed. The parsers must not be modified after parsing
+// as they're shared.
+template<typename Tparser>
+class parse_cache_c {
+protected:
+  struct entry_t {
+    mtx::cache::file_identity_t m_identity;
+    std::shared_ptr<Tparser> m_parser;
+  };
+
+  // A disc rarely contains more than a couple of hundred playlists
+  // and clips. Start over if the process has been running for so long
+  // that it has seen a lot more.
+  static std::size_t const ms_max_entries = 4096;
+
+  std::mutex m_mutex;
+  std::unordered_map<std::string, entry_t> m_entries;
+
+public:
+  std::shared_ptr<Tparser>
+  get(std::string const &file_name,
+      std::function<std::shared_ptr<Tparser>()> const &parse) {
+    auto identity = mtx::cache::get_file_identity(file_name);
+    if (!identity)
+      return parse();
+
+    // Playlists and streams refer to clip info files via paths such as
+    // "PLAYLIST/../CLIPINF" or "STREAM/../CLIPINF". Use the canonical
+    // path so that all of them share the same entry.
+    boost::system::error_code ec;
+    auto key = bfs::canonical(bfs::path{file_name}, ec).string();
+    if (ec)
+      key = bfs::system_complete(bfs::path{file_name}).string();
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      auto itr = m_entries.find(key);
+      if ((itr != m_entries.end()) && (itr->second.m_identity == *identity))
+        return itr->second.m_parser;
+    }
+
+    // Parse without holding the lock so that several threads can parse
+    // different files at the same time.
+    auto parser = parse();
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    if (m_entries.size() >= ms_max_entries)
+      m_entries.clear();
+
+    m_entries[key] = entry_t{ *identity, parser };
+
+    return parser;
+  }
+};
+
+}}
+
+#endif  // MTX_COMMON_BLURAY_PARSE_CACHE_H
@@ -0,0 +1,83 @@
+/*
+  mkvmerge -- utility for splicing together matroska files
+  from component media subtypes
+
+  Distributed under the GPL v2
+  see the file COPYING for details
+  or visit http://www.gnu.org/copyleft/gpl.html
+
+  helper functions for BluRay disc structures
+
+  Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/bluray_util.h"
+#include "common/clpi.h"
+#include "common/file.h"
+#include "common/mm_io_x.h"
+#include "common/mm_mpls_multi_file_io.h"
+
+namespace mtx { namespace bluray {
+
+bfs::path
+find_other_file(bfs::path const &reference_file_name,
+                std::string const &sub_directory,
+                std::string const &extension) {
+  auto file_lower          = reference_file_name;
+  auto file_upper          = reference_file_name;
+
+  auto sub_directory_upper = balg::to_upper_copy(sub_directory);
+  auto sub_directory_lower = balg::to_lower_copy(sub_directory);
+
+  file_upper.replace_extension(balg::to_upper_copy(extension));
+  file_lower.replace_extension(balg::to_lower_copy(extension));
+
+  auto file_name_lower = file_upper.filename();
+  auto file_name_upper = file_lower.filename();
+  auto path            = reference_file_name.parent_path();
+
+  return mtx::file::first_existing_path({
+      file_lower,
+      file_upper,
+      path / ".." / sub_directory_upper / file_name_lower, path / ".." / ".." / sub_directory_upper / file_name_lower,
+      path / ".." / sub_directory_upper / file_name_upper, path / ".." / ".." / sub_directory_upper / file_name_upper,
+      path / ".." / sub_directory_lower / file_name_lower, path / ".." / ".." / sub_directory_lower / file_name_lower,
+      path / ".." / sub_directory_lower / file_name_upper, path / ".." / ".." / sub_directory_lower / file_name_upper,
+  });
+}
+
+void
+prime_parse_caches(std::string const &file_name) {
+  try {
+    auto path      = bfs::path{file_name};
+    auto extension = balg::to_lower_copy(path.extension().string());
+
+    if (!bfs::is_regular_file(path))
+      return;
+
+    // The MPEG TS reader only looks up the clip info file of the first
+    // file a playlist refers to.
+    if (extension == ".mpls") {
+      auto in = mm_mpls_multi_file_io_c::open_multi(file_name);
+      if (!in)
+        return;
+
+      path      = static_cast<mm_mpls_multi_file_io_c &>(*in).get_file_names()[0];
+      extension = balg::to_lower_copy(path.extension().string());
+    }
+
+    if ((extension != ".m2ts") && (extension != ".mts"))
+      return;
+
+    auto clpi_file = find_other_file(path, "clipinf", ".clpi");
+    if (!clpi_file.empty())
+      clpi::parse_cached(clpi_file.string());
+
+  } catch (mtx::mm_io::exception &) {
+  } catch (bfs::filesystem_error &) {
+  }
+}
+
+}}
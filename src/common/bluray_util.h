@@ -0,0 +1,36 @@
+/*
+  mkvmerge -- utility for splicing together matroska files
+  from component media subtypes
+
+  Distributed under the GPL v2
+  see the file COPYING for details
+  or visit http://www.gnu.org/copyleft/gpl.html
+
+  helper functions for BluRay disc structures
+
+  Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_BLURAY_UTIL_H
+#define MTX_COMMON_BLURAY_UTIL_H
+
+#include "common/common_pch.h"
+
+namespace mtx { namespace bluray {
+
+// Finds the file belonging to \c reference_file_name with the same base
+// name and the extension \c extension, either next to it or in the
+// directory \c sub_directory of the disc structure, e.g. the clip info
+// file "CLIPINF/00001.clpi" for "STREAM/00001.m2ts". Returns an empty
+// path if there's no such file.
+bfs::path find_other_file(bfs::path const &reference_file_name, std::string const &sub_directory, std::string const &extension);
+
+// Parses the playlist or clip info files that identifying or reading
+// \c file_name will need and stores them in their parse caches. Used by
+// the identification server so that the processes it creates for each
+// request find them already parsed.
+void prime_parse_caches(std::string const &file_name);
+
+}}
+
+#endif  // MTX_COMMON_BLURAY_UTIL_H
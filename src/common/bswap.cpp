@@ -13,21 +13,242 @@
 
 #include <stdexcept>
 
+#if defined(MTX_X86_SIMD)
+# include <immintrin.h>
+#endif
+
 #include "common/bswap.h"
 #include "common/endian.h"
 
 namespace mtx {
 
+namespace {
+
+template<std::size_t Tword_length>
+void
+bswap_words(unsigned char const *src,
+            unsigned char *dst,
+            std::size_t num_bytes) {
+  unsigned char word[Tword_length];
+
+  for (std::size_t idx = 0; idx < num_bytes; idx += Tword_length) {
+    std::memcpy(word, &src[idx], Tword_length);
+    for (std::size_t byte_idx = 0; byte_idx < Tword_length; ++byte_idx)
+      dst[idx + byte_idx] = word[Tword_length - 1 - byte_idx];
+  }
+}
+
+template<>
+void
+bswap_words<2>(unsigned char const *src,
+               unsigned char *dst,
+               std::size_t num_bytes) {
+  for (std::size_t idx = 0; idx < num_bytes; idx += 2) {
+    uint16_t word;
+    std::memcpy(&word, &src[idx], 2);
+    word = bswap_16(word);
+    std::memcpy(&dst[idx], &word, 2);
+  }
+}
+
+template<>
+void
+bswap_words<4>(unsigned char const *src,
+               unsigned char *dst,
+               std::size_t num_bytes) {
+  for (std::size_t idx = 0; idx < num_bytes; idx += 4) {
+    uint32_t word;
+    std::memcpy(&word, &src[idx], 4);
+    word = bswap_32(word);
+    std::memcpy(&dst[idx], &word, 4);
+  }
+}
+
+template<>
+void
+bswap_words<8>(unsigned char const *src,
+               unsigned char *dst,
+               std::size_t num_bytes) {
+  for (std::size_t idx = 0; idx < num_bytes; idx += 8) {
+    uint64_t word;
+    std::memcpy(&word, &src[idx], 8);
+    word = bswap_64(word);
+    std::memcpy(&dst[idx], &word, 8);
+  }
+}
+
+void
+bswap_buffer_scalar(unsigned char const *src,
+                    unsigned char *dst,
+                    std::size_t num_bytes,
+                    std::size_t word_length) {
+  switch (word_length) {
+    case 2:  bswap_words<2>(src, dst, num_bytes); break;
+    case 3:  bswap_words<3>(src, dst, num_bytes); break;
+    case 4:  bswap_words<4>(src, dst, num_bytes); break;
+    case 8:  bswap_words<8>(src, dst, num_bytes); break;
+    default:
+      for (std::size_t idx = 0; idx < num_bytes; idx += word_length)
+        put_uint_le(&dst[idx], get_uint_be(&src[idx], word_length), word_length);
+  }
+}
+
+#if defined(MTX_X86_SIMD)
+
+// Byte shuffle masks reversing the bytes of each word in 16 bytes.
+alignas(16) unsigned char const s_shuffle_16[16] = {  1,  0,  3,  2,  5,  4,  7,  6,  9,  8, 11, 10, 13, 12, 15, 14 };
+alignas(16) unsigned char const s_shuffle_32[16] = {  3,  2,  1,  0,  7,  6,  5,  4, 11, 10,  9,  8, 15, 14, 13, 12 };
+alignas(16) unsigned char const s_shuffle_64[16] = {  7,  6,  5,  4,  3,  2,  1,  0, 15, 14, 13, 12, 11, 10,  9,  8 };
+
+// 24-bit words are swapped in blocks of 48 bytes (16 words) loaded
+// into three registers. Words crossing the register boundaries are
+// assembled from two registers; 0x80 clears the byte.
+alignas(16) unsigned char const s_shuffle_24[7][16] = {
+  {    2,    1,    0,    5,    4,    3,    8,    7,    6,   11,   10,    9,   14,   13,   12, 0x80 }, // first output from first input
+  { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,    1 }, // first output from second input
+  { 0x80,   15, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, // second output from first input
+  {    0, 0x80,    4,    3,    2,    7,    6,    5,   10,    9,    8,   13,   12,   11, 0x80,   15 }, // second output from second input
+  { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,    0, 0x80 }, // second output from third input
+  {   14, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80 }, // third output from second input
+  { 0x80,    3,    2,    1,    6,    5,    4,    9,    8,    7,   12,   11,   10,   15,   14,   13 }, // third output from third input
+};
+
+unsigned char const *
+shuffle_mask_for(std::size_t word_length) {
+  return 2 == word_length ? s_shuffle_16
+       : 3 == word_length ? s_shuffle_24[0]
+       : 4 == word_length ? s_shuffle_32
+       : 8 == word_length ? s_shuffle_64
+       :                    nullptr;
+}
+
+__attribute__((target("ssse3")))
+std::size_t
+bswap_buffer_24_ssse3(unsigned char const *src,
+                      unsigned char *dst,
+                      std::size_t num_bytes) {
+  __m128i masks[7];
+  for (auto idx = 0; idx < 7; ++idx)
+    masks[idx] = _mm_load_si128(reinterpret_cast<__m128i const *>(s_shuffle_24[idx]));
+
+  auto idx = std::size_t{};
+
+  for (; (idx + 48) <= num_bytes; idx += 48) {
+    auto in0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&src[idx]));
+    auto in1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&src[idx + 16]));
+    auto in2 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&src[idx + 32]));
+
+    auto out0 = _mm_or_si128(_mm_shuffle_epi8(in0, masks[0]), _mm_shuffle_epi8(in1, masks[1]));
+    auto out1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(in0, masks[2]), _mm_shuffle_epi8(in1, masks[3])), _mm_shuffle_epi8(in2, masks[4]));
+    auto out2 = _mm_or_si128(_mm_shuffle_epi8(in1, masks[5]), _mm_shuffle_epi8(in2, masks[6]));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[idx]),      out0);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[idx + 16]), out1);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[idx + 32]), out2);
+  }
+
+  return idx;
+}
+
+// Returns the number of bytes processed. The rest is left for the
+// scalar code.
+__attribute__((target("ssse3")))
+std::size_t
+bswap_buffer_ssse3(unsigned char const *src,
+                   unsigned char *dst,
+                   std::size_t num_bytes,
+                   std::size_t word_length) {
+  if (3 == word_length)
+    return bswap_buffer_24_ssse3(src, dst, num_bytes);
+
+  auto mask = _mm_load_si128(reinterpret_cast<__m128i const *>(shuffle_mask_for(word_length)));
+  auto idx  = std::size_t{};
+
+  for (; (idx + 16) <= num_bytes; idx += 16) {
+    auto data = _mm_loadu_si128(reinterpret_cast<__m128i const *>(&src[idx]));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&dst[idx]), _mm_shuffle_epi8(data, mask));
+  }
+
+  return idx;
+}
+
+// VPSHUFB shuffles within each 128-bit lane, so the same masks work
+// for all word lengths that divide 16.
+__attribute__((target("avx2")))
+std::size_t
+bswap_buffer_avx2(unsigned char const *src,
+                  unsigned char *dst,
+                  std::size_t num_bytes,
+                  std::size_t word_length) {
+  if (3 == word_length)
+    return bswap_buffer_24_ssse3(src, dst, num_bytes);
+
+  auto mask = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const *>(shuffle_mask_for(word_length))));
+  auto idx  = std::size_t{};
+
+  for (; (idx + 32) <= num_bytes; idx += 32) {
+    auto data = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(&src[idx]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(&dst[idx]), _mm256_shuffle_epi8(data, mask));
+  }
+
+  return idx + bswap_buffer_ssse3(&src[idx], &dst[idx], num_bytes - idx, word_length);
+}
+
+#endif  // MTX_X86_SIMD
+
+bswap_kernel_e
+determine_best_bswap_kernel() {
+#if defined(MTX_X86_SIMD)
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2"))
+    return bswap_kernel_e::avx2;
+  if (__builtin_cpu_supports("ssse3"))
+    return bswap_kernel_e::ssse3;
+#endif
+
+  return bswap_kernel_e::scalar;
+}
+
+}
+
+bswap_kernel_e
+best_bswap_kernel() {
+  static auto const s_best_kernel = determine_best_bswap_kernel();
+  return s_best_kernel;
+}
+
 void
 bswap_buffer(unsigned char const *src,
              unsigned char *dst,
              std::size_t num_bytes,
              std::size_t word_length) {
+  bswap_buffer(src, dst, num_bytes, word_length, best_bswap_kernel());
+}
+
+void
+bswap_buffer(unsigned char const *src,
+             unsigned char *dst,
+             std::size_t num_bytes,
+             std::size_t word_length,
+             bswap_kernel_e kernel) {
   if ((num_bytes % word_length) != 0)
     throw std::invalid_argument((boost::format(Y("The number of bytes to swap isn't divisible by %1%.")) % word_length).str());
 
-  for (std::size_t idx = 0; idx < num_bytes; idx += word_length)
-    put_uint_le(&dst[idx], get_uint_be(&src[idx], word_length), word_length);
+  auto num_done = std::size_t{};
+
+#if defined(MTX_X86_SIMD)
+  if (shuffle_mask_for(word_length)) {
+    if (bswap_kernel_e::avx2 == kernel)
+      num_done = bswap_buffer_avx2(src, dst, num_bytes, word_length);
+    else if (bswap_kernel_e::ssse3 == kernel)
+      num_done = bswap_buffer_ssse3(src, dst, num_bytes, word_length);
+  }
+#else
+  static_cast<void>(kernel);
+#endif
+
+  bswap_buffer_scalar(&src[num_done], &dst[num_done], num_bytes - num_done, word_length);
 }
 
 }
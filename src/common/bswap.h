@@ -46,7 +46,19 @@ bswap_64(uint64_t x) {
   return r.ll;
 }
 
+// The implementations bswap_buffer() can use. The best one the CPU
+// supports is determined at runtime. Selecting one explicitly is only
+// meant for testing and benchmarking.
+enum class bswap_kernel_e {
+  scalar,
+  ssse3,
+  avx2,
+};
+
+bswap_kernel_e best_bswap_kernel();
+
 void bswap_buffer(unsigned char const *src, unsigned char *dst, std::size_t num_bytes, std::size_t word_length);
+void bswap_buffer(unsigned char const *src, unsigned char *dst, std::size_t num_bytes, std::size_t word_length, bswap_kernel_e kernel);
 
 }
 
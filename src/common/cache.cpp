@@ -0,0 +1,485 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   on-disk caches for information derived from source files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if !defined(SYS_WINDOWS)
+# include <sys/stat.h>
+#endif
+
+#include "common/cache.h"
+#include "common/checksums/base_fwd.h"
+#include "common/fs_sys_helpers.h"
+#include "common/mm_io.h"
+#include "common/random.h"
+#include "common/strings/formatting.h"
+#include "common/strings/parsing.h"
+#include "common/version.h"
+
+namespace mtx { namespace cache {
+
+static debugging_option_c s_debug{"cache"};
+static bfs::path s_base_dir;
+
+// The name of the file in each category's directory that holds the
+// total size of its entries. It is updated by each write so that the
+// directory only has to be scanned once the limit is exceeded. Other
+// processes writing concurrently may cause it to be off a bit; each
+// trim stores the actual size again.
+static char const *s_total_size_file_name = "total_size";
+
+message_recorder_c::message_recorder_c()
+  : m_messages(nlohmann::json::array())
+  , m_previous_info_handler{get_mxmsg_handler(MXMSG_INFO)}
+  , m_previous_warning_handler{get_mxmsg_handler(MXMSG_WARNING)}
+{
+  for (auto level : std::vector<unsigned int>{ MXMSG_INFO, MXMSG_WARNING }) {
+    auto previous_handler = get_mxmsg_handler(level);
+
+    set_mxmsg_handler(level, [this, previous_handler](unsigned int level, std::string const &message) {
+      m_messages.push_back(nlohmann::json{ { "level", level }, { "text", message } });
+      if (previous_handler)
+        previous_handler(level, message);
+    });
+  }
+}
+
+message_recorder_c::~message_recorder_c() {
+  set_mxmsg_handler(MXMSG_INFO,    m_previous_info_handler);
+  set_mxmsg_handler(MXMSG_WARNING, m_previous_warning_handler);
+}
+
+nlohmann::json const &
+message_recorder_c::get_messages()
+  const {
+  return m_messages;
+}
+
+/** \brief Output messages recorded by \c message_recorder_c again
+
+   Throws if \c messages isn't in the format \c message_recorder_c
+   records.
+*/
+void
+replay_messages(nlohmann::json const &messages) {
+  for (auto const &message : messages) {
+    auto level = message.at("level").get<unsigned int>();
+    auto text  = message.at("text").get<std::string>();
+
+    if (MXMSG_WARNING == level)
+      mxwarn(text);
+    else
+      mxinfo(text);
+  }
+}
+
+bool
+file_identity_t::operator ==(file_identity_t const &other)
+  const {
+  return (m_size              == other.m_size)
+      && (m_inode             == other.m_inode)
+      && (m_modification_time == other.m_modification_time);
+}
+
+bool
+file_identity_t::operator !=(file_identity_t const &other)
+  const {
+  return !(*this == other);
+}
+
+nlohmann::json
+file_identity_t::to_json()
+  const {
+  return nlohmann::json{
+    { "size",              m_size              },
+    { "inode",             m_inode             },
+    { "modification_time", m_modification_time },
+  };
+}
+
+boost::optional<file_identity_t>
+file_identity_t::from_json(nlohmann::json const &json) {
+  try {
+    file_identity_t identity;
+
+    identity.m_size              = json.at("size").get<uint64_t>();
+    identity.m_inode             = json.at("inode").get<uint64_t>();
+    identity.m_modification_time = json.at("modification_time").get<int64_t>();
+
+    return identity;
+
+  } catch (std::exception const &) {
+    return boost::none;
+  }
+}
+
+boost::optional<file_identity_t>
+get_file_identity(std::string const &file_name) {
+  file_identity_t identity;
+
+#if defined(SYS_WINDOWS)
+  boost::system::error_code ec;
+  auto path = bfs::path{file_name};
+
+  identity.m_size              = bfs::file_size(path, ec);
+  if (ec)
+    return boost::none;
+
+  identity.m_modification_time = bfs::last_write_time(path, ec);
+  if (ec)
+    return boost::none;
+
+#else  // defined(SYS_WINDOWS)
+  struct stat st;
+
+  if (0 != ::stat(file_name.c_str(), &st))
+    return boost::none;
+
+  identity.m_size              = st.st_size;
+  identity.m_inode             = st.st_ino;
+# if defined(SYS_APPLE)
+  identity.m_modification_time = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000ll + st.st_mtimespec.tv_nsec;
+# else
+  identity.m_modification_time = static_cast<int64_t>(st.st_mtim.tv_sec)      * 1000000000ll + st.st_mtim.tv_nsec;
+# endif
+
+#endif  // defined(SYS_WINDOWS)
+
+  return identity;
+}
+
+/** \brief Use a different directory than the application data folder
+
+   The cache directories are created below \c base_dir. An empty path
+   restores the default.
+*/
+void
+set_base_dir(bfs::path const &base_dir) {
+  s_base_dir = base_dir;
+}
+
+bfs::path
+get_cache_dir(std::string const &category) {
+  auto base_dir = s_base_dir.empty() ? mtx::sys::get_application_data_folder() / "cache" : s_base_dir;
+  if (base_dir.empty())
+    return {};
+
+  auto dir = base_dir / category;
+
+  boost::system::error_code ec;
+  if (!bfs::is_directory(dir, ec))
+    bfs::create_directories(dir, ec);
+
+  return ec ? bfs::path{} : dir;
+}
+
+/** \brief The key of the cache entry for a file
+
+   The key is derived from the file's absolute name. \c variant
+   distinguishes between several entries for the same file, e.g. if
+   the cached information depends on options.
+*/
+std::string
+get_cache_key(std::string const &file_name,
+              std::string const &variant) {
+  auto absolute_name = bfs::absolute(bfs::path{file_name}).string();
+  if (!variant.empty())
+    absolute_name += "\n" + variant;
+
+  return to_hex(mtx::checksum::calculate(mtx::checksum::algorithm_e::md5, absolute_name.c_str(), absolute_name.length()), true);
+}
+
+/** \brief The name of the cache entry for a file
+
+   See \c get_cache_key for the meaning of \c variant.
+*/
+bfs::path
+get_cache_file_name(std::string const &category,
+                    std::string const &file_name,
+                    std::string const &variant) {
+  auto dir = get_cache_dir(category);
+  if (dir.empty())
+    return {};
+
+  return dir / get_cache_key(file_name, variant);
+}
+
+boost::optional<nlohmann::json>
+read(bfs::path const &cache_file_name) {
+  boost::system::error_code ec;
+
+  if (cache_file_name.empty() || !bfs::exists(cache_file_name, ec))
+    return boost::none;
+
+  try {
+    auto content = mm_file_io_c::slurp(cache_file_name.string());
+    auto json    = mtx::json::parse(std::string{reinterpret_cast<char const *>(content->get_buffer()), content->get_size()});
+
+    if (json.value("program_version", std::string{}) != get_current_version().to_string()) {
+      mxdebug_if(s_debug, boost::format("cache: ignoring %1% from a different version\n") % cache_file_name.string());
+      return boost::none;
+    }
+
+    return json;
+
+  } catch (...) {
+    mxdebug_if(s_debug, boost::format("cache: reading %1% failed\n") % cache_file_name.string());
+  }
+
+  return boost::none;
+}
+
+/** \brief Read the entry for a file if the file hasn't changed
+
+   The entry must have been written by \c write_for_file for a file
+   with the same identity.
+*/
+boost::optional<nlohmann::json>
+read_for_file(bfs::path const &cache_file_name,
+              file_identity_t const &identity) {
+  auto json = read(cache_file_name);
+  if (!json)
+    return boost::none;
+
+  auto cached_identity = json->count("file") ? file_identity_t::from_json(json->at("file")) : boost::none;
+  if (cached_identity && (*cached_identity == identity))
+    return json;
+
+  mxdebug_if(s_debug, boost::format("cache: ignoring %1% for a modified file\n") % cache_file_name.string());
+
+  return boost::none;
+}
+
+// Write to a temporary file first and rename it afterwards so that
+// other processes never see partially written files.
+static bool
+write_file_atomically(bfs::path const &file_name,
+                      std::string const &content) {
+  auto temp_name = file_name.string() + (boost::format(".%|1$016x|.tmp") % random_c::generate_64bits()).str();
+  auto written   = false;
+
+  try {
+    mm_file_io_c out{temp_name, MODE_CREATE};
+
+    written = out.write(content.c_str(), content.length()) == content.length();
+
+  } catch (...) {
+  }
+
+  boost::system::error_code ec;
+
+  if (!written) {
+    mxdebug_if(s_debug, boost::format("cache: writing %1% failed\n") % temp_name);
+    bfs::remove(temp_name, ec);
+
+    return false;
+  }
+
+#if defined(SYS_WINDOWS)
+  bfs::remove(file_name, ec);
+#endif
+  bfs::rename(temp_name, file_name, ec);
+
+  if (ec) {
+    mxdebug_if(s_debug, boost::format("cache: renaming %1% to %2% failed: %3%\n") % temp_name % file_name.string() % ec.message());
+    bfs::remove(temp_name, ec);
+    return false;
+  }
+
+  return true;
+}
+
+static boost::optional<uint64_t>
+read_total_size(bfs::path const &dir) {
+  boost::system::error_code ec;
+  auto file_name = dir / s_total_size_file_name;
+
+  if (!bfs::exists(file_name, ec))
+    return boost::none;
+
+  try {
+    auto content    = mm_file_io_c::slurp(file_name.string());
+    auto total_size = uint64_t{};
+
+    if (parse_number(std::string{reinterpret_cast<char const *>(content->get_buffer()), content->get_size()}, total_size))
+      return total_size;
+
+  } catch (...) {
+  }
+
+  return boost::none;
+}
+
+static void
+write_total_size(bfs::path const &dir,
+                 uint64_t total_size) {
+  write_file_atomically(dir / s_total_size_file_name, to_string(total_size));
+}
+
+/** \brief Write a cache entry
+
+   If \c max_size is not 0 then the least recently used entries of the
+   entry's category are removed once the total size of all its entries
+   exceeds \c max_size bytes.
+*/
+bool
+write(bfs::path const &cache_file_name,
+      nlohmann::json const &content,
+      uint64_t max_size) {
+  if (cache_file_name.empty())
+    return false;
+
+  auto to_write               = content;
+  to_write["program_version"] = get_current_version().to_string();
+
+  auto serialized = mtx::json::dump(to_write);
+
+  boost::system::error_code ec;
+  auto previous_size = bfs::file_size(cache_file_name, ec);
+  if (ec)
+    previous_size = 0;
+
+  if (!write_file_atomically(cache_file_name, serialized))
+    return false;
+
+  if (!max_size)
+    return true;
+
+  auto dir        = cache_file_name.parent_path();
+  auto total_size = read_total_size(dir);
+
+  if (total_size) {
+    auto new_total_size = std::max<int64_t>(static_cast<int64_t>(*total_size + serialized.length()) - static_cast<int64_t>(previous_size), 0);
+    if (static_cast<uint64_t>(new_total_size) <= max_size) {
+      write_total_size(dir, new_total_size);
+      return true;
+    }
+  }
+
+  trim_dir(dir, max_size);
+
+  return true;
+}
+
+/** \brief Write an entry for a file
+
+   The file's identity is stored in the entry. The entry is only
+   written if the result was derived from the file alone, meaning
+   exactly \c num_bytes_used bytes, the file's size, were taken into
+   account. Results for playlists or files spanning several parts
+   depend on other files whose modifications would go unnoticed.
+*/
+bool
+write_for_file(bfs::path const &cache_file_name,
+               file_identity_t const &identity,
+               uint64_t num_bytes_used,
+               nlohmann::json content,
+               uint64_t max_size) {
+  if (num_bytes_used != identity.m_size) {
+    mxdebug_if(s_debug, boost::format("cache: not writing %1%: result depends on %2% bytes, file size is %3%\n") % cache_file_name.string() % num_bytes_used % identity.m_size);
+    return false;
+  }
+
+  content["file"] = identity.to_json();
+
+  return write(cache_file_name, content, max_size);
+}
+
+void
+remove(bfs::path const &cache_file_name) {
+  boost::system::error_code ec;
+
+  if (!cache_file_name.empty())
+    bfs::remove(cache_file_name, ec);
+}
+
+/** \brief Mark an entry as recently used
+
+   \c trim removes the entries that haven't been used for the longest
+   time first.
+*/
+void
+touch(bfs::path const &cache_file_name) {
+  boost::system::error_code ec;
+
+  if (!cache_file_name.empty())
+    bfs::last_write_time(cache_file_name, std::time(nullptr), ec);
+}
+
+/** \brief Limit the size of all entries in a category
+
+   See \c trim_dir.
+*/
+void
+trim(std::string const &category,
+     uint64_t max_size) {
+  auto dir = get_cache_dir(category);
+  if (!dir.empty())
+    trim_dir(dir, max_size);
+}
+
+/** \brief Limit the size of all entries in a cache directory
+
+   Removes the least recently used entries until the entries' total
+   size is \c max_size bytes at most. Entries removed concurrently by
+   other processes are simply skipped.
+*/
+void
+trim_dir(bfs::path const &dir,
+         uint64_t max_size) {
+
+  struct entry_t {
+    bfs::path m_name;
+    std::time_t m_last_used;
+    uint64_t m_size;
+  };
+
+  std::vector<entry_t> entries;
+  auto total_size = uint64_t{};
+  boost::system::error_code ec;
+
+  for (bfs::directory_iterator itr{dir, ec}, end; !ec && (itr != end); itr.increment(ec)) {
+    boost::system::error_code entry_ec;
+    auto name      = itr->path();
+    auto size      = bfs::file_size(name, entry_ec);
+    auto last_used = entry_ec ? std::time_t{} : bfs::last_write_time(name, entry_ec);
+
+    // Skip temporary files which are still being written.
+    if (entry_ec || (name.extension() == ".tmp") || (name.filename() == s_total_size_file_name))
+      continue;
+
+    entries.push_back({ name, last_used, size });
+    total_size += size;
+  }
+
+  if (total_size <= max_size) {
+    write_total_size(dir, total_size);
+    return;
+  }
+
+  std::sort(entries.begin(), entries.end(), [](entry_t const &a, entry_t const &b) { return a.m_last_used < b.m_last_used; });
+
+  for (auto const &entry : entries) {
+    if (total_size <= max_size)
+      break;
+
+    mxdebug_if(s_debug, boost::format("cache: trimming %1%: removing %2%\n") % dir.string() % entry.m_name.string());
+
+    bfs::remove(entry.m_name, ec);
+    total_size -= entry.m_size;
+  }
+
+  write_total_size(dir, total_size);
+}
+
+}}
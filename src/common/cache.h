@@ -0,0 +1,71 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   on-disk caches for information derived from source files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_CACHE_H
+#define MTX_COMMON_CACHE_H
+
+#include "common/common_pch.h"
+
+#include "common/json.h"
+
+namespace mtx { namespace cache {
+
+// Cheap way of recognizing whether or not a file has been modified
+// since a cache entry was created for it.
+struct file_identity_t {
+  uint64_t m_size{}, m_inode{};
+  int64_t m_modification_time{};
+
+  bool operator ==(file_identity_t const &other) const;
+  bool operator !=(file_identity_t const &other) const;
+
+  nlohmann::json to_json() const;
+  static boost::optional<file_identity_t> from_json(nlohmann::json const &json);
+};
+
+// Records the informational messages and the warnings output while
+// it exists in the order they're output so that they can be stored
+// in a cache entry and replayed later.
+class message_recorder_c {
+protected:
+  nlohmann::json m_messages;
+  mxmsg_handler_t m_previous_info_handler, m_previous_warning_handler;
+
+public:
+  message_recorder_c();
+  ~message_recorder_c();
+
+  nlohmann::json const &get_messages() const;
+};
+
+void replay_messages(nlohmann::json const &messages);
+
+boost::optional<file_identity_t> get_file_identity(std::string const &file_name);
+
+void set_base_dir(bfs::path const &base_dir);
+bfs::path get_cache_dir(std::string const &category);
+std::string get_cache_key(std::string const &file_name, std::string const &variant = std::string{});
+bfs::path get_cache_file_name(std::string const &category, std::string const &file_name, std::string const &variant = std::string{});
+
+boost::optional<nlohmann::json> read(bfs::path const &cache_file_name);
+boost::optional<nlohmann::json> read_for_file(bfs::path const &cache_file_name, file_identity_t const &identity);
+bool write(bfs::path const &cache_file_name, nlohmann::json const &content, uint64_t max_size = 0);
+bool write_for_file(bfs::path const &cache_file_name, file_identity_t const &identity, uint64_t num_bytes_used, nlohmann::json content, uint64_t max_size = 0);
+void remove(bfs::path const &cache_file_name);
+void touch(bfs::path const &cache_file_name);
+void trim(std::string const &category, uint64_t max_size);
+void trim_dir(bfs::path const &dir, uint64_t max_size);
+
+}}
+
+#endif  // MTX_COMMON_CACHE_H
@@ -57,7 +57,7 @@ crc_base_c::init_table() {
   if ((parameters.bits < 8) || (parameters.bits > 32) || (parameters.poly >= (1LL<<parameters.bits)))
     throw std::domain_error{"Invalid CRC parameters"};
 
-  m_table.resize(256);
+  m_table.resize(256 * 8);
 
   for (auto i = 0u; i < 256u; i++) {
     if (parameters.le) {
@@ -74,6 +74,15 @@ crc_base_c::init_table() {
     }
   }
 
+  // Additional tables for processing eight bytes at once
+  // ("slicing-by-8"). Table n contains the CRC of each byte value
+  // followed by n zero bytes.
+  for (auto n = 1u; n < 8u; ++n)
+    for (auto i = 0u; i < 256u; ++i) {
+      auto previous        = m_table[(n - 1) * 256 + i];
+      m_table[n * 256 + i] = m_table[previous & 0xff] ^ (previous >> 8);
+    }
+
   // for (auto row = 0u; row < (256u / 4); ++row)
   //   mxinfo(boost::format("0x%|1$08x| 0x%|2$08x| 0x%|3$08x| 0x%|4$08x|\n")
   //          % m_table[row * 4 + 0] % m_table[row * 4 + 1] % m_table[row * 4 + 2] % m_table[row * 4 + 3]);
@@ -127,7 +136,24 @@ crc_base_c::set_result_in_le(bool result_in_le) {
 void
 crc_base_c::add_impl(unsigned char const *buffer,
                      size_t size) {
-  auto end = buffer + size;
+  auto end   = buffer + size;
+  auto table = m_table.data();
+
+  while ((end - buffer) >= 8) {
+    auto one = get_uint32_le(buffer) ^ m_crc;
+    auto two = get_uint32_le(buffer + 4);
+
+    m_crc    = table[7 * 256 + ( one        & 0xff)]
+             ^ table[6 * 256 + ((one >>  8) & 0xff)]
+             ^ table[5 * 256 + ((one >> 16) & 0xff)]
+             ^ table[4 * 256 + ( one >> 24        )]
+             ^ table[3 * 256 + ( two        & 0xff)]
+             ^ table[2 * 256 + ((two >>  8) & 0xff)]
+             ^ table[1 * 256 + ((two >> 16) & 0xff)]
+             ^ table[0 * 256 + ( two >> 24        )];
+
+    buffer  += 8;
+  }
 
   while (buffer < end) {
     m_crc = m_table[(m_crc & 0xff) ^ *buffer] ^ (m_crc >> 8);
@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include "common/bit_reader.h"
+#include "common/bluray_parse_cache.h"
 #include "common/clpi.h"
 
 namespace mtx { namespace bluray { namespace clpi {
@@ -233,4 +234,15 @@ parser_c::parse_program_stream(bit_reader_c &bc,
   bc.set_bit_position(position_in_bits + length_in_bytes * 8);
 }
 
+parser_cptr
+parse_cached(std::string const &file_name) {
+  static parse_cache_c<parser_c> s_cache;
+
+  return s_cache.get(file_name, [&file_name]() -> parser_cptr {
+    auto parser = std::make_shared<parser_c>(file_name);
+    parser->parse();
+    return parser;
+  });
+}
+
 }}}
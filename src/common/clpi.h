@@ -82,6 +82,11 @@ namespace mtx { namespace bluray { namespace clpi {
   };
   using parser_cptr = std::shared_ptr<parser_c>;
 
+  // Returns the parsed clip info file. Files are only parsed once per
+  // process as long as they don't change. The result must be checked
+  // with is_ok().
+  parser_cptr parse_cached(std::string const &file_name);
+
 }}}                             // namespace mtx::bluray::clpi
 
 #endif // MTX_COMMON_CLPI_COMMON_H
@@ -13,6 +13,8 @@
 
 #include "common/common_pch.h"
 
+#include <mutex>
+
 #include "common/codec.h"
 #include "common/mp4.h"
 
@@ -21,8 +23,15 @@ codec_c::specialization_map_t codec_c::ms_specialization_descriptions;
 
 void
 codec_c::initialize() {
-  if (!ms_codecs.empty())
-    return;
+  // mkvmerge's readers look codecs up from several threads while
+  // parsing their headers concurrently.
+  static std::once_flag s_registered;
+
+  std::call_once(s_registered, register_codecs);
+}
+
+void
+codec_c::register_codecs() {
   ms_codecs.emplace_back("Bitfields",               type_e::V_BITFIELDS,    track_video,    "", fourcc_c{0x03000000u});
   ms_codecs.emplace_back("Cinepak",                 type_e::V_CINEPAK,      track_video,    "cvid");
   ms_codecs.emplace_back("Dirac",                   type_e::V_DIRAC,        track_video,    "drac|V_DIRAC");
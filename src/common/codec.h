@@ -262,6 +262,7 @@ public:
 
 private:
   static void initialize();
+  static void register_codecs();
 
 public:                         // static
   static codec_c const look_up(std::string const &fourcc_or_codec_id);
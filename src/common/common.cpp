@@ -74,7 +74,6 @@ fix_windows_errormode() {
 
 unsigned int verbose = 1;
 
-extern bool g_warning_issued;
 static std::string s_program_name;
 
 // Functions
@@ -16,6 +16,8 @@
 
 #include "common/common_pch.h"
 
+#include <atomic>
+#include <mutex>
 #include <sstream>
 #include <unordered_map>
 
@@ -47,55 +49,91 @@ public:
 
 class debugging_option_c {
   struct option_c {
-    boost::tribool m_requested;
+    // The state is read and written by several threads in
+    // mkvextract. It is either one of the two boolean values or
+    // 'unknown'.
+    static int const unknown = -1;
+
+    std::atomic<int> m_requested;
     std::string m_option;
 
     option_c(std::string const &option)
-      : m_requested{boost::logic::indeterminate}
+      : m_requested{unknown}
       , m_option{option}
     {
     }
 
     bool get() {
-      if (boost::logic::indeterminate(m_requested))
-        m_requested = debugging_c::requested(m_option);
+      auto requested = m_requested.load();
+
+      if (unknown == requested) {
+        requested   = debugging_c::requested(m_option) ? 1 : 0;
+        m_requested = requested;
+      }
+
+      return !!requested;
+    }
 
-      return m_requested;
+    void set(boost::tribool requested) {
+      m_requested = boost::logic::indeterminate(requested) ? unknown : requested ? 1 : 0;
     }
   };
 
 protected:
-  mutable size_t m_registered_idx;
+  mutable std::atomic<option_c *> m_registered_option;
   std::string m_option;
 
 private:
-  static std::vector<option_c> ms_registered_options;
+  // The options are allocated individually so that pointers to them
+  // stay valid while other threads register more options.
+  static std::vector<std::unique_ptr<option_c>> ms_registered_options;
+  static std::mutex ms_registration_mutex;
 
 public:
   debugging_option_c(std::string const &option)
-    : m_registered_idx{std::numeric_limits<size_t>::max()}
+    : m_registered_option{}
     , m_option{option}
   {
   }
 
+  debugging_option_c(debugging_option_c const &other)
+    : m_registered_option{other.m_registered_option.load()}
+    , m_option{other.m_option}
+  {
+  }
+
+  debugging_option_c &operator =(debugging_option_c const &other) {
+    m_registered_option = other.m_registered_option.load();
+    m_option            = other.m_option;
+
+    return *this;
+  }
+
   operator bool() const {
-    return ms_registered_options.at(get_idx()).get();
+    return get_option().get();
   }
 
   void set(boost::tribool requested) {
-    ms_registered_options.at(get_idx()).m_requested = requested;
+    get_option().set(requested);
   }
 
 protected:
-  std::size_t get_idx() const {
-    if (m_registered_idx == std::numeric_limits<size_t>::max())
-      m_registered_idx = register_option(m_option);
+  // Registering returns the same pointer for the same option name no
+  // matter which thread registers it first.
+  option_c &get_option() const {
+    auto option = m_registered_option.load();
+
+    if (!option) {
+      option              = register_option(m_option);
+      m_registered_option = option;
+    }
 
-    return m_registered_idx;
+    return *option;
   }
 
+  static option_c *register_option(std::string const &option);
+
 public:
-  static size_t register_option(std::string const &option);
   static void invalidate_cache();
 };
 
@@ -14,6 +14,10 @@
 
 #include "common/common_pch.h"
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #if defined(HAVE_UNISTD_H)
 # include <unistd.h>
 #endif  // HAVE_UNISTD_H
@@ -896,6 +900,39 @@ header_t::decode_exss_header(unsigned char const *buf,
   return false;
 }
 
+#if defined(__SSE2__)
+// dst_n = (src_n << (2 * n + 2)) | ((src_n+1 & 0x3fff) >> (12 - 2 * n))
+// for n = 0..6 with all words in big endian byte order. The per-word
+// shifts are done by multiplying with powers of two as SSE2 lacks
+// variable shifts for 16-bit words.
+static void
+convert_14_to_16_bits_sse2(const unsigned short *src,
+                           unsigned long num_blocks,
+                           unsigned short *dst) {
+  auto const shift_left  = _mm_setr_epi16(4, 16, 64, 256, 1024, 4096, 16384, 0);
+  auto const shift_right = _mm_setr_epi16(16, 64, 256, 1024, 4096, 16384, 0, 0);
+  auto const mask_14     = _mm_set1_epi16(0x3fff);
+  auto const mask_last   = _mm_setr_epi16(0, 0, 0, 0, 0, 0, -1, 0);
+
+  auto swap = [](__m128i value) {
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+  };
+
+  for (unsigned long b = 0; b < num_blocks; b++) {
+    auto words = swap(_mm_loadu_si128(reinterpret_cast<__m128i const *>(src)));
+    auto next  = _mm_and_si128(_mm_srli_si128(words, 2), mask_14);
+    auto high  = _mm_mullo_epi16(words, shift_left);
+    auto low   = _mm_or_si128(_mm_mulhi_epu16(next, shift_right), _mm_and_si128(next, mask_last));
+
+    // Writing in place is safe: the store ends before the next block.
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), swap(_mm_or_si128(high, low)));
+
+    dst += 7;
+    src += 8;
+  }
+}
+#endif
+
 void
 convert_14_to_16_bits(const unsigned short *src,
                       unsigned long srcwords,
@@ -903,7 +940,19 @@ convert_14_to_16_bits(const unsigned short *src,
   // srcwords has to be a multiple of 8!
   // you will get (srcbytes >> 3)*7 destination words!
 
-  const unsigned long l = srcwords >> 3;
+  unsigned long l = srcwords >> 3;
+
+#if defined(__SSE2__)
+  // Each block of eight 14-bit words fits into one register. The last
+  // block is converted by the scalar code as the vector store writes
+  // two bytes more than the seven words produced.
+  if (l > 1) {
+    convert_14_to_16_bits_sse2(src, l - 1, dst);
+    src += (l - 1) * 8;
+    dst += (l - 1) * 7;
+    l    = 1;
+  }
+#endif
 
   for (unsigned long b = 0; b < l; b++) {
     unsigned short src_0 = (src[0] >>  8) | (src[0] << 8);
@@ -0,0 +1,275 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   splitting raw FLAC streams into frames
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/flac_frame_parser.h"
+
+namespace mtx { namespace flac {
+
+namespace {
+
+// Sync code (14 bits), reserved bit, blocking strategy bit, block
+// size, sample rate, channel assignment, sample size, reserved bit,
+// coded frame or sample number (up to seven bytes), optional block
+// size (up to two bytes), optional sample rate (up to two bytes) and
+// the CRC-8.
+std::size_t const s_max_header_size = 16;
+
+}
+
+frame_parser_c::frame_parser_c()
+{
+}
+
+void
+frame_parser_c::set_seek_point_offsets(std::vector<uint64_t> offsets) {
+  brng::sort(offsets);
+  m_seek_point_offsets = std::move(offsets);
+}
+
+void
+frame_parser_c::set_min_frame_size(std::size_t min_frame_size) {
+  m_min_frame_size = min_frame_size;
+}
+
+// See https://xiph.org/flac/format.html#frame_header
+int
+frame_parser_c::get_frame_header_size(unsigned char const *buffer,
+                                      std::size_t size) {
+  if (size < 4)
+    return -1;
+
+  if ((buffer[0] != 0xff) || ((buffer[1] & 0xfe) != 0xf8))
+    return 0;
+
+  auto block_size_code  = buffer[2] >> 4;
+  auto sample_rate_code = buffer[2] & 0x0f;
+  auto channels_code    = buffer[3] >> 4;
+  auto sample_size_code = (buffer[3] >> 1) & 0x07;
+
+  if ((0 == block_size_code) || (0x0f == sample_rate_code) || (0x0a < channels_code) || (3 == sample_size_code) || (buffer[3] & 0x01))
+    return 0;
+
+  // The frame or sample number is coded like UTF-8 with up to six
+  // continuation bytes.
+  std::size_t position = 4;
+
+  if (size <= position)
+    return -1;
+
+  auto first_byte         = buffer[position++];
+  auto num_continuations  = first_byte <  0x80 ? 0
+                          : first_byte <  0xc0 ? -1
+                          : first_byte <  0xe0 ? 1
+                          : first_byte <  0xf0 ? 2
+                          : first_byte <  0xf8 ? 3
+                          : first_byte <  0xfc ? 4
+                          : first_byte <  0xfe ? 5
+                          : first_byte == 0xfe ? 6
+                          :                      -1;
+
+  // Only streams with a variable block size use the seven byte form.
+  if ((-1 == num_continuations) || ((6 == num_continuations) && !(buffer[1] & 0x01)))
+    return 0;
+
+  for (auto idx = 0; idx < num_continuations; ++idx, ++position) {
+    if (size <= position)
+      return -1;
+    if ((buffer[position] & 0xc0) != 0x80)
+      return 0;
+  }
+
+  position += 6 == block_size_code  ? 1
+            : 7 == block_size_code  ? 2
+            :                         0;
+  position += 12 == sample_rate_code ? 1
+            : 13 <= sample_rate_code ? 2
+            :                          0;
+
+  if (size <= position)
+    return -1;
+
+  mtx::checksum::crc8_atm_c crc;
+  crc.add(buffer, position);
+
+  if (crc.get_result_as_uint() != buffer[position])
+    return 0;
+
+  return position + 1;
+}
+
+void
+frame_parser_c::add_bytes(unsigned char const *buffer,
+                          std::size_t size) {
+  m_buffer.add(buffer, size);
+  parse(false);
+}
+
+void
+frame_parser_c::flush() {
+  parse(true);
+}
+
+bool
+frame_parser_c::frame_available()
+  const {
+  return !m_frames.empty();
+}
+
+memory_cptr
+frame_parser_c::get_frame() {
+  if (m_frames.empty())
+    return {};
+
+  auto frame = m_frames.front();
+  m_frames.pop_front();
+
+  return frame;
+}
+
+uint64_t
+frame_parser_c::get_garbage_size()
+  const {
+  return m_garbage_size;
+}
+
+bool
+frame_parser_c::is_seek_point(std::size_t position)
+  const {
+  return brng::binary_search(m_seek_point_offsets, m_stream_position + position);
+}
+
+void
+frame_parser_c::add_frame(std::size_t size) {
+  m_frames.push_back(memory_c::clone(m_buffer.get_buffer(), size));
+  m_buffer.remove(size);
+
+  m_stream_position += size;
+  m_scan_position    = 0;
+  m_crc_position     = 0;
+  m_crc.set_initial_value(0);
+}
+
+// Drops everything in front of the first valid frame header.
+bool
+frame_parser_c::sync() {
+  auto buffer = m_buffer.get_buffer();
+  auto size   = m_buffer.get_size();
+
+  for (auto position = std::size_t{}; position < size; ++position) {
+    auto header_size = get_frame_header_size(&buffer[position], size - position);
+
+    if (-1 == header_size) {
+      m_buffer.remove(position);
+      m_stream_position += position;
+      m_garbage_size    += position;
+      return false;
+    }
+
+    if (0 < header_size) {
+      m_buffer.remove(position);
+      m_stream_position += position;
+      m_garbage_size    += position;
+      m_synced           = true;
+      return true;
+    }
+  }
+
+  m_buffer.remove(size);
+  m_stream_position += size;
+  m_garbage_size    += size;
+
+  return false;
+}
+
+void
+frame_parser_c::parse(bool end_of_stream) {
+  if (!m_synced && !sync())
+    return;
+
+  while (true) {
+    auto buffer = m_buffer.get_buffer();
+    auto size   = m_buffer.get_size();
+
+    // The candidate for the next frame's start must be behind the
+    // current frame's header and must respect the minimum frame size.
+    m_scan_position = std::max<std::size_t>({ m_scan_position, m_min_frame_size, 2 });
+
+    auto next_frame_found = false;
+
+    while ((m_scan_position + 1) < size) {
+      auto candidate = static_cast<unsigned char const *>(std::memchr(&buffer[m_scan_position], 0xff, size - m_scan_position - 1));
+      if (!candidate) {
+        m_scan_position = size - 1;
+        break;
+      }
+
+      m_scan_position = candidate - buffer;
+
+      // The blocking strategy must not change within a stream.
+      if (buffer[m_scan_position + 1] != buffer[1]) {
+        ++m_scan_position;
+        continue;
+      }
+
+      auto header_size = get_frame_header_size(&buffer[m_scan_position], size - m_scan_position);
+      if ((-1 == header_size) && !end_of_stream)
+        return;
+
+      if (0 < header_size) {
+        m_crc.add(&buffer[m_crc_position], m_scan_position - m_crc_position);
+        m_crc_position = m_scan_position;
+
+        if ((0 == m_crc.get_result_as_uint()) || is_seek_point(m_scan_position)) {
+          next_frame_found = true;
+          break;
+        }
+      }
+
+      ++m_scan_position;
+    }
+
+    if (next_frame_found) {
+      add_frame(m_scan_position);
+      continue;
+    }
+
+    if (!end_of_stream || !size)
+      return;
+
+    // The last frame ends at the first position with a valid CRC-16.
+    // Anything following it (e.g. tags) is dropped.
+    m_crc.add(&buffer[m_crc_position], size - m_crc_position);
+    if (0 == m_crc.get_result_as_uint()) {
+      add_frame(size);
+      return;
+    }
+
+    mtx::checksum::crc16_ansi_c crc;
+    for (auto position = std::size_t{}; position < size; ++position) {
+      crc.add(&buffer[position], 1);
+      if ((position >= std::max<std::size_t>(m_min_frame_size, 3)) && (0 == crc.get_result_as_uint())) {
+        m_garbage_size += size - position - 1;
+        add_frame(position + 1);
+        m_buffer.clear();
+        return;
+      }
+    }
+
+    add_frame(size);
+    return;
+  }
+}
+
+}}
@@ -0,0 +1,71 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   splitting raw FLAC streams into frames
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_FLAC_FRAME_PARSER_H
+#define MTX_COMMON_FLAC_FRAME_PARSER_H
+
+#include "common/common_pch.h"
+
+#include <deque>
+
+#include "common/byte_buffer.h"
+#include "common/checksums/crc.h"
+
+namespace mtx { namespace flac {
+
+// Splits the frames of a raw FLAC stream without decoding them. Frame
+// headers are recognized by their sync code and their CRC-8. As the
+// sync code may occur inside a frame, too, a header is only accepted
+// as the start of the next frame if the data in front of it ends with
+// a valid CRC-16 or if a seek point refers to its position.
+class frame_parser_c {
+protected:
+  byte_buffer_c m_buffer;
+  std::deque<memory_cptr> m_frames;
+  std::vector<uint64_t> m_seek_point_offsets;
+  std::size_t m_min_frame_size{}, m_scan_position{}, m_crc_position{};
+  mtx::checksum::crc16_ansi_c m_crc;
+  uint64_t m_stream_position{}, m_garbage_size{};
+  bool m_synced{};
+
+public:
+  frame_parser_c();
+
+  // Offsets of frames relative to the start of the first frame as
+  // found in the SEEKTABLE metadata block.
+  void set_seek_point_offsets(std::vector<uint64_t> offsets);
+  void set_min_frame_size(std::size_t min_frame_size);
+
+  void add_bytes(unsigned char const *buffer, std::size_t size);
+  void flush();
+
+  bool frame_available() const;
+  memory_cptr get_frame();
+
+  uint64_t get_garbage_size() const;
+
+  // Returns the header's size if buffer starts with a valid frame
+  // header, 0 if it doesn't and -1 if there isn't enough data for
+  // deciding.
+  static int get_frame_header_size(unsigned char const *buffer, std::size_t size);
+
+protected:
+  void parse(bool end_of_stream);
+  bool sync();
+  bool is_seek_point(std::size_t position) const;
+  void add_frame(std::size_t size);
+};
+
+}}
+
+#endif  // MTX_COMMON_FLAC_FRAME_PARSER_H
@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include <cmath>
+#include <mutex>
 #include <unordered_map>
 
 #include "common/bit_reader.h"
@@ -1383,6 +1384,7 @@ es_parser_c::es_parser_c()
   , m_max_timecode(0)
   , m_stream_position(0)
   , m_parsed_position(0)
+  , m_max_partitions{mtx::mpeg::default_max_partitions()}
   , m_have_incomplete_frame(false)
   , m_simple_picture_order{}
   , m_ignore_nalu_size_length_errors(false)
@@ -1432,68 +1434,110 @@ es_parser_c::discard_actual_frames(bool discard) {
 
 void
 es_parser_c::add_bytes(unsigned char *buffer,
-                       size_t size) {
-  memory_slice_cursor_c cursor;
-  int marker_size              = 0;
-  int previous_marker_size     = 0;
-  int previous_pos             = -1;
-  uint64_t previous_parsed_pos = m_parsed_position;
-
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
-
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker =                               1 << 24
-                    | (unsigned int)cursor.get_char() << 16
-                    | (unsigned int)cursor.get_char() <<  8
-                    | (unsigned int)cursor.get_char();
-
-    while (1) {
-      if (NALU_START_CODE == marker)
-        marker_size = 4;
-      else if (NALU_START_CODE == (marker & 0x00ffffff))
-        marker_size = 3;
-
-      if (0 != marker_size) {
-        if (-1 != previous_pos) {
-          auto new_size = cursor.get_position() - marker_size - previous_pos - previous_marker_size;
-          auto nalu     = memory_c::alloc(new_size);
-          cursor.copy(nalu->get_buffer(), previous_pos + previous_marker_size, new_size);
-          m_parsed_position = previous_parsed_pos + previous_pos;
-
-          mtx::mpeg::remove_trailing_zero_bytes(*nalu);
-          if (nalu->get_size())
-            handle_nalu(nalu, m_parsed_position);
-        }
-        previous_pos         = cursor.get_position() - marker_size;
-        previous_marker_size = marker_size;
-        marker_size          = 0;
-      }
+                      size_t size) {
+  auto previous_parsed_pos = m_parsed_position;
+  auto unparsed_size       = m_unparsed_buffer ? m_unparsed_buffer->get_size() : 0;
+  auto data                = buffer;
+  auto data_size           = unparsed_size + size;
+  auto combined            = memory_cptr{};
+
+  if (unparsed_size) {
+    combined = memory_c::alloc(data_size);
+    data     = combined->get_buffer();
+
+    memcpy(data,                 m_unparsed_buffer->get_buffer(), unparsed_size);
+    memcpy(data + unparsed_size, buffer,                          size);
+  }
 
-      if (!cursor.char_available())
-        break;
+  // Large buffers are split into partitions. Finding the start codes
+  // and parsing the slice headers is done for all of them
+  // concurrently. The NALUs are then handled in stream order, the
+  // same way they are without partitions.
+  auto num_partitions = mtx::mpeg::get_num_partitions(data_size, m_max_partitions);
 
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
-    }
+  // A start code is four bytes long if a zero byte precedes the
+  // 00 00 01.
+  std::vector<std::pair<std::size_t, std::size_t>> markers;
+
+  for (auto start_code_pos : mtx::mpeg::find_start_codes(data, data_size, num_partitions)) {
+    auto marker_size = (start_code_pos && !data[start_code_pos - 1]) ? 4 : 3;
+    markers.emplace_back(start_code_pos - marker_size + 3, marker_size);
+  }
+
+  auto pre_parsed_slices = pre_parse_slices(data, markers, num_partitions);
+
+  for (auto idx = 1u; idx < markers.size(); ++idx) {
+    auto const &previous = markers[idx - 1];
+    auto nalu            = memory_c::clone(data + previous.first + previous.second, markers[idx].first - previous.first - previous.second);
+    m_parsed_position    = previous_parsed_pos + previous.first;
+
+    mtx::mpeg::remove_trailing_zero_bytes(*nalu);
+    if (nalu->get_size())
+      handle_nalu(nalu, m_parsed_position, pre_parsed_slices.empty() ? nullptr : &pre_parsed_slices[idx - 1]);
   }
 
-  if (-1 == previous_pos)
-    previous_pos = 0;
+  auto unparsed_pos = markers.empty() ? 0 : markers.back().first;
 
   m_stream_position += size;
-  m_parsed_position  = previous_parsed_pos + previous_pos;
+  m_parsed_position  = previous_parsed_pos + unparsed_pos;
 
-  int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    m_unparsed_buffer = memory_c::alloc(new_size);
-    cursor.copy(m_unparsed_buffer->get_buffer(), previous_pos, new_size);
+  auto new_size = data_size - unparsed_pos;
+  if (0 != new_size)
+    m_unparsed_buffer = memory_c::clone(data + unparsed_pos, new_size);
 
-  } else
+  else
     m_unparsed_buffer.reset();
 }
 
+/** \brief Parses the slice headers of all complete NALUs concurrently
+
+   Only the SPS and PPS known when the buffer was added are used. The
+   results are tagged with their generation; slices following a change
+   of those are parsed again when their turn comes. Returns nothing if
+   the buffer isn't split into partitions.
+*/
+std::vector<pre_parsed_slice_t>
+es_parser_c::pre_parse_slices(unsigned char const *data,
+                              std::vector<std::pair<std::size_t, std::size_t>> const &markers,
+                              unsigned int num_partitions)
+  const {
+  std::vector<pre_parsed_slice_t> pre_parsed_slices;
+
+  if ((2 > num_partitions) || (2 > markers.size()))
+    return pre_parsed_slices;
+
+  pre_parsed_slices.resize(markers.size() - 1);
+
+  mtx::mpeg::run_partitioned(pre_parsed_slices.size(), num_partitions, [this, data, &markers, &pre_parsed_slices](std::size_t begin, std::size_t end) {
+    for (auto idx = begin; idx < end; ++idx) {
+      auto start = markers[idx].first + markers[idx].second;
+      auto size  = markers[idx + 1].first - start;
+
+      // Same as remove_trailing_zero_bytes() without the debug output.
+      while (size && !data[start + size - 1])
+        --size;
+
+      if (!size)
+        continue;
+
+      auto type = (data[start] >> 1) & 0x3f;
+      if (   (HEVC_NALU_TYPE_RASL_R < type)
+          && ((HEVC_NALU_TYPE_BLA_W_LP > type) || (HEVC_NALU_TYPE_CRA_NUT < type)))
+        continue;
+
+      auto &parsed = pre_parsed_slices[idx];
+      auto nalu    = memory_cptr{new memory_c(const_cast<unsigned char *>(data + start), size, false)};
+
+      parse_slice(mpeg::nalu_to_rbsp(nalu), parsed, m_sps_info_list, m_pps_info_list);
+
+      parsed.m_available                 = true;
+      parsed.m_parameter_sets_generation = m_parameter_sets_generation;
+    }
+  });
+
+  return pre_parsed_slices;
+}
+
 void
 es_parser_c::flush() {
   if (m_unparsed_buffer && (5 <= m_unparsed_buffer->get_size())) {
@@ -1538,14 +1582,19 @@ es_parser_c::flush_unhandled_nalus() {
 
 void
 es_parser_c::handle_slice_nalu(memory_cptr const &nalu,
-                               uint64_t nalu_pos) {
+                               uint64_t nalu_pos,
+                               pre_parsed_slice_t const *pre_parsed_slice) {
   if (!m_hevcc_ready) {
     m_unhandled_nalus.emplace_back(nalu, nalu_pos);
     return;
   }
 
+  auto use_pre_parsed_slice = pre_parsed_slice
+                           && pre_parsed_slice->m_available
+                           && (pre_parsed_slice->m_parameter_sets_generation == m_parameter_sets_generation);
+
   slice_info_t si;
-  if (!parse_slice(mpeg::nalu_to_rbsp(nalu), si))
+  if (!(use_pre_parsed_slice ? use_parsed_slice(*pre_parsed_slice, si) : parse_slice(mpeg::nalu_to_rbsp(nalu), si)))
     return;
 
   if (m_have_incomplete_frame && si.first_slice_segment_in_pic_flag)
@@ -1664,6 +1713,7 @@ es_parser_c::handle_sps_nalu(memory_cptr const &nalu) {
     m_sps_list.push_back(parsed_nalu);
     m_sps_info_list.push_back(sps_info);
     m_hevcc_changed = true;
+    ++m_parameter_sets_generation;
 
   } else if (m_sps_info_list[i].checksum != sps_info.checksum) {
     mxverb(2, boost::format("hevc: SPS ID %|1$04x| changed; checksum old %|2$04x| new %|3$04x|\n") % sps_info.id % m_sps_info_list[i].checksum % sps_info.checksum);
@@ -1673,6 +1723,7 @@ es_parser_c::handle_sps_nalu(memory_cptr const &nalu) {
     m_sps_info_list[i] = sps_info;
     m_sps_list[i]      = parsed_nalu;
     m_hevcc_changed    = true;
+    ++m_parameter_sets_generation;
 
     // Update codec private if needed
     if (m_codec_private.sps_data_id == (int) sps_info.id) {
@@ -1735,6 +1786,7 @@ es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
     m_pps_list.push_back(nalu);
     m_pps_info_list.push_back(pps_info);
     m_hevcc_changed = true;
+    ++m_parameter_sets_generation;
 
   } else if (m_pps_info_list[i].checksum != pps_info.checksum) {
     mxverb(2, boost::format("hevc: PPS ID %|1$04x| changed; checksum old %|2$04x| new %|3$04x|\n") % pps_info.id % m_pps_info_list[i].checksum % pps_info.checksum);
@@ -1745,6 +1797,7 @@ es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
     m_pps_info_list[i] = pps_info;
     m_pps_list[i]      = nalu;
     m_hevcc_changed     = true;
+    ++m_parameter_sets_generation;
   }
 
   m_extra_data.push_back(create_nalu_with_size(nalu));
@@ -1758,7 +1811,8 @@ es_parser_c::handle_sei_nalu(memory_cptr const &nalu) {
 
 void
 es_parser_c::handle_nalu(memory_cptr const &nalu,
-                         uint64_t nalu_pos) {
+                         uint64_t nalu_pos,
+                         pre_parsed_slice_t const *pre_parsed_slice) {
   if (1 > nalu->get_size())
     return;
 
@@ -1817,7 +1871,7 @@ es_parser_c::handle_nalu(memory_cptr const &nalu,
         m_hevcc_ready = true;
         flush_unhandled_nalus();
       }
-      handle_slice_nalu(nalu, nalu_pos);
+      handle_slice_nalu(nalu, nalu_pos, pre_parsed_slice);
       break;
 
     default:
@@ -1832,9 +1886,20 @@ es_parser_c::handle_nalu(memory_cptr const &nalu,
   }
 }
 
-bool
+/** \brief Parses a slice header
+
+   Only reads the SPS and PPS lists given, making it safe to call from
+   several threads at once. Instead of updating the statistics and
+   reporting errors it records them in \c parsed. use_parsed_slice()
+   takes care of that.
+*/
+void
 es_parser_c::parse_slice(memory_cptr const &buffer,
-                         slice_info_t &si) {
+                         pre_parsed_slice_t &parsed,
+                         std::vector<sps_info_t> const &sps_info_list,
+                         std::vector<pps_info_t> const &pps_info_list) {
+  auto &si = parsed.m_si;
+
   try {
     bit_reader_c r(buffer->get_buffer(), buffer->get_size());
     unsigned int i;
@@ -1855,26 +1920,26 @@ es_parser_c::parse_slice(memory_cptr const &buffer,
     si.pps_id = r.get_unsigned_golomb();  // slice_pic_parameter_set_id
 
     size_t pps_idx;
-    for (pps_idx = 0; m_pps_info_list.size() > pps_idx; ++pps_idx)
-      if (m_pps_info_list[pps_idx].id == si.pps_id)
+    for (pps_idx = 0; pps_info_list.size() > pps_idx; ++pps_idx)
+      if (pps_info_list[pps_idx].id == si.pps_id)
         break;
-    if (m_pps_info_list.size() == pps_idx) {
-      mxverb(3, boost::format("slice parser error: PPS not found: %1%\n") % si.pps_id);
-      return false;
+    if (pps_info_list.size() == pps_idx) {
+      parsed.m_error = (boost::format("slice parser error: PPS not found: %1%\n") % si.pps_id).str();
+      return;
     }
 
-    pps_info_t &pps = m_pps_info_list[pps_idx];
+    auto const &pps = pps_info_list[pps_idx];
     size_t sps_idx;
-    for (sps_idx = 0; m_sps_info_list.size() > sps_idx; ++sps_idx)
-      if (m_sps_info_list[sps_idx].id == pps.sps_id)
+    for (sps_idx = 0; sps_info_list.size() > sps_idx; ++sps_idx)
+      if (sps_info_list[sps_idx].id == pps.sps_id)
         break;
-    if (m_sps_info_list.size() == sps_idx)
-      return false;
+    if (sps_info_list.size() == sps_idx)
+      return;
 
     si.sps = sps_idx;
     si.pps = pps_idx;
 
-    sps_info_t &sps = m_sps_info_list[sps_idx];
+    auto const &sps = sps_info_list[sps_idx];
 
     bool dependent_slice_segment_flag = false;
     if (!si.first_slice_segment_in_pic_flag) {
@@ -1908,15 +1973,38 @@ es_parser_c::parse_slice(memory_cptr const &buffer,
         si.pic_order_cnt_lsb = r.get_bits(sps.log2_max_pic_order_cnt_lsb); // slice_pic_order_cnt_lsb
       }
 
-      ++m_stats.num_slices_by_type[1 < si.type ? 2 : si.type];
+      parsed.m_type_index = 1 < si.type ? 2 : si.type;
     }
 
-    return true;
+    parsed.m_valid = true;
+
   } catch (...) {
-    return false;
   }
 }
 
+bool
+es_parser_c::parse_slice(memory_cptr const &buffer,
+                         slice_info_t &si) {
+  pre_parsed_slice_t parsed;
+  parse_slice(buffer, parsed, m_sps_info_list, m_pps_info_list);
+
+  return use_parsed_slice(parsed, si);
+}
+
+bool
+es_parser_c::use_parsed_slice(pre_parsed_slice_t const &parsed,
+                              slice_info_t &si) {
+  if (-1 != parsed.m_type_index)
+    ++m_stats.num_slices_by_type[parsed.m_type_index];
+
+  if (!parsed.m_error.empty())
+    mxverb(3, parsed.m_error);
+
+  si = parsed.m_si;
+
+  return parsed.m_valid;
+}
+
 int64_t
 es_parser_c::duration_for(slice_info_t const &si)
   const {
@@ -2250,75 +2338,77 @@ es_parser_c::get_nalu_type_name(int type) {
 
 void
 es_parser_c::init_nalu_names() {
-  if (!ms_nalu_names_by_type.empty())
-    return;
-
-  ms_nalu_names_by_type = std::unordered_map<int, std::string>{
-    { HEVC_NALU_TYPE_TRAIL_N,       "trail_n"       },
-    { HEVC_NALU_TYPE_TRAIL_R,       "trail_r"       },
-    { HEVC_NALU_TYPE_TSA_N,         "tsa_n"         },
-    { HEVC_NALU_TYPE_TSA_R,         "tsa_r"         },
-    { HEVC_NALU_TYPE_STSA_N,        "stsa_n"        },
-    { HEVC_NALU_TYPE_STSA_R,        "stsa_r"        },
-    { HEVC_NALU_TYPE_RADL_N,        "radl_n"        },
-    { HEVC_NALU_TYPE_RADL_R,        "radl_r"        },
-    { HEVC_NALU_TYPE_RASL_N,        "rasl_n"        },
-    { HEVC_NALU_TYPE_RASL_R,        "rasl_r"        },
-    { HEVC_NALU_TYPE_RSV_VCL_N10,   "rsv_vcl_n10"   },
-    { HEVC_NALU_TYPE_RSV_VCL_N12,   "rsv_vcl_n12"   },
-    { HEVC_NALU_TYPE_RSV_VCL_N14,   "rsv_vcl_n14"   },
-    { HEVC_NALU_TYPE_RSV_VCL_R11,   "rsv_vcl_r11"   },
-    { HEVC_NALU_TYPE_RSV_VCL_R13,   "rsv_vcl_r13"   },
-    { HEVC_NALU_TYPE_RSV_VCL_R15,   "rsv_vcl_r15"   },
-    { HEVC_NALU_TYPE_BLA_W_LP,      "bla_w_lp"      },
-    { HEVC_NALU_TYPE_BLA_W_RADL,    "bla_w_radl"    },
-    { HEVC_NALU_TYPE_BLA_N_LP,      "bla_n_lp"      },
-    { HEVC_NALU_TYPE_IDR_W_RADL,    "idr_w_radl"    },
-    { HEVC_NALU_TYPE_IDR_N_LP,      "idr_n_lp"      },
-    { HEVC_NALU_TYPE_CRA_NUT,       "cra_nut"       },
-    { HEVC_NALU_TYPE_RSV_RAP_VCL22, "rsv_rap_vcl22" },
-    { HEVC_NALU_TYPE_RSV_RAP_VCL23, "rsv_rap_vcl23" },
-    { HEVC_NALU_TYPE_RSV_VCL24,     "rsv_vcl24"     },
-    { HEVC_NALU_TYPE_RSV_VCL25,     "rsv_vcl25"     },
-    { HEVC_NALU_TYPE_RSV_VCL26,     "rsv_vcl26"     },
-    { HEVC_NALU_TYPE_RSV_VCL27,     "rsv_vcl27"     },
-    { HEVC_NALU_TYPE_RSV_VCL28,     "rsv_vcl28"     },
-    { HEVC_NALU_TYPE_RSV_VCL29,     "rsv_vcl29"     },
-    { HEVC_NALU_TYPE_RSV_VCL30,     "rsv_vcl30"     },
-    { HEVC_NALU_TYPE_RSV_VCL31,     "rsv_vcl31"     },
-    { HEVC_NALU_TYPE_VIDEO_PARAM,   "video_param"   },
-    { HEVC_NALU_TYPE_SEQ_PARAM,     "seq_param"     },
-    { HEVC_NALU_TYPE_PIC_PARAM,     "pic_param"     },
-    { HEVC_NALU_TYPE_ACCESS_UNIT,   "access_unit"   },
-    { HEVC_NALU_TYPE_END_OF_SEQ,    "end_of_seq"    },
-    { HEVC_NALU_TYPE_END_OF_STREAM, "end_of_stream" },
-    { HEVC_NALU_TYPE_FILLER_DATA,   "filler_data"   },
-    { HEVC_NALU_TYPE_PREFIX_SEI,    "prefix_sei"    },
-    { HEVC_NALU_TYPE_SUFFIX_SEI,    "suffix_sei"    },
-    { HEVC_NALU_TYPE_RSV_NVCL41,    "rsv_nvcl41"    },
-    { HEVC_NALU_TYPE_RSV_NVCL42,    "rsv_nvcl42"    },
-    { HEVC_NALU_TYPE_RSV_NVCL43,    "rsv_nvcl43"    },
-    { HEVC_NALU_TYPE_RSV_NVCL44,    "rsv_nvcl44"    },
-    { HEVC_NALU_TYPE_RSV_NVCL45,    "rsv_nvcl45"    },
-    { HEVC_NALU_TYPE_RSV_NVCL46,    "rsv_nvcl46"    },
-    { HEVC_NALU_TYPE_RSV_NVCL47,    "rsv_nvcl47"    },
-    { HEVC_NALU_TYPE_UNSPEC48,      "unspec48"      },
-    { HEVC_NALU_TYPE_UNSPEC49,      "unspec49"      },
-    { HEVC_NALU_TYPE_UNSPEC50,      "unspec50"      },
-    { HEVC_NALU_TYPE_UNSPEC51,      "unspec51"      },
-    { HEVC_NALU_TYPE_UNSPEC52,      "unspec52"      },
-    { HEVC_NALU_TYPE_UNSPEC53,      "unspec53"      },
-    { HEVC_NALU_TYPE_UNSPEC54,      "unspec54"      },
-    { HEVC_NALU_TYPE_UNSPEC55,      "unspec55"      },
-    { HEVC_NALU_TYPE_UNSPEC56,      "unspec56"      },
-    { HEVC_NALU_TYPE_UNSPEC57,      "unspec57"      },
-    { HEVC_NALU_TYPE_UNSPEC58,      "unspec58"      },
-    { HEVC_NALU_TYPE_UNSPEC59,      "unspec59"      },
-    { HEVC_NALU_TYPE_UNSPEC60,      "unspec60"      },
-    { HEVC_NALU_TYPE_UNSPEC61,      "unspec61"      },
-    { HEVC_NALU_TYPE_UNSPEC62,      "unspec62"      },
-    { HEVC_NALU_TYPE_UNSPEC63,      "unspec63"      },
-  };
+  // The HEVC parsers of several readers may run concurrently.
+  static std::once_flag s_initialized;
+
+  std::call_once(s_initialized, []() {
+    ms_nalu_names_by_type = std::unordered_map<int, std::string>{
+      { HEVC_NALU_TYPE_TRAIL_N,       "trail_n"       },
+      { HEVC_NALU_TYPE_TRAIL_R,       "trail_r"       },
+      { HEVC_NALU_TYPE_TSA_N,         "tsa_n"         },
+      { HEVC_NALU_TYPE_TSA_R,         "tsa_r"         },
+      { HEVC_NALU_TYPE_STSA_N,        "stsa_n"        },
+      { HEVC_NALU_TYPE_STSA_R,        "stsa_r"        },
+      { HEVC_NALU_TYPE_RADL_N,        "radl_n"        },
+      { HEVC_NALU_TYPE_RADL_R,        "radl_r"        },
+      { HEVC_NALU_TYPE_RASL_N,        "rasl_n"        },
+      { HEVC_NALU_TYPE_RASL_R,        "rasl_r"        },
+      { HEVC_NALU_TYPE_RSV_VCL_N10,   "rsv_vcl_n10"   },
+      { HEVC_NALU_TYPE_RSV_VCL_N12,   "rsv_vcl_n12"   },
+      { HEVC_NALU_TYPE_RSV_VCL_N14,   "rsv_vcl_n14"   },
+      { HEVC_NALU_TYPE_RSV_VCL_R11,   "rsv_vcl_r11"   },
+      { HEVC_NALU_TYPE_RSV_VCL_R13,   "rsv_vcl_r13"   },
+      { HEVC_NALU_TYPE_RSV_VCL_R15,   "rsv_vcl_r15"   },
+      { HEVC_NALU_TYPE_BLA_W_LP,      "bla_w_lp"      },
+      { HEVC_NALU_TYPE_BLA_W_RADL,    "bla_w_radl"    },
+      { HEVC_NALU_TYPE_BLA_N_LP,      "bla_n_lp"      },
+      { HEVC_NALU_TYPE_IDR_W_RADL,    "idr_w_radl"    },
+      { HEVC_NALU_TYPE_IDR_N_LP,      "idr_n_lp"      },
+      { HEVC_NALU_TYPE_CRA_NUT,       "cra_nut"       },
+      { HEVC_NALU_TYPE_RSV_RAP_VCL22, "rsv_rap_vcl22" },
+      { HEVC_NALU_TYPE_RSV_RAP_VCL23, "rsv_rap_vcl23" },
+      { HEVC_NALU_TYPE_RSV_VCL24,     "rsv_vcl24"     },
+      { HEVC_NALU_TYPE_RSV_VCL25,     "rsv_vcl25"     },
+      { HEVC_NALU_TYPE_RSV_VCL26,     "rsv_vcl26"     },
+      { HEVC_NALU_TYPE_RSV_VCL27,     "rsv_vcl27"     },
+      { HEVC_NALU_TYPE_RSV_VCL28,     "rsv_vcl28"     },
+      { HEVC_NALU_TYPE_RSV_VCL29,     "rsv_vcl29"     },
+      { HEVC_NALU_TYPE_RSV_VCL30,     "rsv_vcl30"     },
+      { HEVC_NALU_TYPE_RSV_VCL31,     "rsv_vcl31"     },
+      { HEVC_NALU_TYPE_VIDEO_PARAM,   "video_param"   },
+      { HEVC_NALU_TYPE_SEQ_PARAM,     "seq_param"     },
+      { HEVC_NALU_TYPE_PIC_PARAM,     "pic_param"     },
+      { HEVC_NALU_TYPE_ACCESS_UNIT,   "access_unit"   },
+      { HEVC_NALU_TYPE_END_OF_SEQ,    "end_of_seq"    },
+      { HEVC_NALU_TYPE_END_OF_STREAM, "end_of_stream" },
+      { HEVC_NALU_TYPE_FILLER_DATA,   "filler_data"   },
+      { HEVC_NALU_TYPE_PREFIX_SEI,    "prefix_sei"    },
+      { HEVC_NALU_TYPE_SUFFIX_SEI,    "suffix_sei"    },
+      { HEVC_NALU_TYPE_RSV_NVCL41,    "rsv_nvcl41"    },
+      { HEVC_NALU_TYPE_RSV_NVCL42,    "rsv_nvcl42"    },
+      { HEVC_NALU_TYPE_RSV_NVCL43,    "rsv_nvcl43"    },
+      { HEVC_NALU_TYPE_RSV_NVCL44,    "rsv_nvcl44"    },
+      { HEVC_NALU_TYPE_RSV_NVCL45,    "rsv_nvcl45"    },
+      { HEVC_NALU_TYPE_RSV_NVCL46,    "rsv_nvcl46"    },
+      { HEVC_NALU_TYPE_RSV_NVCL47,    "rsv_nvcl47"    },
+      { HEVC_NALU_TYPE_UNSPEC48,      "unspec48"      },
+      { HEVC_NALU_TYPE_UNSPEC49,      "unspec49"      },
+      { HEVC_NALU_TYPE_UNSPEC50,      "unspec50"      },
+      { HEVC_NALU_TYPE_UNSPEC51,      "unspec51"      },
+      { HEVC_NALU_TYPE_UNSPEC52,      "unspec52"      },
+      { HEVC_NALU_TYPE_UNSPEC53,      "unspec53"      },
+      { HEVC_NALU_TYPE_UNSPEC54,      "unspec54"      },
+      { HEVC_NALU_TYPE_UNSPEC55,      "unspec55"      },
+      { HEVC_NALU_TYPE_UNSPEC56,      "unspec56"      },
+      { HEVC_NALU_TYPE_UNSPEC57,      "unspec57"      },
+      { HEVC_NALU_TYPE_UNSPEC58,      "unspec58"      },
+      { HEVC_NALU_TYPE_UNSPEC59,      "unspec59"      },
+      { HEVC_NALU_TYPE_UNSPEC60,      "unspec60"      },
+      { HEVC_NALU_TYPE_UNSPEC61,      "unspec61"      },
+      { HEVC_NALU_TYPE_UNSPEC62,      "unspec62"      },
+      { HEVC_NALU_TYPE_UNSPEC63,      "unspec63"      },
+    };
+  });
 }
 
 }}                              // namespace mtx::hevc
@@ -24,6 +24,7 @@
 #include <matroska/KaxTags.h>
 
 #include "common/bitvalue.h"
+#include "common/cache.h"
 #include "common/construct.h"
 #include "common/ebml.h"
 #include "common/endian.h"
@@ -39,6 +40,7 @@ using namespace libmatroska;
 #define in_parent(p) (!p->IsFiniteSize() || (m_file->getFilePointer() < (p->GetElementPosition() + p->HeadSize() + p->GetSize())))
 
 #define CONSOLE_PERCENTAGE_WIDTH 25
+#define KAX_ANALYZER_INDEX_CACHE_MAX_SIZE (16 * 1024 * 1024)
 
 bool
 operator <(const kax_analyzer_data_cptr &d1,
@@ -90,6 +92,11 @@ kax_analyzer_c::close_file() {
 
     delete m_stream;
     m_stream = nullptr;
+
+    // Only now that all buffered data has been written can the file's
+    // identity be determined reliably.
+    if (m_index_cache_outdated)
+      save_index_cache();
   }
 }
 
@@ -245,6 +252,12 @@ kax_analyzer_c::set_parser_start_position(uint64_t position) {
   return *this;
 }
 
+kax_analyzer_c &
+kax_analyzer_c::set_use_index_cache(bool use_index_cache) {
+  m_use_index_cache = use_index_cache;
+  return *this;
+}
+
 bool
 kax_analyzer_c::process() {
   try {
@@ -318,6 +331,11 @@ kax_analyzer_c::process_internal() {
   EbmlElement *l1      = nullptr;
   upper_lvl_el         = 0;
 
+  if (load_index_cache()) {
+    show_progress_done();
+    return true;
+  }
+
   // In certain situations the caller doesn't way to have to pay the
   // price for full analysis. Then it can configure the parser to
   // start parsing at a certain offset. EbmlStream::FindNextElement()
@@ -362,6 +380,8 @@ kax_analyzer_c::process_internal() {
     if (parse_mode_full != m_parse_mode)
       fix_element_sizes(file_size);
 
+    save_index_cache();
+
     return true;
   }
 
@@ -445,13 +465,17 @@ kax_analyzer_c::update_element(EbmlElement *e,
 
   } catch (kax_analyzer_c::update_element_result_e result) {
     debug_dump_elements_maybe("update_element_exception");
+    remove_index_cache();
     return result;
 
   } catch (mtx::mm_io::exception &ex) {
     mxdebug_if(m_debug, boost::format("I/O exception: %1%\n") % ex.what());
+    remove_index_cache();
     return uer_error_unknown;
   }
 
+  m_index_cache_outdated = m_use_index_cache;
+
   return uer_success;
 }
 
@@ -469,9 +493,12 @@ kax_analyzer_c::remove_elements(EbmlId const &id) {
 
   } catch (kax_analyzer_c::update_element_result_e result) {
     debug_dump_elements_maybe("update_element_exception");
+    remove_index_cache();
     return result;
   }
 
+  m_index_cache_outdated = m_use_index_cache;
+
   return uer_success;
 }
 
@@ -1528,6 +1555,95 @@ kax_analyzer_c::determine_webm() {
   m_is_webm     = doc_type && (doc_type->GetValue() == "webm");
 }
 
+bool
+kax_analyzer_c::can_use_index_cache()
+  const {
+  return m_use_index_cache && !m_parser_start_position && !m_file_name.empty();
+}
+
+/** \brief Restore the list of level 1 elements from the index cache
+
+   The cache is only used if the file's size, modification time and
+   inode number haven't changed since the cache entry was written and
+   if it was created with the same parse mode. The EBML head and the
+   segment must have been read already.
+ */
+bool
+kax_analyzer_c::load_index_cache() {
+  if (!can_use_index_cache())
+    return false;
+
+  auto identity = mtx::cache::get_file_identity(m_file_name);
+  if (!identity)
+    return false;
+
+  auto cache_file_name = mtx::cache::get_cache_file_name("kax_analyzer", m_file_name);
+  auto json            = mtx::cache::read_for_file(cache_file_name, *identity);
+  if (!json)
+    return false;
+
+  try {
+    if (   (json->at("parse_mode").get<int>()            != static_cast<int>(m_parse_mode))
+        || (json->at("segment_position").get<uint64_t>() != m_segment->GetElementPosition())) {
+      mxdebug_if(m_debug, boost::format("kax_analyzer: index cache for '%1%' is outdated\n") % m_file_name);
+      return false;
+    }
+
+    std::vector<kax_analyzer_data_cptr> data;
+
+    for (auto const &element : json->at("elements"))
+      data.push_back(kax_analyzer_data_c::create(EbmlId{element.at(0).get<uint32_t>(), element.at(1).get<size_t>()}, element.at(2).get<uint64_t>(), element.at(3).get<int64_t>(), element.at(4).get<bool>()));
+
+    m_data = std::move(data);
+
+  } catch (std::exception const &ex) {
+    mxdebug_if(m_debug, boost::format("kax_analyzer: index cache for '%1%' is invalid: %2%\n") % m_file_name % ex.what());
+    return false;
+  }
+
+  mxdebug_if(m_debug, boost::format("kax_analyzer: restored %2% elements from index cache for '%1%'\n") % m_file_name % m_data.size());
+
+  mtx::cache::touch(cache_file_name);
+
+  return true;
+}
+
+void
+kax_analyzer_c::save_index_cache() {
+  m_index_cache_outdated = false;
+
+  if (!can_use_index_cache() || !m_segment)
+    return;
+
+  try {
+    auto identity = mtx::cache::get_file_identity(m_file_name);
+    if (!identity)
+      return;
+
+    auto elements = nlohmann::json::array();
+    for (auto const &data : m_data)
+      elements.push_back(nlohmann::json{ EBML_ID_VALUE(data->m_id), EBML_ID_LENGTH(data->m_id), data->m_pos, data->m_size, data->m_size_known });
+
+    auto json = nlohmann::json{
+      { "parse_mode",       static_cast<int>(m_parse_mode)   },
+      { "segment_position", m_segment->GetElementPosition()  },
+      { "elements",         elements                         },
+    };
+
+    mtx::cache::write_for_file(mtx::cache::get_cache_file_name("kax_analyzer", m_file_name), *identity, identity->m_size, json, KAX_ANALYZER_INDEX_CACHE_MAX_SIZE);
+
+  } catch (...) {
+  }
+}
+
+void
+kax_analyzer_c::remove_index_cache() {
+  m_index_cache_outdated = false;
+
+  if (can_use_index_cache())
+    mtx::cache::remove(mtx::cache::get_cache_file_name("kax_analyzer", m_file_name));
+}
+
 
 // ------------------------------------------------------------
 
@@ -111,7 +111,7 @@ private:
   open_mode m_open_mode{MODE_WRITE};
   bool m_throw_on_error{};
   boost::optional<uint64_t> m_parser_start_position;
-  bool m_is_webm{};
+  bool m_is_webm{}, m_use_index_cache{}, m_index_cache_outdated{};
 
 public:                         // Static functions
   static bool probe(std::string file_name);
@@ -144,6 +144,7 @@ public:
   virtual kax_analyzer_c &set_open_mode(open_mode mode);
   virtual kax_analyzer_c &set_throw_on_error(bool throw_on_error);
   virtual kax_analyzer_c &set_parser_start_position(uint64_t position);
+  virtual kax_analyzer_c &set_use_index_cache(bool use_index_cache);
 
   virtual bool process();
 
@@ -209,6 +210,11 @@ protected:
 
   virtual void determine_webm();
 
+  virtual bool can_use_index_cache() const;
+  virtual bool load_index_cache();
+  virtual void save_index_cache();
+  virtual void remove_index_cache();
+
 protected:
   virtual bool process_internal();
 };
@@ -0,0 +1,254 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   lightweight scanner for the block headers in Matroska clusters
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <matroska/KaxBlock.h>
+#include <matroska/KaxBlockData.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxClusterData.h>
+#include <matroska/KaxSegment.h>
+
+#include "common/kax_cluster_scanner.h"
+
+using namespace libmatroska;
+
+kax_cluster_scanner_c::kax_cluster_scanner_c(mm_io_c &in,
+                                             uint64_t timestamp_scale,
+                                             uint64_t end)
+  : m_in(in)
+  , m_timestamp_scale{timestamp_scale}
+  , m_end{end}
+{
+}
+
+bool
+kax_cluster_scanner_c::is_level1_element_id(vint_c const &id) {
+  auto &context = EBML_CLASS_CONTEXT(KaxSegment);
+  for (size_t segment_idx = 0, end = EBML_CTX_SIZE(context); end > segment_idx; ++segment_idx)
+    if (EBML_ID_VALUE(EBML_CTX_IDX_ID(context,segment_idx)) == id.m_value)
+      return true;
+
+  return false;
+}
+
+uint64_t
+kax_cluster_scanner_c::read_uint(uint64_t size) {
+  auto value = uint64_t{};
+
+  for (auto idx = 0u; idx < std::min<uint64_t>(size, 8); ++idx)
+    value = (value << 8) | m_in.read_uint8();
+
+  return value;
+}
+
+bool
+kax_cluster_scanner_c::read_element_header(uint64_t end,
+                                           vint_c &id,
+                                           vint_c &size,
+                                           uint64_t &data_start) {
+  if (m_in.getFilePointer() >= end)
+    return false;
+
+  id = vint_c::read_ebml_id(m_in);
+  if (!id.is_valid())
+    return false;
+
+  size = vint_c::read(m_in);
+  if (!size.is_valid())
+    return false;
+
+  data_start = m_in.getFilePointer();
+
+  return data_start <= end;
+}
+
+bool
+kax_cluster_scanner_c::read_block_header(uint64_t data_end,
+                                         int64_t cluster_timestamp,
+                                         block_t &block) {
+  auto track_number = vint_c::read(m_in);
+  if (!track_number.is_valid())
+    return false;
+
+  auto relative_timestamp = static_cast<int16_t>(m_in.read_uint16_be());
+  auto flags              = m_in.read_uint8();
+  auto lacing             = (flags >> 1) & 0x03;
+
+  block.m_track_number    = track_number.m_value;
+  block.m_timestamp       = (cluster_timestamp + relative_timestamp) * static_cast<int64_t>(m_timestamp_scale);
+  block.m_num_frames      = 1;
+
+  if (block.m_is_simple_block) {
+    block.m_is_key         = (flags & 0x80) == 0x80;
+    block.m_is_discardable = (flags & 0x01) == 0x01;
+  }
+
+  if (lacing) {
+    block.m_num_frames = m_in.read_uint8() + 1;
+
+    // Only the lace sizes have to be skipped: the frames fill the rest
+    // of the block.
+    for (auto frame_idx = 1u; frame_idx < block.m_num_frames; ++frame_idx) {
+      if (1 == lacing) {        // Xiph lacing
+        while (0xff == m_in.read_uint8())
+          ;
+
+      } else if (3 == lacing) { // EBML lacing
+        if (!vint_c::read(m_in).is_valid())
+          return false;
+      }
+    }
+  }
+
+  auto header_end = m_in.getFilePointer();
+  if (header_end > data_end)
+    return false;
+
+  block.m_frame_bytes = data_end - header_end;
+
+  return true;
+}
+
+/** \brief Scan the cluster starting at \c position
+
+   The callback is called for each SimpleBlock and BlockGroup found.
+
+   Returns the position right after the cluster. For clusters with an
+   unknown size that's the position of the first level 1 element
+   following it. Returns nothing if the cluster is invalid.
+*/
+boost::optional<uint64_t>
+kax_cluster_scanner_c::scan_cluster(uint64_t position,
+                                    block_cb_t const &callback) {
+  try {
+    vint_c id, size;
+    uint64_t data_start{};
+
+    m_in.setFilePointer(position);
+
+    if (   !read_element_header(m_end, id, size, data_start)
+        || (EBML_ID_VALUE(EBML_ID(KaxCluster)) != id.m_value))
+      return boost::none;
+
+    auto size_known        = !size.is_unknown();
+    auto cluster_end       = size_known ? data_start + size.m_value : m_end;
+    auto cluster_timestamp = int64_t{};
+    auto child_position    = data_start;
+
+    if (cluster_end > m_end)
+      return boost::none;
+
+    while (child_position < cluster_end) {
+      vint_c child_id, child_size;
+      uint64_t child_data_start{};
+
+      m_in.setFilePointer(child_position);
+
+      if (!read_element_header(cluster_end, child_id, child_size, child_data_start))
+        return size_known ? boost::optional<uint64_t>{} : boost::optional<uint64_t>{child_position};
+
+      if (!size_known && is_level1_element_id(child_id))
+        return child_position;
+
+      auto child_end = child_data_start + child_size.m_value;
+      if (child_size.is_unknown() || (child_end > cluster_end))
+        return boost::none;
+
+      if (EBML_ID_VALUE(EBML_ID(KaxClusterTimecode)) == child_id.m_value)
+        cluster_timestamp = read_uint(child_size.m_value);
+
+      else if (EBML_ID_VALUE(EBML_ID(KaxSimpleBlock)) == child_id.m_value) {
+        block_t block;
+        block.m_position        = child_position;
+        block.m_is_simple_block = true;
+
+        if (!read_block_header(child_end, cluster_timestamp, block))
+          return boost::none;
+
+        callback(block);
+
+      } else if (EBML_ID_VALUE(EBML_ID(KaxBlockGroup)) == child_id.m_value) {
+        block_t block;
+        block.m_position     = child_position;
+        auto block_found     = false;
+        auto group_position  = child_data_start;
+
+        while (group_position < child_end) {
+          vint_c group_child_id, group_child_size;
+          uint64_t group_child_data_start{};
+
+          m_in.setFilePointer(group_position);
+
+          if (   !read_element_header(child_end, group_child_id, group_child_size, group_child_data_start)
+              || group_child_size.is_unknown()
+              || ((group_child_data_start + group_child_size.m_value) > child_end))
+            return boost::none;
+
+          if (EBML_ID_VALUE(EBML_ID(KaxBlock)) == group_child_id.m_value) {
+            if (!read_block_header(group_child_data_start + group_child_size.m_value, cluster_timestamp, block))
+              return boost::none;
+            block_found = true;
+
+          } else if (EBML_ID_VALUE(EBML_ID(KaxBlockDuration)) == group_child_id.m_value)
+            block.m_duration = static_cast<int64_t>(read_uint(group_child_size.m_value) * m_timestamp_scale);
+
+          else if (EBML_ID_VALUE(EBML_ID(KaxReferenceBlock)) == group_child_id.m_value)
+            ++block.m_num_references;
+
+          group_position = group_child_data_start + group_child_size.m_value;
+        }
+
+        if (block_found)
+          callback(block);
+      }
+
+      child_position = child_end;
+    }
+
+    return cluster_end;
+
+  } catch (...) {
+  }
+
+  return boost::none;
+}
+
+/** \brief Scan consecutive clusters starting at \c position
+
+   Returns the position of the first element that isn't a cluster or
+   the end position if it has been reached. Returns nothing if one of
+   the clusters is invalid.
+*/
+boost::optional<uint64_t>
+kax_cluster_scanner_c::scan_clusters(uint64_t position,
+                                     block_cb_t const &callback) {
+  while (position < m_end) {
+    try {
+      m_in.setFilePointer(position);
+      if (vint_c::read_ebml_id(m_in).m_value != EBML_ID_VALUE(EBML_ID(KaxCluster)))
+        return position;
+
+    } catch (...) {
+      return boost::none;
+    }
+
+    auto next_position = scan_cluster(position, callback);
+    if (!next_position || (*next_position <= position))
+      return boost::none;
+
+    position = *next_position;
+  }
+
+  return m_end;
+}
@@ -0,0 +1,53 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   lightweight scanner for the block headers in Matroska clusters
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_KAX_CLUSTER_SCANNER_H
+#define MTX_COMMON_KAX_CLUSTER_SCANNER_H
+
+#include "common/common_pch.h"
+
+#include "common/vint.h"
+
+// Walks over clusters reading only the element headers and the
+// headers of the blocks they contain. The frames themselves are
+// skipped without being read.
+class kax_cluster_scanner_c {
+public:
+  struct block_t {
+    uint64_t m_position{}, m_track_number{}, m_frame_bytes{};
+    int64_t m_timestamp{};
+    boost::optional<int64_t> m_duration;
+    unsigned int m_num_frames{}, m_num_references{};
+    bool m_is_simple_block{}, m_is_key{}, m_is_discardable{};
+  };
+  using block_cb_t = std::function<void(block_t const &)>;
+
+protected:
+  mm_io_c &m_in;
+  uint64_t m_timestamp_scale, m_end;
+
+public:
+  kax_cluster_scanner_c(mm_io_c &in, uint64_t timestamp_scale, uint64_t end);
+
+  boost::optional<uint64_t> scan_cluster(uint64_t position, block_cb_t const &callback);
+  boost::optional<uint64_t> scan_clusters(uint64_t position, block_cb_t const &callback);
+
+  static bool is_level1_element_id(vint_c const &id);
+
+protected:
+  bool read_element_header(uint64_t end, vint_c &id, vint_c &size, uint64_t &data_start);
+  bool read_block_header(uint64_t data_end, int64_t cluster_timestamp, block_t &block);
+  uint64_t read_uint(uint64_t size);
+};
+
+#endif  // MTX_COMMON_KAX_CLUSTER_SCANNER_H
@@ -13,18 +13,25 @@
 
 #include "common/common_pch.h"
 
+#include <array>
 #include <typeinfo>
 
 #include <ebml/EbmlCrc32.h>
 #include <ebml/EbmlStream.h>
 #include <ebml/EbmlVoid.h>
 
+#include "common/at_scope_exit.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/fs_sys_helpers.h"
 #include "common/kax_file.h"
 #include "common/mm_io_x.h"
 #include "common/strings/formatting.h"
 
+static std::size_t const s_resync_window_size     = 1024 * 1024;
+// Cluster ID, size, CRC-32 element, timecode ID, size and value
+static std::size_t const s_max_cluster_start_size = 4 + 8 + 6 + 1 + 8 + 8;
+
 kax_file_c::kax_file_c(mm_io_c &in)
   : m_in(in)
   , m_resynced{}
@@ -204,10 +211,13 @@ kax_file_c::resync_to_level1_element_internal(uint32_t wanted_id) {
   m_resynced         = true;
   m_resync_start_pos = m_in.getFilePointer();
 
-  auto actual_id     = m_in.read_uint32_be();
-  auto start_time    = mtx::sys::get_current_time_millis();
+  auto resync_start  = mtx::sys::get_current_time_millis();
+  auto start_time    = resync_start;
   auto is_cluster_id = !wanted_id || (EBML_ID_VALUE(EBML_ID(KaxCluster)) == wanted_id); // 0 means: any level 1 element will do
 
+  ++m_num_resyncs;
+  at_scope_exit_c account_time([this, resync_start]() { m_resync_time_spent += mtx::sys::get_current_time_millis() - resync_start; });
+
   report(boost::format(Y("%1%: Error in the Matroska file structure at position %2%. Resyncing to the next level 1 element.\n"))
          % m_in.get_file_name() % m_resync_start_pos);
 
@@ -216,77 +226,173 @@ kax_file_c::resync_to_level1_element_internal(uint32_t wanted_id) {
     m_last_timecode = -1;
   }
 
-  if (m_debug_resync)
-    mxinfo(boost::format("kax_file::resync_to_level1_element(): starting at %1% potential ID %|2$08x|\n") % m_resync_start_pos % actual_id);
+  mxdebug_if(m_debug_resync, boost::format("kax_file::resync_to_level1_element(): starting at %1%\n") % m_resync_start_pos);
+
+  // All level 1 IDs are four bytes long. Only their first bytes are
+  // looked at for each position in the window; the full ID is only
+  // compared if the first byte matches one of them.
+  auto first_bytes = std::array<bool, 256>{};
+  if (wanted_id)
+    first_bytes[wanted_id >> 24] = true;
 
-  while (m_in.getFilePointer() < m_file_size) {
+  else {
+    auto &context = EBML_CLASS_CONTEXT(KaxSegment);
+    for (size_t segment_idx = 0, end = EBML_CTX_SIZE(context); end > segment_idx; ++segment_idx)
+      first_bytes[(EBML_ID_VALUE(EBML_CTX_IDX_ID(context,segment_idx)) >> 24) & 0xff] = true;
+  }
+
+  auto window     = memory_c::alloc(s_resync_window_size);
+  auto buffer     = window->get_buffer();
+  auto search_pos = m_resync_start_pos + 1;
+
+  while ((search_pos + 4) <= m_file_size) {
     auto now = mtx::sys::get_current_time_millis();
     if ((now - start_time) >= 10000) {
-      report(boost::format("Still resyncing at position %1%.\n") % m_in.getFilePointer());
+      report(boost::format("Still resyncing at position %1%.\n") % search_pos);
       start_time = now;
     }
 
-    actual_id = (actual_id << 8) | m_in.read_uint8();
-
-    if (   ((0 != wanted_id) && (wanted_id != actual_id))
-        || ((0 == wanted_id) && !is_level1_element_id(vint_c(actual_id, 4))))
-      continue;
+    m_in.setFilePointer(search_pos, seek_beginning);
+    auto num_read = m_in.read(buffer, std::min<uint64_t>(s_resync_window_size, m_file_size - search_pos));
+    if (4 > num_read)
+      break;
 
-    auto current_start_pos  = m_in.getFilePointer() - 4;
-    auto element_pos        = current_start_pos;
-    auto num_headers        = 1u;
-    auto valid_unknown_size = false;
+    // Candidates close to the window's end are looked at in the next
+    // window so that the headers checked for clusters are complete.
+    auto at_end     = ((search_pos + num_read) >= m_file_size) || (s_max_cluster_start_size >= num_read);
+    auto search_end = at_end ? num_read - 3 : num_read - s_max_cluster_start_size;
 
-    if (m_debug_resync)
-      mxinfo(boost::format("kax_file::resync_to_level1_element(): byte-for-byte search, found level 1 ID %|2$x| at %1%\n") % current_start_pos % actual_id);
-
-    try {
-      for (auto idx = 0; 3 > idx; ++idx) {
-        auto length = vint_c::read(m_in);
+    for (auto idx = 0u; idx < search_end; ++idx) {
+      if (!first_bytes[buffer[idx]])
+        continue;
 
-        if (m_debug_resync)
-          mxinfo(boost::format("kax_file::resync_to_level1_element():   read ebml length %1%/%2% valid? %3% unknown? %4%\n")
-                 % length.m_value % length.m_coded_size % length.is_valid() % length.is_unknown());
+      auto actual_id = get_uint32_be(&buffer[idx]);
 
-        if (length.is_unknown()) {
-          valid_unknown_size = true;
-          break;
-        }
+      if (   ((0 != wanted_id) && (wanted_id != actual_id))
+          || ((0 == wanted_id) && !is_level1_element_id(vint_c(actual_id, 4))))
+        continue;
 
-        if (   !length.is_valid()
-            || ((element_pos + length.m_value + length.m_coded_size + 2 * 4) >= m_file_size)
-            || !m_in.setFilePointer2(element_pos + 4 + length.m_value + length.m_coded_size, seek_beginning))
-          break;
+      auto candidate_pos = search_pos + idx;
 
-        element_pos  = m_in.getFilePointer();
-        auto next_id = m_in.read_uint32_be();
+      mxdebug_if(m_debug_resync, boost::format("kax_file::resync_to_level1_element(): found level 1 ID %|2$x| at %1%\n") % candidate_pos % actual_id);
 
-        if (m_debug_resync)
-          mxinfo(boost::format("kax_file::resync_to_level1_element():   next ID is %|1$x| at %2%\n") % next_id % element_pos);
+      if (   (   (EBML_ID_VALUE(EBML_ID(KaxCluster)) == actual_id)
+              && !starts_with_cluster_timecode(&buffer[idx], num_read - idx))
+          || !is_valid_level1_candidate(candidate_pos, wanted_id)) {
+        ++m_num_resync_candidates_rejected;
+        continue;
+      }
 
-        if (   ((0 != wanted_id) && (wanted_id != next_id))
-            || ((0 == wanted_id) && !is_level1_element_id(vint_c(next_id, 4))))
-          break;
+      report(boost::format(Y("Resyncing successful at position %1%.\n")) % candidate_pos);
 
-        ++num_headers;
-      }
-    } catch (...) {
-    }
+      m_resync_bytes_skipped += candidate_pos - m_resync_start_pos;
+      m_in.setFilePointer(candidate_pos, seek_beginning);
 
-    if ((4 == num_headers) || valid_unknown_size) {
-      report(boost::format(Y("Resyncing successful at position %1%.\n")) % current_start_pos);
-      m_in.setFilePointer(current_start_pos, seek_beginning);
       return read_next_level1_element(wanted_id, is_cluster_id);
     }
 
-    m_in.setFilePointer(current_start_pos + 4, seek_beginning);
+    search_pos += search_end;
   }
 
   report(Y("Resync failed: no valid Matroska level 1 element found.\n"));
 
+  ++m_num_resyncs_failed;
+  m_resync_bytes_skipped += m_file_size - std::min(m_file_size, m_resync_start_pos);
+
   return nullptr;
 }
 
+/** \brief Checks whether a cluster candidate's first child is its timecode
+
+   \c buffer points to the cluster's ID. A CRC-32 element may precede
+   the timecode.
+*/
+bool
+kax_file_c::starts_with_cluster_timecode(unsigned char const *buffer,
+                                         std::size_t size) {
+  if (4 >= size)
+    return false;
+
+  mm_mem_io_c in{buffer + 4, size - 4};
+
+  try {
+    auto cluster_size = vint_c::read(in);
+    if (!cluster_size.is_valid())
+      return false;
+
+    auto child_id = vint_c::read_ebml_id(in);
+
+    if (EBML_ID_VALUE(EBML_ID(EbmlCrc32)) == child_id.m_value) {
+      auto crc_size = vint_c::read(in);
+      if (!crc_size.is_valid() || (4 != crc_size.m_value))
+        return false;
+
+      in.skip(4);
+      child_id = vint_c::read_ebml_id(in);
+    }
+
+    if (EBML_ID_VALUE(EBML_ID(KaxClusterTimecode)) != child_id.m_value)
+      return false;
+
+    auto timecode_size = vint_c::read(in);
+
+    return timecode_size.is_valid()
+      && !timecode_size.is_unknown()
+      && (8 >= timecode_size.m_value)
+      && (cluster_size.is_unknown() || (static_cast<uint64_t>(cluster_size.m_value) >= (in.getFilePointer() - cluster_size.m_coded_size + timecode_size.m_value)));
+
+  } catch (...) {
+    return false;
+  }
+}
+
+/** \brief Verifies a level 1 element candidate found while resyncing
+
+   Either the candidate's size must be unknown or it must be followed
+   by three more level 1 elements (or the element wanted if \c
+   wanted_id is not 0).
+*/
+bool
+kax_file_c::is_valid_level1_candidate(uint64_t position,
+                                      uint32_t wanted_id) {
+  auto element_pos = position;
+  auto num_headers = 1u;
+
+  try {
+    m_in.setFilePointer(position + 4, seek_beginning);
+
+    for (auto idx = 0; 3 > idx; ++idx) {
+      auto length = vint_c::read(m_in);
+
+      mxdebug_if(m_debug_resync,
+                 boost::format("kax_file::resync_to_level1_element():   read ebml length %1%/%2% valid? %3% unknown? %4%\n")
+                 % length.m_value % length.m_coded_size % length.is_valid() % length.is_unknown());
+
+      if (length.is_unknown())
+        return true;
+
+      if (   !length.is_valid()
+          || ((element_pos + length.m_value + length.m_coded_size + 2 * 4) >= m_file_size)
+          || !m_in.setFilePointer2(element_pos + 4 + length.m_value + length.m_coded_size, seek_beginning))
+        break;
+
+      element_pos  = m_in.getFilePointer();
+      auto next_id = m_in.read_uint32_be();
+
+      mxdebug_if(m_debug_resync, boost::format("kax_file::resync_to_level1_element():   next ID is %|1$x| at %2%\n") % next_id % element_pos);
+
+      if (   ((0 != wanted_id) && (wanted_id != next_id))
+          || ((0 == wanted_id) && !is_level1_element_id(vint_c(next_id, 4))))
+        break;
+
+      ++num_headers;
+    }
+  } catch (...) {
+  }
+
+  return 4 == num_headers;
+}
+
 KaxCluster *
 kax_file_c::resync_to_cluster() {
   return static_cast<KaxCluster *>(resync_to_level1_element(EBML_ID_VALUE(EBML_ID(KaxCluster))));
@@ -336,6 +442,16 @@ kax_file_c::set_segment_end(EbmlElement const &segment) {
   m_segment_end = segment.IsFiniteSize() ? segment.GetElementPosition() + segment.HeadSize() + segment.GetSize() : m_in.get_size();
 }
 
+/** \brief Sets the position reading stops at
+
+   A value of 0 means that there's no limit, e.g. for a segment whose
+   file is still being written to.
+*/
+void
+kax_file_c::set_segment_end(uint64_t segment_end) {
+  m_segment_end = segment_end;
+}
+
 uint64_t
 kax_file_c::get_segment_end()
   const {
@@ -347,6 +463,17 @@ kax_file_c::enable_reporting(bool enable) {
   m_reporting_enabled = enable;
 }
 
+/** \brief Outputs a summary of all resyncs if there were any
+*/
+void
+kax_file_c::report_resync_statistics() {
+  if (!m_num_resyncs)
+    return;
+
+  report(boost::format(Y("%1%: %2% resync(s) due to errors in the file structure, %3% of them failed. %4% bytes were skipped, %5% potential elements were rejected, and searching took %6% ms.\n"))
+         % m_in.get_file_name() % m_num_resyncs % m_num_resyncs_failed % m_resync_bytes_skipped % m_num_resync_candidates_rejected % m_resync_time_spent);
+}
+
 void
 kax_file_c::report(boost::format const &message) {
   if (m_reporting_enabled)
@@ -29,6 +29,8 @@ protected:
   mm_io_c &m_in;
   bool m_resynced, m_reporting_enabled{true};
   uint64_t m_resync_start_pos, m_file_size, m_segment_end;
+  uint64_t m_num_resyncs{}, m_num_resyncs_failed{}, m_num_resync_candidates_rejected{}, m_resync_bytes_skipped{};
+  int64_t m_resync_time_spent{};
   int64_t m_timecode_scale, m_last_timecode;
   std::shared_ptr<EbmlStream> m_es;
 
@@ -54,15 +56,20 @@ public:
   virtual void set_timecode_scale(int64_t timecode_scale);
   virtual void set_last_timecode(int64_t last_timecode);
   virtual void set_segment_end(EbmlElement const &segment);
+  virtual void set_segment_end(uint64_t segment_end);
   virtual uint64_t get_segment_end() const;
 
   virtual void enable_reporting(bool enable);
+  virtual void report_resync_statistics();
 
 protected:
   virtual EbmlElement *read_one_element();
 
   virtual EbmlElement *read_next_level1_element_internal(uint32_t wanted_id = 0);
   virtual EbmlElement *resync_to_level1_element_internal(uint32_t wanted_id = 0);
+  virtual bool is_valid_level1_candidate(uint64_t position, uint32_t wanted_id);
+
+  static bool starts_with_cluster_timecode(unsigned char const *buffer, std::size_t size);
 
   virtual void report(boost::format const &message);
   virtual void report(std::string const &message);
@@ -0,0 +1,79 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include <chrono>
+#include <thread>
+
+#include "common/fs_sys_helpers.h"
+#include "common/mm_growing_file_io.h"
+
+mm_growing_file_io_c::mm_growing_file_io_c(std::string const &path,
+                                           int64_t idle_timeout)
+  : mm_file_io_c{path, MODE_READ}
+  , m_idle_timeout{idle_timeout}
+  , m_following{}
+  , m_debug{"growing_file"}
+{
+}
+
+int64_t
+mm_growing_file_io_c::get_size() {
+  m_cached_size = -1;
+  return mm_file_io_c::get_size();
+}
+
+/** \brief Enables or disables waiting for more data
+
+   Readers usually only probe the data present when they're opened.
+   Following is therefore only enabled once the headers have been read.
+*/
+void
+mm_growing_file_io_c::enable_following(bool enable) {
+  m_following = enable;
+}
+
+uint32
+mm_growing_file_io_c::_read(void *buffer,
+                            size_t size) {
+  auto num_read = static_cast<size_t>(mm_file_io_c::_read(buffer, size));
+
+  if (!m_following || (num_read >= size))
+    return num_read;
+
+  auto poll_interval = std::min<int64_t>(m_idle_timeout, 100);
+  auto idle_since    = mtx::sys::get_current_time_millis();
+
+  mxdebug_if(m_debug, boost::format("waiting for %1% more bytes at %2%\n") % (size - num_read) % getFilePointer());
+
+  while (num_read < size) {
+    auto idle_for = mtx::sys::get_current_time_millis() - idle_since;
+    if (idle_for >= m_idle_timeout)
+      break;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(poll_interval, m_idle_timeout - idle_for)));
+
+    clear_eof();
+    auto num_read_now = mm_file_io_c::_read(static_cast<unsigned char *>(buffer) + num_read, size - num_read);
+
+    if (num_read_now) {
+      num_read   += num_read_now;
+      idle_since  = mtx::sys::get_current_time_millis();
+    }
+  }
+
+  mxdebug_if(m_debug, boost::format("done waiting: %1% bytes missing at %2%\n") % (size - num_read) % getFilePointer());
+
+  return num_read;
+}
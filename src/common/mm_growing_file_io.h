@@ -0,0 +1,45 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   IO callback class definitions
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_MM_GROWING_FILE_IO_H
+#define MTX_COMMON_MM_GROWING_FILE_IO_H
+
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+
+/** \brief Reads a file that is still being written to
+
+   Once following has been enabled, reads at the end of the file wait
+   for more data to be appended instead of returning less data than
+   requested. Reads only return less data if the file hasn't grown
+   for the idle timeout. The size is re-determined each time it's
+   requested.
+*/
+class mm_growing_file_io_c: public mm_file_io_c {
+protected:
+  int64_t m_idle_timeout;
+  bool m_following;
+  debugging_option_c m_debug;
+
+public:
+  mm_growing_file_io_c(std::string const &path, int64_t idle_timeout);
+
+  virtual int64_t get_size();
+  virtual void enable_following(bool enable);
+
+protected:
+  virtual uint32 _read(void *buffer, size_t size);
+};
+
+#endif // MTX_COMMON_MM_GROWING_FILE_IO_H
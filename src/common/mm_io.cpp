@@ -15,6 +15,7 @@
 #include "common/common_pch.h"
 
 #include <errno.h>
+#include <numeric>
 #include <stdio.h>
 #include <stdlib.h>
 #ifdef HAVE_UNISTD_H
@@ -22,6 +23,12 @@
 #endif
 #include <sys/stat.h>
 #include <sys/types.h>
+#if !defined(SYS_WINDOWS)
+#include <sys/uio.h>
+#endif
+#if defined(HAVE_SYS_SENDFILE_H)
+# include <sys/sendfile.h>
+#endif
 
 #include "common/endian.h"
 #include "common/error.h"
@@ -101,6 +108,69 @@ mm_file_io_c::_write(const void *buffer,
   return bwritten;
 }
 
+/** \brief Write several pieces with as few system calls as possible
+
+   Small amounts of data are collected in stdio's buffer. Larger ones
+   are written directly from the pieces with \c writev after stdio's
+   buffer has been flushed.
+*/
+size_t
+mm_file_io_c::_writev(iovec_t const *pieces,
+                      std::size_t num_pieces) {
+  static std::size_t const s_min_direct_write_size = 64 * 1024;
+  static std::size_t const s_max_iovecs            = 1024;
+
+  auto total_size = std::accumulate(pieces, pieces + num_pieces, std::size_t{}, [](std::size_t sum, iovec_t const &piece) { return sum + piece.m_size; });
+  if (total_size < s_min_direct_write_size)
+    return mm_io_c::_writev(pieces, num_pieces);
+
+  auto file = static_cast<FILE *>(m_file);
+  if (fflush(file) != 0)
+    throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+
+  std::vector<struct iovec> iovecs;
+  iovecs.reserve(num_pieces);
+
+  for (auto idx = 0u; idx < num_pieces; ++idx)
+    if (pieces[idx].m_size)
+      iovecs.push_back({ const_cast<void *>(pieces[idx].m_buffer), pieces[idx].m_size });
+
+  auto written = std::size_t{};
+  auto idx     = std::size_t{};
+
+  while (idx < iovecs.size()) {
+    auto num_written = ::writev(fileno(file), &iovecs[idx], std::min(iovecs.size() - idx, s_max_iovecs));
+
+    if ((0 > num_written) && (EINTR == errno))
+      continue;
+
+    if (0 >= num_written)
+      throw mtx::mm_io::read_write_x{mtx::mm_io::make_error_code()};
+
+    written += num_written;
+
+    // Skip the pieces written completely and continue with the rest of
+    // the one written partially.
+    auto remaining = static_cast<std::size_t>(num_written);
+    while (remaining && (remaining >= iovecs[idx].iov_len))
+      remaining -= iovecs[idx++].iov_len;
+
+    if (remaining) {
+      iovecs[idx].iov_base  = static_cast<char *>(iovecs[idx].iov_base) + remaining;
+      iovecs[idx].iov_len  -= remaining;
+    }
+  }
+
+  m_current_position += written;
+  m_cached_size       = -1;
+
+  // The data has bypassed stdio. Let it know where the file pointer is.
+  if (fseeko(file, m_current_position, SEEK_SET) != 0)
+    throw mtx::mm_io::seek_x{mtx::mm_io::make_error_code()};
+
+  return written;
+}
+
 uint32
 mm_file_io_c::_read(void *buffer,
                     size_t size) {
@@ -135,6 +205,24 @@ mm_file_io_c::truncate(int64_t pos) {
   return ftruncate(fileno((FILE *)m_file), pos);
 }
 
+/** \brief The file descriptor for direct access
+
+   Data buffered by the C library is written first so that the
+   descriptor's content matches what has been written through this
+   object. Callers must reposition this object with \c setFilePointer
+   after accessing the descriptor directly.
+*/
+int
+mm_file_io_c::get_file_descriptor() {
+  if (!m_file)
+    return -1;
+
+  fflush((FILE *)m_file);
+  m_cached_size = -1;
+
+  return fileno((FILE *)m_file);
+}
+
 /** \brief OS and kernel dependant setup
 */
 void
@@ -523,6 +611,31 @@ mm_io_c::write(const void *buffer,
   return _write(buffer, size);
 }
 
+/** \brief Write several pieces of data in one go
+
+   Equivalent to calling \c write for each piece. Implementations may
+   hand the pieces to the operating system in a single call without
+   copying them into a buffer first.
+
+   Returns the number of bytes written.
+*/
+size_t
+mm_io_c::writev(iovec_t const *pieces,
+                std::size_t num_pieces) {
+  return _writev(pieces, num_pieces);
+}
+
+size_t
+mm_io_c::_writev(iovec_t const *pieces,
+                 std::size_t num_pieces) {
+  auto written = std::size_t{};
+
+  for (auto idx = 0u; idx < num_pieces; ++idx)
+    written += _write(pieces[idx].m_buffer, pieces[idx].m_size);
+
+  return written;
+}
+
 size_t
 mm_io_c::write(const memory_cptr &buffer,
                size_t size,
@@ -534,6 +647,82 @@ mm_io_c::write(const memory_cptr &buffer,
   return size;
 }
 
+/** \brief Copy data from another file to the current position
+
+   Copies up to \c size bytes starting at the current position of
+   \c in. If both files are backed by file descriptors then the kernel
+   copies the data directly with \c copy_file_range or \c sendfile
+   where available. Everything else is read and written in chunks.
+
+   Both file pointers are advanced by the number of bytes copied,
+   which is returned.
+*/
+uint64_t
+mm_io_c::copy_from(mm_io_c &in,
+                   uint64_t size) {
+  auto copied = uint64_t{};
+
+#if defined(HAVE_COPY_FILE_RANGE) || (defined(HAVE_SYS_SENDFILE_H) && defined(HAVE_SENDFILE))
+  auto in_fd  = in.get_file_descriptor();
+  auto out_fd = -1 != in_fd ? get_file_descriptor() : -1;
+
+  if ((-1 != in_fd) && (-1 != out_fd)) {
+    int64_t in_position  = in.getFilePointer();
+    int64_t out_position = getFilePointer();
+# if defined(HAVE_COPY_FILE_RANGE)
+    auto use_copy_file_range = true;
+# endif
+
+    while (copied < size) {
+      auto chunk_size = static_cast<size_t>(std::min<uint64_t>(size - copied, 1 << 30));
+      auto num_copied = static_cast<ssize_t>(-1);
+
+# if defined(HAVE_COPY_FILE_RANGE)
+      if (use_copy_file_range) {
+        // Older kernels refuse copying between different file systems.
+        loff_t in_offset  = in_position  + copied;
+        loff_t out_offset = out_position + copied;
+        num_copied        = copy_file_range(in_fd, &in_offset, out_fd, &out_offset, chunk_size, 0);
+        use_copy_file_range = 0 < num_copied;
+      }
+# endif
+
+# if defined(HAVE_SYS_SENDFILE_H) && defined(HAVE_SENDFILE)
+      if ((0 >= num_copied) && (-1 != lseek(out_fd, out_position + copied, SEEK_SET))) {
+        off_t in_offset = in_position + copied;
+        num_copied      = sendfile(out_fd, in_fd, &in_offset, chunk_size);
+      }
+# endif
+
+      if (0 >= num_copied)
+        break;
+
+      copied += num_copied;
+    }
+
+    in.setFilePointer(in_position + copied);
+    setFilePointer(out_position + copied);
+  }
+#endif  // HAVE_COPY_FILE_RANGE || (HAVE_SYS_SENDFILE_H && HAVE_SENDFILE)
+
+  if (copied < size) {
+    auto buffer = memory_c::alloc(std::min<uint64_t>(size - copied, 1024 * 1024));
+
+    while (copied < size) {
+      auto num_read = in.read(buffer->get_buffer(), std::min<uint64_t>(size - copied, buffer->get_size()));
+      if (!num_read)
+        break;
+
+      if (write(buffer->get_buffer(), num_read) != num_read)
+        throw mtx::mm_io::insufficient_space_x();
+
+      copied += num_read;
+    }
+  }
+
+  return copied;
+}
+
 void
 mm_io_c::skip(int64 num_bytes) {
   uint64_t pos = getFilePointer();
@@ -895,6 +1084,9 @@ mm_text_io_c::mm_text_io_c(mm_io_c *in,
   , m_uses_carriage_returns(false)
   , m_uses_newlines(false)
   , m_eol_style_detected(false)
+  , m_buffer(memory_c::alloc(64 * 1024))
+  , m_buffer_pos(0)
+  , m_buffer_fill(0)
 {
   in->setFilePointer(0, seek_beginning);
 
@@ -998,21 +1190,105 @@ mm_text_io_c::get_encoding(byte_order_e byte_order) {
        :                             std::string{"UTF-32BE"};
 }
 
+bool
+mm_text_io_c::fill_buffer(std::size_t num_bytes) {
+  auto available = m_buffer_fill - m_buffer_pos;
+  if (available >= num_bytes)
+    return true;
+
+  auto buffer = m_buffer->get_buffer();
+
+  if (m_buffer_pos) {
+    memmove(buffer, buffer + m_buffer_pos, available);
+    m_buffer_pos  = 0;
+    m_buffer_fill = available;
+  }
+
+  while (m_buffer_fill < num_bytes) {
+    auto num_read = m_proxy_io->read(buffer + m_buffer_fill, m_buffer->get_size() - m_buffer_fill);
+    if (!num_read)
+      break;
+
+    m_buffer_fill += num_read;
+  }
+
+  return m_buffer_fill >= num_bytes;
+}
+
+void
+mm_text_io_c::drop_buffer() {
+  if (m_buffer_pos < m_buffer_fill)
+    m_proxy_io->setFilePointer(getFilePointer(), seek_beginning);
+
+  m_buffer_pos  = 0;
+  m_buffer_fill = 0;
+}
+
+uint64
+mm_text_io_c::getFilePointer() {
+  return m_proxy_io->getFilePointer() - (m_buffer_fill - m_buffer_pos);
+}
+
+bool
+mm_text_io_c::eof() {
+  return (m_buffer_pos >= m_buffer_fill) && m_proxy_io->eof();
+}
+
+uint32
+mm_text_io_c::_read(void *buffer,
+                    size_t size) {
+  auto dst       = static_cast<unsigned char *>(buffer);
+  auto available = std::min(size, m_buffer_fill - m_buffer_pos);
+
+  if (available) {
+    memcpy(dst, m_buffer->get_buffer() + m_buffer_pos, available);
+    m_buffer_pos += available;
+    dst          += available;
+    size         -= available;
+  }
+
+  if (!size)
+    return available;
+
+  // Large reads bypass the buffer.
+  if (size >= m_buffer->get_size())
+    return available + m_proxy_io->read(dst, size);
+
+  fill_buffer(size);
+
+  auto num_copied = std::min(size, m_buffer_fill - m_buffer_pos);
+  memcpy(dst, m_buffer->get_buffer() + m_buffer_pos, num_copied);
+  m_buffer_pos += num_copied;
+
+  return available + num_copied;
+}
+
+size_t
+mm_text_io_c::_write(const void *buffer,
+                     size_t size) {
+  drop_buffer();
+  return mm_proxy_io_c::_write(buffer, size);
+}
+
 // 1 byte: 0xxxxxxx,
 // 2 bytes: 110xxxxx 10xxxxxx,
 // 3 bytes: 1110xxxx 10xxxxxx 10xxxxxx
 
 int
 mm_text_io_c::read_next_char(char *buffer) {
-  if (BO_NONE == m_byte_order)
-    return read(buffer, 1);
+  if (!fill_buffer(1))
+    return 0;
+
+  auto stream = m_buffer->get_buffer() + m_buffer_pos;
+
+  if (BO_NONE == m_byte_order) {
+    buffer[0] = stream[0];
+    ++m_buffer_pos;
+    return 1;
+  }
 
-  unsigned char stream[6];
   size_t size = 0;
   if (BO_UTF8 == m_byte_order) {
-    if (read(stream, 1) != 1)
-      return 0;
-
     size = ((stream[0] & 0x80) == 0x00) ?  1
          : ((stream[0] & 0xe0) == 0xc0) ?  2
          : ((stream[0] & 0xf0) == 0xe0) ?  3
@@ -1021,13 +1297,18 @@ mm_text_io_c::read_next_char(char *buffer) {
          : ((stream[0] & 0xfe) == 0xfc) ?  6
          :                                99;
 
-    if (99 == size)
+    if (99 == size) {
+      ++m_buffer_pos;
       throw mtx::mm_io::text::invalid_utf8_char_x(stream[0]);
+    }
 
-    if ((1 < size) && (read(&stream[1], size - 1) != (size - 1)))
+    if (!fill_buffer(size)) {
+      m_buffer_pos = m_buffer_fill;
       return 0;
+    }
 
-    memcpy(buffer, stream, size);
+    memcpy(buffer, m_buffer->get_buffer() + m_buffer_pos, size);
+    m_buffer_pos += size;
 
     return size;
 
@@ -1036,8 +1317,13 @@ mm_text_io_c::read_next_char(char *buffer) {
   else
     size = 4;
 
-  if (read(stream, size) != size)
+  if (!fill_buffer(size)) {
+    m_buffer_pos = m_buffer_fill;
     return 0;
+  }
+
+  stream        = m_buffer->get_buffer() + m_buffer_pos;
+  m_buffer_pos += size;
 
   unsigned long data = 0;
   auto little_endian = ((BO_UTF16_LE == m_byte_order) || (BO_UTF32_LE == m_byte_order));
@@ -1070,6 +1356,35 @@ mm_text_io_c::read_next_char(char *buffer) {
   return 0;
 }
 
+// Appends a run of characters that need neither decoding nor special
+// treatment directly from the buffer. Returns the number of
+// characters appended.
+std::size_t
+mm_text_io_c::append_plain_characters(std::string &s,
+                                      std::size_t max_chars) {
+  if ((BO_NONE != m_byte_order) && (BO_UTF8 != m_byte_order))
+    return 0;
+
+  auto ascii_only = BO_UTF8 == m_byte_order;
+  auto start      = m_buffer->get_buffer() + m_buffer_pos;
+  auto end        = start + std::min(m_buffer_fill - m_buffer_pos, max_chars);
+  auto current    = start;
+
+  while (   (current < end)
+         && (*current != '\n')
+         && (*current != '\r')
+         && (*current != '\0')
+         && (!ascii_only || (*current < 0x80)))
+    ++current;
+
+  auto num_chars = static_cast<std::size_t>(current - start);
+
+  s.append(reinterpret_cast<char const *>(start), num_chars);
+  m_buffer_pos += num_chars;
+
+  return num_chars;
+}
+
 std::string
 mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
   if (eof())
@@ -1084,12 +1399,19 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
   std::size_t num_chars_read{};
 
   while (1) {
-    memset(utf8char, 0, 9);
+    if (!previous_was_carriage_return && fill_buffer(1)) {
+      num_chars_read += append_plain_characters(s, max_chars ? *max_chars - num_chars_read : std::numeric_limits<std::size_t>::max());
+
+      if (max_chars && (num_chars_read >= *max_chars))
+        return s;
+    }
 
     int len = read_next_char(utf8char);
     if (0 == len)
       return s;
 
+    utf8char[len] = 0;
+
     if ((1 == len) && (utf8char[0] == '\r')) {
       if (previous_was_carriage_return && !m_uses_newlines) {
         setFilePointer(-1, seek_current);
@@ -1120,19 +1442,43 @@ mm_text_io_c::getline(boost::optional<std::size_t> max_chars) {
 void
 mm_text_io_c::setFilePointer(int64 offset,
                              seek_mode mode) {
-  mm_proxy_io_c::setFilePointer(((0 == offset) && (seek_beginning == mode)) ? m_bom_len : offset, mode);
+  if ((0 == offset) && (seek_beginning == mode))
+    offset = m_bom_len;
+
+  // Seeking within the buffer is common, e.g. for putting back a
+  // character read while looking for the end of a line.
+  if ((seek_current == mode) || (seek_beginning == mode)) {
+    auto buffer_start = static_cast<int64_t>(m_proxy_io->getFilePointer() - m_buffer_fill);
+    auto new_position = seek_current == mode ? static_cast<int64_t>(getFilePointer()) + offset : static_cast<int64_t>(offset);
+
+    if ((new_position >= buffer_start) && (new_position <= static_cast<int64_t>(buffer_start + m_buffer_fill))) {
+      m_buffer_pos = new_position - buffer_start;
+      return;
+    }
+
+    m_buffer_pos = m_buffer_fill = 0;
+    mm_proxy_io_c::setFilePointer(new_position, seek_beginning);
+    return;
+  }
+
+  m_buffer_pos = m_buffer_fill = 0;
+  mm_proxy_io_c::setFilePointer(offset, mode);
 }
 
 /*
-   Class for reading from stdin & writing to stdout.
+   Class for reading from stdin & writing to stdout or stderr.
 */
 
-mm_stdio_c::mm_stdio_c() {
+mm_stdio_c::mm_stdio_c(FILE *out)
+  : m_out{out}
+{
 }
 
+// Counts the bytes written so that elements written to a pipe get
+// their correct positions.
 uint64
 mm_stdio_c::getFilePointer() {
-  return 0;
+  return m_current_position;
 }
 
 void
@@ -1152,15 +1498,19 @@ mm_stdio_c::_write(const void *buffer,
                    size_t size) {
   m_cached_size = -1;
 
-  return fwrite(buffer, 1, size, stdout);
+  auto bytes_written  = fwrite(buffer, 1, size, m_out);
+  m_current_position += bytes_written;
+
+  return bytes_written;
 }
 #endif // defined(SYS_WINDOWS)
 
 void
 mm_stdio_c::close() {
+  fflush(m_out);
 }
 
 void
 mm_stdio_c::flush() {
-  fflush(stdout);
+  fflush(m_out);
 }
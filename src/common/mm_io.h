@@ -29,6 +29,13 @@ class charset_converter_c;
 using charset_converter_cptr = std::shared_ptr<charset_converter_c>;
 
 class mm_io_c: public IOCallback {
+public:
+  // One piece of data for writev()
+  struct iovec_t {
+    void const *m_buffer;
+    std::size_t m_size;
+  };
+
 protected:
   bool m_dos_style_newlines, m_bom_written;
   std::stack<int64_t> m_positions;
@@ -76,6 +83,10 @@ public:
   virtual size_t write(const void *buffer, size_t size);
   virtual size_t write(std::string const &buffer);
   virtual size_t write(const memory_cptr &buffer, size_t size = UINT_MAX, size_t offset = 0);
+  size_t writev(iovec_t const *pieces, std::size_t num_pieces);
+  size_t writev(std::initializer_list<iovec_t> pieces) {
+    return writev(pieces.begin(), pieces.size());
+  }
   virtual bool eof() = 0;
   virtual void clear_eof() { }
   virtual void flush() {
@@ -114,9 +125,15 @@ public:
   virtual void enable_buffering(bool /* enable */) {
   }
 
+  virtual int get_file_descriptor() {
+    return -1;
+  }
+  virtual uint64_t copy_from(mm_io_c &in, uint64_t size);
+
 protected:
   virtual uint32 _read(void *buffer, size_t size) = 0;
   virtual size_t _write(const void *buffer, size_t size) = 0;
+  virtual size_t _writev(iovec_t const *pieces, std::size_t num_pieces);
 };
 
 class mm_file_io_c: public mm_io_c {
@@ -149,6 +166,9 @@ public:
   }
 
   virtual int truncate(int64_t pos);
+#if !defined(SYS_WINDOWS)
+  virtual int get_file_descriptor();
+#endif
 
   static void setup();
   static void cleanup();
@@ -157,6 +177,9 @@ public:
 protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
+#if !defined(SYS_WINDOWS)
+  virtual size_t _writev(iovec_t const *pieces, std::size_t num_pieces);
+#endif
 };
 
 using mm_file_io_cptr = std::shared_ptr<mm_file_io_c>;
@@ -268,10 +291,17 @@ protected:
   unsigned int m_bom_len;
   bool m_uses_carriage_returns, m_uses_newlines, m_eol_style_detected;
 
+  // Read-ahead buffer so that lines and characters can be decoded
+  // without one call to the proxied I/O per byte.
+  memory_cptr m_buffer;
+  std::size_t m_buffer_pos, m_buffer_fill;
+
 public:
   mm_text_io_c(mm_io_c *in, bool delete_in = true);
 
+  virtual uint64 getFilePointer();
   virtual void setFilePointer(int64 offset, seek_mode mode=seek_beginning);
+  virtual bool eof();
   virtual std::string getline(boost::optional<std::size_t> max_chars = boost::none);
   virtual int read_next_char(char *buffer);
   virtual byte_order_e get_byte_order() const {
@@ -289,6 +319,12 @@ public:
 
 protected:
   virtual void detect_eol_style();
+  virtual bool fill_buffer(std::size_t num_bytes);
+  virtual void drop_buffer();
+  virtual std::size_t append_plain_characters(std::string &s, std::size_t max_chars);
+
+  virtual uint32 _read(void *buffer, size_t size);
+  virtual size_t _write(const void *buffer, size_t size);
 
 public:
   static bool has_byte_order_marker(const std::string &string);
@@ -299,8 +335,11 @@ public:
 using mm_text_io_cptr = std::shared_ptr<mm_text_io_c>;
 
 class mm_stdio_c: public mm_io_c {
+protected:
+  FILE *m_out;
+
 public:
-  mm_stdio_c();
+  mm_stdio_c(FILE *out = stdout);
 
   virtual uint64 getFilePointer();
   virtual void setFilePointer(int64 offset, seek_mode mode=seek_beginning);
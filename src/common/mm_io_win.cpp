@@ -190,7 +190,8 @@ static bool s_stdout_binmode_set = false;
 size_t
 mm_stdio_c::_write(const void *buffer,
                    size_t size) {
-  HANDLE h_stdout = GetStdHandle(STD_OUTPUT_HANDLE);
+  auto to_stdout  = stdout == m_out;
+  HANDLE h_stdout = GetStdHandle(to_stdout ? STD_OUTPUT_HANDLE : STD_ERROR_HANDLE);
   if (INVALID_HANDLE_VALUE == h_stdout)
     return 0;
 
@@ -210,15 +211,16 @@ mm_stdio_c::_write(const void *buffer,
     return bytes_written;
   }
 
-  if (!s_stdout_binmode_set) {
+  if (to_stdout && !s_stdout_binmode_set) {
     _setmode(1, _O_BINARY);
     s_stdout_binmode_set = true;
   }
 
-  size_t bytes_written = fwrite(buffer, 1, size, stdout);
-  fflush(stdout);
+  size_t bytes_written = fwrite(buffer, 1, size, m_out);
+  fflush(m_out);
 
-  m_cached_size = -1;
+  m_cached_size       = -1;
+  m_current_position += bytes_written;
 
   return bytes_written;
 }
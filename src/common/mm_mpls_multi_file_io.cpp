@@ -42,9 +42,9 @@ mm_mpls_multi_file_io_c::open_multi(std::string const &display_file_name) {
 
 mm_io_cptr
 mm_mpls_multi_file_io_c::open_multi(mm_io_c *in) {
-  auto mpls_parser = std::make_shared<mtx::bluray::mpls::parser_c>();
+  auto mpls_parser = mtx::bluray::mpls::parse_cached(in);
 
-  if (!mpls_parser->parse(in) || mpls_parser->get_playlist().items.empty()) {
+  if (!mpls_parser->is_ok() || mpls_parser->get_playlist().items.empty()) {
     mxdebug_if(ms_debug, boost::format("Not handling because %1%\n") % (mpls_parser->is_ok() ? "playlist is empty" : "parser not OK"));
     return mm_io_cptr{};
   }
@@ -14,6 +14,8 @@
 
 #include "common/common_pch.h"
 
+#include <numeric>
+
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
 
@@ -88,40 +90,67 @@ mm_write_buffer_io_c::_read(void *buffer,
 size_t
 mm_write_buffer_io_c::_write(const void *buffer,
                              size_t size) {
-  size_t avail;
-  const char *buf = static_cast<const char *>(buffer);
-  size_t remain   = size;
-
-  // whole blocks
-  while (remain >= (avail = m_size - m_fill)) {
-    if (m_fill) {
-      // Fill the buffer in an attempt to defeat potentially
-      // lousy OS I/O scheduling
-      memcpy(m_buffer + m_fill, buf, avail);
-      m_fill = m_size;
-      flush_buffer();
-      remain -= avail;
-      buf    += avail;
-
-    } else {
-      // write whole blocks, skipping the buffer
-      avail = mm_proxy_io_c::_write(buf, m_size);
-      if (avail != m_size)
-        throw mtx::mm_io::insufficient_space_x();
-
-      remain -= avail;
-      buf    += avail;
+  iovec_t piece{buffer, size};
+  return _writev(&piece, 1);
+}
+
+/** \brief Write several pieces, copying only the small ones
+
+   Pieces fitting into the buffer are copied into it. Otherwise the
+   buffered data and the pieces are handed to the underlying file in a
+   single vectored write. Large pieces skip the buffer that way. Small
+   pieces at the end stay in the buffer for the next write.
+*/
+size_t
+mm_write_buffer_io_c::_writev(iovec_t const *pieces,
+                              std::size_t num_pieces) {
+  auto total_size = std::accumulate(pieces, pieces + num_pieces, std::size_t{}, [](std::size_t sum, iovec_t const &piece) { return sum + piece.m_size; });
+
+  m_cached_size = -1;
+
+  if ((m_fill + total_size) <= m_size) {
+    for (auto idx = 0u; idx < num_pieces; ++idx) {
+      memcpy(m_buffer + m_fill, pieces[idx].m_buffer, pieces[idx].m_size);
+      m_fill += pieces[idx].m_size;
     }
+
+    return total_size;
   }
 
-  if (remain) {
-    memcpy(m_buffer + m_fill, buf, remain);
-    m_fill += remain;
+  auto min_direct_size = std::min<std::size_t>(m_size, 1024 * 1024);
+  auto num_direct      = num_pieces;
+  auto tail_size       = std::size_t{};
+
+  while (   num_direct
+         && (pieces[num_direct - 1].m_size < min_direct_size)
+         && ((tail_size + pieces[num_direct - 1].m_size) <= m_size)) {
+    --num_direct;
+    tail_size += pieces[num_direct].m_size;
   }
 
-  m_cached_size = -1;
+  std::vector<iovec_t> direct_pieces;
+  direct_pieces.reserve(num_direct + 1);
+
+  if (m_fill)
+    direct_pieces.push_back({ m_buffer, m_fill });
+  direct_pieces.insert(direct_pieces.end(), pieces, pieces + num_direct);
 
-  return size;
+  auto direct_size = m_fill + total_size - tail_size;
+  auto written     = m_proxy_io->writev(direct_pieces.data(), direct_pieces.size());
+
+  mxdebug_if(m_debug_write, boost::format("writev() at %1% for %2% in %3% piece(s) written %4%\n") % (mm_proxy_io_c::getFilePointer() - written) % direct_size % direct_pieces.size() % written);
+
+  m_fill = 0;
+
+  if (written != direct_size)
+    throw mtx::mm_io::insufficient_space_x();
+
+  for (auto idx = num_direct; idx < num_pieces; ++idx) {
+    memcpy(m_buffer + m_fill, pieces[idx].m_buffer, pieces[idx].m_size);
+    m_fill += pieces[idx].m_size;
+  }
+
+  return total_size;
 }
 
 void
@@ -143,3 +172,11 @@ void
 mm_write_buffer_io_c::discard_buffer() {
   m_fill = 0;
 }
+
+int
+mm_write_buffer_io_c::get_file_descriptor() {
+  flush_buffer();
+  m_cached_size = -1;
+
+  return m_proxy_io->get_file_descriptor();
+}
@@ -36,12 +36,14 @@ public:
   virtual void flush();
   virtual void close();
   virtual void discard_buffer();
+  virtual int get_file_descriptor();
 
   static mm_io_cptr open(const std::string &file_name, size_t buffer_size);
 
 protected:
   virtual uint32 _read(void *buffer, size_t size);
   virtual size_t _write(const void *buffer, size_t size);
+  virtual size_t _writev(iovec_t const *pieces, std::size_t num_pieces);
   virtual void flush_buffer();
 };
 using mm_write_buffer_io_cptr = std::shared_ptr<mm_write_buffer_io_c>;
@@ -12,32 +12,58 @@
 
 #include "common/common_pch.h"
 
+#include <cstring>
+#include <exception>
+#include <thread>
+
 #include "common/debugging.h"
 #include "common/endian.h"
 #include "common/mpeg.h"
 
 namespace mtx { namespace mpeg {
 
+static std::size_t const s_min_partition_size = 1024 * 1024;
+static unsigned int const s_max_partitions    = 16;
+
 memory_cptr
 nalu_to_rbsp(memory_cptr const &buffer) {
-  int pos, size = buffer->get_size();
-  mm_mem_io_c d(nullptr, size, 100);
-  unsigned char *b = buffer->get_buffer();
+  auto size = buffer->get_size();
+  auto src  = buffer->get_buffer();
+  auto rbsp = memory_c::alloc(size);
+  auto dst  = rbsp->get_buffer();
+  auto pos  = std::size_t{};
 
-  for (pos = 0; pos < size; ++pos) {
-    if (   ((pos + 2) < size)
-        && (0 == b[pos])
-        && (0 == b[pos + 1])
-        && (3 == b[pos + 2])) {
-      d.write_uint8(0);
-      d.write_uint8(0);
-      pos += 2;
+  // Copy everything up to the next emulation prevention sequence
+  // 00 00 03 at once and drop its 03.
+  while (pos < size) {
+    auto escape_pos = size;
 
-    } else
-      d.write_uint8(b[pos]);
+    for (auto search_pos = pos + 2; search_pos < size; ++search_pos) {
+      auto three = static_cast<unsigned char const *>(std::memchr(src + search_pos, 3, size - search_pos));
+      if (!three)
+        break;
+
+      search_pos = three - src;
+      if (!src[search_pos - 1] && !src[search_pos - 2]) {
+        escape_pos = search_pos - 2;
+        break;
+      }
+    }
+
+    if (escape_pos == size) {
+      std::memcpy(dst, src + pos, size - pos);
+      dst += size - pos;
+      break;
+    }
+
+    std::memcpy(dst, src + pos, escape_pos + 2 - pos);
+    dst += escape_pos + 2 - pos;
+    pos  = escape_pos + 3;
   }
 
-  return std::make_shared<memory_c>(d.get_and_lock_buffer(), d.getFilePointer(), true);
+  rbsp->set_size(dst - rbsp->get_buffer());
+
+  return rbsp;
 }
 
 memory_cptr
@@ -103,6 +129,123 @@ create_nalu_with_size(memory_cptr const &src,
   return buffer;
 }
 
+/** \brief Determines how many partitions a buffer is split into
+
+   Buffers smaller than two partitions' worth of data are handled in
+   one go. Otherwise each partition spans at least 1 MiB, and there
+   are no more than \c max_partitions of them.
+*/
+unsigned int
+get_num_partitions(std::size_t size,
+                   unsigned int max_partitions) {
+  auto num_partitions = size / s_min_partition_size;
+
+  return std::max<unsigned int>(std::min<std::size_t>(num_partitions, max_partitions), 1);
+}
+
+unsigned int
+default_max_partitions() {
+  return std::min<unsigned int>(std::max(std::thread::hardware_concurrency(), 1u), s_max_partitions);
+}
+
+/** \brief Calls a worker for consecutive ranges of items concurrently
+
+   The items <tt>[0, num_items)</tt> are split into \c num_partitions
+   ranges of about the same size. The first range is handled by the
+   calling thread, all others by one thread each. The function returns
+   once all of them are done. If workers throw, the exception of the
+   first range that failed is re-thrown.
+
+   Workers must not output messages or modify shared state.
+*/
+void
+run_partitioned(std::size_t num_items,
+                unsigned int num_partitions,
+                std::function<void(std::size_t, std::size_t)> const &worker) {
+  if ((2 > num_partitions) || (2 > num_items)) {
+    worker(0, num_items);
+    return;
+  }
+
+  std::vector<std::exception_ptr> exceptions(num_partitions);
+  std::vector<std::thread> threads;
+
+  auto run = [&exceptions, &worker, num_items, num_partitions](unsigned int partition) {
+    try {
+      worker(num_items * partition / num_partitions, num_items * (partition + 1) / num_partitions);
+    } catch (...) {
+      exceptions[partition] = std::current_exception();
+    }
+  };
+
+  for (auto partition = 1u; partition < num_partitions; ++partition)
+    threads.emplace_back(run, partition);
+
+  run(0);
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto const &exception : exceptions)
+    if (exception)
+      std::rethrow_exception(exception);
+}
+
+static void
+find_start_codes_in_range(unsigned char const *buffer,
+                          std::size_t begin,
+                          std::size_t end,
+                          std::vector<std::size_t> &positions) {
+  // Look for the 01 of each 00 00 01.
+  auto pos = std::max<std::size_t>(begin, 2);
+
+  while (pos < end) {
+    auto one = static_cast<unsigned char const *>(std::memchr(buffer + pos, 1, end - pos));
+    if (!one)
+      break;
+
+    pos = one - buffer;
+    if (!buffer[pos - 1] && !buffer[pos - 2])
+      positions.push_back(pos - 2);
+
+    ++pos;
+  }
+}
+
+/** \brief Finds all start codes in an Annex B byte stream buffer
+
+   Returns the positions of the three-byte sequences 00 00 01 in
+   ascending order. Whether or not a start code is four bytes long is
+   up to the caller to determine by looking at the preceding byte.
+
+   With more than one partition the buffer is searched concurrently.
+   Each partition is responsible for the start codes whose 01 lies
+   within it, even if their zero bytes belong to the previous one.
+*/
+std::vector<std::size_t>
+find_start_codes(unsigned char const *buffer,
+                 std::size_t size,
+                 unsigned int num_partitions) {
+  std::vector<std::size_t> positions;
+
+  if (2 > num_partitions) {
+    find_start_codes_in_range(buffer, 0, size, positions);
+    return positions;
+  }
+
+  std::vector<std::vector<std::size_t>> positions_by_partition(num_partitions);
+
+  run_partitioned(num_partitions, num_partitions, [buffer, size, num_partitions, &positions_by_partition](std::size_t begin, std::size_t end) {
+    for (auto partition = begin; partition < end; ++partition)
+      find_start_codes_in_range(buffer, size * partition / num_partitions, size * (partition + 1) / num_partitions, positions_by_partition[partition]);
+  });
+
+  for (auto const &partition_positions : positions_by_partition)
+    positions.insert(positions.end(), partition_positions.begin(), partition_positions.end());
+
+  return positions;
+}
+
 void
 remove_trailing_zero_bytes(memory_c &buffer) {
   static debugging_option_c s_debug_trailing_zero_byte_removal{"avc_parser|avc_trailing_zero_byte_removal"};
@@ -47,6 +47,11 @@ memory_cptr rbsp_to_nalu(memory_cptr const &buffer);
 void write_nalu_size(unsigned char *buffer, std::size_t size, std::size_t nalu_size_length, bool ignore_nalu_size_length_errors = false);
 memory_cptr create_nalu_with_size(memory_cptr const &src, std::size_t nalu_size_length, std::vector<memory_cptr> extra_data);
 
+unsigned int get_num_partitions(std::size_t size, unsigned int max_partitions);
+unsigned int default_max_partitions();
+void run_partitioned(std::size_t num_items, unsigned int num_partitions, std::function<void(std::size_t, std::size_t)> const &worker);
+
+std::vector<std::size_t> find_start_codes(unsigned char const *buffer, std::size_t size, unsigned int num_partitions = 1);
 void remove_trailing_zero_bytes(memory_c &buffer);
 
 }}
@@ -870,6 +870,7 @@ mpeg4::p10::avc_es_parser_c::avc_es_parser_c()
   , m_previous_frame_start_in_display_order{}
   , m_stream_position(0)
   , m_parsed_position(0)
+  , m_max_partitions{mtx::mpeg::default_max_partitions()}
   , m_have_incomplete_frame(false)
   , m_ignore_nalu_size_length_errors(false)
   , m_discard_actual_frames(false)
@@ -926,68 +927,109 @@ mpeg4::p10::avc_es_parser_c::discard_actual_frames(bool discard) {
 
 void
 mpeg4::p10::avc_es_parser_c::add_bytes(unsigned char *buffer,
-                                       size_t size) {
-  memory_slice_cursor_c cursor;
-  int marker_size              = 0;
-  int previous_marker_size     = 0;
-  int previous_pos             = -1;
-  uint64_t previous_parsed_pos = m_parsed_position;
-
-  if (m_unparsed_buffer && (0 != m_unparsed_buffer->get_size()))
-    cursor.add_slice(m_unparsed_buffer);
-  cursor.add_slice(buffer, size);
-
-  if (3 <= cursor.get_remaining_size()) {
-    uint32_t marker =                               1 << 24
-                    | (unsigned int)cursor.get_char() << 16
-                    | (unsigned int)cursor.get_char() <<  8
-                    | (unsigned int)cursor.get_char();
+                                      size_t size) {
+  auto previous_parsed_pos = m_parsed_position;
+  auto unparsed_size       = m_unparsed_buffer ? m_unparsed_buffer->get_size() : 0;
+  auto data                = buffer;
+  auto data_size           = unparsed_size + size;
+  auto combined            = memory_cptr{};
+
+  if (unparsed_size) {
+    combined = memory_c::alloc(data_size);
+    data     = combined->get_buffer();
+
+    memcpy(data,                 m_unparsed_buffer->get_buffer(), unparsed_size);
+    memcpy(data + unparsed_size, buffer,                          size);
+  }
 
-    while (1) {
-      if (NALU_START_CODE == marker)
-        marker_size = 4;
-      else if (NALU_START_CODE == (marker & 0x00ffffff))
-        marker_size = 3;
-
-      if (0 != marker_size) {
-        if (-1 != previous_pos) {
-          int new_size = cursor.get_position() - marker_size - previous_pos - previous_marker_size;
-          auto nalu = memory_c::alloc(new_size);
-          cursor.copy(nalu->get_buffer(), previous_pos + previous_marker_size, new_size);
-          m_parsed_position = previous_parsed_pos + previous_pos;
-
-          mtx::mpeg::remove_trailing_zero_bytes(*nalu);
-          if (nalu->get_size())
-            handle_nalu(nalu, m_parsed_position);
-        }
-        previous_pos         = cursor.get_position() - marker_size;
-        previous_marker_size = marker_size;
-        marker_size          = 0;
-      }
+  // Large buffers are split into partitions. Finding the start codes
+  // and parsing the slice headers is done for all of them
+  // concurrently. The NALUs are then handled in stream order, the
+  // same way they are without partitions.
+  auto num_partitions = mtx::mpeg::get_num_partitions(data_size, m_max_partitions);
 
-      if (!cursor.char_available())
-        break;
+  // A start code is four bytes long if a zero byte precedes the
+  // 00 00 01.
+  std::vector<std::pair<std::size_t, std::size_t>> markers;
 
-      marker <<= 8;
-      marker  |= (unsigned int)cursor.get_char();
-    }
+  for (auto start_code_pos : mtx::mpeg::find_start_codes(data, data_size, num_partitions)) {
+    auto marker_size = (start_code_pos && !data[start_code_pos - 1]) ? 4 : 3;
+    markers.emplace_back(start_code_pos - marker_size + 3, marker_size);
+  }
+
+  auto pre_parsed_slices = pre_parse_slices(data, markers, num_partitions);
+
+  for (auto idx = 1u; idx < markers.size(); ++idx) {
+    auto const &previous = markers[idx - 1];
+    auto nalu            = memory_c::clone(data + previous.first + previous.second, markers[idx].first - previous.first - previous.second);
+    m_parsed_position    = previous_parsed_pos + previous.first;
+
+    mtx::mpeg::remove_trailing_zero_bytes(*nalu);
+    if (nalu->get_size())
+      handle_nalu(nalu, m_parsed_position, pre_parsed_slices.empty() ? nullptr : &pre_parsed_slices[idx - 1]);
   }
 
-  if (-1 == previous_pos)
-    previous_pos = 0;
+  auto unparsed_pos = markers.empty() ? 0 : markers.back().first;
 
   m_stream_position += size;
-  m_parsed_position  = previous_parsed_pos + previous_pos;
+  m_parsed_position  = previous_parsed_pos + unparsed_pos;
 
-  int new_size = cursor.get_size() - previous_pos;
-  if (0 != new_size) {
-    m_unparsed_buffer = memory_c::alloc(new_size);
-    cursor.copy(m_unparsed_buffer->get_buffer(), previous_pos, new_size);
+  auto new_size = data_size - unparsed_pos;
+  if (0 != new_size)
+    m_unparsed_buffer = memory_c::clone(data + unparsed_pos, new_size);
 
-  } else
+  else
     m_unparsed_buffer.reset();
 }
 
+/** \brief Parses the slice headers of all complete NALUs concurrently
+
+   Only the SPS and PPS known when the buffer was added are used. The
+   results are tagged with their generation; slices following a change
+   of those are parsed again when their turn comes. Returns nothing if
+   the buffer isn't split into partitions.
+*/
+std::vector<mpeg4::p10::pre_parsed_slice_t>
+mpeg4::p10::avc_es_parser_c::pre_parse_slices(unsigned char const *data,
+                                              std::vector<std::pair<std::size_t, std::size_t>> const &markers,
+                                              unsigned int num_partitions)
+  const {
+  std::vector<pre_parsed_slice_t> pre_parsed_slices;
+
+  if ((2 > num_partitions) || (2 > markers.size()))
+    return pre_parsed_slices;
+
+  pre_parsed_slices.resize(markers.size() - 1);
+
+  mtx::mpeg::run_partitioned(pre_parsed_slices.size(), num_partitions, [this, data, &markers, &pre_parsed_slices](std::size_t begin, std::size_t end) {
+    for (auto idx = begin; idx < end; ++idx) {
+      auto start = markers[idx].first + markers[idx].second;
+      auto size  = markers[idx + 1].first - start;
+
+      // Same as remove_trailing_zero_bytes() without the debug output.
+      while (size && !data[start + size - 1])
+        --size;
+
+      if (!size)
+        continue;
+
+      auto type = data[start] & 0x1f;
+      if ((NALU_TYPE_NON_IDR_SLICE != type) && (NALU_TYPE_DP_A_SLICE != type) && (NALU_TYPE_IDR_SLICE != type))
+        continue;
+
+      auto &parsed = pre_parsed_slices[idx];
+      auto nalu    = memory_cptr{new memory_c(const_cast<unsigned char *>(data + start), size, false)};
+
+      parse_slice(mtx::mpeg::nalu_to_rbsp(nalu), parsed, m_sps_info_list, m_pps_info_list);
+
+      parsed.m_available                 = true;
+      parsed.m_parameter_sets_generation = m_parameter_sets_generation;
+    }
+  });
+
+  return pre_parsed_slices;
+}
+
 void
 mpeg4::p10::avc_es_parser_c::flush() {
   if (m_unparsed_buffer && (5 <= m_unparsed_buffer->get_size())) {
@@ -1086,14 +1128,19 @@ mpeg4::p10::avc_es_parser_c::add_sps_and_pps_to_extra_data() {
 
 void
 mpeg4::p10::avc_es_parser_c::handle_slice_nalu(memory_cptr const &nalu,
-                                               uint64_t nalu_pos) {
+                                               uint64_t nalu_pos,
+                                               pre_parsed_slice_t const *pre_parsed_slice) {
   if (!m_avcc_ready) {
     m_unhandled_nalus.emplace_back(nalu, nalu_pos);
     return;
   }
 
+  auto use_pre_parsed_slice = pre_parsed_slice
+                           && pre_parsed_slice->m_available
+                           && (pre_parsed_slice->m_parameter_sets_generation == m_parameter_sets_generation);
+
   slice_info_t si;
-  if (!parse_slice(mtx::mpeg::nalu_to_rbsp(nalu), si))
+  if (!(use_pre_parsed_slice ? use_parsed_slice(*pre_parsed_slice, si) : parse_slice(mtx::mpeg::nalu_to_rbsp(nalu), si)))
     return;
 
   if (NALU_TYPE_IDR_SLICE == si.nalu_type)
@@ -1190,6 +1237,7 @@ mpeg4::p10::avc_es_parser_c::handle_sps_nalu(memory_cptr const &nalu) {
     m_sps_list.push_back(parsed_nalu);
     m_sps_info_list.push_back(sps_info);
     m_avcc_changed = true;
+    ++m_parameter_sets_generation;
 
   } else if (m_sps_info_list[i].checksum != sps_info.checksum) {
     mxdebug_if(m_debug_sps_pps_changes, boost::format("mpeg4::p10: SPS ID %|1$04x| changed; checksum old %|2$04x| new %|3$04x|\n") % sps_info.id % m_sps_info_list[i].checksum % sps_info.checksum);
@@ -1200,6 +1248,7 @@ mpeg4::p10::avc_es_parser_c::handle_sps_nalu(memory_cptr const &nalu) {
     m_sps_list[i]            = parsed_nalu;
     m_avcc_changed           = true;
     m_sps_or_sps_overwritten = true;
+    ++m_parameter_sets_generation;
 
   } else
     use_sps_info = false;
@@ -1242,6 +1291,7 @@ mpeg4::p10::avc_es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
     m_pps_list.push_back(nalu);
     m_pps_info_list.push_back(pps_info);
     m_avcc_changed = true;
+    ++m_parameter_sets_generation;
 
   } else if (m_pps_info_list[i].checksum != pps_info.checksum) {
     mxdebug_if(m_debug_sps_pps_changes, boost::format("mpeg4::p10: PPS ID %|1$04x| changed; checksum old %|2$04x| new %|3$04x|\n") % pps_info.id % m_pps_info_list[i].checksum % pps_info.checksum);
@@ -1253,6 +1303,7 @@ mpeg4::p10::avc_es_parser_c::handle_pps_nalu(memory_cptr const &nalu) {
     m_pps_list[i]            = nalu;
     m_avcc_changed           = true;
     m_sps_or_sps_overwritten = true;
+    ++m_parameter_sets_generation;
   }
 
   m_extra_data.push_back(create_nalu_with_size(nalu));
@@ -1295,7 +1346,8 @@ mpeg4::p10::avc_es_parser_c::handle_sei_nalu(memory_cptr const &nalu) {
 
 void
 mpeg4::p10::avc_es_parser_c::handle_nalu(memory_cptr const &nalu,
-                                         uint64_t nalu_pos) {
+                                         uint64_t nalu_pos,
+                                         pre_parsed_slice_t const *pre_parsed_slice) {
   if (1 > nalu->get_size())
     return;
 
@@ -1333,7 +1385,7 @@ mpeg4::p10::avc_es_parser_c::handle_nalu(memory_cptr const &nalu,
         m_avcc_ready = true;
         flush_unhandled_nalus();
       }
-      handle_slice_nalu(nalu, nalu_pos);
+      handle_slice_nalu(nalu, nalu_pos, pre_parsed_slice);
       break;
 
     default:
@@ -1351,9 +1403,20 @@ mpeg4::p10::avc_es_parser_c::handle_nalu(memory_cptr const &nalu,
   }
 }
 
-bool
+/** \brief Parses a slice header
+
+   Only reads the SPS and PPS lists given, making it safe to call from
+   several threads at once. Instead of updating the statistics and
+   reporting errors it records them in \c parsed. use_parsed_slice()
+   takes care of that.
+*/
+void
 mpeg4::p10::avc_es_parser_c::parse_slice(memory_cptr const &buffer,
-                                         slice_info_t &si) {
+                                         pre_parsed_slice_t &parsed,
+                                         std::vector<sps_info_t> const &sps_info_list,
+                                         std::vector<pps_info_t> const &pps_info_list) {
+  auto &si = parsed.m_si;
+
   try {
     bit_reader_c r(buffer->get_buffer(), buffer->get_size());
 
@@ -1364,41 +1427,41 @@ mpeg4::p10::avc_es_parser_c::parse_slice(memory_cptr const &buffer,
     if (   (NALU_TYPE_NON_IDR_SLICE != si.nalu_type)
         && (NALU_TYPE_DP_A_SLICE    != si.nalu_type)
         && (NALU_TYPE_IDR_SLICE     != si.nalu_type))
-      return false;
+      return;
 
     si.first_mb_in_slice = r.get_unsigned_golomb(); // first_mb_in_slice
     si.type              = r.get_unsigned_golomb(); // slice_type
 
-    ++m_stats.num_slices_by_type[9 < si.type ? 10 : si.type];
+    parsed.m_type_index = 9 < si.type ? 10 : si.type;
 
     if (9 < si.type) {
-      mxverb(3, boost::format("slice parser error: 9 < si.type: %1%\n") % si.type);
-      return false;
+      parsed.m_error = (boost::format("slice parser error: 9 < si.type: %1%\n") % si.type).str();
+      return;
     }
 
     si.pps_id = r.get_unsigned_golomb();      // pps_id
 
     size_t pps_idx;
-    for (pps_idx = 0; m_pps_info_list.size() > pps_idx; ++pps_idx)
-      if (m_pps_info_list[pps_idx].id == si.pps_id)
+    for (pps_idx = 0; pps_info_list.size() > pps_idx; ++pps_idx)
+      if (pps_info_list[pps_idx].id == si.pps_id)
         break;
-    if (m_pps_info_list.size() == pps_idx) {
-      mxverb(3, boost::format("slice parser error: PPS not found: %1%\n") % si.pps_id);
-      return false;
+    if (pps_info_list.size() == pps_idx) {
+      parsed.m_error = (boost::format("slice parser error: PPS not found: %1%\n") % si.pps_id).str();
+      return;
     }
 
-    pps_info_t &pps = m_pps_info_list[pps_idx];
+    auto const &pps = pps_info_list[pps_idx];
     size_t sps_idx;
-    for (sps_idx = 0; m_sps_info_list.size() > sps_idx; ++sps_idx)
-      if (m_sps_info_list[sps_idx].id == pps.sps_id)
+    for (sps_idx = 0; sps_info_list.size() > sps_idx; ++sps_idx)
+      if (sps_info_list[sps_idx].id == pps.sps_id)
         break;
-    if (m_sps_info_list.size() == sps_idx)
-      return false;
+    if (sps_info_list.size() == sps_idx)
+      return;
 
     si.sps = sps_idx;
     si.pps = pps_idx;
 
-    sps_info_t &sps = m_sps_info_list[sps_idx];
+    auto const &sps = sps_info_list[sps_idx];
 
     si.frame_num = r.get_bits(sps.log2_max_frame_num);
 
@@ -1423,12 +1486,35 @@ mpeg4::p10::avc_es_parser_c::parse_slice(memory_cptr const &buffer,
         si.delta_pic_order_cnt[1] = r.get_signed_golomb();
     }
 
-    return true;
+    parsed.m_valid = true;
+
   } catch (...) {
-    return false;
   }
 }
 
+bool
+mpeg4::p10::avc_es_parser_c::parse_slice(memory_cptr const &buffer,
+                                         slice_info_t &si) {
+  pre_parsed_slice_t parsed;
+  parse_slice(buffer, parsed, m_sps_info_list, m_pps_info_list);
+
+  return use_parsed_slice(parsed, si);
+}
+
+bool
+mpeg4::p10::avc_es_parser_c::use_parsed_slice(pre_parsed_slice_t const &parsed,
+                                              slice_info_t &si) {
+  if (-1 != parsed.m_type_index)
+    ++m_stats.num_slices_by_type[parsed.m_type_index];
+
+  if (!parsed.m_error.empty())
+    mxverb(3, parsed.m_error);
+
+  si = parsed.m_si;
+
+  return parsed.m_valid;
+}
+
 int64_t
 mpeg4::p10::avc_es_parser_c::duration_for(unsigned int sps,
                                           bool field_pic_flag)
@@ -137,6 +137,16 @@ struct slice_info_t {
   }
 };
 
+// The result of parsing a slice header ahead of the NALU's turn,
+// possibly in another thread.
+struct pre_parsed_slice_t {
+  slice_info_t m_si;
+  bool m_available{}, m_valid{};
+  int m_type_index{-1};
+  std::string m_error;
+  uint64_t m_parameter_sets_generation{};
+};
+
 struct par_extraction_t {
   memory_cptr new_avcc;
   unsigned int numerator, denominator;
@@ -249,6 +259,9 @@ protected:
   memory_cptr m_unparsed_buffer;
   uint64_t m_stream_position, m_parsed_position;
 
+  unsigned int m_max_partitions;
+  uint64_t m_parameter_sets_generation{};
+
   avc_frame_t m_incomplete_frame;
   bool m_have_incomplete_frame;
   std::deque<std::pair<memory_cptr, uint64_t>> m_unhandled_nalus;
@@ -301,6 +314,10 @@ public:
     m_fix_bitstream_frame_rate = fix;
   }
 
+  void set_max_partitions(unsigned int max_partitions) {
+    m_max_partitions = max_partitions;
+  }
+
   void add_bytes(unsigned char *buf, size_t size);
   void add_bytes(memory_cptr &buf) {
     add_bytes(buf->get_buffer(), buf->get_size());
@@ -337,7 +354,7 @@ public:
     return m_sps_info_list.begin()->height;
   }
 
-  void handle_nalu(memory_cptr const &nalu, uint64_t nalu_pos);
+  void handle_nalu(memory_cptr const &nalu, uint64_t nalu_pos, pre_parsed_slice_t const *pre_parsed_slice = nullptr);
 
   void add_timecode(int64_t timecode);
 
@@ -387,11 +404,14 @@ public:
   std::pair<int64_t, int64_t> const get_display_dimensions(int width = -1, int height = -1) const;
 
 protected:
+  static void parse_slice(memory_cptr const &buffer, pre_parsed_slice_t &parsed, std::vector<sps_info_t> const &sps_info_list, std::vector<pps_info_t> const &pps_info_list);
   bool parse_slice(memory_cptr const &buffer, slice_info_t &si);
+  bool use_parsed_slice(pre_parsed_slice_t const &parsed, slice_info_t &si);
+  std::vector<pre_parsed_slice_t> pre_parse_slices(unsigned char const *data, std::vector<std::pair<std::size_t, std::size_t>> const &markers, unsigned int num_partitions) const;
   void handle_sps_nalu(memory_cptr const &nalu);
   void handle_pps_nalu(memory_cptr const &nalu);
   void handle_sei_nalu(memory_cptr const &nalu);
-  void handle_slice_nalu(memory_cptr const &nalu, uint64_t nalu_pos);
+  void handle_slice_nalu(memory_cptr const &nalu, uint64_t nalu_pos, pre_parsed_slice_t const *pre_parsed_slice);
   void cleanup();
   bool flush_decision(slice_info_t &si, slice_info_t &ref);
   void flush_incomplete_frame();
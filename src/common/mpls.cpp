@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "common/bluray_parse_cache.h"
 #include "common/debugging.h"
 #include "common/hacks.h"
 #include "common/list_utils.h"
@@ -499,4 +500,21 @@ parser_c::dump()
   m_playlist.dump();
 }
 
+parser_cptr
+parse_cached(mm_io_c *in) {
+  static parse_cache_c<parser_c> s_cache;
+
+  auto parse = [in]() -> parser_cptr {
+    auto parser = std::make_shared<parser_c>();
+    parser->parse(in);
+    return parser;
+  };
+
+  auto file_name = in->get_file_name();
+  if (file_name.empty())
+    return parse();
+
+  return s_cache.get(file_name, parse);
+}
+
 }}}
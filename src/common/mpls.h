@@ -188,6 +188,11 @@ protected:
 };
 using parser_cptr = std::shared_ptr<parser_c>;
 
+// Returns the parsed playlist \c in refers to. Files are only parsed
+// once per process as long as they don't change. The result must be
+// checked with \c is_ok().
+parser_cptr parse_cached(mm_io_c *in);
+
 }}}
 
 #endif // MTX_COMMON_MPLS_COMMON_H
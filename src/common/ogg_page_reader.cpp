@@ -0,0 +1,168 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   reader for the pages of Ogg files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/bswap.h"
+#include "common/checksums/crc.h"
+#include "common/endian.h"
+#include "common/mm_io.h"
+#include "common/ogg_page_reader.h"
+
+namespace {
+
+std::size_t const s_header_size    = 27;
+std::size_t const s_max_page_size  = s_header_size + 255 + 255 * 255;
+
+// The first reads are small so that probing and reading the headers
+// don't read much more than necessary. Sequential reads afterwards are
+// done in larger and larger blocks.
+std::size_t const s_min_read_size  =   64 * 1024;
+std::size_t const s_max_read_size  = 1024 * 1024;
+
+}
+
+ogg_page_reader_c::ogg_page_reader_c(mm_io_c &in)
+  : m_in(in)
+  , m_read_size{s_min_read_size}
+{
+}
+
+/** \brief Drop all buffered data
+
+   Must be called after the file pointer has been changed.
+*/
+void
+ogg_page_reader_c::reset() {
+  m_start     = 0;
+  m_fill      = 0;
+  m_read_size = s_min_read_size;
+  m_eof       = false;
+  m_lost_sync = false;
+}
+
+bool
+ogg_page_reader_c::lost_sync() {
+  auto lost_sync = m_lost_sync;
+  m_lost_sync    = false;
+
+  return lost_sync;
+}
+
+bool
+ogg_page_reader_c::fill_buffer() {
+  if (m_eof)
+    return false;
+
+  if (m_start) {
+    std::memmove(m_buffer.data(), m_buffer.data() + m_start, m_fill - m_start);
+    m_fill  -= m_start;
+    m_start  = 0;
+  }
+
+  auto wanted_size = std::max(m_fill + m_read_size, s_max_page_size);
+  if (m_buffer.size() < wanted_size)
+    m_buffer.resize(wanted_size);
+
+  auto num_read = m_in.read(m_buffer.data() + m_fill, m_buffer.size() - m_fill);
+  m_fill       += num_read;
+  m_read_size   = std::min(m_read_size * 2, s_max_read_size);
+
+  if (!num_read)
+    m_eof = true;
+
+  return 0 != num_read;
+}
+
+// Same as libogg: continue at the next 'O' after the start of the
+// current, invalid page candidate.
+void
+ogg_page_reader_c::skip_to_next_capture_pattern() {
+  auto start  = m_buffer.data() + m_start + 1;
+  auto end    = m_buffer.data() + m_fill;
+  auto next   = static_cast<unsigned char *>(std::memchr(start, 'O', end - start));
+
+  m_start     = next ? next - m_buffer.data() : m_fill;
+  m_lost_sync = true;
+}
+
+bool
+ogg_page_reader_c::is_crc_valid(unsigned char const *page,
+                                std::size_t size) {
+  static unsigned char const s_zero_crc[4]{};
+
+  // The CRC is calculated over the whole page with the CRC field set
+  // to 0 and stored in little endian byte order.
+  mtx::checksum::crc32_ieee_c crc;
+  crc.add(page,       22);
+  crc.add(s_zero_crc, 4);
+  crc.add(page + 26,  size - 26);
+
+  return get_uint32_le(&page[22]) == mtx::bswap_32(static_cast<uint32_t>(crc.get_result_as_uint()));
+}
+
+/** \brief Find the next valid page
+
+   Returns \c false if the end of the file has been reached before a
+   complete, valid page has been found.
+*/
+bool
+ogg_page_reader_c::read_next_page(page_t &page) {
+  while (true) {
+    auto available = m_fill - m_start;
+
+    if (available < s_header_size) {
+      if (!fill_buffer())
+        return false;
+      continue;
+    }
+
+    auto header = m_buffer.data() + m_start;
+
+    if (std::memcmp(header, "OggS", 4)) {
+      skip_to_next_capture_pattern();
+      continue;
+    }
+
+    auto header_len = s_header_size + header[26];
+    if (available < header_len) {
+      if (!fill_buffer())
+        return false;
+      continue;
+    }
+
+    auto body_len = std::size_t{};
+    for (auto idx = s_header_size; idx < header_len; ++idx)
+      body_len += header[idx];
+
+    if (available < (header_len + body_len)) {
+      if (!fill_buffer())
+        return false;
+      continue;
+    }
+
+    if (!is_crc_valid(header, header_len + body_len)) {
+      skip_to_next_capture_pattern();
+      continue;
+    }
+
+    page.m_header     = header;
+    page.m_header_len = header_len;
+    page.m_body       = header + header_len;
+    page.m_body_len   = body_len;
+
+    m_start          += header_len + body_len;
+
+    return true;
+  }
+}
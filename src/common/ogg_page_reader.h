@@ -0,0 +1,57 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   reader for the pages of Ogg files
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_OGG_PAGE_READER_H
+#define MTX_COMMON_OGG_PAGE_READER_H
+
+#include "common/common_pch.h"
+
+class mm_io_c;
+
+// Splits an Ogg stream into pages the same way libogg's
+// ogg_sync_pageseek() does, but reads the file in large blocks that
+// grow while it's read sequentially and parses the page headers
+// directly in its own buffer. The pages returned point into that
+// buffer; they're valid until the next call to read_next_page() or
+// reset().
+class ogg_page_reader_c {
+public:
+  struct page_t {
+    unsigned char *m_header{}, *m_body{};
+    std::size_t m_header_len{}, m_body_len{};
+  };
+
+protected:
+  mm_io_c &m_in;
+  std::vector<unsigned char> m_buffer;
+  std::size_t m_start{}, m_fill{}, m_read_size{};
+  bool m_eof{}, m_lost_sync{};
+
+public:
+  ogg_page_reader_c(mm_io_c &in);
+
+  bool read_next_page(page_t &page);
+  void reset();
+
+  // Whether or not data had to be skipped in front of the last page
+  // returned. The flag is cleared by calling this function.
+  bool lost_sync();
+
+  static bool is_crc_valid(unsigned char const *page, std::size_t size);
+
+protected:
+  bool fill_buffer();
+  void skip_to_next_capture_pattern();
+};
+
+#endif  // MTX_COMMON_OGG_PAGE_READER_H
@@ -58,6 +58,12 @@
 # define ARCH_32BIT
 #endif
 
+// SIMD kernels selected at runtime via __builtin_cpu_supports() and
+// compiled with __attribute__((target(...))).
+#if !defined(COMP_MSC) && !defined(COMP_SUNPRO) && (defined(__x86_64__) || defined(__i386__))
+# define MTX_X86_SIMD
+#endif
+
 #if defined(COMP_MSC)
 
 # define strncasecmp _strnicmp
@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <mutex>
 #include <sstream>
 
 #include "common/command_line.h"
@@ -30,7 +31,7 @@
 
 bool g_suppress_info              = false;
 bool g_suppress_warnings          = false;
-bool g_warning_issued             = false;
+std::atomic<bool> g_warning_issued{false};
 std::string g_stdio_charset;
 static bool s_mm_stdio_redirected = false;
 
@@ -39,6 +40,7 @@ std::shared_ptr<mm_io_c> g_mm_stdio   = std::shared_ptr<mm_io_c>(new mm_stdio_c)
 
 static mxmsg_handler_t s_mxmsg_info_handler, s_mxmsg_warning_handler, s_mxmsg_error_handler;
 static std::vector<std::string> s_warnings_emitted, s_errors_emitted;
+static thread_local mxmsg_capture_c::actions_t *tl_captured_actions = nullptr;
 
 static nlohmann::json
 to_json_array(std::vector<std::string> const &messages) {
@@ -102,16 +104,33 @@ set_mxmsg_handler(unsigned int level,
     assert(false);
 }
 
+mxmsg_handler_t
+get_mxmsg_handler(unsigned int level) {
+  if (MXMSG_INFO == level)
+    return s_mxmsg_info_handler;
+  else if (MXMSG_WARNING == level)
+    return s_mxmsg_warning_handler;
+  else if (MXMSG_ERROR == level)
+    return s_mxmsg_error_handler;
+
+  assert(false);
+  return {};
+}
+
 void
 mxmsg(unsigned int level,
       std::string message) {
   static debugging_option_c s_timestamped_messages{"timestamped_messages"};
   static debugging_option_c s_memory_usage_in_messages{"memory_usage_in_messages"};
   static bool s_saw_cr_after_nl = false;
+  static std::mutex s_mutex;
 
   if (g_suppress_info && (MXMSG_INFO == level))
     return;
 
+  // mkvextract's extractors may output warnings from worker threads.
+  std::lock_guard<std::mutex> lock{s_mutex};
+
   if ('\n' == message[0]) {
     message.erase(0, 1);
     g_mm_stdio->puts("\n");
@@ -150,6 +169,21 @@ mxmsg(unsigned int level,
   g_mm_stdio->flush();
 }
 
+mxmsg_capture_c::mxmsg_capture_c(actions_t &actions)
+  : m_previous_actions{tl_captured_actions}
+{
+  tl_captured_actions = &actions;
+}
+
+mxmsg_capture_c::~mxmsg_capture_c() {
+  tl_captured_actions = m_previous_actions;
+}
+
+mxmsg_capture_c::actions_t *
+mxmsg_capture_c::current() {
+  return tl_captured_actions;
+}
+
 static void
 default_mxinfo(unsigned int,
                std::string const &info) {
@@ -158,7 +192,10 @@ default_mxinfo(unsigned int,
 
 void
 mxinfo(std::string const &info) {
-  if (s_mxmsg_info_handler)
+  if (tl_captured_actions)
+    tl_captured_actions->emplace_back([info]() { mxinfo(info); });
+
+  else if (s_mxmsg_info_handler)
     s_mxmsg_info_handler(MXMSG_INFO, info);
 }
 
@@ -185,7 +222,10 @@ default_mxwarn(unsigned int,
 
 void
 mxwarn(std::string const &warning) {
-  if (s_mxmsg_warning_handler)
+  if (tl_captured_actions)
+    tl_captured_actions->emplace_back([warning]() { mxwarn(warning); });
+
+  else if (s_mxmsg_warning_handler)
     s_mxmsg_warning_handler(MXMSG_WARNING, warning);
 }
 
@@ -198,6 +238,11 @@ default_mxerror(unsigned int,
 
 void
 mxerror(std::string const &error) {
+  if (tl_captured_actions) {
+    tl_captured_actions->emplace_back([error]() { mxerror(error); });
+    throw mxmsg_capture_c::captured_error_x{};
+  }
+
   if (s_mxmsg_error_handler)
     s_mxmsg_error_handler(MXMSG_ERROR, error);
 }
@@ -16,6 +16,7 @@
 
 #include "common/os.h"
 
+#include <atomic>
 #include <functional>
 
 #include <ebml/EbmlElement.h>
@@ -28,8 +29,42 @@ using namespace libebml;
 
 using mxmsg_handler_t = std::function<void(unsigned int level, std::string const &)>;
 void set_mxmsg_handler(unsigned int level, mxmsg_handler_t const &handler);
+mxmsg_handler_t get_mxmsg_handler(unsigned int level);
+
+/** \brief Defers the messages output by the current thread
+
+   While an object of this class exists, mxinfo(), mxwarn() and
+   mxerror() called in the thread that created it don't output
+   anything. Instead functions outputting the same messages are
+   appended to the list of actions. Another thread can output them
+   later by running the actions in order. Other actions that depend
+   on the order they're run in can be appended to the current list
+   via \c current().
+
+   mxerror() throws \c captured_error_x after appending its message.
+   The type is not derived from \c std::exception so that it isn't
+   caught by code expecting mxerror() to exit.
+*/
+class mxmsg_capture_c {
+public:
+  using actions_t = std::vector<std::function<void()>>;
+
+  class captured_error_x {
+  };
+
+protected:
+  actions_t *m_previous_actions;
+
+public:
+  mxmsg_capture_c(actions_t &actions);
+  ~mxmsg_capture_c();
+
+  static actions_t *current();
+};
 
 extern bool g_suppress_info, g_suppress_warnings;
+// Set from mkvextract's worker threads, too.
+extern std::atomic<bool> g_warning_issued;
 extern std::string g_stdio_charset;
 extern charset_converter_cptr g_cc_stdio;
 extern std::shared_ptr<mm_io_c> g_mm_stdio;
@@ -0,0 +1,86 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   helper functions for PCM data
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/pcm.h"
+
+namespace mtx { namespace pcm {
+
+namespace {
+
+// With the frame sizes known at compile time the copies are compiled
+// into a couple of (vector) moves instead of a call to memmove() for
+// each sample frame. The copy goes through a temporary as source and
+// destination overlap for the first frames.
+template<std::size_t Tinput_frame_size,
+         std::size_t Toutput_frame_size>
+std::size_t
+remove_trailing_channels_fixed(unsigned char *buffer,
+                               std::size_t size) {
+  auto num_frames = size / Tinput_frame_size;
+  unsigned char frame[Toutput_frame_size];
+
+  for (std::size_t idx = 0; idx < num_frames; ++idx) {
+    std::memcpy(frame,                             &buffer[idx * Tinput_frame_size], Toutput_frame_size);
+    std::memcpy(&buffer[idx * Toutput_frame_size], frame,                            Toutput_frame_size);
+  }
+
+  return num_frames * Toutput_frame_size;
+}
+
+template<std::size_t Tbytes_per_channel,
+         std::size_t Tnum_output_channels>
+std::size_t
+remove_one_channel(unsigned char *buffer,
+                   std::size_t size) {
+  return remove_trailing_channels_fixed<Tbytes_per_channel * (Tnum_output_channels + 1), Tbytes_per_channel * Tnum_output_channels>(buffer, size);
+}
+
+}
+
+std::size_t
+remove_trailing_channels(unsigned char *buffer,
+                         std::size_t size,
+                         std::size_t bytes_per_channel,
+                         std::size_t num_input_channels,
+                         std::size_t num_output_channels) {
+  // Blu-ray PCM always contains an even number of channels. Streams
+  // with an odd number of channels carry an unused one.
+  if ((num_input_channels == (num_output_channels + 1)) && ((2 == bytes_per_channel) || (3 == bytes_per_channel))) {
+    auto key = bytes_per_channel * 10 + num_output_channels;
+
+    switch (key) {
+      case 21: return remove_one_channel<2, 1>(buffer, size);
+      case 23: return remove_one_channel<2, 3>(buffer, size);
+      case 25: return remove_one_channel<2, 5>(buffer, size);
+      case 27: return remove_one_channel<2, 7>(buffer, size);
+      case 31: return remove_one_channel<3, 1>(buffer, size);
+      case 33: return remove_one_channel<3, 3>(buffer, size);
+      case 35: return remove_one_channel<3, 5>(buffer, size);
+      case 37: return remove_one_channel<3, 7>(buffer, size);
+      default: break;
+    }
+  }
+
+  auto input_frame_size  = bytes_per_channel * num_input_channels;
+  auto output_frame_size = bytes_per_channel * num_output_channels;
+  auto num_frames        = input_frame_size ? size / input_frame_size : 0;
+
+  for (std::size_t idx = 0; idx < num_frames; ++idx)
+    std::memmove(&buffer[idx * output_frame_size], &buffer[idx * input_frame_size], output_frame_size);
+
+  return num_frames * output_frame_size;
+}
+
+}}
@@ -0,0 +1,28 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   helper functions for PCM data
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_PCM_H
+#define MTX_COMMON_PCM_H
+
+#include "common/common_pch.h"
+
+namespace mtx { namespace pcm {
+
+// Removes the last num_input_channels - num_output_channels channels of
+// each sample frame in place. Returns the resulting number of bytes.
+// Incomplete sample frames at the end are dropped.
+std::size_t remove_trailing_channels(unsigned char *buffer, std::size_t size, std::size_t bytes_per_channel, std::size_t num_input_channels, std::size_t num_output_channels);
+
+}}
+
+#endif  // MTX_COMMON_PCM_H
@@ -0,0 +1,329 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   scanners for the line formats of text subtitles
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "common/subtitle_tokenizers.h"
+
+namespace mtx { namespace subtitles {
+
+namespace {
+
+using cursor_t = char const *;
+
+// The same characters as "\s" in the regular expressions.
+bool
+is_space(char c) {
+  return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r') || (c == '\f') || (c == '\v');
+}
+
+bool
+is_digit(char c) {
+  return (c >= '0') && (c <= '9');
+}
+
+void
+skip_spaces(cursor_t &pos,
+            cursor_t end) {
+  while ((pos < end) && is_space(*pos))
+    ++pos;
+}
+
+bool
+skip_digits(cursor_t &pos,
+            cursor_t end,
+            std::size_t exact_count = 0) {
+  auto start = pos;
+
+  while ((pos < end) && is_digit(*pos))
+    ++pos;
+
+  auto count = static_cast<std::size_t>(pos - start);
+
+  return exact_count ? count == exact_count : count > 0;
+}
+
+bool
+skip_char(cursor_t &pos,
+          cursor_t end,
+          char c) {
+  if ((pos >= end) || (*pos != c))
+    return false;
+
+  ++pos;
+  return true;
+}
+
+struct srt_value_t {
+  bool negative{};
+  cursor_t digits{}, digits_end{};
+};
+
+// "\s*(-?)\s*(\d+)"
+bool
+read_srt_value(cursor_t &pos,
+               cursor_t end,
+               srt_value_t &value) {
+  skip_spaces(pos, end);
+  value.negative = skip_char(pos, end, '-');
+  skip_spaces(pos, end);
+
+  value.digits = pos;
+  if (!skip_digits(pos, end))
+    return false;
+
+  value.digits_end = pos;
+
+  return true;
+}
+
+// Same result as parse_number() into an int: values that don't fit
+// are treated as 0.
+int64_t
+srt_value_to_int(srt_value_t const &value) {
+  int64_t result{};
+
+  for (auto pos = value.digits; pos < value.digits_end; ++pos) {
+    result = result * 10 + (*pos - '0');
+    if (result > std::numeric_limits<int>::max())
+      return 0;
+  }
+
+  return result;
+}
+
+// The first nine digits of the fraction padded with zeros to nine
+// digits.
+int64_t
+srt_value_to_fraction(srt_value_t const &value) {
+  int64_t result{};
+  auto pos = value.digits;
+
+  for (auto idx = 0; idx < 9; ++idx) {
+    result *= 10;
+    if (pos < value.digits_end)
+      result += *pos++ - '0';
+  }
+
+  return result;
+}
+
+bool
+read_srt_timestamp(cursor_t &pos,
+                   cursor_t end,
+                   int64_t &timestamp) {
+  srt_value_t values[4];
+
+  if (   !read_srt_value(pos, end, values[0]) || !skip_char(pos, end, ':')
+      || !read_srt_value(pos, end, values[1]) || !skip_char(pos, end, ':')
+      || !read_srt_value(pos, end, values[2]))
+    return false;
+
+  if ((pos >= end) || ((*pos != ',') && (*pos != '.') && (*pos != ':')))
+    return false;
+
+  ++pos;
+
+  if (!read_srt_value(pos, end, values[3]))
+    return false;
+
+  int64_t negative = 1;
+  for (auto const &value : values)
+    negative *= value.negative ? -1 : 1;
+
+  timestamp  = srt_value_to_int(values[0]) * 60 * 60 + srt_value_to_int(values[1]) * 60 + srt_value_to_int(values[2]);
+  timestamp *= 1000000000ll * negative;
+  timestamp += srt_value_to_fraction(values[3]);
+
+  return true;
+}
+
+// "\d{2}:\d{2}:\d{2}\.\d{3}"
+bool
+skip_webvtt_timestamp(cursor_t &pos,
+                      cursor_t end) {
+  return skip_digits(pos, end, 2) && skip_char(pos, end, ':')
+      && skip_digits(pos, end, 2) && skip_char(pos, end, ':')
+      && skip_digits(pos, end, 2) && skip_char(pos, end, '.')
+      && skip_digits(pos, end, 3);
+}
+
+} // anonymous namespace
+
+bool
+parse_srt_timestamp_line(std::string const &line,
+                         int64_t &start,
+                         int64_t &end) {
+  auto pos      = line.data();
+  auto line_end = pos + line.size();
+
+  if (!read_srt_timestamp(pos, line_end, start))
+    return false;
+
+  // "\s*[\-\s]+>"
+  auto arrow_start = pos;
+  while ((pos < line_end) && ((*pos == '-') || is_space(*pos)))
+    ++pos;
+
+  if ((pos == arrow_start) || !skip_char(pos, line_end, '>'))
+    return false;
+
+  return read_srt_timestamp(pos, line_end, end);
+}
+
+bool
+is_srt_number_line(std::string const &line) {
+  auto pos = line.data();
+  auto end = pos + line.size();
+
+  return skip_digits(pos, end) && (pos == end);
+}
+
+bool
+has_srt_coordinates(std::string const &line) {
+  // The coordinates have to be at the end of the line. Walk backwards
+  // over the four "[XY]\d+:\d+" groups.
+  auto begin = line.data();
+  auto pos   = begin + line.size();
+
+  auto skip_spaces_backwards = [begin, &pos]() {
+    while ((pos > begin) && is_space(pos[-1]))
+      --pos;
+  };
+
+  auto skip_digits_backwards = [begin, &pos]() -> bool {
+    auto end = pos;
+    while ((pos > begin) && is_digit(pos[-1]))
+      --pos;
+    return pos != end;
+  };
+
+  for (auto group = 0; group < 4; ++group) {
+    skip_spaces_backwards();
+
+    if (!skip_digits_backwards() || (pos == begin) || (pos[-1] != ':'))
+      return false;
+    --pos;
+
+    if (!skip_digits_backwards() || (pos == begin) || ((pos[-1] != 'X') && (pos[-1] != 'Y')))
+      return false;
+    --pos;
+  }
+
+  return true;
+}
+
+bool
+is_ssa_section_line(std::string const &line,
+                    char const *name) {
+  auto pos = line.data();
+  auto end = pos + line.size();
+
+  skip_spaces(pos, end);
+
+  if (!skip_char(pos, end, '['))
+    return false;
+
+  for (; *name; ++name) {
+    if (*name == ' ') {
+      if ((pos >= end) || !is_space(*pos))
+        return false;
+      skip_spaces(pos, end);
+
+    } else if ((pos >= end) || (std::tolower(static_cast<unsigned char>(*pos)) != std::tolower(static_cast<unsigned char>(*name))))
+      return false;
+
+    else
+      ++pos;
+  }
+
+  return skip_char(pos, end, ']');
+}
+
+bool
+is_ssa_comment_line(std::string const &line) {
+  auto pos = line.data();
+  auto end = pos + line.size();
+
+  skip_spaces(pos, end);
+
+  return (pos == end) || (*pos == '!') || (*pos == ';');
+}
+
+bool
+parse_webvtt_timestamp_line(std::string const &line,
+                            std::string &start,
+                            std::string &end,
+                            std::string &settings) {
+  auto begin    = line.data();
+  auto pos      = begin;
+  auto line_end = begin + line.size();
+
+  auto start_pos = pos;
+  if (!skip_webvtt_timestamp(pos, line_end))
+    return false;
+  auto start_end = pos;
+
+  if (!skip_char(pos, line_end, ' ') || !skip_char(pos, line_end, '-') || !skip_char(pos, line_end, '-') || !skip_char(pos, line_end, '>') || !skip_char(pos, line_end, ' '))
+    return false;
+
+  auto end_pos = pos;
+  if (!skip_webvtt_timestamp(pos, line_end))
+    return false;
+  auto end_end = pos;
+
+  if (pos == line_end)
+    settings.clear();
+
+  else if ((*pos == ' ') && ((line_end - pos) > 1) && (std::find(pos, line_end, '\n') == line_end))
+    settings.assign(pos + 1, line_end);
+
+  else
+    return false;
+
+  start.assign(start_pos, start_end);
+  end.assign(end_pos, end_end);
+
+  return true;
+}
+
+std::size_t
+find_webvtt_embedded_timestamp(std::string const &text,
+                               std::size_t offset) {
+  auto begin = text.data();
+  auto end   = begin + text.size();
+
+  while (true) {
+    offset = text.find('<', offset);
+    if (std::string::npos == offset)
+      return offset;
+
+    auto pos = begin + offset + 1;
+    if (skip_webvtt_timestamp(pos, end) && skip_char(pos, end, '>'))
+      return offset;
+
+    ++offset;
+  }
+}
+
+bool
+is_microdvd_line(std::string const &line) {
+  auto pos = line.data();
+  auto end = pos + line.size();
+
+  return skip_char(pos, end, '{') && skip_digits(pos, end) && skip_char(pos, end, '}')
+      && skip_char(pos, end, '{') && skip_digits(pos, end) && skip_char(pos, end, '}')
+      && (pos < end);
+}
+
+}}
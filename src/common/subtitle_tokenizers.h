@@ -0,0 +1,56 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   scanners for the line formats of text subtitles
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_COMMON_SUBTITLE_TOKENIZERS_H
+#define MTX_COMMON_SUBTITLE_TOKENIZERS_H
+
+#include "common/common_pch.h"
+
+// These functions recognize the same lines as the regular expressions
+// noted next to them. They're used instead of the expressions as they
+// are run on each line of a subtitle file and neither allocate memory
+// nor need to be compiled first.
+
+namespace mtx { namespace subtitles {
+
+// SRT: "^\s*(-?)\s*(\d+):…[,.:]…\s*[\-\s]+>\s*…", i.e. two timestamps
+// with optional signs in front of each of their components. The
+// start and end are returned in nanoseconds.
+bool parse_srt_timestamp_line(std::string const &line, int64_t &start, int64_t &end);
+
+// SRT: "^\d+$"
+bool is_srt_number_line(std::string const &line);
+
+// SRT: "([XY]\d+:\d+\s*){4}\s*$"
+bool has_srt_coordinates(std::string const &line);
+
+// SSA/ASS: "^\s*\[name\]" with case-insensitive matching. Each space in
+// name matches one or more whitespace characters.
+bool is_ssa_section_line(std::string const &line, char const *name);
+
+// SSA/ASS: "^\s*$|^\s*[!;]"
+bool is_ssa_comment_line(std::string const &line);
+
+// WebVTT: "^(\d{2}:\d{2}:\d{2}\.\d{3}) --> (\d{2}:\d{2}:\d{2}\.\d{3})(?: ([^\n]+))?$"
+bool parse_webvtt_timestamp_line(std::string const &line, std::string &start, std::string &end, std::string &settings);
+
+// WebVTT: the position of the next "<\d{2}:\d{2}:\d{2}\.\d{3}>" at or
+// after offset or std::string::npos if there's none.
+std::size_t find_webvtt_embedded_timestamp(std::string const &text, std::size_t offset);
+
+// MicroDVD: "^\{\d+?\}\{\d+?\}.+$"
+bool is_microdvd_line(std::string const &line);
+
+}}
+
+#endif  // MTX_COMMON_SUBTITLE_TOKENIZERS_H
@@ -15,10 +15,9 @@
 
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
+#include "common/subtitle_tokenizers.h"
 #include "common/webvtt.h"
 
-#define RE_TIMESTAMP "(\\d{2}:\\d{2}:\\d{2}\\.\\d{3})"
-
 struct webvtt_parser_c::impl_t {
 public:
   std::vector<std::string> current_block, global_blocks, local_blocks;
@@ -26,8 +25,6 @@ public:
   std::deque<webvtt_parser_c::cue_cptr> cues;
   unsigned int current_cue_number{}, total_number_of_cues{};
   debugging_option_c debug{"webvtt_parser"};
-
-  boost::regex timestamp_line_re{"^" RE_TIMESTAMP " --> " RE_TIMESTAMP "(?: ([^\\n]+))?$", boost::regex::perl};
 };
 
 webvtt_parser_c::webvtt_parser_c()
@@ -76,14 +73,13 @@ webvtt_parser_c::add_block() {
   if (m->current_block.empty())
     return;
 
-  boost::smatch matches;
-  std::string label, additional;
+  std::string label, additional, start_str, end_str, settings_list;
   auto timestamp_line = -1;
 
-  if (boost::regex_search(m->current_block[0], matches, m->timestamp_line_re))
+  if (mtx::subtitles::parse_webvtt_timestamp_line(m->current_block[0], start_str, end_str, settings_list))
     timestamp_line = 0;
 
-  else if ((m->current_block.size() > 1) && boost::regex_search(m->current_block[1], matches, m->timestamp_line_re)) {
+  else if ((m->current_block.size() > 1) && mtx::subtitles::parse_webvtt_timestamp_line(m->current_block[1], start_str, end_str, settings_list)) {
     timestamp_line = 1;
     label          = std::move(m->current_block[0]);
 
@@ -99,8 +95,8 @@ webvtt_parser_c::add_block() {
   m->parsing_global_data = false;
 
   timestamp_c start, end;
-  parse_timestamp(matches[1].str(), start);
-  parse_timestamp(matches[2].str(), end);
+  parse_timestamp(start_str, start);
+  parse_timestamp(end_str,   end);
 
   auto content       = boost::join(std::make_pair(m->current_block.begin() + timestamp_line + 1, m->current_block.end()), "\n");;
   content            = adjust_embedded_timestamps(content, start.negate());
@@ -108,7 +104,6 @@ webvtt_parser_c::add_block() {
   cue->m_start       = start;
   cue->m_duration    = end - start;
   cue->m_content     = memory_c::clone(content);
-  auto settings_list = matches[3].str();
 
   if (! (label.empty() && settings_list.empty() && m->local_blocks.empty())) {
     additional = settings_list + "\n" + label + "\n" + boost::join(m->local_blocks, "\n");
@@ -117,7 +112,7 @@ webvtt_parser_c::add_block() {
 
   mxdebug_if(m->debug,
              boost::format("label «%1%» start «%2%» end «%3%» settings list «%4%» additional «%5%» content «%6%»\n")
-             % label % matches[1].str() % matches[2].str() % matches[3].str()
+             % label % start_str % end_str % settings_list
              % boost::regex_replace(additional, boost::regex{"\n+", boost::regex::perl}, "–")
              % boost::regex_replace(content,    boost::regex{"\n+", boost::regex::perl}, "–"));
 
@@ -175,14 +170,24 @@ webvtt_parser_c::get_progress_percentage()
 std::string
 webvtt_parser_c::adjust_embedded_timestamps(std::string const &text,
                                             timestamp_c const &offset) {
-  static boost::regex s_embedded_timestamp_re;
+  std::string result;
+  std::size_t copied_up_to = 0;
+  auto position            = mtx::subtitles::find_webvtt_embedded_timestamp(text, 0);
 
-  if (s_embedded_timestamp_re.empty())
-    s_embedded_timestamp_re = boost::regex{"<" RE_TIMESTAMP ">", boost::regex::perl};
+  if (std::string::npos == position)
+    return text;
 
-  return boost::regex_replace(text, s_embedded_timestamp_re, [&offset](boost::smatch const &match) -> std::string {
+  while (std::string::npos != position) {
     timestamp_c timestamp;
-    parse_timestamp(match[1].str(), timestamp);
-    return (boost::format("<%1%>") % format_timestamp(timestamp + offset, 3)).str();
-  });
+    parse_timestamp(text.substr(position + 1, 12), timestamp);
+
+    result.append(text, copied_up_to, position - copied_up_to);
+    result       += (boost::format("<%1%>") % format_timestamp(timestamp + offset, 3)).str();
+    copied_up_to  = position + 14;
+    position      = mtx::subtitles::find_webvtt_embedded_timestamp(text, copied_up_to);
+  }
+
+  result.append(text, copied_up_to, std::string::npos);
+
+  return result;
 }
@@ -129,9 +129,13 @@ extract_attachments(const std::string &file_name,
   if (tracks.empty())
     mxerror(Y("Nothing to do.\n"));
 
-  auto analyzer = open_and_analyze(file_name, parse_mode);
+  extract_attachments(*open_and_analyze(file_name, parse_mode), tracks);
+}
 
-  ebml_master_cptr attachments_m(analyzer->read_all(EBML_INFO(KaxAttachments)));
+void
+extract_attachments(kax_analyzer_c &analyzer,
+                    std::vector<track_spec_t> &tracks) {
+  ebml_master_cptr attachments_m(analyzer.read_all(EBML_INFO(KaxAttachments)));
   KaxAttachments *attachments = dynamic_cast<KaxAttachments *>(attachments_m.get());
   if (attachments)
     handle_attachments(attachments, tracks);
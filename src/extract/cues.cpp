@@ -182,13 +182,17 @@ extract_cues(std::string const &file_name,
   if (tracks.empty())
     mxerror(Y("Nothing to do.\n"));
 
-  auto analyzer               = open_and_analyze(file_name, parse_mode);
-
-  auto cue_points             = parse_cue_points(*analyzer);
-  auto timecode_scale         = find_timecode_scale(*analyzer);
-  auto track_number_map       = generate_track_number_map(*analyzer);
-  auto segment_data_start_pos = analyzer->get_segment_data_start_pos();
+  extract_cues(*open_and_analyze(file_name, parse_mode), tracks);
+}
 
-  determine_cluster_data_start_positions(analyzer->get_file(), segment_data_start_pos, cue_points);
+void
+extract_cues(kax_analyzer_c &analyzer,
+             std::vector<track_spec_t> const &tracks) {
+  auto cue_points             = parse_cue_points(analyzer);
+  auto timecode_scale         = find_timecode_scale(analyzer);
+  auto track_number_map       = generate_track_number_map(analyzer);
+  auto segment_data_start_pos = analyzer.get_segment_data_start_pos();
+
+  determine_cluster_data_start_positions(analyzer.get_file(), segment_data_start_pos, cue_points);
   write_cues(tracks, track_number_map, cue_points, segment_data_start_pos, timecode_scale);
 }
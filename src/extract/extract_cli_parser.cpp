@@ -32,6 +32,7 @@ void
 extract_cli_parser_c::set_default_values() {
   m_charset                = "UTF-8";
   m_extract_cuesheet       = false;
+  m_binary_timecodes       = false;
   m_extract_blockadd_level = -1;
   m_target_mode            = track_spec_t::tm_normal;
 }
@@ -50,6 +51,7 @@ extract_cli_parser_c::init_parser() {
   add_information(YT("mkvextract cuesheet <inname> [options]"));
   add_information(YT("mkvextract timecodes_v2 <inname> [TID1:out1 [TID2:out2 ...]]"));
   add_information(YT("mkvextract cues <inname> [options] [TID1:out1 [TID2:out2 ...]]"));
+  add_information(YT("mkvextract <mode1> <inname> [options] [extraction-spec] <mode2> [options] [extraction-spec] ..."));
   add_information(YT("mkvextract <-h|-V>"));
 
   add_separator();
@@ -57,9 +59,14 @@ extract_cli_parser_c::init_parser() {
   add_information(YT("The first word tells mkvextract what to extract. The second must be the source file. "
                      "There are few global options that can be used with all modes. "
                      "All other options depend on the mode."));
+  add_information(YT("Several modes can be combined in one invocation. Each mode's options and extraction specifications follow its name. "
+                     "The file is analyzed only once, and tracks and timecodes are extracted in a single pass over its clusters. "
+                     "The modes writing to the standard output (tags, chapters and cuesheet) cannot be combined with other modes."));
 
   add_section_header(YT("Global options"));
   OPT("f|parse-fully",    set_parse_fully,      YT("Parse the whole file instead of relying on the index."));
+  OPT("index-cache",      enable_index_cache,   YT("Stores the positions of the file's top level elements in a cache and re-uses them "
+                                                   "as long as the file has not been modified otherwise."));
 
   add_common_options();
 
@@ -114,6 +121,7 @@ extract_cli_parser_c::init_parser() {
   add_section_header(YT("Timecode extraction"));
 
   add_information(YT("The sixth mode finds the timecodes of all blocks for a track and outputs a timecode v2 file with these timecodes."));
+  OPT("binary", set_binary, YT("Write the timecodes for the following track in mkvmerge's compact binary format instead of the v2 text format."));
 
   add_section_header(YT("Example"));
 
@@ -126,6 +134,13 @@ extract_cli_parser_c::init_parser() {
 
   add_information(YT("mkvextract cues \"a movie.mkv\" 0:cues_track0.txt"));
 
+  add_section_header(YT("Combining modes"));
+  add_information(YT("All of the track, timecode, cue and attachment extraction modes can be used in a single invocation."));
+
+  add_section_header(YT("Example"));
+
+  add_information(YT("mkvextract tracks \"a movie.mkv\" 0:video.h264 1:audio.ac3 timecodes_v2 0:timecodes_track0.txt cues 0:cues_track0.txt"));
+
   add_separator();
 
   add_hook(cli_parser_c::ht_unknown_option, std::bind(&extract_cli_parser_c::set_mode_or_extraction_spec, this));
@@ -135,11 +150,14 @@ extract_cli_parser_c::init_parser() {
 
 void
 extract_cli_parser_c::assert_mode(options_c::extraction_mode_e mode) {
-  if      ((options_c::em_tracks   == mode) && (m_options.m_extraction_mode != mode))
+  if      ((options_c::em_tracks   == mode) && (m_options.get_current_mode() != mode))
     mxerror(boost::format(Y("'%1%' is only allowed when extracting tracks.\n"))   % m_current_arg);
 
-  else if ((options_c::em_chapters == mode) && (m_options.m_extraction_mode != mode))
+  else if ((options_c::em_chapters == mode) && (m_options.get_current_mode() != mode))
     mxerror(boost::format(Y("'%1%' is only allowed when extracting chapters.\n")) % m_current_arg);
+
+  else if ((options_c::em_timecodes_v2 == mode) && (m_options.get_current_mode() != mode))
+    mxerror(boost::format(Y("'%1%' is only allowed when extracting timecodes.\n")) % m_current_arg);
 }
 
 void
@@ -147,6 +165,11 @@ extract_cli_parser_c::set_parse_fully() {
   m_options.m_parse_mode = kax_analyzer_c::parse_mode_full;
 }
 
+void
+extract_cli_parser_c::enable_index_cache() {
+  m_options.m_use_index_cache = true;
+}
+
 void
 extract_cli_parser_c::set_charset() {
   assert_mode(options_c::em_tracks);
@@ -178,10 +201,16 @@ extract_cli_parser_c::set_fullraw() {
   m_target_mode = track_spec_t::tm_full_raw;
 }
 
+void
+extract_cli_parser_c::set_binary() {
+  assert_mode(options_c::em_timecodes_v2);
+  m_binary_timecodes = true;
+}
+
 void
 extract_cli_parser_c::set_simple() {
   assert_mode(options_c::em_chapters);
-  m_options.m_simple_chapter_format = true;
+  m_options.m_modes.back().m_simple_chapter_format = true;
 }
 
 void
@@ -192,7 +221,7 @@ extract_cli_parser_c::set_simple_language() {
   if (0 > language_idx)
     mxerror(boost::format(Y("'%1%' is neither a valid ISO639-2 nor a valid ISO639-1 code. See 'mkvmerge --list-languages' for a list of all languages and their respective ISO639-2 codes.\n")) % m_next_arg);
 
-  m_options.m_simple_chapter_language.reset(g_iso639_languages[language_idx].iso639_2_code);
+  m_options.m_modes.back().m_simple_chapter_language.reset(g_iso639_languages[language_idx].iso639_2_code);
 }
 
 void
@@ -205,12 +234,15 @@ extract_cli_parser_c::set_mode_or_extraction_spec() {
   else if (2 == m_num_unknown_args)
     m_options.m_file_name = m_current_arg;
 
+  else if (options_c::em_unknown != get_extraction_mode(m_current_arg))
+    set_extraction_mode();
+
   else
     add_extraction_spec();
 }
 
-void
-extract_cli_parser_c::set_extraction_mode() {
+options_c::extraction_mode_e
+extract_cli_parser_c::get_extraction_mode(std::string const &name) {
   static struct {
     const char *name;
     options_c::extraction_mode_e extraction_mode;
@@ -227,27 +259,57 @@ extract_cli_parser_c::set_extraction_mode() {
 
   int i;
   for (i = 0; s_mode_map[i].name; ++i)
-    if (m_current_arg == s_mode_map[i].name) {
-      m_options.m_extraction_mode = s_mode_map[i].extraction_mode;
-      return;
-    }
+    if (name == s_mode_map[i].name)
+      return s_mode_map[i].extraction_mode;
 
-  mxerror(boost::format(Y("Unknown mode '%1%'.\n")) % m_current_arg);
+  return options_c::em_unknown;
+}
+
+void
+extract_cli_parser_c::set_extraction_mode() {
+  auto mode = get_extraction_mode(m_current_arg);
+
+  if (options_c::em_unknown == mode)
+    mxerror(boost::format(Y("Unknown mode '%1%'.\n")) % m_current_arg);
+
+  if (m_options.find_mode(mode))
+    mxerror(boost::format(Y("The mode '%1%' has already been used.\n")) % m_current_arg);
+
+  m_options.m_modes.emplace_back(mode);
+
+  // IDs may be re-used in each mode, e.g. for extracting both a track
+  // and its timecodes.
+  m_used_tids.clear();
+  set_default_values();
+}
+
+void
+extract_cli_parser_c::verify_mode_combination() {
+  if (1 >= m_options.m_modes.size())
+    return;
+
+  for (auto const &mode_options : m_options.m_modes) {
+    auto mode = mode_options.m_extraction_mode;
+    if ((options_c::em_tags == mode) || (options_c::em_chapters == mode) || (options_c::em_cuesheet == mode))
+      mxerror(Y("The modes writing to the standard output (tags, chapters and cuesheet) cannot be combined with other modes.\n"));
+  }
 }
 
 void
 extract_cli_parser_c::add_extraction_spec() {
-  if (   (options_c::em_tracks       != m_options.m_extraction_mode)
-      && (options_c::em_cues         != m_options.m_extraction_mode)
-      && (options_c::em_timecodes_v2 != m_options.m_extraction_mode)
-      && (options_c::em_attachments  != m_options.m_extraction_mode))
+  auto mode = m_options.get_current_mode();
+
+  if (   (options_c::em_tracks       != mode)
+      && (options_c::em_cues         != mode)
+      && (options_c::em_timecodes_v2 != mode)
+      && (options_c::em_attachments  != mode))
     mxerror(boost::format(Y("Unrecognized command line option '%1%'.\n")) % m_current_arg);
 
   boost::regex s_track_id_re("^(\\d+)(:(.+))?$", boost::regex::perl);
 
   boost::smatch matches;
   if (!boost::regex_search(m_current_arg, matches, s_track_id_re)) {
-    if (options_c::em_attachments == m_options.m_extraction_mode)
+    if (options_c::em_attachments == mode)
       mxerror(boost::format(Y("Invalid attachment ID/file name specification in argument '%1%'.\n")) % m_current_arg);
     else
       mxerror(boost::format(Y("Invalid track ID/file name specification in argument '%1%'.\n")) % m_current_arg);
@@ -266,7 +328,7 @@ extract_cli_parser_c::add_extraction_spec() {
     output_file_name = matches[3].str();
 
   if (output_file_name.empty()) {
-    if (options_c::em_attachments == m_options.m_extraction_mode)
+    if (options_c::em_attachments == mode)
       mxinfo(Y("No destination file name specified, will use attachment name.\n"));
     else
       mxerror(boost::format(Y("Missing destination file name in argument '%1%'.\n")) % m_current_arg);
@@ -275,9 +337,10 @@ extract_cli_parser_c::add_extraction_spec() {
   track.out_name               = output_file_name;
   track.sub_charset            = m_charset;
   track.extract_cuesheet       = m_extract_cuesheet;
+  track.binary_timecodes       = m_binary_timecodes;
   track.extract_blockadd_level = m_extract_blockadd_level;
   track.target_mode            = m_target_mode;
-  m_options.m_tracks.push_back(track);
+  m_options.m_modes.back().m_tracks.push_back(track);
 
   set_default_values();
 }
@@ -287,6 +350,7 @@ extract_cli_parser_c::run() {
   init_parser();
 
   parse_args();
+  verify_mode_combination();
 
   return m_options;
 }
@@ -25,7 +25,7 @@ protected:
   int m_num_unknown_args;
 
   std::string m_charset;
-  bool m_extract_cuesheet;
+  bool m_extract_cuesheet, m_binary_timecodes;
   int m_extract_blockadd_level;
   track_spec_t::target_mode_e m_target_mode;
 
@@ -43,16 +43,21 @@ protected:
   void assert_mode(options_c::extraction_mode_e mode);
 
   void set_parse_fully();
+  void enable_index_cache();
   void set_charset();
   void set_cuesheet();
   void set_blockadd();
   void set_raw();
   void set_fullraw();
+  void set_binary();
   void set_simple();
   void set_simple_language();
   void set_mode_or_extraction_spec();
   void set_extraction_mode();
   void add_extraction_spec();
+  void verify_mode_combination();
+
+  static options_c::extraction_mode_e get_extraction_mode(std::string const &name);
 };
 
 #endif // MTX_EXTRACT_EXTRACT_CLI_PARSER_H
@@ -38,6 +38,8 @@ enum operation_mode_e {
   MODE_TIMECODES_V2,
 };
 
+static bool s_use_index_cache = false;
+
 kax_analyzer_cptr
 open_and_analyze(std::string const &file_name,
                  kax_analyzer_c::parse_mode_e parse_mode,
@@ -49,6 +51,7 @@ open_and_analyze(std::string const &file_name,
       ->set_parse_mode(parse_mode)
       .set_open_mode(MODE_READ)
       .set_throw_on_error(exit_on_error)
+      .set_use_index_cache(s_use_index_cache)
       .process();
 
     return ok ? analyzer : kax_analyzer_cptr{};
@@ -104,36 +107,80 @@ setup(char **argv) {
   version_info = get_version_info("mkvextract", vif_full);
 }
 
-int
-main(int argc,
-     char **argv) {
-  setup(argv);
-
-  options_c options = extract_cli_parser_c(command_line_utf8(argc, argv)).run();
+static void
+extract_single_mode(options_c &options) {
+  auto &mode_options = options.m_modes.front();
+  auto mode          = mode_options.m_extraction_mode;
 
-  if (options_c::em_tracks == options.m_extraction_mode)
-    extract_tracks(options.m_file_name, options.m_tracks, options.m_parse_mode);
+  if (options_c::em_tracks == mode)
+    extract_tracks(options.m_file_name, mode_options.m_tracks, options.m_parse_mode);
 
-  else if (options_c::em_tags == options.m_extraction_mode)
+  else if (options_c::em_tags == mode)
     extract_tags(options.m_file_name, options.m_parse_mode);
 
-  else if (options_c::em_attachments == options.m_extraction_mode)
-    extract_attachments(options.m_file_name, options.m_tracks, options.m_parse_mode);
+  else if (options_c::em_attachments == mode)
+    extract_attachments(options.m_file_name, mode_options.m_tracks, options.m_parse_mode);
 
-  else if (options_c::em_chapters == options.m_extraction_mode)
-    extract_chapters(options.m_file_name, options.m_simple_chapter_format, options.m_parse_mode, options.m_simple_chapter_language);
+  else if (options_c::em_chapters == mode)
+    extract_chapters(options.m_file_name, mode_options.m_simple_chapter_format, options.m_parse_mode, mode_options.m_simple_chapter_language);
 
-  else if (options_c::em_cues == options.m_extraction_mode)
-    extract_cues(options.m_file_name, options.m_tracks, options.m_parse_mode);
+  else if (options_c::em_cues == mode)
+    extract_cues(options.m_file_name, mode_options.m_tracks, options.m_parse_mode);
 
-  else if (options_c::em_cuesheet == options.m_extraction_mode)
+  else if (options_c::em_cuesheet == mode)
     extract_cuesheet(options.m_file_name, options.m_parse_mode);
 
-  else if (options_c::em_timecodes_v2 == options.m_extraction_mode)
-    extract_timecodes(options.m_file_name, options.m_tracks, 2);
+  else if (options_c::em_timecodes_v2 == mode)
+    extract_timecodes(options.m_file_name, mode_options.m_tracks, 2);
 
   else
     usage(2);
+}
+
+/** \brief Handle several modes with a single analysis of the file
+
+   The analyzer is shared by all modes. Tracks and timecodes are
+   extracted in one pass over the clusters instead of one pass per
+   mode.
+*/
+static void
+extract_multiple_modes(options_c &options) {
+  for (auto const &mode_options : options.m_modes)
+    if (mode_options.m_tracks.empty())
+      mxerror(Y("Nothing to do.\n"));
+
+  auto analyzer = open_and_analyze(options.m_file_name, options.m_parse_mode);
+
+  if (auto attachments = options.find_mode(options_c::em_attachments))
+    extract_attachments(*analyzer, attachments->m_tracks);
+
+  if (auto cues = options.find_mode(options_c::em_cues))
+    extract_cues(*analyzer, cues->m_tracks);
+
+  auto tracks    = options.find_mode(options_c::em_tracks);
+  auto timecodes = options.find_mode(options_c::em_timecodes_v2);
+  auto no_tspecs = std::vector<track_spec_t>{};
+
+  if (tracks || timecodes)
+    extract_tracks_and_timecodes(options.m_file_name, analyzer, tracks ? tracks->m_tracks : no_tspecs, timecodes ? timecodes->m_tracks : no_tspecs);
+}
+
+int
+main(int argc,
+     char **argv) {
+  setup(argv);
+
+  options_c options = extract_cli_parser_c(command_line_utf8(argc, argv)).run();
+  s_use_index_cache = options.m_use_index_cache;
+
+  if (options.m_modes.empty())
+    usage(2);
+
+  else if (1 == options.m_modes.size())
+    extract_single_mode(options);
+
+  else
+    extract_multiple_modes(options);
 
   mxexit();
 }
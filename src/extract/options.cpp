@@ -16,8 +16,19 @@
 #include "extract/options.h"
 
 options_c::options_c()
-  : m_simple_chapter_format(false)
-  , m_parse_mode(kax_analyzer_c::parse_mode_fast)
-  , m_extraction_mode(options_c::em_unknown)
+  : m_parse_mode(kax_analyzer_c::parse_mode_fast)
+  , m_use_index_cache(false)
 {
 }
+
+options_c::extraction_mode_e
+options_c::get_current_mode()
+  const {
+  return m_modes.empty() ? em_unknown : m_modes.back().m_extraction_mode;
+}
+
+options_c::mode_options_t *
+options_c::find_mode(extraction_mode_e mode) {
+  auto itr = brng::find_if(m_modes, [mode](mode_options_t const &mode_options) { return mode_options.m_extraction_mode == mode; });
+  return itr != m_modes.end() ? &(*itr) : nullptr;
+}
@@ -26,16 +26,33 @@ public:
     em_cues,
   };
 
+  struct mode_options_t {
+    extraction_mode_e m_extraction_mode;
+    bool m_simple_chapter_format;
+    boost::optional<std::string> m_simple_chapter_language;
+
+    std::vector<track_spec_t> m_tracks;
+
+    mode_options_t(extraction_mode_e extraction_mode)
+      : m_extraction_mode{extraction_mode}
+      , m_simple_chapter_format{}
+    {
+    }
+  };
+
   std::string m_file_name;
-  bool m_simple_chapter_format;
-  boost::optional<std::string> m_simple_chapter_language;
   kax_analyzer_c::parse_mode_e m_parse_mode;
-  extraction_mode_e m_extraction_mode;
+  bool m_use_index_cache;
 
-  std::vector<track_spec_t> m_tracks;
+  // One entry for each mode given on the command line. All of them
+  // are handled in a single run over the source file.
+  std::vector<mode_options_t> m_modes;
 
 public:
   options_c();
+
+  extraction_mode_e get_current_mode() const;
+  mode_options_t *find_mode(extraction_mode_e mode);
 };
 
 #endif // MTX_EXTRACT_OPTIONS_H
@@ -31,6 +31,7 @@
 #include <matroska/KaxTracks.h>
 #include <matroska/KaxTrackEntryData.h>
 
+#include "common/binary_timestamps.h"
 #include "common/command_line.h"
 #include "common/ebml.h"
 #include "common/mm_io_x.h"
@@ -62,12 +63,14 @@ struct timecode_extractor_t {
   mm_io_cptr m_file;
   std::vector<timecode_t> m_timecodes;
   int64_t m_default_duration;
+  bool m_binary;
 
-  timecode_extractor_t(int64_t tid, int64_t tnum, const mm_io_cptr &file, int64_t default_duration)
+  timecode_extractor_t(int64_t tid, int64_t tnum, const mm_io_cptr &file, int64_t default_duration, bool binary)
     : m_tid(tid)
     , m_tnum(tnum)
     , m_file(file)
     , m_default_duration(default_duration)
+    , m_binary(binary)
   {
   }
 };
@@ -77,11 +80,33 @@ static std::vector<timecode_extractor_t> timecode_extractors;
 // ------------------------------------------------------------------------
 
 static void
+write_binary_timecodes(timecode_extractor_t &extractor) {
+  auto &timecodes = extractor.m_timecodes;
+
+  std::vector<int64_t> timestamps;
+  timestamps.reserve(timecodes.size() + 1);
+
+  for (auto const &timecode : timecodes)
+    timestamps.push_back(timecode.m_timecode);
+
+  if (!timecodes.empty())
+    timestamps.push_back(timecodes.back().m_timecode + timecodes.back().m_duration);
+
+  mtx::binary_timestamps::write(*extractor.m_file, timestamps, mtx::binary_timestamps::determine_default_duration(timestamps));
+}
+
+void
 close_timecode_files() {
   for (auto &extractor : timecode_extractors) {
     auto &timecodes = extractor.m_timecodes;
 
     std::sort(timecodes.begin(), timecodes.end());
+
+    if (extractor.m_binary) {
+      write_binary_timecodes(extractor);
+      continue;
+    }
+
     for (auto timecode : timecodes)
       extractor.m_file->puts(to_string(timecode.m_timecode, 1000000, 6) + "\n");
 
@@ -94,7 +119,7 @@ close_timecode_files() {
   timecode_extractors.clear();
 }
 
-static void
+void
 create_timecode_files(KaxTracks &kax_tracks,
                       std::vector<track_spec_t> &tracks,
                       int version) {
@@ -119,8 +144,12 @@ create_timecode_files(KaxTracks &kax_tracks,
 
     try {
       mm_io_cptr file = mm_write_buffer_io_c::open(tspec.out_name, 128 * 1024);
-      timecode_extractors.push_back(timecode_extractor_t(tspec.tid, kt_get_number(*track), file, std::max(kt_get_default_duration(*track), static_cast<int64_t>(0))));
-      file->puts(boost::format("# timecode format v%1%\n") % version);
+      timecode_extractors.push_back(timecode_extractor_t(tspec.tid, kt_get_number(*track), file, std::max(kt_get_default_duration(*track), static_cast<int64_t>(0)), tspec.binary_timecodes));
+
+      // Binary files start with the number of timecodes which is only
+      // known once all of them have been collected.
+      if (!tspec.binary_timecodes)
+        file->puts(boost::format("# timecode format v%1%\n") % version);
 
     } catch(mtx::mm_io::exception &ex) {
       close_timecode_files();
@@ -136,10 +165,10 @@ find_extractor_by_track_number(unsigned int track_number) {
                       [=](timecode_extractor_t &xtr) { return track_number == xtr.m_tnum; });
 }
 
-static void
-handle_blockgroup(KaxBlockGroup &blockgroup,
-                  KaxCluster &cluster,
-                  int64_t tc_scale) {
+void
+handle_blockgroup_timecodes(KaxBlockGroup &blockgroup,
+                            KaxCluster &cluster,
+                            int64_t tc_scale) {
   // Only continue if this block group actually contains a block.
   KaxBlock *block = FindChild<KaxBlock>(&blockgroup);
   if (!block)
@@ -161,9 +190,9 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
     extractor->m_timecodes.push_back(timecode_t(block->GlobalTimecode() + i * duration / block->NumberFrames(), duration / block->NumberFrames()));
 }
 
-static void
-handle_simpleblock(KaxSimpleBlock &simpleblock,
-                   KaxCluster &cluster) {
+void
+handle_simpleblock_timecodes(KaxSimpleBlock &simpleblock,
+                             KaxCluster &cluster) {
   if (0 == simpleblock.NumberFrames())
     return;
 
@@ -310,13 +339,13 @@ extract_timecodes(const std::string &file_name,
             show_element(l2, 2, Y("Block group"));
 
             l2->Read(*es, EBML_CLASS_CONTEXT(KaxBlockGroup), upper_lvl_el, l3, true);
-            handle_blockgroup(*static_cast<KaxBlockGroup *>(l2), *cluster, tc_scale);
+            handle_blockgroup_timecodes(*static_cast<KaxBlockGroup *>(l2), *cluster, tc_scale);
 
           } else if (Is<KaxSimpleBlock>(l2)) {
             show_element(l2, 2, Y("Simple block"));
 
             l2->Read(*es, EBML_CLASS_CONTEXT(KaxSimpleBlock), upper_lvl_el, l3, true);
-            handle_simpleblock(*static_cast<KaxSimpleBlock *>(l2), *cluster);
+            handle_simpleblock_timecodes(*static_cast<KaxSimpleBlock *>(l2), *cluster);
 
           } else
             l2->SkipData(*es, EBML_CONTEXT(l2));
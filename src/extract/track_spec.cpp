@@ -18,6 +18,7 @@ track_spec_t::track_spec_t()
   : tid(0)
   , tuid(0)
   , extract_cuesheet(false)
+  , binary_timecodes(false)
   , target_mode(track_spec_t::tm_normal)
   , extract_blockadd_level(-1)
   , done(false)
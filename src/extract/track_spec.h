@@ -27,6 +27,7 @@ struct track_spec_t {
 
   std::string sub_charset;
   bool extract_cuesheet;
+  bool binary_timecodes;
 
   target_mode_e target_mode;
   int extract_blockadd_level;
@@ -13,6 +13,7 @@
 #include "common/common_pch.h"
 
 #include <cassert>
+#include <unordered_set>
 
 #include <ebml/EbmlHead.h>
 #include <ebml/EbmlSubHead.h>
@@ -33,16 +34,21 @@
 #include <matroska/KaxTrackVideo.h>
 
 #include "common/command_line.h"
+#include "common/debugging.h"
 #include "common/ebml.h"
 #include "common/kax_file.h"
 #include "common/mm_io_x.h"
 #include "common/mm_write_buffer_io.h"
 #include "extract/mkvextract.h"
 #include "extract/xtr_base.h"
+#include "extract/xtr_worker.h"
 
 using namespace libmatroska;
 
 static std::vector<xtr_base_c *> extractors;
+static std::unordered_map<xtr_base_c *, xtr_worker_c *> extractor_workers;
+static std::unordered_set<xtr_worker_c *> workers_using_cluster;
+static debugging_option_c debug_single_threaded{"extraction_single_threaded"};
 
 // ------------------------------------------------------------------------
 
@@ -121,16 +127,105 @@ create_extractors(KaxTracks &kax_tracks,
     extractors[i]->headers_done();
 }
 
+// One worker thread is used per output file. Extractors writing to
+// the same file as another one share the other one's worker.
+static void
+create_workers(std::vector<std::unique_ptr<xtr_worker_c>> &workers) {
+  if (debug_single_threaded)
+    return;
+
+  for (auto extractor : extractors) {
+    auto master  = extractor->m_master ? extractor->m_master : extractor;
+    auto &worker = extractor_workers[master];
+
+    if (!worker) {
+      workers.emplace_back(std::make_unique<xtr_worker_c>());
+      worker = workers.back().get();
+    }
+
+    extractor_workers[extractor] = worker;
+  }
+}
+
+static void
+finish_workers(std::vector<std::unique_ptr<xtr_worker_c>> &workers) {
+  for (auto &worker : workers)
+    worker->finish();
+
+  workers.clear();
+  extractor_workers.clear();
+  workers_using_cluster.clear();
+}
+
+static xtr_worker_c *
+find_worker(xtr_base_c &extractor) {
+  auto itr = extractor_workers.find(&extractor);
+  return itr != extractor_workers.end() ? itr->second : nullptr;
+}
+
+// The frame's data and the block additions belong to the cluster.
+// Instead of copying them the jobs share ownership of the cluster
+// with the main loop. It is deleted once the last job referring to it
+// has been run; see release_cluster().
+static void
+handle_frame(xtr_base_c &extractor,
+             xtr_frame_t &f,
+             std::shared_ptr<KaxCluster> const &cluster) {
+  auto worker = find_worker(extractor);
+  if (!worker) {
+    extractor.decode_and_handle_frame(f);
+    return;
+  }
+
+  auto job = [&extractor, cluster, frame = f.frame, additions = f.additions, timecode = f.timecode, duration = f.duration, bref = f.bref, fref = f.fref,
+              keyframe = f.keyframe, discardable = f.discardable, references_valid = f.references_valid, discard_duration = f.discard_duration]() mutable {
+    auto f = xtr_frame_t{frame, additions, timecode, duration, bref, fref, keyframe, discardable, references_valid, discard_duration};
+    extractor.decode_and_handle_frame(f);
+  };
+
+  worker->add_job(job, 0);
+  workers_using_cluster.insert(worker);
+}
+
+static void
+handle_codec_state(xtr_base_c &extractor,
+                   memory_cptr &codec_state,
+                   std::shared_ptr<KaxCluster> const &cluster) {
+  auto worker = find_worker(extractor);
+  if (!worker) {
+    extractor.handle_codec_state(codec_state);
+    return;
+  }
+
+  worker->add_job([&extractor, cluster, codec_state]() mutable { extractor.handle_codec_state(codec_state); }, 0);
+  workers_using_cluster.insert(worker);
+}
+
+// Each worker that has been handed parts of the cluster gets one more
+// job holding a reference to it. That job accounts for the cluster's
+// whole size so that the queue limit covers all the memory kept alive
+// by the jobs, no matter how little of a cluster a worker uses.
+static void
+release_cluster(std::shared_ptr<KaxCluster> &cluster) {
+  auto num_bytes = cluster->GetSize();
+
+  for (auto worker : workers_using_cluster)
+    worker->add_job([cluster]() {}, num_bytes);
+
+  workers_using_cluster.clear();
+  cluster.reset();
+}
+
 static int64_t
 handle_blockgroup(KaxBlockGroup &blockgroup,
-                  KaxCluster &cluster,
+                  std::shared_ptr<KaxCluster> const &cluster,
                   int64_t tc_scale) {
   // Only continue if this block group actually contains a block.
   KaxBlock *block = FindChild<KaxBlock>(&blockgroup);
   if (!block || (0 == block->NumberFrames()))
     return -1;
 
-  block->SetParent(cluster);
+  block->SetParent(*cluster);
 
   // Do we need this block group?
   xtr_base_c *extractor = nullptr;
@@ -169,7 +264,7 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
   KaxCodecState *kcstate = FindChild<KaxCodecState>(&blockgroup);
   if (kcstate) {
     memory_cptr codec_state(new memory_c(kcstate->GetBuffer(), kcstate->GetSize(), false));
-    extractor->handle_codec_state(codec_state);
+    handle_codec_state(*extractor, codec_state, cluster);
   }
 
   for (i = 0; i < block->NumberFrames(); i++) {
@@ -192,7 +287,7 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
     auto &data = block->GetBuffer(i);
     auto frame = std::make_shared<memory_c>(data.Buffer(), data.Size(), false);
     auto f     = xtr_frame_t{frame, kadditions, this_timecode, this_duration, bref, fref, false, false, true, discard_padding};
-    extractor->decode_and_handle_frame(f);
+    handle_frame(*extractor, f, cluster);
 
     max_timecode = std::max(max_timecode, this_timecode);
   }
@@ -202,11 +297,11 @@ handle_blockgroup(KaxBlockGroup &blockgroup,
 
 static int64_t
 handle_simpleblock(KaxSimpleBlock &simpleblock,
-                   KaxCluster &cluster) {
+                   std::shared_ptr<KaxCluster> const &cluster) {
   if (0 == simpleblock.NumberFrames())
     return - 1;
 
-  simpleblock.SetParent(cluster);
+  simpleblock.SetParent(*cluster);
 
   // Do we need this block group?
   xtr_base_c *extractor = nullptr;
@@ -237,7 +332,7 @@ handle_simpleblock(KaxSimpleBlock &simpleblock,
     auto &data = simpleblock.GetBuffer(i);
     auto frame = std::make_shared<memory_c>(data.Buffer(), data.Size(), false);
     auto f     = xtr_frame_t{frame, nullptr, this_timecode, this_duration, -1, -1, simpleblock.IsKeyframe(), simpleblock.IsDiscardable(), false, timestamp_c::ns(0)};
-    extractor->decode_and_handle_frame(f);
+    handle_frame(*extractor, f, cluster);
 
     max_timecode = std::max(max_timecode, this_timecode);
   }
@@ -342,6 +437,22 @@ handle_segment_info(EbmlMaster *info,
   file->set_timecode_scale(tc_scale);
 }
 
+static void
+handle_tracks(KaxTracks &tracks,
+              std::vector<track_spec_t> &tspecs,
+              std::vector<track_spec_t> &timecode_tspecs,
+              std::vector<std::unique_ptr<xtr_worker_c>> &workers) {
+  find_and_verify_track_uids(tracks, tspecs);
+  create_extractors(tracks, tspecs);
+  create_workers(workers);
+
+  if (timecode_tspecs.empty())
+    return;
+
+  find_and_verify_track_uids(tracks, timecode_tspecs);
+  create_timecode_files(tracks, timecode_tspecs, 2);
+}
+
 bool
 extract_tracks(const std::string &file_name,
                std::vector<track_spec_t> &tspecs,
@@ -349,6 +460,23 @@ extract_tracks(const std::string &file_name,
   if (tspecs.empty())
     mxerror(Y("Nothing to do.\n"));
 
+  auto timecode_tspecs = std::vector<track_spec_t>{};
+
+  return extract_tracks_and_timecodes(file_name, open_and_analyze(file_name, parse_mode, false), tspecs, timecode_tspecs);
+}
+
+/** \brief Extract tracks and their timecodes in a single pass
+
+   The tracks in \c tspecs are written to their files and v2 timecode
+   files are written for the tracks in \c timecode_tspecs. Both are
+   fed from the same pass over the clusters. The headers are taken
+   from \c analyzer if it is set.
+*/
+bool
+extract_tracks_and_timecodes(const std::string &file_name,
+                             kax_analyzer_cptr const &analyzer,
+                             std::vector<track_spec_t> &tspecs,
+                             std::vector<track_spec_t> &timecode_tspecs) {
   // open input file
   mm_io_cptr in;
   kax_file_cptr file;
@@ -364,8 +492,10 @@ extract_tracks(const std::string &file_name,
   uint64_t tc_scale = TIMECODE_SCALE;
   bool segment_info_found = false, tracks_found = false;
 
-  // open input file
-  auto analyzer = open_and_analyze(file_name, parse_mode, false);
+  // The workers register themselves so that they can be stopped if
+  // any thread reports an error.
+  std::vector<std::unique_ptr<xtr_worker_c>> workers;
+
   if (analyzer) {
     auto af_master    = ebml_master_cptr{ analyzer->read_all(EBML_INFO(KaxInfo)) };
     auto segment_info = dynamic_cast<KaxInfo *>(af_master.get());
@@ -378,8 +508,7 @@ extract_tracks(const std::string &file_name,
     auto tracks = dynamic_cast<KaxTracks *>(af_master.get());
     if (tracks) {
       tracks_found = true;
-      find_and_verify_track_uids(*tracks, tspecs);
-      create_extractors(*tracks, tspecs);
+      handle_tracks(*tracks, tspecs, timecode_tspecs, workers);
     }
   }
 
@@ -430,12 +559,12 @@ extract_tracks(const std::string &file_name,
 
       } else if (Is<KaxTracks>(l1) && !tracks_found) {
         tracks_found = true;
-        find_and_verify_track_uids(*dynamic_cast<KaxTracks *>(l1), tspecs);
-        create_extractors(*dynamic_cast<KaxTracks *>(l1), tspecs);
+        handle_tracks(*dynamic_cast<KaxTracks *>(l1), tspecs, timecode_tspecs, workers);
 
       } else if (Is<KaxCluster>(l1)) {
         show_element(l1, 1, Y("Cluster"));
-        KaxCluster *cluster = static_cast<KaxCluster *>(l1);
+        auto cluster = std::shared_ptr<KaxCluster>{static_cast<KaxCluster *>(l1)};
+        l1           = nullptr;
 
         if (0 == verbose) {
           auto current_percentage = in->getFilePointer() * 100 / file_size;
@@ -446,7 +575,7 @@ extract_tracks(const std::string &file_name,
             mxinfo(boost::format(Y("Progress: %1%%%%2%")) % current_percentage % "\r");
         }
 
-        KaxClusterTimecode *ctc = FindChild<KaxClusterTimecode>(l1);
+        KaxClusterTimecode *ctc = FindChild<KaxClusterTimecode>(cluster.get());
         if (ctc) {
           uint64_t cluster_tc = ctc->GetValue();
           show_element(ctc, 2, boost::format(Y("Cluster timecode: %|1$.3f|s")) % ((float)cluster_tc * (float)tc_scale / 1000000000.0));
@@ -463,11 +592,13 @@ extract_tracks(const std::string &file_name,
 
           if (Is<KaxBlockGroup>(el)) {
             show_element(el, 2, Y("Block group"));
-            max_bg_timecode = handle_blockgroup(*static_cast<KaxBlockGroup *>(el), *cluster, tc_scale);
+            max_bg_timecode = handle_blockgroup(*static_cast<KaxBlockGroup *>(el), cluster, tc_scale);
+            handle_blockgroup_timecodes(*static_cast<KaxBlockGroup *>(el), *cluster, tc_scale);
 
           } else if (Is<KaxSimpleBlock>(el)) {
             show_element(el, 2, Y("SimpleBlock"));
-            max_bg_timecode = handle_simpleblock(*static_cast<KaxSimpleBlock *>(el), *cluster);
+            max_bg_timecode = handle_simpleblock(*static_cast<KaxSimpleBlock *>(el), cluster);
+            handle_simpleblock_timecodes(*static_cast<KaxSimpleBlock *>(el), *cluster);
           }
 
           max_timecode = std::max(max_timecode, max_bg_timecode);
@@ -476,6 +607,8 @@ extract_tracks(const std::string &file_name,
         if (-1 != max_timecode)
           file->set_last_timecode(max_timecode);
 
+        release_cluster(cluster);
+
       } else if (Is<KaxChapters>(l1)) {
         KaxChapters &chapters = *static_cast<KaxChapters *>(l1);
 
@@ -508,12 +641,15 @@ extract_tracks(const std::string &file_name,
     delete l0;
     delete es;
 
+    finish_workers(workers);
+
     write_all_cuesheets(all_chapters, all_tags, tspecs);
 
     // Now just close the files and go to sleep. Mummy will sing you a
     // lullaby. Just close your eyes, listen to her sweet voice, singing,
     // singing, fading... fad... ing...
     close_extractors();
+    close_timecode_files();
 
     if (0 == verbose) {
       if (g_gui_mode)
@@ -522,8 +658,12 @@ extract_tracks(const std::string &file_name,
         mxinfo(boost::format(Y("Progress: %1%%%%2%")) % 100 % "\n");
     }
 
+    file->report_resync_statistics();
+
     return true;
   } catch (...) {
+    xtr_worker_c::abort_all();
+    close_timecode_files();
     show_error(Y("Caught exception"));
 
     return false;
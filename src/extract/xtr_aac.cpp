@@ -159,6 +159,5 @@ xtr_aac_c::handle_frame(xtr_frame_t &f) {
   // number of raw frames, 2 bits, 0 (meaning 1 frame) (ASSUMPTION!)
 
   // Write the ADTS header and the data itself.
-  m_out->write(adts, 56 / 8);
-  m_out->write(f.frame);
+  m_out->writev({ { adts, 56 / 8 }, { f.frame->get_buffer(), f.frame->get_size() } });
 }
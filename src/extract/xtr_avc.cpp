@@ -44,8 +44,7 @@ xtr_avc_c::write_nal(const binary *data,
     return false;
   }
 
-  m_out->write(ms_start_code, 4);
-  m_out->write(data + pos, nal_size);
+  m_out->writev({ { ms_start_code, 4 }, { data + pos, nal_size } });
 
   pos += nal_size;
 
@@ -41,8 +41,7 @@ xtr_hdmv_pgs_c::handle_frame(xtr_frame_t &f) {
   while ((offset + 3) <= data_size) {
     int packet_size = std::min(static_cast<int>(get_uint16_be(mybuffer + offset + 1) + 3), data_size - offset);
 
-    m_out->write(sup_header, 10);
-    m_out->write(mybuffer + offset, packet_size);
+    m_out->writev({ { sup_header, 10 }, { mybuffer + offset, static_cast<std::size_t>(packet_size) } });
     offset += packet_size;
   }
 }
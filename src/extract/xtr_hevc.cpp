@@ -90,8 +90,7 @@ xtr_hevc_c::write_nal(binary const *data,
   auto start_code_size = m_first_nalu || mtx::included_in(nal_unit_type, HEVC_NALU_TYPE_VIDEO_PARAM, HEVC_NALU_TYPE_SEQ_PARAM, HEVC_NALU_TYPE_PIC_PARAM) ? 4 : 3;
   m_first_nalu         = false;
 
-  m_out->write(ms_start_code + (4 - start_code_size), start_code_size);
-  m_out->write(data + pos, nal_size);
+  m_out->writev({ { ms_start_code + (4 - start_code_size), static_cast<std::size_t>(start_code_size) }, { data + pos, static_cast<std::size_t>(nal_size) } });
 
   pos += nal_size;
 
@@ -79,8 +79,7 @@ xtr_ivf_c::handle_frame(xtr_frame_t &f) {
   put_uint32_le(&frame_header.frame_size, f.frame->get_size());
   put_uint32_le(&frame_header.timestamp,  frame_number);
 
-  m_out->write(&frame_header,         sizeof(frame_header));
-  m_out->write(f.frame->get_buffer(), f.frame->get_size());
+  m_out->writev({ { &frame_header, sizeof(frame_header) }, { f.frame->get_buffer(), f.frame->get_size() } });
 
   ++m_frame_count;
 }
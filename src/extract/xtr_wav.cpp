@@ -164,21 +164,18 @@ xtr_wavpack4_c::handle_frame(xtr_frame_t &f) {
     uint32_t block_size = get_uint32_le(&mybuffer[12]);
 
     put_uint32_le(&wv_header[4], block_size + 24);  // ck_size
-    m_out->write(wv_header, 32);
     flags.push_back(*(uint32_t *)&mybuffer[4]);
     mybuffer += 16;
-    m_out->write(mybuffer, block_size);
+    m_out->writev({ { wv_header, 32 }, { mybuffer, block_size } });
     mybuffer  += block_size;
     data_size -= block_size + 16;
     while (0 < data_size) {
       block_size = get_uint32_le(&mybuffer[8]);
       memcpy(&wv_header[24], mybuffer, 8);
       put_uint32_le(&wv_header[4], block_size + 24);
-      m_out->write(wv_header, 32);
-
       flags.push_back(*(uint32_t *)mybuffer);
       mybuffer += 12;
-      m_out->write(mybuffer, block_size);
+      m_out->writev({ { wv_header, 32 }, { mybuffer, block_size } });
 
       mybuffer  += block_size;
       data_size -= block_size + 12;
@@ -186,8 +183,7 @@ xtr_wavpack4_c::handle_frame(xtr_frame_t &f) {
 
   } else {
     put_uint32_le(&wv_header[4], data_size + 12); // ck_size
-    m_out->write(wv_header, 32);
-    m_out->write(&mybuffer[12], data_size - 12); // the rest of the
+    m_out->writev({ { wv_header, 32 }, { &mybuffer[12], static_cast<std::size_t>(data_size - 12) } }); // the rest of the
   }
 
   // support hybrid mode data
@@ -213,9 +209,8 @@ xtr_wavpack4_c::handle_frame(xtr_frame_t &f) {
         put_uint32_le(&wv_header[4], block_size + 24); // ck_size
         memcpy(&wv_header[24], &flags[flags_index++], 4); // flags
         memcpy(&wv_header[28], mybuffer, 4); // crc
-        m_corr_out->write(wv_header, 32);
         mybuffer += 8;
-        m_corr_out->write(mybuffer, block_size);
+        m_corr_out->writev({ { wv_header, 32 }, { mybuffer, block_size } });
         mybuffer += block_size;
         data_size -= 8 + block_size;
       }
@@ -223,8 +218,7 @@ xtr_wavpack4_c::handle_frame(xtr_frame_t &f) {
     } else {
       put_uint32_le(&wv_header[4], data_size + 20); // ck_size
       memcpy(&wv_header[28], mybuffer, 4); // crc
-      m_corr_out->write(wv_header, 32);
-      m_corr_out->write(&mybuffer[4], data_size - 4);
+      m_corr_out->writev({ { wv_header, 32 }, { &mybuffer[4], static_cast<std::size_t>(data_size - 4) } });
     }
   }
 }
@@ -0,0 +1,206 @@
+/*
+   mkvextract -- extract tracks from Matroska files into other files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   worker threads running the extractors for one output file each
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "extract/xtr_worker.h"
+
+namespace {
+
+// Thrown by mxerror() in worker threads instead of exiting. Not
+// derived from std::exception so that it isn't caught by the
+// extractors.
+class worker_error_x {
+public:
+  std::string m_error;
+
+  worker_error_x(std::string const &error)
+    : m_error{error}
+  {
+  }
+};
+
+thread_local bool tl_is_worker_thread = false;
+
+std::mutex s_workers_mutex;
+std::vector<xtr_worker_c *> s_workers;
+std::once_flag s_error_handler_installed;
+
+void
+handle_error(unsigned int,
+             std::string const &error) {
+  if (tl_is_worker_thread)
+    throw worker_error_x{error};
+
+  xtr_worker_c::abort_all();
+
+  mxmsg(MXMSG_ERROR, error);
+  mxexit(2);
+}
+
+}
+
+xtr_worker_c::xtr_worker_c(std::size_t max_queued_bytes)
+  : m_queued_bytes{}
+  , m_max_queued_bytes{max_queued_bytes}
+  , m_finishing{}
+{
+  std::call_once(s_error_handler_installed, []() {
+    set_mxmsg_handler(MXMSG_ERROR, handle_error);
+    mxrun_before_exit(xtr_worker_c::abort_all);
+  });
+
+  {
+    std::lock_guard<std::mutex> lock{s_workers_mutex};
+    s_workers.push_back(this);
+  }
+
+  m_thread = std::thread{[this]() { run(); }};
+}
+
+xtr_worker_c::~xtr_worker_c() {
+  stop(true);
+
+  std::lock_guard<std::mutex> lock{s_workers_mutex};
+  s_workers.erase(std::remove(s_workers.begin(), s_workers.end(), this), s_workers.end());
+}
+
+/** \brief Stop all workers without running their queued jobs
+
+   Must be called from the main thread before it exits.
+*/
+void
+xtr_worker_c::abort_all() {
+  std::vector<xtr_worker_c *> workers;
+
+  {
+    std::lock_guard<std::mutex> lock{s_workers_mutex};
+    workers = s_workers;
+  }
+
+  for (auto worker : workers)
+    worker->stop(true);
+}
+
+/** \brief Queue a job
+
+   \c num_bytes is the amount of data the job keeps alive until it has
+   been run. A job is always accepted if the queue is empty, no matter
+   how large it is.
+*/
+void
+xtr_worker_c::add_job(job_t const &job,
+                      std::size_t num_bytes) {
+  std::unique_lock<std::mutex> lock{m_mutex};
+
+  m_queue_not_full.wait(lock, [this]() { return m_exception || m_jobs.empty() || (m_queued_bytes < m_max_queued_bytes); });
+
+  if (m_exception) {
+    lock.unlock();
+    handle_failure();
+  }
+
+  m_jobs.emplace_back(job, num_bytes);
+  m_queued_bytes += num_bytes;
+
+  lock.unlock();
+  m_queue_not_empty.notify_one();
+}
+
+/** \brief Run all queued jobs and wait for the thread to exit
+
+   Re-throws the exception a job may have thrown.
+*/
+void
+xtr_worker_c::finish() {
+  stop(false);
+
+  if (m_exception)
+    handle_failure();
+}
+
+/** \brief Stop all workers and pass a job's failure on
+
+   Errors reported with \c mxerror() are reported again in the calling
+   thread which exits. Other exceptions are re-thrown.
+*/
+void
+xtr_worker_c::handle_failure() {
+  auto exception = m_exception;
+
+  abort_all();
+
+  try {
+    std::rethrow_exception(exception);
+  } catch (worker_error_x &ex) {
+    mxerror(ex.m_error);
+  }
+}
+
+void
+xtr_worker_c::stop(bool discard_jobs) {
+  if (!m_thread.joinable())
+    return;
+
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_finishing = true;
+
+    if (discard_jobs) {
+      m_jobs.clear();
+      m_queued_bytes = 0;
+    }
+  }
+
+  m_queue_not_empty.notify_one();
+  m_thread.join();
+}
+
+void
+xtr_worker_c::run() {
+  tl_is_worker_thread = true;
+
+  while (true) {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    m_queue_not_empty.wait(lock, [this]() { return m_finishing || !m_jobs.empty(); });
+
+    if (m_jobs.empty())
+      return;
+
+    auto job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    auto failed = !!m_exception;
+
+    lock.unlock();
+
+    if (!failed) {
+      try {
+        job.first();
+      } catch (...) {
+        lock.lock();
+        m_exception = std::current_exception();
+        lock.unlock();
+      }
+    }
+
+    // Release the data the job refers to before making room in the
+    // queue.
+    job.first = nullptr;
+
+    lock.lock();
+    m_queued_bytes -= std::min(m_queued_bytes, job.second);
+    lock.unlock();
+
+    m_queue_not_full.notify_one();
+  }
+}
@@ -0,0 +1,67 @@
+/*
+   mkvextract -- extract tracks from Matroska files into other files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   worker threads running the extractors for one output file each
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_XTR_WORKER_H
+#define MTX_XTR_WORKER_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/** \brief Runs jobs for one output file in a thread of its own
+
+   All extractors writing to the same file share one worker so that
+   their frames are converted and written in the order they were
+   read. The queue is bounded by the number of bytes the jobs refer
+   to; adding a job blocks while the queue is full.
+
+   Exceptions thrown by a job are stored and re-thrown in the thread
+   adding the next job or finishing the worker. The jobs following the
+   failed one are discarded. Errors reported with \c mxerror() by a
+   job don't exit the program from the worker thread. They're passed
+   to the main thread which reports them after all workers have been
+   stopped. All workers are also stopped before the main thread exits
+   due to an error.
+*/
+class xtr_worker_c {
+public:
+  using job_t = std::function<void()>;
+
+protected:
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_queue_not_empty, m_queue_not_full;
+  std::deque<std::pair<job_t, std::size_t>> m_jobs;
+  std::size_t m_queued_bytes, m_max_queued_bytes;
+  bool m_finishing;
+  std::exception_ptr m_exception;
+
+public:
+  xtr_worker_c(std::size_t max_queued_bytes = 32 * 1024 * 1024);
+  ~xtr_worker_c();
+
+  void add_job(job_t const &job, std::size_t num_bytes);
+  void finish();
+
+  static void abort_all();
+
+protected:
+  void run();
+  void stop(bool discard_jobs);
+  void handle_failure();
+};
+
+#endif  // MTX_XTR_WORKER_H
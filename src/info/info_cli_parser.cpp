@@ -42,6 +42,7 @@ info_cli_parser_c::init_parser() {
   OPT("C|check-mode",    set_check_mode,    YT("Calculate and display checksums and use verbosity level 4."));
   OPT("s|summary",       set_summary,       YT("Only show summaries of the contents, not each element."));
   OPT("t|track-info",    set_track_info,    YT("Show statistics for each track in verbose mode."));
+  OPT("fast-track-info", set_fast_track_info, YT("Show statistics for each track without reading the frames or showing each cluster."));
   OPT("x|hexdump",       set_hexdump,       YT("Show the first 16 bytes of each frame as a hex dump."));
   OPT("X|full-hexdump",  set_full_hexdump,  YT("Show all bytes of each frame as a hex dump."));
   OPT("p|hex-positions", set_hex_positions, YT("Show positions in hexadecimal."));
@@ -111,6 +112,12 @@ info_cli_parser_c::set_track_info() {
     verbose = 1;
 }
 
+void
+info_cli_parser_c::set_fast_track_info() {
+  m_options.m_show_track_info = true;
+  m_options.m_fast_track_info = true;
+}
+
 void
 info_cli_parser_c::set_file_name() {
   if (!m_options.m_file_name.empty())
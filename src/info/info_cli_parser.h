@@ -39,6 +39,7 @@ protected:
   void set_size();
   void set_file_name();
   void set_track_info();
+  void set_fast_track_info();
   void set_hex_positions();
 };
 
@@ -63,6 +63,7 @@
 #include "common/endian.h"
 #include "common/fourcc.h"
 #include "common/hevc.h"
+#include "common/kax_cluster_scanner.h"
 #include "common/kax_file.h"
 #include "common/math.h"
 #include "common/mm_io.h"
@@ -71,6 +72,8 @@
 #include "common/stereo_mode.h"
 #include "common/strings/editing.h"
 #include "common/strings/formatting.h"
+#include "common/strings/parsing.h"
+#include "common/tags/tags.h"
 #include "common/translation.h"
 #include "common/version.h"
 #include "common/xml/ebml_chapters_converter.h"
@@ -134,6 +137,41 @@ options_c g_options;
 static uint64_t s_tc_scale = TIMECODE_SCALE;
 std::vector<boost::format> g_common_boost_formats;
 size_t s_mkvmerge_track_id = 0;
+static uint64_t s_segment_data_start = 0;
+static std::vector<std::pair<uint32_t, uint64_t>> s_seek_entries;
+static std::map<uint64_t, track_info_t> s_statistics_tags;
+
+// Accounts for a block in the track statistics. Used both while
+// showing all elements and by the fast cluster scan.
+static void
+add_block_to_track_info(kax_cluster_scanner_c::block_t const &block) {
+  auto &tinfo = s_track_info[block.m_track_number];
+
+  tinfo.m_blocks       += block.m_num_frames;
+  tinfo.m_size         += block.m_frame_bytes;
+  tinfo.m_min_timecode  = std::min(tinfo.m_min_timecode, block.m_timestamp);
+
+  if (block.m_is_simple_block) {
+    tinfo.m_blocks_by_ref_num[block.m_is_key ? 0 : block.m_is_discardable ? 2 : 1] += block.m_num_frames;
+    tinfo.m_max_timecode                                                            = std::max(tinfo.max_timecode_unset() ? 0 : tinfo.m_max_timecode, block.m_timestamp);
+    tinfo.m_add_duration_for_n_packets                                              = block.m_num_frames;
+    return;
+  }
+
+  tinfo.m_blocks_by_ref_num[std::min(block.m_num_references, 2u)] += block.m_num_frames;
+
+  if (!tinfo.max_timecode_unset() && (tinfo.m_max_timecode >= block.m_timestamp))
+    return;
+
+  tinfo.m_max_timecode = block.m_timestamp;
+
+  if (!block.m_duration)
+    tinfo.m_add_duration_for_n_packets  = block.m_num_frames;
+  else {
+    tinfo.m_max_timecode               += *block.m_duration;
+    tinfo.m_add_duration_for_n_packets  = 0;
+  }
+}
 
 #define BF_DO(n)                             g_common_boost_formats[n]
 #define BF_ADD(s)                            g_common_boost_formats.push_back(boost::format(s))
@@ -1080,22 +1118,45 @@ handle_tracks(EbmlStream *&es,
       show_unknown_element(l2, 2);
 }
 
+static void
+remember_seek_entries(EbmlMaster &seek_head) {
+  for (auto l2 : seek_head) {
+    if (!Is<KaxSeek>(l2))
+      continue;
+
+    auto seek_id       = FindChild<KaxSeekID>(l2);
+    auto seek_position = FindChild<KaxSeekPosition>(l2);
+
+    if (seek_id && seek_position)
+      s_seek_entries.emplace_back(EBML_ID_VALUE(EbmlId(seek_id->GetBuffer(), seek_id->GetSize())), s_segment_data_start + seek_position->GetValue());
+  }
+}
+
 void
 handle_seek_head(EbmlStream *&es,
                  int &upper_lvl_el,
                  EbmlElement *&l1) {
-  if ((g_options.m_verbose < 2) && !g_options.m_use_gui) {
+  auto show_entries = (g_options.m_verbose >= 2) || g_options.m_use_gui;
+
+  if (!show_entries) {
     show_element(l1, 1, Y("Seek head (subentries will be skipped)"));
-    return;
-  }
+    if (!g_options.m_fast_track_info)
+      return;
 
-  show_element(l1, 1, Y("Seek head"));
+  } else
+    show_element(l1, 1, Y("Seek head"));
 
   upper_lvl_el               = 0;
   EbmlElement *element_found = nullptr;
   auto m1                    = static_cast<EbmlMaster *>(l1);
   read_master(m1, es, EBML_CONTEXT(l1), upper_lvl_el, element_found);
 
+  if (g_options.m_fast_track_info)
+    remember_seek_entries(*m1);
+
+  if (!show_entries)
+    return;
+
   for (auto l2 : *m1)
     if (Is<KaxSeek>(l2)) {
       show_element(l2, 2, Y("Seek entry"));
@@ -1438,24 +1499,18 @@ handle_block_group(EbmlStream *&es,
                  % lf_tnum
                  % std::llround(lf_timecode / 1000000.0));
 
-  track_info_t &tinfo = s_track_info[lf_tnum];
+  kax_cluster_scanner_c::block_t block_info;
 
-  tinfo.m_blocks                                          += frame_sizes.size();
-  tinfo.m_blocks_by_ref_num[std::min(num_references, 2u)] += frame_sizes.size();
-  tinfo.m_min_timecode                                     = std::min(tinfo.m_min_timecode, lf_timecode);
-  tinfo.m_size                                            += boost::accumulate(frame_sizes, 0);
+  block_info.m_track_number   = lf_tnum;
+  block_info.m_timestamp      = lf_timecode;
+  block_info.m_num_frames     = frame_sizes.size();
+  block_info.m_num_references = num_references;
+  block_info.m_frame_bytes    = boost::accumulate(frame_sizes, 0);
 
-  if (!tinfo.max_timecode_unset() && (tinfo.m_max_timecode >= lf_timecode))
-    return;
-
-  tinfo.m_max_timecode = lf_timecode;
+  if (-1 != bduration)
+    block_info.m_duration = static_cast<int64_t>(bduration * 1000000.0);
 
-  if (-1 == bduration)
-    tinfo.m_add_duration_for_n_packets  = frame_sizes.size();
-  else {
-    tinfo.m_max_timecode               += bduration * 1000000.0;
-    tinfo.m_add_duration_for_n_packets  = 0;
-  }
+  add_block_to_track_info(block_info);
 }
 
 void
@@ -1471,7 +1526,6 @@ handle_simple_block(EbmlStream *&es,
   int64_t frame_pos   = block.GetElementPosition() + block.ElementSize();
   auto timecode_ns    = mtx::math::to_signed(block.GlobalTimecode());
   auto timecode_ms    = std::llround(static_cast<double>(timecode_ns) / 1000000.0);
-  track_info_t &tinfo = s_track_info[block.TrackNum()];
 
   std::string info;
   if (block.IsKeyframe())
@@ -1534,12 +1588,17 @@ handle_simple_block(EbmlStream *&es,
                  % block.TrackNum()
                  % timecode_ms);
 
-  tinfo.m_blocks                                                                    += block.NumberFrames();
-  tinfo.m_blocks_by_ref_num[block.IsKeyframe() ? 0 : block.IsDiscardable() ? 2 : 1] += block.NumberFrames();
-  tinfo.m_min_timecode                                                                = std::min(tinfo.m_min_timecode, static_cast<int64_t>(timecode_ns));
-  tinfo.m_max_timecode                                                                = std::max(tinfo.max_timecode_unset() ? 0 : tinfo.m_max_timecode, static_cast<int64_t>(timecode_ns));
-  tinfo.m_add_duration_for_n_packets                                                  = block.NumberFrames();
-  tinfo.m_size                                                                       += boost::accumulate(frame_sizes, 0);
+  kax_cluster_scanner_c::block_t block_info;
+
+  block_info.m_track_number    = block.TrackNum();
+  block_info.m_timestamp       = timecode_ns;
+  block_info.m_num_frames      = block.NumberFrames();
+  block_info.m_frame_bytes     = boost::accumulate(frame_sizes, 0);
+  block_info.m_is_simple_block = true;
+  block_info.m_is_key          = block.IsKeyframe();
+  block_info.m_is_discardable  = block.IsDiscardable();
+
+  add_block_to_track_info(block_info);
 }
 
 void
@@ -1582,6 +1641,30 @@ handle_cluster(EbmlStream *&es,
       show_unknown_element(l2, 2);
 }
 
+// Statistics tags as written by mkvmerge and mkvpropedit
+static void
+remember_statistics_tags(KaxTags &tags) {
+  for (auto l2 : tags) {
+    auto tag = dynamic_cast<KaxTag *>(l2);
+    if (!tag)
+      continue;
+
+    auto tuid     = mtx::tags::get_tuid(*tag);
+    auto duration = int64_t{};
+    track_info_t tinfo;
+
+    if (   (-1 == tuid)
+        || !parse_number(mtx::tags::get_simple_value("NUMBER_OF_FRAMES", *tag), tinfo.m_blocks)
+        || !parse_number(mtx::tags::get_simple_value("NUMBER_OF_BYTES",  *tag), tinfo.m_size)
+        || !parse_timestamp(mtx::tags::get_simple_value("DURATION",      *tag), duration))
+      continue;
+
+    tinfo.m_min_timecode    = 0;
+    tinfo.m_max_timecode    = duration;
+    s_statistics_tags[tuid] = tinfo;
+  }
+}
+
 void
 handle_elements_rec(EbmlStream *es,
                     int level,
@@ -1649,6 +1732,71 @@ handle_tags(EbmlStream *&es,
   mtx::xml::ebml_tags_converter_c converter;
   for (auto l2 : *static_cast<EbmlMaster *>(l1))
     handle_elements_rec(es, 2, l2, converter);
+
+  if (g_options.m_fast_track_info)
+    remember_statistics_tags(*static_cast<KaxTags *>(l1));
+}
+
+static void
+read_statistics_tags_after(mm_io_c &in,
+                           kax_file_c &kax_file,
+                           uint64_t position) {
+  for (auto const &entry : s_seek_entries) {
+    if ((entry.first != EBML_ID_VALUE(EBML_ID(KaxTags))) || (entry.second <= position) || !in.setFilePointer2(entry.second))
+      continue;
+
+    kax_file.enable_reporting(false);
+    auto l1 = std::unique_ptr<EbmlElement>(kax_file.read_next_level1_element());
+    kax_file.enable_reporting(true);
+
+    if (l1 && Is<KaxTags>(*l1))
+      remember_statistics_tags(*static_cast<KaxTags *>(l1.get()));
+  }
+}
+
+static bool
+use_statistics_tags() {
+  if (s_tracks.empty())
+    return false;
+
+  for (auto const &track : s_tracks)
+    if (!s_statistics_tags.count(track->tuid))
+      return false;
+
+  for (auto const &track : s_tracks)
+    s_track_info[track->tnum] = s_statistics_tags[track->tuid];
+
+  return true;
+}
+
+// Gathers the track statistics without reading the frames. The
+// statistics tags are used if they exist for all tracks and if the
+// position of the first element following the clusters is known from
+// the seek head. Otherwise only the cluster and block headers are
+// read. Returns the position of the first element after the clusters.
+static boost::optional<uint64_t>
+handle_clusters_fast(mm_io_c &in,
+                     kax_file_c &kax_file,
+                     uint64_t clusters_start) {
+  boost::optional<uint64_t> clusters_end;
+
+  for (auto const &entry : s_seek_entries)
+    if (   (entry.first  != EBML_ID_VALUE(EBML_ID(KaxCluster)))
+        && (entry.second >  clusters_start)
+        && (!clusters_end || (entry.second < *clusters_end)))
+      clusters_end = entry.second;
+
+  if (clusters_end) {
+    read_statistics_tags_after(in, kax_file, clusters_start);
+    if (use_statistics_tags())
+      return clusters_end;
+  }
+
+  auto next_position = kax_cluster_scanner_c{in, s_tc_scale, kax_file.get_segment_end()}.scan_clusters(clusters_start, add_block_to_track_info);
+  if (!next_position)
+    show_error(Y("The clusters could not be scanned completely. The statistics are incomplete."));
+
+  return next_position;
 }
 
 void
@@ -1706,6 +1854,8 @@ handle_segment(EbmlElement *l0,
 
   kax_file->set_segment_end(*l0);
 
+  s_segment_data_start = l0->GetElementPosition() + l0->HeadSize();
+
   if (!l0->IsFiniteSize())
     show_element(l0, 0, Y("Segment, size unknown"));
   else
@@ -1728,6 +1878,14 @@ handle_segment(EbmlElement *l0,
 
     else if (Is<KaxCluster>(l1)) {
       show_element(l1, 1, Y("Cluster"));
+
+      if (g_options.m_fast_track_info) {
+        auto next_position = handle_clusters_fast(*in, *kax_file, l1->GetElementPosition());
+        if (!next_position || !in->setFilePointer2(*next_position))
+          break;
+        continue;
+      }
+
       if ((g_options.m_verbose == 0) && !g_options.m_show_summary)
         return;
       handle_cluster(es, upper_lvl_el, l1, file_size);
@@ -1789,6 +1947,8 @@ process_file(const std::string &file_name) {
   s_tracks.clear();
   s_tracks_by_number.clear();
   s_track_info.clear();
+  s_seek_entries.clear();
+  s_statistics_tags.clear();
 
   // open input file
   mm_io_cptr in;
@@ -26,6 +26,9 @@
 
 #define PROBESIZE 4
 #define READ_SIZE 1024 * 1024
+// Large enough for the parser to split it into partitions that are
+// parsed concurrently.
+#define MUX_READ_SIZE 16 * 1024 * 1024
 #define MAX_PROBE_BUFFERS 50
 
 using namespace mpeg4::p10;
@@ -77,7 +80,7 @@ avc_es_reader_c::probe_file(mm_io_c *in,
 avc_es_reader_c::avc_es_reader_c(const track_info_c &ti,
                                  const mm_io_cptr &in)
   : generic_reader_c(ti, in)
-  , m_buffer(memory_c::alloc(READ_SIZE))
+  , m_buffer(memory_c::alloc(MUX_READ_SIZE))
 {
 }
 
@@ -130,7 +133,7 @@ avc_es_reader_c::read(generic_packetizer_c *,
   if (m_in->getFilePointer() >= m_size)
     return FILE_STATUS_DONE;
 
-  int num_read = m_in->read(m_buffer->get_buffer(), READ_SIZE);
+  int num_read = m_in->read(m_buffer->get_buffer(), MUX_READ_SIZE);
   if (0 < num_read)
     PTZR0->process(new packet_t(new memory_c(m_buffer->get_buffer(), num_read)));
 
@@ -21,6 +21,7 @@
 #include "common/codec.h"
 #include "common/endian.h"
 #include "common/error.h"
+#include "common/fourcc.h"
 #include "common/hacks.h"
 #include "common/ivf.h"
 #include "common/mm_io_x.h"
@@ -101,6 +102,9 @@ avi_reader_c::read_headers() {
   verify_video_track();
   parse_subtitle_chunks();
 
+  m_movi_position          = m_avi->movi_start;
+  m_read_movi_sequentially = m_avi->video_index && (0 < m_avi->movi_start) && !debugging_c::requested("avi_read_via_index");
+
   if (debugging_c::requested("avi_dump_video_index"))
     debug_dump_video_index();
 }
@@ -110,6 +114,7 @@ avi_reader_c::~avi_reader_c() {
     AVI_close(m_avi);
 
   mxverb(2, boost::format("avi_reader_c: Dropped video frames: %1%\n") % m_dropped_video_frames);
+  mxdebug_if(m_debug_movi, boost::format("avi_reader: stream chunks in the 'movi' lists not found in the index: %1%\n") % m_num_skipped_movi_chunks);
 }
 
 void
@@ -702,22 +707,33 @@ avi_reader_c::read_video() {
     ++m_video_frames_read;
   }
 
-  int64_t timestamp       = static_cast<int64_t>(static_cast<int64_t>(old_video_frames_read)   * 1000000000ll / m_fps);
-  int64_t duration        = static_cast<int64_t>(static_cast<int64_t>(dropped_frames_here + 1) * 1000000000ll / m_fps);
+  process_video_frame(chunk, key, old_video_frames_read, dropped_frames_here);
 
-  m_dropped_video_frames += dropped_frames_here;
+  return m_video_frames_read >= m_max_video_frames ? flush_packetizer(m_vptzr) :  FILE_STATUS_MOREDATA;
+}
+
+void
+avi_reader_c::process_video_frame(memory_cptr const &frame,
+                                  bool key_frame,
+                                  unsigned int frame_number,
+                                  int num_dropped_frames) {
+  int64_t timestamp       = static_cast<int64_t>(static_cast<int64_t>(frame_number)           * 1000000000ll / m_fps);
+  int64_t duration        = static_cast<int64_t>(static_cast<int64_t>(num_dropped_frames + 1) * 1000000000ll / m_fps);
+  int num_read            = frame->get_size();
+
+  m_dropped_video_frames += num_dropped_frames;
 
   // AVC with framed packets (without NALU start codes but with length fields)
   // or non-AVC video track?
   if (0 >= m_avc_nal_size_size)
-    PTZR(m_vptzr)->process(new packet_t(chunk, timestamp, duration, key ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
+    PTZR(m_vptzr)->process(new packet_t(frame, timestamp, duration, key_frame ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
 
   else {
     // AVC video track without NALU start codes. Re-frame with NALU start codes.
     int offset = 0;
 
     while ((offset + m_avc_nal_size_size) < num_read) {
-      int nalu_size  = get_uint_be(chunk->get_buffer() + offset, m_avc_nal_size_size);
+      int nalu_size  = get_uint_be(frame->get_buffer() + offset, m_avc_nal_size_size);
       offset        += m_avc_nal_size_size;
 
       if ((offset + nalu_size) > num_read)
@@ -725,16 +741,14 @@ avi_reader_c::read_video() {
 
       memory_cptr nalu = memory_c::alloc(4 + nalu_size);
       put_uint32_be(nalu->get_buffer(), NALU_START_CODE);
-      memcpy(nalu->get_buffer() + 4, chunk->get_buffer() + offset, nalu_size);
+      memcpy(nalu->get_buffer() + 4, frame->get_buffer() + offset, nalu_size);
       offset += nalu_size;
 
-      PTZR(m_vptzr)->process(new packet_t(nalu, timestamp, duration, key ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
+      PTZR(m_vptzr)->process(new packet_t(nalu, timestamp, duration, key_frame ? VFT_IFRAME : VFT_PFRAMEAUTOMATIC, VFT_NOBFRAME));
     }
   }
 
   m_bytes_processed += num_read;
-
-  return m_video_frames_read >= m_max_video_frames ? flush_packetizer(m_vptzr) :  FILE_STATUS_MOREDATA;
 }
 
 file_status_e
@@ -782,8 +796,7 @@ avi_reader_c::read_subtitles(avi_subs_demuxer_t &demuxer) {
 }
 
 file_status_e
-avi_reader_c::read(generic_packetizer_c *ptzr,
-                   bool) {
+avi_reader_c::read_via_index(generic_packetizer_c *ptzr) {
   if ((-1 != m_vptzr) && (PTZR(m_vptzr) == ptzr))
     return read_video();
 
@@ -791,11 +804,251 @@ avi_reader_c::read(generic_packetizer_c *ptzr,
     if ((-1 != demuxer.m_ptzr) && (PTZR(demuxer.m_ptzr) == ptzr))
       return read_audio(demuxer);
 
+  return flush_packetizers();
+}
+
+memory_cptr
+avi_reader_c::read_movi_chunk_data(uint64_t data_pos,
+                                   uint64_t size) {
+  auto chunk = memory_c::alloc(size);
+
+  m_in->setFilePointer(data_pos);
+  if (m_in->read(chunk->get_buffer(), size) != size)
+    return {};
+
+  return chunk;
+}
+
+avi_reader_c::movi_chunk_e
+avi_reader_c::handle_movi_video_chunk(uint64_t data_pos,
+                                      uint64_t size) {
+  // Index entries without data are dropped frames. They only
+  // lengthen the duration of the frame they belong to.
+  auto first_frame = m_video_frames_read;
+  auto frame       = first_frame;
+
+  while ((frame < m_max_video_frames) && !m_avi->video_index[frame].len)
+    ++frame;
+
+  if ((frame >= m_max_video_frames) || (static_cast<uint64_t>(m_avi->video_index[frame].pos) > data_pos)) {
+    if (size)
+      ++m_num_skipped_movi_chunks;
+    return movi_chunk_e::skipped;
+  }
+
+  auto const &entry = m_avi->video_index[frame];
+
+  if ((static_cast<uint64_t>(entry.pos) != data_pos) || (static_cast<uint64_t>(entry.len) != size))
+    return movi_chunk_e::index_mismatch;
+
+  auto chunk = read_movi_chunk_data(data_pos, size);
+  if (!chunk)
+    return movi_chunk_e::read_error;
+
+  int num_dropped_frames = frame - first_frame;
+  m_video_frames_read    = frame + 1;
+
+  while ((m_video_frames_read < m_max_video_frames) && !m_avi->video_index[m_video_frames_read].len) {
+    ++num_dropped_frames;
+    ++m_video_frames_read;
+  }
+
+  // Keep avilib's position up to date in case reading has to
+  // continue via the index.
+  AVI_set_video_position(m_avi, m_video_frames_read);
+
+  process_video_frame(chunk, 0x10 == entry.key, first_frame, num_dropped_frames); // AVIIF_KEYFRAME
+
+  return movi_chunk_e::used;
+}
+
+avi_reader_c::movi_chunk_e
+avi_reader_c::handle_movi_audio_chunk(avi_demuxer_t &demuxer,
+                                      uint64_t data_pos,
+                                      uint64_t size) {
+  auto &track = m_avi->track[demuxer.m_aid];
+  auto idx    = track.audio_posc;
+
+  // Skip the same chunks read_audio() skips.
+  while ((idx < track.audio_chunks) && (!track.audio_index[idx].len || (track.audio_index[idx].len > AVI_MAX_AUDIO_CHUNK_SIZE)))
+    ++idx;
+
+  if ((idx >= track.audio_chunks) || (static_cast<uint64_t>(track.audio_index[idx].pos) > data_pos)) {
+    if (size)
+      ++m_num_skipped_movi_chunks;
+    return movi_chunk_e::skipped;
+  }
+
+  auto const &entry = track.audio_index[idx];
+
+  if ((static_cast<uint64_t>(entry.pos) != data_pos) || (static_cast<uint64_t>(entry.len) != size))
+    return movi_chunk_e::index_mismatch;
+
+  auto chunk = read_movi_chunk_data(data_pos, size);
+  if (!chunk)
+    return movi_chunk_e::read_error;
+
+  AVI_set_audio_track(m_avi, demuxer.m_aid);
+  AVI_set_audio_position_index(m_avi, idx + 1);
+
+  PTZR(demuxer.m_ptzr)->process(new packet_t(chunk));
+
+  m_bytes_processed += size;
+
+  return movi_chunk_e::used;
+}
+
+avi_reader_c::movi_chunk_e
+avi_reader_c::handle_movi_chunk(unsigned char const *id,
+                                uint64_t data_pos,
+                                uint64_t size) {
+  auto id_matches = [id](char const *tag, std::size_t length) {
+    return !strncasecmp(reinterpret_cast<char const *>(id), tag, length);
+  };
+
+  if ((-1 != m_vptzr) && id_matches(m_avi->video_tag, 2))
+    return handle_movi_video_chunk(data_pos, size);
+
+  for (auto &demuxer : m_audio_demuxers)
+    if ((-1 != demuxer.m_ptzr) && id_matches(m_avi->track[demuxer.m_aid].audio_tag, 4))
+      return handle_movi_audio_chunk(demuxer, data_pos, size);
+
+  return movi_chunk_e::skipped;
+}
+
+bool
+avi_reader_c::all_indexed_chunks_read()
+  const {
+  if (-1 != m_vptzr)
+    for (auto frame = m_video_frames_read; frame < m_max_video_frames; ++frame)
+      if (m_avi->video_index[frame].len)
+        return false;
+
+  for (auto const &demuxer : m_audio_demuxers) {
+    if (-1 == demuxer.m_ptzr)
+      continue;
+
+    auto const &track = m_avi->track[demuxer.m_aid];
+    for (auto idx = track.audio_posc; idx < track.audio_chunks; ++idx)
+      if (track.audio_index[idx].len && (track.audio_index[idx].len <= AVI_MAX_AUDIO_CHUNK_SIZE))
+        return false;
+  }
+
+  return true;
+}
+
+void
+avi_reader_c::switch_to_reading_via_index(std::string const &reason) {
+  mxdebug_if(m_debug_movi, boost::format("avi_reader: switching to reading via the index: %1%\n") % reason);
+  m_read_movi_sequentially = false;
+}
+
+/** \brief Read the next chunk from the 'movi' lists
+
+   The chunks are read in the order they're stored in the file and
+   handed to the track they belong to, no matter which packetizer
+   has requested data. This avoids seeking back and forth between the
+   tracks' chunks. The index is only used for verifying that a chunk
+   is part of its track's stream and for the key frame flags.
+
+   If the chunks found in the file don't match the index, reading
+   continues via the index for all tracks.
+*/
+file_status_e
+avi_reader_c::read_movi(generic_packetizer_c *ptzr,
+                        bool force) {
+  if (m_movi_done)
+    return flush_packetizers();
+
+  if (!force && (64 * 1024 * 1024 < get_queued_bytes()))
+    return FILE_STATUS_HOLDING;
+
+  try {
+    unsigned char header[12];
+
+    while ((m_movi_position + 8) <= m_size) {
+      m_in->setFilePointer(m_movi_position);
+      if (m_in->read(header, 8) != 8)
+        break;
+
+      auto id   = fourcc_c{header};
+      auto size = static_cast<uint64_t>(get_uint32_le(&header[4]));
+
+      if (id.equiv("RIFF") || id.equiv("LIST")) {
+        if (m_in->read(&header[8], 4) != 4)
+          break;
+
+        // Descend into the 'AVIX' RIFF chunks of OpenDML files and into
+        // the 'movi' and 'rec ' lists. Skip all other lists.
+        auto type        = fourcc_c{&header[8]};
+        m_movi_position += id.equiv("RIFF") || type.equiv("movi") || type.equiv("rec ") ? 12 : 8 + size + (size & 1);
+        continue;
+      }
+
+      auto data_pos   = m_movi_position + 8;
+      m_movi_position = data_pos + size + (size & 1);
+      auto result     = handle_movi_chunk(header, data_pos, size);
+
+      if (movi_chunk_e::used == result)
+        return FILE_STATUS_MOREDATA;
+
+      if (movi_chunk_e::read_error == result)
+        break;
+
+      if (movi_chunk_e::index_mismatch == result) {
+        switch_to_reading_via_index((boost::format("chunk %1% at %2% does not match the index") % id % data_pos).str());
+        return read_via_index(ptzr);
+      }
+    }
+
+  } catch (mtx::mm_io::exception &) {
+  }
+
+  if (!all_indexed_chunks_read()) {
+    switch_to_reading_via_index((boost::format("end of the 'movi' lists reached at %1% before all indexed chunks were found") % m_movi_position).str());
+    return read_via_index(ptzr);
+  }
+
+  m_movi_done = true;
+
+  return flush_packetizers();
+}
+
+file_status_e
+avi_reader_c::read(generic_packetizer_c *ptzr,
+                   bool force) {
   for (auto &subs_demuxer : m_subtitle_demuxers)
     if ((-1 != subs_demuxer.m_ptzr) && (PTZR(subs_demuxer.m_ptzr) == ptzr))
       return read_subtitles(subs_demuxer);
 
-  return flush_packetizers();
+  return m_read_movi_sequentially ? read_movi(ptzr, force) : read_via_index(ptzr);
+}
+
+bool
+avi_reader_c::seek_to_key_frame_before(timestamp_c const &timestamp) {
+  // Only the video track can be positioned via the index. The audio
+  // packetizers calculate their timestamps from the number of samples
+  // processed so far; therefore audio is still read sequentially.
+  if ((-1 == m_vptzr) || !m_avi->video_index)
+    return false;
+
+  // Frames before this one start before the timestamp.
+  auto frame = std::min<int64_t>(std::ceil(timestamp.to_ns() * m_fps / 1000000000.0), m_max_video_frames);
+
+  while (--frame > static_cast<int64_t>(m_video_frames_read)) {
+    if (0x10 != m_avi->video_index[frame].key) // AVIIF_KEYFRAME
+      continue;
+
+    for (auto skipped = m_video_frames_read; skipped < frame; ++skipped)
+      m_bytes_processed += AVI_frame_size(m_avi, skipped);
+
+    AVI_set_video_position(m_avi, frame);
+    m_video_frames_read = frame;
+
+    return true;
+  }
+
+  return false;
 }
 
 int
@@ -924,7 +1177,7 @@ avi_reader_c::identify_attachments() {
   }
 
   for (auto const &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_size(), attachment->name, attachment->description);
 }
 
 void
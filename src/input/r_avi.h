@@ -59,6 +59,13 @@ private:
     DIVX_TYPE_MPEG4
   };
 
+  enum class movi_chunk_e {
+    used,
+    skipped,
+    index_mismatch,
+    read_error,
+  };
+
   divx_type_e m_divx_type{DIVX_TYPE_NONE};
   avi_t *m_avi{};
   int m_vptzr{-1};
@@ -72,6 +79,11 @@ private:
   uint64_t m_bytes_to_process{}, m_bytes_processed{};
   bool m_video_track_ok{};
 
+  bool m_read_movi_sequentially{}, m_movi_done{};
+  uint64_t m_movi_position{}, m_num_skipped_movi_chunks{};
+
+  debugging_option_c m_debug_movi{"avi_reader|avi_movi"};
+
 public:
   avi_reader_c(const track_info_c &ti, const mm_io_cptr &in);
   virtual ~avi_reader_c();
@@ -82,6 +94,7 @@ public:
 
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
+  virtual bool seek_to_key_frame_before(timestamp_c const &timestamp);
   virtual int get_progress();
   virtual void identify();
   virtual void create_packetizers();
@@ -95,6 +108,17 @@ protected:
   virtual file_status_e read_video();
   virtual file_status_e read_audio(avi_demuxer_t &demuxer);
   virtual file_status_e read_subtitles(avi_subs_demuxer_t &demuxer);
+  virtual file_status_e read_via_index(generic_packetizer_c *ptzr);
+  virtual file_status_e read_movi(generic_packetizer_c *ptzr, bool force);
+
+  virtual movi_chunk_e handle_movi_chunk(unsigned char const *id, uint64_t data_pos, uint64_t size);
+  virtual movi_chunk_e handle_movi_video_chunk(uint64_t data_pos, uint64_t size);
+  virtual movi_chunk_e handle_movi_audio_chunk(avi_demuxer_t &demuxer, uint64_t data_pos, uint64_t size);
+  memory_cptr read_movi_chunk_data(uint64_t data_pos, uint64_t size);
+  bool all_indexed_chunks_read() const;
+  void switch_to_reading_via_index(std::string const &reason);
+
+  virtual void process_video_frame(memory_cptr const &frame, bool key_frame, unsigned int frame_number, int num_dropped_frames);
 
   virtual generic_packetizer_c *create_aac_packetizer(int aid, avi_demuxer_t &demuxer);
   virtual generic_packetizer_c *create_dts_packetizer(int aid);
@@ -25,7 +25,7 @@
 #include "merge/file_status.h"
 #include "merge/output_control.h"
 
-#define BUFFER_SIZE 4096
+#define FLAC_READ_SIZE (1024 * 1024)
 
 #if defined(HAVE_FLAC_FORMAT_H)
 
@@ -66,24 +66,22 @@ flac_reader_c::read_headers() {
   show_demuxer_info();
 
   try {
-    uint32_t block_size = 0;
+    // Everything between the "fLaC" marker and the first frame.
+    m_header = memory_c::alloc(m_frames_start - 4);
 
-    for (current_block = blocks.begin(); (current_block != blocks.end()) && (FLAC_BLOCK_TYPE_HEADERS == current_block->type); current_block++)
-      block_size += current_block->len;
-
-    m_header = memory_c::alloc(block_size);
-
-    block_size         = 0;
-    for (current_block = blocks.begin(); (current_block != blocks.end()) && (FLAC_BLOCK_TYPE_HEADERS == current_block->type); current_block++) {
-      m_in->setFilePointer(current_block->filepos);
-      if (m_in->read(m_header->get_buffer() + block_size, current_block->len) != current_block->len)
-        mxerror(Y("flac_reader: Could not read a header packet.\n"));
-      block_size += current_block->len;
-    }
+    m_in->setFilePointer(4);
+    if (m_in->read(m_header, m_header->get_size()) != m_header->get_size())
+      mxerror(Y("flac_reader: Could not read a header packet.\n"));
 
   } catch (mtx::exception &) {
     mxerror(Y("flac_reader: could not initialize the FLAC packetizer.\n"));
   }
+
+  m_frame_parser.set_min_frame_size(stream_info.min_framesize);
+  m_frame_parser.set_seek_point_offsets(m_seek_point_offsets);
+
+  m_chunk = memory_c::alloc(FLAC_READ_SIZE);
+  m_in->setFilePointer(m_frames_start);
 }
 
 flac_reader_c::~flac_reader_c() {
@@ -98,24 +96,21 @@ flac_reader_c::create_packetizer(int64_t) {
   show_packetizer_info(0, PTZR0);
 }
 
+/** \brief Parse the metadata blocks
+
+   Only the metadata is parsed with libFLAC. The frames are split by
+   \c mtx::flac::frame_parser_c while reading the file, so the file is
+   read only once.
+*/
 bool
 flac_reader_c::parse_file(bool for_identification_only) {
-  FLAC__StreamDecoderState state;
-  flac_block_t block;
-  uint64_t u, old_pos;
-  int result, progress, old_progress;
-  bool ok;
-
   m_in->setFilePointer(0);
   metadata_parsed = false;
 
-  if (!for_identification_only)
-    mxinfo(Y("+-> Parsing the FLAC file. This can take a LONG time.\n"));
-
   init_flac_decoder();
-  result = FLAC__stream_decoder_process_until_end_of_metadata(m_flac_decoder.get());
+  auto result = FLAC__stream_decoder_process_until_end_of_metadata(m_flac_decoder.get());
 
-  mxdebug_if(m_debug, boost::format("flac_reader: extract->metadata, result: %1%, mdp: %2%, num blocks: %3%\n") % result % metadata_parsed % blocks.size());
+  mxdebug_if(m_debug, boost::format("flac_reader: extract->metadata, result: %1%, mdp: %2%\n") % result % metadata_parsed);
 
   if (!metadata_parsed)
     mxerror_fn(m_ti.m_fname, Y("No metadata block found. This file is broken.\n"));
@@ -123,77 +118,50 @@ flac_reader_c::parse_file(bool for_identification_only) {
   if (for_identification_only)
     return true;
 
-  FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &u);
-
-  block.type    = FLAC_BLOCK_TYPE_HEADERS;
-  block.filepos = 0;
-  block.len     = u;
-  old_pos       = u;
-
-  blocks.push_back(block);
+  if (!FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &m_frames_start) || (4 > m_frames_start))
+    mxerror(Y("flac_reader: Could not read all header packets.\n"));
 
-  mxdebug_if(m_debug, boost::format("flac_reader: headers: block at %1% with size %2%\n") % block.filepos % block.len);
+  mxdebug_if(m_debug, boost::format("flac_reader: headers: block at 4 with size %1%\n") % (m_frames_start - 4));
 
-  old_progress = -5;
-  ok = FLAC__stream_decoder_skip_single_frame(m_flac_decoder.get());
-  while (ok) {
-    state = FLAC__stream_decoder_get_state(m_flac_decoder.get());
+  m_flac_decoder.reset();
 
-    progress = m_in->getFilePointer() * 100 / m_size;
-    if ((progress - old_progress) >= 5) {
-      mxinfo(boost::format(Y("+-> Pre-parsing FLAC file: %1%%%%2%")) % progress % "\r");
-      old_progress = progress;
-    }
+  return metadata_parsed;
+}
 
-    if (FLAC__stream_decoder_get_decode_position(m_flac_decoder.get(), &u) && (u != old_pos)) {
-      block.type    = FLAC_BLOCK_TYPE_DATA;
-      block.filepos = old_pos;
-      block.len     = u - old_pos;
-      old_pos       = u;
-      blocks.push_back(block);
+void
+flac_reader_c::process_available_frames() {
+  while (m_frame_parser.frame_available()) {
+    auto frame        = m_frame_parser.get_frame();
+    auto samples_here = mtx::flac::get_num_samples(frame->get_buffer(), frame->get_size(), stream_info);
 
-      mxdebug_if(m_debug, boost::format("flac_reader: skip/decode frame, block at %1% with size %2%\n") % block.filepos % block.len);
-    }
+    mxdebug_if(m_debug, boost::format("flac_reader: frame with size %1% samples %2%\n") % frame->get_size() % samples_here);
 
-    if (state > FLAC__STREAM_DECODER_READ_FRAME)
-      break;
+    PTZR0->process(new packet_t(frame, samples * 1000000000 / sample_rate));
 
-    ok = FLAC__stream_decoder_skip_single_frame(m_flac_decoder.get());
+    if (0 < samples_here)
+      samples += samples_here;
   }
-
-  if (100 != old_progress)
-    mxinfo(Y("+-> Pre-parsing FLAC file: 100%\n"));
-  else
-    mxinfo("\n");
-
-  if ((blocks.size() == 0) || (blocks[0].type != FLAC_BLOCK_TYPE_HEADERS))
-    mxerror(Y("flac_reader: Could not read all header packets.\n"));
-
-  m_in->setFilePointer(0);
-  blocks[0].len     -= 4;
-  blocks[0].filepos  = 4;
-
-  return metadata_parsed;
 }
 
 file_status_e
 flac_reader_c::read(generic_packetizer_c *,
                     bool) {
-  if (current_block == blocks.end())
-    return flush_packetizers();
+  auto num_read = m_in->read(m_chunk->get_buffer(), FLAC_READ_SIZE);
+
+  if (num_read)
+    m_frame_parser.add_bytes(m_chunk->get_buffer(), num_read);
+  else
+    m_frame_parser.flush();
 
-  memory_cptr buf = memory_c::alloc(current_block->len);
-  m_in->setFilePointer(current_block->filepos);
-  if (m_in->read(buf, current_block->len) != current_block->len)
-    return flush_packetizers();
+  process_available_frames();
 
-  unsigned int samples_here = mtx::flac::get_num_samples(buf->get_buffer(), current_block->len, stream_info);
-  PTZR0->process(new packet_t(buf, samples * 1000000000 / sample_rate));
+  if (num_read)
+    return FILE_STATUS_MOREDATA;
 
-  samples += samples_here;
-  current_block++;
+  if (m_frame_parser.get_garbage_size())
+    mxdebug_if(m_debug, boost::format("flac_reader: skipped %1% bytes not belonging to any frame\n") % m_frame_parser.get_garbage_size());
 
-  return (current_block == blocks.end()) ? flush_packetizers() : FILE_STATUS_MOREDATA;
+  return flush_packetizers();
 }
 
 FLAC__StreamDecoderReadStatus
@@ -223,6 +191,19 @@ flac_reader_c::handle_stream_info_metadata(FLAC__StreamMetadata const *metadata)
   mxdebug_if(m_debug, boost::format("flac_reader:   bits_per_sample: %1%\n")        % metadata->data.stream_info.bits_per_sample);
 }
 
+// The seek points are used for recognizing frame boundaries. Their
+// offsets are relative to the first frame.
+void
+flac_reader_c::handle_seek_table_metadata(FLAC__StreamMetadata const *metadata) {
+  auto const &seek_table = metadata->data.seek_table;
+
+  for (auto idx = 0u; idx < seek_table.num_points; ++idx)
+    if (seek_table.points[idx].sample_number != FLAC__STREAM_METADATA_SEEKPOINT_PLACEHOLDER)
+      m_seek_point_offsets.push_back(seek_table.points[idx].stream_offset);
+
+  mxdebug_if(m_debug, boost::format("flac_reader: SEEKTABLE block (%1% bytes), %2% seek points\n") % metadata->length % m_seek_point_offsets.size());
+}
+
 std::string
 flac_reader_c::attachment_name_from_metadata(FLAC__StreamMetadata_Picture const &picture)
   const {
@@ -307,12 +288,15 @@ flac_reader_c::flac_metadata_cb(const FLAC__StreamMetadata *metadata) {
       handle_picture_metadata(metadata);
       break;
 
+    case FLAC__METADATA_TYPE_SEEKTABLE:
+      handle_seek_table_metadata(metadata);
+      break;
+
     default:
       mxdebug_if(m_debug,
                  boost::format("%1% (%2%) block (%3% bytes)\n")
                  % (  metadata->type == FLAC__METADATA_TYPE_PADDING        ? "PADDING"
                     : metadata->type == FLAC__METADATA_TYPE_APPLICATION    ? "APPLICATION"
-                    : metadata->type == FLAC__METADATA_TYPE_SEEKTABLE      ? "SEEKTABLE"
                     : metadata->type == FLAC__METADATA_TYPE_VORBIS_COMMENT ? "VORBIS COMMENT"
                     : metadata->type == FLAC__METADATA_TYPE_CUESHEET       ? "CUESHEET"
                     :                                                        "UNDEFINED")
@@ -361,7 +345,7 @@ flac_reader_c::identify() {
   id_result_container();
   id_result_track(0, ID_RESULT_TRACK_AUDIO, "FLAC", info.get());
   for (auto &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description, attachment->id);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_size(), attachment->name, attachment->description, attachment->id);
 }
 
 #else  // HAVE_FLAC_FORMAT_H
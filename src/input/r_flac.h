@@ -26,24 +26,19 @@
 #include <FLAC/stream_decoder.h>
 
 #include "common/flac.h"
+#include "common/flac_frame_parser.h"
 #include "output/p_flac.h"
 
-#define FLAC_BLOCK_TYPE_HEADERS 0
-#define FLAC_BLOCK_TYPE_DATA    1
-
-struct flac_block_t {
-  int64_t filepos;
-  unsigned int type, len;
-};
-
 class flac_reader_c: public generic_reader_c, public mtx::flac::decoder_c {
 private:
   memory_cptr m_header;
   int sample_rate{}, channels{}, bits_per_sample{};
   bool metadata_parsed{};
   uint64_t samples{};
-  std::vector<flac_block_t> blocks;
-  std::vector<flac_block_t>::iterator current_block;
+  uint64_t m_frames_start{};
+  std::vector<uint64_t> m_seek_point_offsets;
+  mtx::flac::frame_parser_c m_frame_parser;
+  memory_cptr m_chunk;
   FLAC__StreamMetadata_StreamInfo stream_info;
   unsigned int m_attachment_id{};
   debugging_option_c m_debug{"flac_reader|flac"};
@@ -78,6 +73,8 @@ protected:
   virtual bool parse_file(bool for_identification_only);
   virtual void handle_picture_metadata(FLAC__StreamMetadata const *metadata);
   virtual void handle_stream_info_metadata(FLAC__StreamMetadata const *metadata);
+  virtual void handle_seek_table_metadata(FLAC__StreamMetadata const *metadata);
+  virtual void process_available_frames();
   virtual std::string attachment_name_from_metadata(FLAC__StreamMetadata_Picture const &picture) const;
 };
 
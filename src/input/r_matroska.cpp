@@ -31,6 +31,8 @@
 #include <matroska/KaxCluster.h>
 #include <matroska/KaxClusterData.h>
 #include <matroska/KaxContexts.h>
+#include <matroska/KaxCues.h>
+#include <matroska/KaxCuesData.h>
 #include <matroska/KaxInfo.h>
 #include <matroska/KaxInfoData.h>
 #include <matroska/KaxSeekHead.h>
@@ -55,11 +57,13 @@
 #include "common/ivf.h"
 #include "common/kax_analyzer.h"
 #include "common/mm_io.h"
+#include "common/mm_io_x.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "common/strings/utf8.h"
 #include "common/tags/tags.h"
 #include "common/id_info.h"
+#include "common/vint.h"
 #include "common/vobsub.h"
 #include "input/r_matroska.h"
 #include "merge/file_status.h"
@@ -316,6 +320,8 @@ kax_reader_c::kax_reader_c(const track_info_c &ti,
 }
 
 kax_reader_c::~kax_reader_c() {
+  if (m_in_file)
+    m_in_file->report_resync_statistics();
 }
 
 void
@@ -325,6 +331,7 @@ kax_reader_c::init_l1_position_storage(deferred_positions_t &storage) {
   storage[dl1t_tags]        = std::vector<int64_t>();
   storage[dl1t_tracks]      = std::vector<int64_t>();
   storage[dl1t_seek_head]   = std::vector<int64_t>();
+  storage[dl1t_cues]        = std::vector<int64_t>();
 }
 
 bool
@@ -816,9 +823,63 @@ kax_reader_c::has_deferred_element_been_processed(kax_reader_c::deferred_l1_type
   return false;
 }
 
+static bool
+read_attachment_element_header(mm_io_c &in,
+                               uint64_t parent_end,
+                               vint_c &id,
+                               uint64_t &data_start,
+                               uint64_t &data_end) {
+  if (in.getFilePointer() >= parent_end)
+    return false;
+
+  id        = vint_c::read_ebml_id(in);
+  auto size = vint_c::read(in);
+
+  if (!id.is_valid() || !size.is_valid() || size.is_unknown())
+    return false;
+
+  data_start = in.getFilePointer();
+  data_end   = data_start + size.m_value;
+
+  return data_end <= parent_end;
+}
+
+static std::string
+read_attachment_string(mm_io_c &in,
+                       uint64_t size) {
+  std::string value;
+
+  if (in.read(value, size) != size)
+    throw mtx::mm_io::end_of_file_x{};
+
+  auto end = value.find('\0');
+  if (std::string::npos != end)
+    value.erase(end);
+
+  return value;
+}
+
+static uint64_t
+read_attachment_uint(mm_io_c &in,
+                     uint64_t size) {
+  auto value = uint64_t{};
+
+  for (auto idx = 0u; idx < std::min<uint64_t>(size, 8); ++idx)
+    value = (value << 8) | in.read_uint8();
+
+  return value;
+}
+
+/** \brief Parse the attachments starting at \c pos
+
+   The elements are parsed manually instead of with libebml so that
+   the attachments' content isn't read into memory. For plain files
+   only its position is recorded, and it is copied directly from the
+   source file into the output file when the attachments are rendered.
+*/
 void
 kax_reader_c::handle_attachments(mm_io_c *io,
-                                 EbmlElement *l0,
+                                 EbmlElement *,
                                  int64_t pos) {
   if (has_deferred_element_been_processed(dl1t_attachments, pos))
     return;
@@ -826,49 +887,94 @@ kax_reader_c::handle_attachments(mm_io_c *io,
   io->save_pos(pos);
   at_scope_exit_c restore([io]() { io->restore_pos(); });
 
-  int upper_lvl_el = 0;
-  std::shared_ptr<EbmlElement> l1(m_es->FindNextElement(EBML_CONTEXT(l0), upper_lvl_el, 0xFFFFFFFFL, true));
-  KaxAttachments *atts = dynamic_cast<KaxAttachments *>(l1.get());
+  auto proxy          = dynamic_cast<mm_proxy_io_c *>(io);
+  auto underlying_io  = proxy ? proxy->get_proxied() : io;
+  auto data_file_name = dynamic_cast<mm_file_io_c *>(underlying_io) ? underlying_io->get_file_name() : std::string{};
 
-  if (!atts)
-    return;
+  try {
+    vint_c id;
+    uint64_t atts_start{}, atts_end{};
 
-  EbmlElement *element_found = nullptr;
-  upper_lvl_el               = 0;
+    if (   !read_attachment_element_header(*io, io->get_size(), id, atts_start, atts_end)
+        || (EBML_ID_VALUE(EBML_ID(KaxAttachments)) != id.m_value))
+      return;
 
-  atts->Read(*m_es, EBML_CLASS_CONTEXT(KaxAttachments), upper_lvl_el, element_found, true);
+    auto att_position = atts_start;
 
-  for (auto l1_att : *atts) {
-    auto att = dynamic_cast<KaxAttached *>(l1_att);
-    if (!att)
-      continue;
+    while (att_position < atts_end) {
+      uint64_t att_start{}, att_end{};
 
-    ++m_attachment_id;
+      io->setFilePointer(att_position);
+      if (!read_attachment_element_header(*io, atts_end, id, att_start, att_end))
+        break;
 
-    auto fdata = FindChild<KaxFileData>(att);
-    if (!fdata)
-      continue;
+      att_position = att_end;
 
-    auto matt         = std::make_shared<attachment_t>();
-    matt->name        = to_utf8(FindChildValue<KaxFileName>(att));
-    matt->description = to_utf8(FindChildValue<KaxFileDescription>(att));
-    matt->mime_type   = FindChildValue<KaxMimeType>(att);
-    matt->id          = FindChildValue<KaxFileUID>(att);
-    matt->data        = memory_c::clone(static_cast<unsigned char *>(fdata->GetBuffer()), fdata->GetSize());
+      if (EBML_ID_VALUE(EBML_ID(KaxAttached)) != id.m_value)
+        continue;
 
-    auto attach_mode  = attachment_requested(m_attachment_id);
+      ++m_attachment_id;
 
-    if (   !matt->data->get_size()
-        || matt->mime_type.empty()
-        || matt->name.empty()
-        || (ATTACH_MODE_SKIP == attach_mode))
-      continue;
+      auto matt           = std::make_shared<attachment_t>();
+      auto data_found     = false;
+      auto child_position = att_start;
+
+      while (child_position < att_end) {
+        uint64_t child_start{}, child_end{};
+
+        io->setFilePointer(child_position);
+        if (!read_attachment_element_header(*io, att_end, id, child_start, child_end))
+          break;
+
+        auto child_size = child_end - child_start;
+        child_position  = child_end;
 
-    matt->ui_id          = m_attachment_id;
-    matt->to_all_files   = ATTACH_MODE_TO_ALL_FILES == attach_mode;
-    matt->source_file    = m_ti.m_fname;
+        if (EBML_ID_VALUE(EBML_ID(KaxFileName)) == id.m_value)
+          matt->name = read_attachment_string(*io, child_size);
+
+        else if (EBML_ID_VALUE(EBML_ID(KaxFileDescription)) == id.m_value)
+          matt->description = read_attachment_string(*io, child_size);
+
+        else if (EBML_ID_VALUE(EBML_ID(KaxMimeType)) == id.m_value)
+          matt->mime_type = read_attachment_string(*io, child_size);
+
+        else if (EBML_ID_VALUE(EBML_ID(KaxFileUID)) == id.m_value)
+          matt->id = read_attachment_uint(*io, child_size);
+
+        else if (EBML_ID_VALUE(EBML_ID(KaxFileData)) == id.m_value) {
+          data_found          = true;
+          matt->data_position = child_start;
+          matt->data_size     = child_size;
+        }
+      }
 
-    add_attachment(matt);
+      if (!data_found)
+        continue;
+
+      auto attach_mode  = attachment_requested(m_attachment_id);
+
+      if (   !matt->get_size()
+          || matt->mime_type.empty()
+          || matt->name.empty()
+          || (ATTACH_MODE_SKIP == attach_mode))
+        continue;
+
+      if (!data_file_name.empty())
+        matt->data_file_name = data_file_name;
+
+      else {
+        io->setFilePointer(matt->data_position);
+        matt->data = io->read(matt->data_size);
+      }
+
+      matt->ui_id          = m_attachment_id;
+      matt->to_all_files   = ATTACH_MODE_TO_ALL_FILES == attach_mode;
+      matt->source_file    = m_ti.m_fname;
+
+      add_attachment(matt);
+    }
+
+  } catch (mtx::mm_io::exception &) {
   }
 }
 
@@ -1359,6 +1465,7 @@ kax_reader_c::handle_seek_head(mm_io_c *io,
         :                       Is<KaxTracks>(id)      ? dl1t_tracks
         :                       Is<KaxSeekHead>(id)    ? dl1t_seek_head
         :                       Is<KaxInfo>(id)        ? dl1t_info
+        :                       Is<KaxCues>(id)        ? dl1t_cues
         :                                                dl1t_unknown;
 
       if (dl1t_unknown == type)
@@ -1410,6 +1517,7 @@ kax_reader_c::find_level1_elements_via_analyzer() {
     analyzer->with_elements(EBML_ID(KaxAttachments), [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_attachments].push_back(data.m_pos); });
     analyzer->with_elements(EBML_ID(KaxChapters),    [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_chapters   ].push_back(data.m_pos); });
     analyzer->with_elements(EBML_ID(KaxTags),        [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_tags       ].push_back(data.m_pos); });
+    analyzer->with_elements(EBML_ID(KaxCues),        [this](kax_analyzer_data_c const &data) { m_deferred_l1_positions[dl1t_cues       ].push_back(data.m_pos); });
 
   } catch (...) {
   }
@@ -1445,7 +1553,8 @@ bool
 kax_reader_c::read_headers_internal() {
   // Elements for different levels
 
-  auto cluster = std::shared_ptr<KaxCluster>{};
+  auto cluster           = std::shared_ptr<KaxCluster>{};
+  auto following_segment = false;
   try {
     m_es      = std::shared_ptr<EbmlStream>(new EbmlStream(*m_in));
     m_in_file = std::make_shared<kax_file_c>(*m_in);
@@ -1477,7 +1586,15 @@ kax_reader_c::read_headers_internal() {
       return false;
     }
 
-    m_in_file->set_segment_end(*l0);
+    // A segment whose file is still being written to has no final
+    // size yet; mkvmerge writes 0 until it's done.
+    following_segment = m_ti.m_follow_growing_file && (!l0->IsFiniteSize() || !l0->GetSize());
+
+    if (following_segment)
+      m_in_file->set_segment_end(m_in->get_size());
+    else
+      m_in_file->set_segment_end(*l0);
+    m_segment_data_start = l0->GetElementPosition() + l0->HeadSize();
 
     // We've got our segment, so let's find the m_tracks
     m_tc_scale = TIMECODE_SCALE;
@@ -1502,6 +1619,9 @@ kax_reader_c::read_headers_internal() {
       else if (Is<KaxTags>(*l1))
         m_deferred_l1_positions[dl1t_tags].push_back(l1->GetElementPosition());
 
+      else if (Is<KaxCues>(*l1))
+        m_deferred_l1_positions[dl1t_cues].push_back(l1->GetElementPosition());
+
       else if (Is<KaxSeekHead>(*l1))
         handle_seek_head(m_in.get(), l0, l1->GetElementPosition());
 
@@ -1514,7 +1634,7 @@ kax_reader_c::read_headers_internal() {
       if (cluster)              // we've found the first cluster, so get out
         break;
 
-      if (!in_parent(l0))
+      if (!following_segment && !in_parent(l0))
         break;
 
       l1->SkipData(*m_es, EBML_CONTEXT(l1));
@@ -1539,6 +1659,10 @@ kax_reader_c::read_headers_internal() {
 
   m_in->setFilePointer(cluster_pos, seek_beginning);
 
+  // Clusters appended later on must be read, too.
+  if (following_segment)
+    m_in_file->set_segment_end(0);
+
   return true;
 }
 
@@ -2225,6 +2349,95 @@ kax_reader_c::read(generic_packetizer_c *requested_ptzr,
   return FILE_STATUS_MOREDATA;
 }
 
+void
+kax_reader_c::read_cues() {
+  m_cues_read = true;
+
+  // Only use the cue points of the video tracks being muxed if there
+  // are any; those point to clusters starting with key frames.
+  std::unordered_map<uint64_t, bool> video_track_numbers;
+  for (auto &track : m_tracks)
+    if (('v' == track->type) && (-1 != track->ptzr))
+      video_track_numbers[track->track_number] = true;
+
+  m_in->save_pos();
+  at_scope_exit_c restore([this]() { m_in->restore_pos(); });
+
+  for (auto position : m_deferred_l1_positions[dl1t_cues]) {
+    if (has_deferred_element_been_processed(dl1t_cues, position))
+      continue;
+
+    try {
+      m_in->setFilePointer(position);
+
+      int upper_lvl_el = 0;
+      std::shared_ptr<EbmlElement> l1(m_es->FindNextElement(EBML_CLASS_CONTEXT(KaxSegment), upper_lvl_el, 0xFFFFFFFFL, true));
+      auto cues = dynamic_cast<KaxCues *>(l1.get());
+
+      if (!cues)
+        continue;
+
+      EbmlElement *l2 = nullptr;
+      upper_lvl_el    = 0;
+
+      cues->Read(*m_es, EBML_CLASS_CONTEXT(KaxCues), upper_lvl_el, l2, true);
+
+      for (auto cues_child : *cues) {
+        auto cue_point = dynamic_cast<KaxCuePoint *>(cues_child);
+        if (!cue_point)
+          continue;
+
+        auto cue_time = FindChildValue<KaxCueTime, uint64_t>(*cue_point, std::numeric_limits<uint64_t>::max());
+        if (std::numeric_limits<uint64_t>::max() == cue_time)
+          continue;
+
+        for (auto cue_point_child : *cue_point) {
+          auto positions = dynamic_cast<KaxCueTrackPositions *>(cue_point_child);
+          if (!positions)
+            continue;
+
+          auto track_number     = FindChildValue<KaxCueTrack>(*positions);
+          auto cluster_position = FindChildValue<KaxCueClusterPosition, int64_t>(*positions, -1);
+
+          if (   (-1 == cluster_position)
+              || (!video_track_numbers.empty() && !video_track_numbers[track_number]))
+            continue;
+
+          m_cue_positions.emplace_back(static_cast<int64_t>(cue_time) * m_tc_scale + m_global_timestamp_offset, cluster_position + m_segment_data_start);
+        }
+      }
+
+    } catch (...) {
+    }
+  }
+
+  brng::sort(m_cue_positions);
+}
+
+bool
+kax_reader_c::seek_to_key_frame_before(timestamp_c const &timestamp) {
+  if (m_tracks.empty() || (FILE_STATUS_DONE == m_file_status))
+    return false;
+
+  if (!m_cues_read)
+    read_cues();
+
+  // Find the last cue point before the timestamp. Only ever seek
+  // forward.
+  auto itr = std::lower_bound(m_cue_positions.begin(), m_cue_positions.end(), std::make_pair(timestamp.to_ns(), std::numeric_limits<int64_t>::min()));
+  if (m_cue_positions.begin() == itr)
+    return false;
+
+  --itr;
+
+  if (itr->second <= static_cast<int64_t>(m_in->getFilePointer()))
+    return false;
+
+  m_in->setFilePointer(itr->second);
+
+  return true;
+}
+
 void
 kax_reader_c::process_simple_block(KaxCluster *cluster,
                                    KaxSimpleBlock *block_simple) {
@@ -2468,7 +2681,7 @@ kax_reader_c::get_progress() {
   if (0 != m_segment_duration)
     return std::min(m_last_timecode, m_segment_duration) * 100 / m_segment_duration;
 
-  return 100 * m_in->getFilePointer() / m_size;
+  return generic_reader_c::get_progress();
 }
 
 void
@@ -2682,7 +2895,7 @@ kax_reader_c::identify() {
   }
 
   for (auto &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description, attachment->id);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_size(), attachment->name, attachment->description, attachment->id);
 
   if (m_chapters)
     id_result_chapters(count_chapter_atoms(*m_chapters));
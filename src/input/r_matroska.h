@@ -203,6 +203,7 @@ private:
     dl1t_tracks,
     dl1t_seek_head,
     dl1t_info,
+    dl1t_cues,
   };
 
   std::vector<kax_track_cptr> m_tracks;
@@ -215,7 +216,7 @@ private:
 
   std::shared_ptr<EbmlStream> m_es;
 
-  int64_t m_segment_duration, m_last_timecode, m_first_timecode, m_global_timestamp_offset;
+  int64_t m_segment_duration, m_last_timecode, m_first_timecode, m_global_timestamp_offset, m_segment_data_start{};
   std::string m_title;
 
   using deferred_positions_t = std::map<deferred_l1_type_e, std::vector<int64_t> >;
@@ -233,7 +234,10 @@ private:
 
   file_status_e m_file_status;
 
-  bool m_opus_experimental_warning_shown, m_regenerate_chapter_uids;
+  bool m_opus_experimental_warning_shown, m_regenerate_chapter_uids, m_cues_read{};
+
+  // Cue timestamp & absolute cluster position pairs
+  std::vector<std::pair<int64_t, int64_t>> m_cue_positions;
 
 public:
   kax_reader_c(const track_info_c &ti, const mm_io_cptr &in);
@@ -245,6 +249,7 @@ public:
 
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
+  virtual bool seek_to_key_frame_before(timestamp_c const &timestamp);
 
   virtual int get_progress();
   virtual void set_headers();
@@ -287,6 +292,7 @@ protected:
   virtual void handle_chapters(mm_io_c *io, EbmlElement *l0, int64_t pos);
   virtual void handle_seek_head(mm_io_c *io, EbmlElement *l0, int64_t pos);
   virtual void handle_tags(mm_io_c *io, EbmlElement *l0, int64_t pos);
+  virtual void read_cues();
   virtual void process_global_tags();
   virtual void discard_track_statistics_tags();
 
@@ -15,6 +15,7 @@
 
 #include "common/mm_io_x.h"
 #include "common/strings/formatting.h"
+#include "common/subtitle_tokenizers.h"
 #include "input/r_microdvd.h"
 #include "merge/id_result.h"
 
@@ -22,8 +23,6 @@ int
 microdvd_reader_c::probe_file(mm_text_io_c *in,
                               uint64_t) {
   try {
-    boost::regex re("^\\{\\d+?\\}\\{\\d+?\\}.+$", boost::regex::perl);
-
     in->setFilePointer(0, seek_beginning);
 
     std::string line;
@@ -39,7 +38,7 @@ microdvd_reader_c::probe_file(mm_text_io_c *in,
       ++line_num;
     }
 
-    if (boost::regex_match(line, re))
+    if (mtx::subtitles::is_microdvd_line(line))
       id_result_container_unsupported(in->get_file_name(), file_type_t::get_name(FILE_TYPE_MICRODVD));
 
   } catch (mtx::mm_io::end_of_file_x &) {
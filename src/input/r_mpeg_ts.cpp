@@ -17,6 +17,7 @@
 #include <iostream>
 
 #include "common/at_scope_exit.h"
+#include "common/bluray_util.h"
 #include "common/bswap.h"
 #include "common/checksums/crc.h"
 #include "common/checksums/base_fwd.h"
@@ -1639,42 +1640,40 @@ reader_c::parse_pmt(track_c &track) {
 
 charset_converter_cptr
 reader_c::get_charset_converter_for_coding_type(unsigned int coding) {
-  static std::unordered_map<unsigned int, std::string> coding_names;
-
-  if (coding_names.empty()) {
-    coding_names[0x00]     = "ISO6937";
-    coding_names[0x01]     = "ISO8859-5";
-    coding_names[0x02]     = "ISO8859-6";
-    coding_names[0x03]     = "ISO8859-7";
-    coding_names[0x04]     = "ISO8859-8";
-    coding_names[0x05]     = "ISO8859-9";
-    coding_names[0x06]     = "ISO8859-10";
-    coding_names[0x07]     = "ISO8859-11";
-    coding_names[0x09]     = "ISO8859-13";
-    coding_names[0x0a]     = "ISO8859-14";
-    coding_names[0x0b]     = "ISO8859-15";
-    coding_names[0x10]     = "ISO8859";
-    coding_names[0x13]     = "GB2312";
-    coding_names[0x14]     = "BIG5";
-    coding_names[0x100001] = "ISO8859-1";
-    coding_names[0x100002] = "ISO8859-2";
-    coding_names[0x100003] = "ISO8859-3";
-    coding_names[0x100004] = "ISO8859-4";
-    coding_names[0x100005] = "ISO8859-5";
-    coding_names[0x100006] = "ISO8859-6";
-    coding_names[0x100007] = "ISO8859-7";
-    coding_names[0x100008] = "ISO8859-8";
-    coding_names[0x100009] = "ISO8859-9";
-    coding_names[0x10000a] = "ISO8859-10";
-    coding_names[0x10000b] = "ISO8859-11";
-    coding_names[0x10000d] = "ISO8859-13";
-    coding_names[0x10000e] = "ISO8859-14";
-    coding_names[0x10000f] = "ISO8859-15";
-  }
-
-  auto coding_name = coding_names[coding];
-  if (coding_name.empty())
-    coding_name = "UTF-8";
+  // Several readers may parse their headers concurrently.
+  static std::unordered_map<unsigned int, std::string> const s_coding_names{
+    { 0x00,     "ISO6937" },
+    { 0x01,     "ISO8859-5" },
+    { 0x02,     "ISO8859-6" },
+    { 0x03,     "ISO8859-7" },
+    { 0x04,     "ISO8859-8" },
+    { 0x05,     "ISO8859-9" },
+    { 0x06,     "ISO8859-10" },
+    { 0x07,     "ISO8859-11" },
+    { 0x09,     "ISO8859-13" },
+    { 0x0a,     "ISO8859-14" },
+    { 0x0b,     "ISO8859-15" },
+    { 0x10,     "ISO8859" },
+    { 0x13,     "GB2312" },
+    { 0x14,     "BIG5" },
+    { 0x100001, "ISO8859-1" },
+    { 0x100002, "ISO8859-2" },
+    { 0x100003, "ISO8859-3" },
+    { 0x100004, "ISO8859-4" },
+    { 0x100005, "ISO8859-5" },
+    { 0x100006, "ISO8859-6" },
+    { 0x100007, "ISO8859-7" },
+    { 0x100008, "ISO8859-8" },
+    { 0x100009, "ISO8859-9" },
+    { 0x10000a, "ISO8859-10" },
+    { 0x10000b, "ISO8859-11" },
+    { 0x10000d, "ISO8859-13" },
+    { 0x10000e, "ISO8859-14" },
+    { 0x10000f, "ISO8859-15" },
+  };
+
+  auto itr         = s_coding_names.find(coding);
+  auto coding_name = itr != s_coding_names.end() ? itr->second : std::string{"UTF-8"};
 
   auto converter = charset_converter_c::init(coding_name, true);
   return converter ? converter : charset_converter_c::init("UTF-8");
@@ -2380,34 +2379,6 @@ reader_c::read(generic_packetizer_c *requested_ptzr,
   return FILE_STATUS_MOREDATA;
 }
 
-bfs::path
-reader_c::find_file(bfs::path const &source_file,
-                    std::string const &sub_directory,
-                    std::string const &extension)
-  const {
-  auto file_lower          = source_file;
-  auto file_upper          = source_file;
-
-  auto sub_directory_upper = balg::to_upper_copy(sub_directory);
-  auto sub_directory_lower = balg::to_lower_copy(sub_directory);
-
-  file_upper.replace_extension(balg::to_upper_copy(extension));;
-  file_lower.replace_extension(balg::to_lower_copy(extension));;
-
-  auto file_name_lower = file_upper.filename();
-  auto file_name_upper = file_lower.filename();
-  auto path            = source_file.parent_path();
-
-  return mtx::file::first_existing_path({
-      file_lower,
-      file_upper,
-      path / ".." / sub_directory_upper / file_name_lower, path / ".." / ".." / sub_directory_upper / file_name_lower,
-      path / ".." / sub_directory_upper / file_name_upper, path / ".." / ".." / sub_directory_upper / file_name_upper,
-      path / ".." / sub_directory_lower / file_name_lower, path / ".." / ".." / sub_directory_lower / file_name_lower,
-      path / ".." / sub_directory_lower / file_name_upper, path / ".." / ".." / sub_directory_lower / file_name_upper,
-  });
-}
-
 void
 reader_c::parse_clip_info_file(std::size_t file_idx) {
   auto &file         = *m_files[file_idx];
@@ -2416,15 +2387,15 @@ reader_c::parse_clip_info_file(std::size_t file_idx) {
 
   mxdebug_if(m_debug_clpi, boost::format("find_clip_info_file: Searching for CLPI corresponding to %1%\n") % source_file.string());
 
-  auto clpi_file = find_file(source_file, "clipinf", ".clpi");
+  auto clpi_file = mtx::bluray::find_other_file(source_file, "clipinf", ".clpi");
 
   mxdebug_if(m_debug_clpi, boost::format("reader_c::find_clip_info_file: CLPI file: %1%\n") % (!clpi_file.empty() ? clpi_file.string() : "not found"));
 
   if (clpi_file.empty())
     return;
 
-  mtx::bluray::clpi::parser_c parser(clpi_file.string());
-  if (!parser.parse())
+  auto parser = mtx::bluray::clpi::parse_cached(clpi_file.string());
+  if (!parser->is_ok())
     return;
 
   for (auto &track : m_tracks) {
@@ -2433,7 +2404,7 @@ reader_c::parse_clip_info_file(std::size_t file_idx) {
 
     bool found = false;
 
-    for (auto &program : parser.m_programs) {
+    for (auto &program : parser->m_programs) {
       for (auto &stream : program->program_streams) {
         if ((stream->pid != track->pid) || stream->language.empty())
           continue;
@@ -2560,7 +2531,7 @@ reader_c::add_external_files_from_mpls(mm_mpls_multi_file_io_c &mpls_in) {
       continue;
 
     auto &item = sub_path.items.front();
-    auto m2ts  = find_file(source_file.parent_path() / (boost::format("%1%.m2ts") % item.clpi_file_name).str(), "STREAM", ".m2ts");
+    auto m2ts  = mtx::bluray::find_other_file(source_file.parent_path() / (boost::format("%1%.m2ts") % item.clpi_file_name).str(), "STREAM", ".m2ts");
 
     mxdebug_if(m_debug_mpls, boost::format("add_external_files_from_mpls: M2TS for sub_path %1%: %2%\n") % (sub_path_idx - 1) % (!m2ts.empty() ? m2ts.string() : "not found"));
 
@@ -20,6 +20,7 @@
 
 #include "common/codec.h"
 #include "common/mm_io.h"
+#include "common/ogg_page_reader.h"
 #include "merge/generic_reader.h"
 #include "common/theora.h"
 #include "common/kate.h"
@@ -80,7 +81,7 @@ using ogm_demuxer_cptr = std::shared_ptr<ogm_demuxer_c>;
 
 class ogm_reader_c: public generic_reader_c {
 private:
-  ogg_sync_state oy;
+  std::unique_ptr<ogg_page_reader_c> m_page_reader;
   std::vector<ogm_demuxer_cptr> sdemuxers;
   int bos_pages_read;
 
@@ -202,7 +202,7 @@ qtmp4_reader_c::read_atom(mm_io_c *read_from,
 bool
 qtmp4_reader_c::resync_to_top_level_atom(uint64_t start_pos) {
   static std::vector<std::string> const s_top_level_atoms{ "ftyp", "pdin", "moov", "moof", "mfra", "mdat", "free", "skip" };
-  static auto test_atom_at = [this](uint64_t atom_pos, uint64_t expected_hsize, fourcc_c const &expected_fourcc) -> bool {
+  auto test_atom_at = [this](uint64_t atom_pos, uint64_t expected_hsize, fourcc_c const &expected_fourcc) -> bool {
     m_in->setFilePointer(atom_pos);
     auto test_atom = read_atom(nullptr, false);
     mxdebug_if(m_debug_resync, boost::format("Test for %1%bit offset atom: %2%\n") % (8 == expected_hsize ? 32 : 64) % test_atom);
@@ -1607,6 +1607,56 @@ qtmp4_reader_c::read(generic_packetizer_c *ptzr,
   return flush_packetizers();
 }
 
+bool
+qtmp4_reader_c::seek_to_key_frame_before(timestamp_c const &timestamp) {
+  // Video tracks continue with their last key frame before the
+  // timestamp. All other tracks continue with the last sample
+  // starting at or before the earliest of those key frames.
+  auto target = timestamp.to_ns();
+  std::unordered_map<qtmp4_demuxer_c *, size_t> new_positions;
+
+  for (auto const &dmx : m_demuxers) {
+    if ((-1 == dmx->ptzr) || !dmx->is_video())
+      continue;
+
+    for (auto idx = static_cast<size_t>(dmx->pos); idx < dmx->m_index.size(); ++idx) {
+      auto const &index = dmx->m_index[idx];
+      if (!index.is_keyframe)
+        continue;
+
+      if (index.timecode >= timestamp.to_ns())
+        break;
+
+      new_positions[dmx.get()] = idx;
+    }
+
+    if (new_positions.count(dmx.get()))
+      target = std::min(target, dmx->m_index[new_positions[dmx.get()]].timecode);
+  }
+
+  for (auto const &dmx : m_demuxers) {
+    if ((-1 == dmx->ptzr) || dmx->is_video())
+      continue;
+
+    for (auto idx = static_cast<size_t>(dmx->pos); idx < dmx->m_index.size(); ++idx) {
+      if (dmx->m_index[idx].timecode > target)
+        break;
+
+      new_positions[dmx.get()] = idx;
+    }
+  }
+
+  auto seeked = false;
+
+  for (auto const &new_position : new_positions)
+    if (new_position.second > new_position.first->pos) {
+      new_position.first->pos = new_position.second;
+      seeked                  = true;
+    }
+
+  return seeked;
+}
+
 memory_cptr
 qtmp4_reader_c::create_bitmap_info_header(qtmp4_demuxer_c &dmx,
                                           const char *fourcc,
@@ -465,6 +465,7 @@ public:
 
   virtual void read_headers();
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false);
+  virtual bool seek_to_key_frame_before(timestamp_c const &timestamp);
   virtual int get_progress();
   virtual void identify();
   virtual void create_packetizers();
@@ -104,5 +104,5 @@ ssa_reader_c::identify() {
   id_result_track(0, ID_RESULT_TRACK_SUBTITLES, codec_c::get_name(codec_c::type_e::S_SSA_ASS, "SSA/ASS"), info.get());
 
   for (auto const &attachment : g_attachments)
-    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->data->get_size(), attachment->name, attachment->description);
+    id_result_attachment(attachment->ui_id, attachment->mime_type, attachment->get_size(), attachment->name, attachment->description);
 }
@@ -15,7 +15,9 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
+#include "common/list_utils.h"
 #include "common/math.h"
 #include "common/strings/formatting.h"
 #include "common/tags/tags.h"
@@ -98,6 +100,27 @@ cluster_helper_c::discarding()
   return splitting() && m->discarding;
 }
 
+/** \brief End of the range currently being discarded
+
+   Only known for timestamp based 'parts:' splitting: if the packets
+   are currently being discarded and the next split point starts a
+   range to be kept then its timestamp is returned. Readers may skip
+   directly to the key frame before that timestamp instead of reading
+   all of the data that would be thrown away anyway. An invalid
+   timestamp is returned in all other cases.
+*/
+timestamp_c
+cluster_helper_c::get_discarded_range_end()
+  const {
+  if (   !discarding()
+      || (m->split_points.end() == m->current_split_point)
+      || (split_point_c::parts  != m->current_split_point->m_type)
+      || m->current_split_point->m_discard)
+    return {};
+
+  return timestamp_c::ns(m->current_split_point->m_point);
+}
+
 bool
 cluster_helper_c::is_splitting_and_processed_fully()
   const {
@@ -549,9 +572,16 @@ cluster_helper_c::render() {
       m->cluster->set_min_timecode(min_cl_timecode - timecode_offset);
       m->cluster->set_max_timecode(max_cl_timecode - timecode_offset);
 
+      // Switches m->out to the actual output once the headers have
+      // been written there.
+      write_streaming_output_headers();
+
       m->cluster->Render(*m->out, cues);
       m->bytes_in_file += m->cluster->ElementSize();
 
+      if (g_latency_target)
+        flush_and_account_latency();
+
       if (g_kax_sh_cues)
         g_kax_sh_cues->IndexThis(*m->cluster, *g_kax_segment);
 
@@ -571,6 +601,40 @@ cluster_helper_c::render() {
   return 1;
 }
 
+/** \brief Pass a rendered cluster on right away in low latency mode
+
+   The time between a packetizer receiving a frame and the frame
+   having been flushed to the output is recorded for the summary.
+*/
+void
+cluster_helper_c::flush_and_account_latency() {
+  m->out->flush();
+
+  auto now         = mtx::sys::get_current_time_millis();
+  auto max_latency = int64_t{};
+
+  for (auto const &pack : m->packets) {
+    auto latency    = now - pack->received_at_ms;
+    max_latency     = std::max(max_latency, latency);
+    m->latency_sum += latency;
+    ++m->latency_num_packets;
+  }
+
+  m->latency_max = std::max(m->latency_max, max_latency);
+
+  mxverb(2, boost::format(Y("Cluster at %1% written; maximum latency: %2% ms.\n")) % format_timestamp(m->cluster->GlobalTimecode()) % max_latency);
+}
+
+void
+cluster_helper_c::report_latency()
+  const {
+  if (!m->latency_num_packets)
+    return;
+
+  mxinfo(boost::format(Y("Latency between receiving frames and writing them: average %1% ms, maximum %2% ms.\n"))
+         % (m->latency_sum / m->latency_num_packets) % m->latency_max);
+}
+
 bool
 cluster_helper_c::add_to_cues_maybe(packet_cptr &pack) {
   auto &source  = *pack->source;
@@ -664,6 +728,9 @@ cluster_helper_c::split_mode_produces_many_files()
   if (!splitting())
     return false;
 
+  if (m->force_many_files)
+    return true;
+
   if (   (split_point_c::parts             != m->split_points.front().m_type)
       && (split_point_c::parts_frame_field != m->split_points.front().m_type))
     return true;
@@ -679,6 +746,91 @@ cluster_helper_c::split_mode_produces_many_files()
   return false;
 }
 
+/** \brief Plan the output files for splitting them in parallel
+
+   Each entry in the returned list contains the split points for
+   exactly one output file. Running the normal splitting logic with
+   such a list discards everything before the file's start, writes the
+   file and stops processing once its last range has been
+   finished. The result is the same as if all files had been created
+   sequentially.
+
+   Only the timestamp based modes with fixed split points are
+   supported ('parts:' and 'timestamps:'). Each file has to skip the
+   data before its start by seeking, and that is only possible for
+   timestamps (see get_discarded_range_end()). An empty list is
+   returned for all other modes.
+*/
+std::vector<std::vector<split_point_c>>
+cluster_helper_c::plan_parallel_split_parts()
+  const {
+  std::vector<std::vector<split_point_c>> plan;
+
+  if (!splitting())
+    return plan;
+
+  auto type = m->split_points.front().m_type;
+  if (!mtx::included_in(type, split_point_c::parts, split_point_c::timecode))
+    return plan;
+
+  auto points = m->split_points;
+
+  if (split_point_c::timecode == type) {
+    // Convert the split points into the equivalent 'parts:' form
+    // without any discarded ranges.
+    type = split_point_c::parts;
+    points.clear();
+    points.emplace_back(0, type, true, false, true);
+
+    for (auto const &point : m->split_points) {
+      if (point.m_point <= points.back().m_point)
+        return plan;
+
+      points.emplace_back(point.m_point, type, true, false, true);
+    }
+  }
+
+  for (auto idx = 0u; idx < points.size(); ++idx) {
+    auto const &start = points[idx];
+    if (start.m_discard || !start.m_create_new_file)
+      continue;
+
+    // Ranges appended with '+' belong to the same output file.
+    auto end_idx = idx + 1;
+    while ((end_idx < points.size()) && !points[end_idx].m_create_new_file)
+      ++end_idx;
+
+    std::vector<split_point_c> part_points;
+
+    if (0 != start.m_point)
+      part_points.emplace_back(0, type, true, true, true);
+
+    std::copy(points.begin() + idx, points.begin() + end_idx, std::back_inserter(part_points));
+
+    if (end_idx < points.size())
+      part_points.emplace_back(points[end_idx].m_point, type, true, true, true);
+
+    plan.push_back(part_points);
+  }
+
+  return plan;
+}
+
+void
+cluster_helper_c::restrict_to_parallel_split_part(std::size_t part_idx) {
+  auto plan = plan_parallel_split_parts();
+  if (part_idx >= plan.size())
+    return;
+
+  m->split_points.clear();
+  m->force_many_files = true;
+
+  for (auto const &point : plan[part_idx])
+    add_split_point(point);
+
+  mxdebug_if(m->debug_splitting, boost::format("Restricted splitting to part %1% of %2%\n") % (part_idx + 1) % plan.size());
+}
+
 void
 cluster_helper_c::discard_queued_packets() {
   m->packets.clear();
@@ -62,13 +62,17 @@ public:
   int64_t get_max_timecode_in_file() const;
   int64_t get_discarded_duration() const;
   void handle_discarded_duration(bool create_new_file, bool previously_discarding);
+  void report_latency() const;
 
   void add_split_point(split_point_c const &split_point);
   void dump_split_points() const;
   bool splitting() const;
   bool split_mode_produces_many_files() const;
+  std::vector<std::vector<split_point_c>> plan_parallel_split_parts() const;
+  void restrict_to_parallel_split_part(std::size_t part_idx);
 
   bool discarding() const;
+  timestamp_c get_discarded_range_end() const;
 
   int get_packet_count() const;
 
@@ -97,6 +101,7 @@ private:
   void split(packet_cptr &packet);
 
   bool add_to_cues_maybe(packet_cptr &pack);
+  void flush_and_account_latency();
 };
 
 extern std::unique_ptr<cluster_helper_c> g_cluster_helper;
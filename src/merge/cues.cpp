@@ -87,13 +87,18 @@ cues_c::write(mm_io_c &out,
   // no API function to force the position to a certain value; nor is
   // there a different API function in KaxSeekHead for adding anything
   // by ID and position manually.
-  out.save_pos();
-  kax_cues_position_dummy_c cues_dummy;
-  cues_dummy.Render(out);
-  out.restore_pos();
-
-  // Write meta seek information if it is not disabled.
-  seek_head.IndexThis(cues_dummy, *g_kax_segment);
+  //
+  // Streaming output cannot go back, and its meta seek element has
+  // already been written anyway.
+  if (!g_streaming_output) {
+    out.save_pos();
+    kax_cues_position_dummy_c cues_dummy;
+    cues_dummy.Render(out);
+    out.restore_pos();
+
+    // Write meta seek information if it is not disabled.
+    seek_head.IndexThis(cues_dummy, *g_kax_segment);
+  }
 
   // Forcefully write the correct head and copy its content from the
   // temporary storage location.
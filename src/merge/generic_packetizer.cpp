@@ -27,6 +27,7 @@
 #include "common/compression.h"
 #include "common/container.h"
 #include "common/ebml.h"
+#include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/strings/formatting.h"
 #include "common/unique_numbers.h"
@@ -1220,6 +1221,9 @@ generic_packetizer_c::add_packet(packet_cptr pack) {
 
   pack->source = this;
 
+  if (g_latency_target)
+    pack->received_at_ms = mtx::sys::get_current_time_millis();
+
   if ((0 > pack->bref) && (0 <= pack->fref))
     std::swap(pack->bref, pack->fref);
 
@@ -1366,13 +1370,31 @@ generic_packetizer_c::apply_factory() {
   if (m_packet_queue.end() == p_start)
     return;
 
-  if (TFA_SHORT_QUEUEING == m_timestamp_factory_application_mode)
+  // Full queueing waits for the next key frame which can be seconds
+  // away. Only wait for the frames being re-ordered in low latency mode.
+  if ((TFA_SHORT_QUEUEING == m_timestamp_factory_application_mode) || g_latency_target)
     apply_factory_short_queueing(p_start);
 
   else
     apply_factory_full_queueing(p_start);
 }
 
+struct packet_sorter_t {
+  int m_index;
+  static std::deque<packet_cptr> *m_packet_queue;
+
+  packet_sorter_t(int index)
+    : m_index(index)
+  {
+  }
+
+  bool operator <(const packet_sorter_t &cmp) const {
+    return (*m_packet_queue)[m_index]->timecode < (*m_packet_queue)[cmp.m_index]->timecode;
+  }
+};
+
+std::deque<packet_cptr> *packet_sorter_t::m_packet_queue = nullptr;
+
 void
 generic_packetizer_c::apply_factory_short_queueing(packet_cptr_di &p_start) {
   while (m_packet_queue.end() != p_start) {
@@ -1388,6 +1410,28 @@ generic_packetizer_c::apply_factory_short_queueing(packet_cptr_di &p_start) {
     if (!m_has_been_flushed && (m_packet_queue.end() == p_end))
       return;
 
+    // Packetizers requesting full queueing only end up here in low
+    // latency mode. Their packets have to be fed to the factory in
+    // timecode order just like in apply_factory_full_queueing().
+    if (TFA_FULL_QUEUEING == m_timestamp_factory_application_mode) {
+      packet_sorter_t::m_packet_queue = &m_packet_queue;
+
+      std::vector<packet_sorter_t> sorter;
+      size_t i = distance(m_packet_queue.begin(), p_start);
+
+      packet_cptr_di p_current;
+      for (p_current = p_start; p_current != p_end; ++i, ++p_current)
+        sorter.push_back(packet_sorter_t(i));
+
+      std::stable_sort(sorter.begin(), sorter.end());
+
+      for (i = 0; sorter.size() > i; ++i)
+        apply_factory_once(m_packet_queue[sorter[i].m_index]);
+
+      p_start = p_end;
+      continue;
+    }
+
     // Now assign timecodes to the ones between p_start and p_end...
     packet_cptr_di p_current;
     for (p_current = p_start + 1; p_current != p_end; ++p_current)
@@ -1399,22 +1443,6 @@ generic_packetizer_c::apply_factory_short_queueing(packet_cptr_di &p_start) {
   }
 }
 
-struct packet_sorter_t {
-  int m_index;
-  static std::deque<packet_cptr> *m_packet_queue;
-
-  packet_sorter_t(int index)
-    : m_index(index)
-  {
-  }
-
-  bool operator <(const packet_sorter_t &cmp) const {
-    return (*m_packet_queue)[m_index]->timecode < (*m_packet_queue)[cmp.m_index]->timecode;
-  }
-};
-
-std::deque<packet_cptr> *packet_sorter_t::m_packet_queue = nullptr;
-
 void
 generic_packetizer_c::apply_factory_full_queueing(packet_cptr_di &p_start) {
   packet_sorter_t::m_packet_queue = &m_packet_queue;
@@ -1520,6 +1548,16 @@ generic_packetizer_c::contains_gap() {
   return m_timestamp_factory ? m_timestamp_factory->contains_gap() : false;
 }
 
+bool
+generic_packetizer_c::are_timestamps_modified()
+  const {
+  return m_timestamp_factory
+      || (0 != m_correction_timecode_offset)
+      || (0 != m_append_timecode_offset)
+      || (0 != m_ti.m_tcsync.displacement)
+      || (m_ti.m_tcsync.numerator != m_ti.m_tcsync.denominator);
+}
+
 void
 generic_packetizer_c::flush() {
   flush_impl();
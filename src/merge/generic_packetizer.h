@@ -103,6 +103,7 @@ public:
   virtual ~generic_packetizer_c();
 
   virtual bool contains_gap();
+  virtual bool are_timestamps_modified() const;
 
   virtual file_status_e read(bool force);
 
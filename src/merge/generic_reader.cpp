@@ -135,6 +135,13 @@ generic_reader_c::get_timecode_restriction_max()
   return m_restricted_timecodes_max;
 }
 
+// Readers for formats with an index can skip data that would be
+// discarded anyway. They must only ever seek forward.
+bool
+generic_reader_c::seek_to_key_frame_before(timestamp_c const &) {
+  return false;
+}
+
 void
 generic_reader_c::read_all() {
   for (auto &packetizer : m_reader_packetizers)
@@ -521,7 +528,13 @@ generic_reader_c::add_available_track_id_range(int64_t start,
 
 int
 generic_reader_c::get_progress() {
-  return 100 * m_in->getFilePointer() / m_size;
+  uint64_t position = m_in->getFilePointer();
+
+  // The file may still be growing.
+  if (position > m_size)
+    m_size = m_in->get_size();
+
+  return 100 * position / m_size;
 }
 
 mm_io_c *
@@ -540,6 +553,11 @@ generic_reader_c::set_probe_range_percentage(int64_rational_c const &probe_range
   s_probe_range_percentage = probe_range_percentage;
 }
 
+int64_rational_c const &
+generic_reader_c::get_probe_range_percentage() {
+  return s_probe_range_percentage;
+}
+
 int64_t
 generic_reader_c::calculate_probe_range(int64_t file_size,
                                         int64_t fixed_minimum)
@@ -83,6 +83,8 @@ public:
   virtual timestamp_c const &get_timecode_restriction_min() const;
   virtual timestamp_c const &get_timecode_restriction_max() const;
 
+  virtual bool seek_to_key_frame_before(timestamp_c const &timestamp);
+
   virtual void read_headers() = 0;
   virtual file_status_e read(generic_packetizer_c *ptzr, bool force = false) = 0;
   virtual void read_all();
@@ -129,6 +131,7 @@ public:
 
 public:
   static void set_probe_range_percentage(int64_rational_c const &probe_range_percentage);
+  static int64_rational_c const &get_probe_range_percentage();
 
 protected:
   virtual bool demuxing_requested(char type, int64_t id, boost::optional<std::string> const &language = boost::none) const;
@@ -0,0 +1,148 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   concurrent parsing of the source files' headers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#include "merge/header_parser.h"
+
+namespace {
+
+unsigned int const s_max_threads = 8;
+
+}
+
+header_parser_c::header_parser_c(std::vector<job_t *> const &jobs,
+                                 unsigned int num_threads)
+  : m_next_job_idx{}
+  , m_aborted{}
+  , m_debug{"header_parser"}
+{
+  num_threads = std::min<unsigned int>(num_threads, jobs.size());
+  if (!num_threads)
+    return;
+
+  m_jobs = jobs;
+  for (auto job : m_jobs)
+    job->m_queued = true;
+
+  mxdebug_if(m_debug, boost::format("header_parser: starting %1% thread(s) for %2% file(s)\n") % num_threads % m_jobs.size());
+
+  for (auto idx = 0u; idx < num_threads; ++idx)
+    m_threads.emplace_back([this]() { run(); });
+}
+
+header_parser_c::~header_parser_c() {
+  abort();
+}
+
+unsigned int
+header_parser_c::default_num_threads(std::size_t num_jobs) {
+  if (num_jobs < 2)
+    return 0;
+
+  return std::min<unsigned int>(std::max(std::thread::hardware_concurrency(), 2u), s_max_threads);
+}
+
+/** \brief Wait until the headers of the job's reader have been parsed
+
+   If the job isn't handled by the threads, its reader has to parse its
+   headers in the calling thread afterwards. As those readers may
+   access global state, all queued jobs are finished and the threads
+   have exited when this function returns. The same goes for jobs that
+   failed, as reporting their errors exits, except that the jobs that
+   haven't been started yet are dropped.
+*/
+void
+header_parser_c::wait_for(job_t &job) {
+  {
+    std::unique_lock<std::mutex> lock{m_mutex};
+
+    m_job_done.wait(lock, [&job]() { return job.m_done || !job.m_queued; });
+  }
+
+  if (job.m_exception)
+    abort();
+
+  else if (!job.m_done)
+    finish();
+}
+
+/** \brief Wait until all queued jobs are done and the threads have exited
+*/
+void
+header_parser_c::finish() {
+  join();
+}
+
+/** \brief Stop the threads as soon as possible
+
+   The jobs currently being run are finished. Jobs that haven't been
+   started yet are removed from the queue; their readers have to parse
+   their headers in the calling thread.
+*/
+void
+header_parser_c::abort() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_aborted = true;
+  }
+
+  join();
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+
+  for (auto job : m_jobs)
+    if (!job->m_done)
+      job->m_queued = false;
+}
+
+void
+header_parser_c::join() {
+  for (auto &thread : m_threads)
+    thread.join();
+
+  m_threads.clear();
+}
+
+void
+header_parser_c::run() {
+  while (true) {
+    job_t *job{};
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+
+      if (m_aborted || (m_next_job_idx >= m_jobs.size()))
+        return;
+
+      job = m_jobs[m_next_job_idx++];
+    }
+
+    {
+      mxmsg_capture_c capture{job->m_deferred_actions};
+
+      try {
+        job->m_read_headers();
+      } catch (...) {
+        job->m_exception = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock{m_mutex};
+      job->m_done = true;
+    }
+
+    m_job_done.notify_all();
+  }
+}
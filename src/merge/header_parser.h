@@ -0,0 +1,72 @@
+/*
+   mkvmerge -- utility for splicing together matroska files
+   from component media subtypes
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   concurrent parsing of the source files' headers
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_MERGE_HEADER_PARSER_H
+#define MTX_MERGE_HEADER_PARSER_H
+
+#include "common/common_pch.h"
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "common/debugging.h"
+
+/** \brief Runs the readers' read_headers() in background threads
+
+   Each reader is handled by one thread at a time. The messages the
+   reader outputs and the attachments it adds are deferred via \c
+   mxmsg_capture_c. The main thread waits for the readers in command
+   line order, replays the deferred actions and re-throws the
+   exception a reader may have thrown. This way all messages are
+   output in the same order as if the headers had been parsed one
+   after the other.
+
+   Only readers that keep all their state in the reader object itself
+   may be handled this way.
+*/
+class header_parser_c {
+public:
+  struct job_t {
+    std::function<void()> m_read_headers;
+    mxmsg_capture_c::actions_t m_deferred_actions;
+    std::exception_ptr m_exception;
+    bool m_queued{}, m_done{};
+  };
+
+protected:
+  std::vector<job_t *> m_jobs;
+  std::size_t m_next_job_idx;
+  bool m_aborted;
+  std::mutex m_mutex;
+  std::condition_variable m_job_done;
+  std::vector<std::thread> m_threads;
+  debugging_option_c m_debug;
+
+public:
+  header_parser_c(std::vector<job_t *> const &jobs, unsigned int num_threads);
+  ~header_parser_c();
+
+  void wait_for(job_t &job);
+  void finish();
+  void abort();
+
+  static unsigned int default_num_threads(std::size_t num_jobs);
+
+protected:
+  void run();
+  void join();
+};
+
+#endif  // MTX_MERGE_HEADER_PARSER_H
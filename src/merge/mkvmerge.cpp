@@ -17,6 +17,10 @@
 
 #if defined(SYS_UNIX) || defined(SYS_APPLE)
 #include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <string.h>
 #endif
 #include <stdlib.h>
 #include <stdio.h>
@@ -40,13 +44,17 @@
 #include <matroska/KaxTag.h>
 #include <matroska/KaxTags.h>
 
+#include "common/bluray_util.h"
 #include "common/chapters/chapters.h"
+#include "common/cache.h"
 #include "common/command_line.h"
 #include "common/ebml.h"
 #include "common/extern_data.h"
 #include "common/file_types.h"
 #include "common/fs_sys_helpers.h"
+#include "common/hacks.h"
 #include "common/iso639.h"
+#include "common/json.h"
 #include "common/kax_analyzer.h"
 #include "common/list_utils.h"
 #include "common/mm_io.h"
@@ -55,6 +63,7 @@
 #include "common/split_arg_parsing.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
+#include "common/translation.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
 #include "common/webm.h"
@@ -69,6 +78,13 @@
 
 using namespace libmatroska;
 
+// Increase when the cached identification output changes in a way
+// the program version alone doesn't reflect.
+#define IDENTIFICATION_CACHE_VERSION  1
+#define IDENTIFICATION_CACHE_MAX_SIZE (64 * 1024 * 1024)
+
+static bool s_use_identification_cache = false;
+
 /** \brief Outputs usage information
 */
 #define S(x) std::string{x}
@@ -118,6 +134,12 @@ set_usage() {
                   "                           cluster.\n");
   usage_text += Y("  --no-cues                Do not write the cue data (the index).\n");
   usage_text += Y("  --clusters-in-meta-seek  Write meta seek data for clusters.\n");
+  usage_text += Y("  --streaming-output       Write the destination file without ever going\n"
+                  "                           back, e.g. into a pipe. Used automatically for\n"
+                  "                           '-o -' (the standard output).\n");
+  usage_text += Y("  --latency-target <n>     Low latency mode for live muxing: limit\n"
+                  "                           clusters to n milliseconds, write each one\n"
+                  "                           out immediately and report the latency.\n");
   usage_text += Y("  --no-date                Do not write the 'date' field in the segment\n"
                   "                           information headers.\n");
   usage_text += Y("  --disable-lacing         Do not use lacing.\n");
@@ -147,6 +169,9 @@ set_usage() {
                   "                           Create a new file before each chapter (with 'all')\n"
                   "                           or before chapter numbers A, B etc.\n");
   usage_text += Y("  --split-max-files <n>    Create at most n files.\n");
+  usage_text += Y("  --split-parallel <n>     Create up to n files at the same time in separate\n"
+                  "                           processes. Only for splitting by 'parts:' and\n"
+                  "                           'timestamps:' with Matroska, MP4 and AVI files.\n");
   usage_text += Y("  --link                   Link splitted files.\n");
   usage_text += Y("  --link-to-previous <SID> Link the first file to the given SID.\n");
   usage_text += Y("  --link-to-next <SID>     Link the last file to the given SID.\n");
@@ -208,6 +233,10 @@ set_usage() {
   usage_text += Y("  -T, --no-track-tags      Don't copy tags for tracks from the source file.\n");
   usage_text += Y("  --no-global-tags         Don't keep global tags from the source file.\n");
   usage_text += Y("  --no-chapters            Don't keep chapters from the source file.\n");
+  usage_text += Y("  --follow-growing-file <n>\n"
+                  "                           Keep reading the source file while it is being\n"
+                  "                           written to until it hasn't grown for n seconds.\n"
+                  "                           Only for MPEG TS and Matroska files.\n");
   usage_text += Y("  -y, --sync <TID:d[,o[/p]]>\n"
                   "                           Synchronize, adjust the track's timecodes with\n"
                   "                           the id TID by 'd' ms.\n"
@@ -329,6 +358,11 @@ set_usage() {
                   "                           Sets maximum size to probe for tracks in percent\n"
                   "                           of the total file size for certain file types\n"
                   "                           (default: 0.3).\n");
+  usage_text += Y("  --identification-cache   Store identification results in a cache and\n"
+                  "                           re-use them for unchanged files.\n");
+  usage_text += Y("  --identification-server  Read identification requests from stdin and\n"
+                  "                           write the results to stdout until stdin is\n"
+                  "                           closed.\n");
   usage_text += Y("  -l, --list-types         Lists supported source file types.\n");
   usage_text += Y("  --list-languages         Lists all ISO639 languages and their\n"
                   "                           ISO639-2 codes.\n");
@@ -445,6 +479,54 @@ display_unsupported_file_type(filelist_t const &file) {
   mxerror(boost::format(Y("The type of file '%1%' is not supported.\n")) % file.name);
 }
 
+static std::string
+identification_cache_variant(filelist_t const &file) {
+  // Everything besides the file itself that influences the result.
+  auto hacks = std::string{};
+  for (auto id = 0u; id <= ENGAGE_MAX_IDX; ++id)
+    hacks += hack_engaged(id) ? '1' : '0';
+
+  auto const &percentage = generic_reader_c::get_probe_range_percentage();
+
+  // The output contains the file name exactly as it was given.
+  return (boost::format("%1% %2% %3%/%4% %5% %6%\n%7%")
+          % static_cast<int>(g_identification_output_format) % file.ti->m_disable_multi_file
+          % percentage.numerator() % percentage.denominator()
+          % hacks % translation_c::get_active_translation().get_locale()
+          % file.name).str();
+}
+
+/** \brief Output a cached identification result if there's one
+
+   The entry is only used if the file hasn't been modified since it
+   was created. In that case this function exits.
+*/
+static void
+identify_from_cache(bfs::path const &cache_file_name,
+                    mtx::cache::file_identity_t const &identity) {
+  auto json = mtx::cache::read_for_file(cache_file_name, identity);
+  if (!json)
+    return;
+
+  try {
+    if (json->at("identification_cache_version").get<int>() != IDENTIFICATION_CACHE_VERSION)
+      return;
+
+    auto messages = json->at("messages");
+    auto warned   = json->at("warning_issued").get<bool>();
+
+    mtx::cache::touch(cache_file_name);
+    mtx::cache::replay_messages(messages);
+
+    g_warning_issued = g_warning_issued || warned;
+
+  } catch (std::exception const &) {
+    return;
+  }
+
+  mxexit();
+}
+
 /** \brief Identify a file type and its contents
 
    This function called for \c --identify. It sets up dummy track info
@@ -469,6 +551,18 @@ identify(std::string &filename) {
   file.name           = filename;
   file.all_names.push_back(filename);
 
+  auto identity        = boost::optional<mtx::cache::file_identity_t>{};
+  auto cache_file_name = bfs::path{};
+
+  if (s_use_identification_cache && (identity = mtx::cache::get_file_identity(filename))) {
+    cache_file_name = mtx::cache::get_cache_file_name("identification", filename, identification_cache_variant(file));
+    identify_from_cache(cache_file_name, *identity);
+  }
+
+  auto recorder = std::unique_ptr<mtx::cache::message_recorder_c>{};
+  if (!cache_file_name.empty())
+    recorder = std::make_unique<mtx::cache::message_recorder_c>();
+
   get_file_type(file);
 
   if (FILE_TYPE_IS_UNKNOWN == file.type)
@@ -479,6 +573,13 @@ identify(std::string &filename) {
   file.reader->identify();
   file.reader->display_identification_results();
 
+  if (recorder)
+    mtx::cache::write_for_file(cache_file_name, *identity, file.size, nlohmann::json{
+      { "identification_cache_version", IDENTIFICATION_CACHE_VERSION },
+      { "messages",                     recorder->get_messages()     },
+      { "warning_issued",               g_warning_issued.load()      },
+    }, IDENTIFICATION_CACHE_MAX_SIZE);
+
   g_files.clear();
 }
 
@@ -1700,9 +1801,11 @@ static void
 parse_arg_attach_file(attachment_cptr const &attachment,
                       const std::string &arg,
                       bool attach_once) {
+  auto size = int64_t{};
+
   try {
     mm_file_io_c test(arg);
-    auto size = test.get_size();
+    size = test.get_size();
 
     if (size > 0x7fffffff)
       mxerror(boost::format("%1% %2%\n")
@@ -1713,24 +1816,19 @@ parse_arg_attach_file(attachment_cptr const &attachment,
     mxerror(boost::format(Y("The file '%1%' cannot be attached because it does not exist or cannot be read.\n")) % arg);
   }
 
+  if (0 == size)
+    mxerror(boost::format(Y("The size of attachment '%1%' is 0.\n")) % arg);
+
   attachment->name         = arg;
   attachment->to_all_files = !attach_once;
 
   if (attachment->mime_type.empty())
     attachment->mime_type  = guess_mime_type_and_report(arg);
 
-  try {
-    mm_io_cptr io = mm_file_io_c::open(attachment->name);
-
-    if (0 == io->get_size())
-      mxerror(boost::format(Y("The size of attachment '%1%' is 0.\n")) % attachment->name);
-
-    attachment->data = memory_c::alloc(io->get_size());
-    io->read(attachment->data->get_buffer(), attachment->data->get_size());
-
-  } catch (...) {
-    mxerror(boost::format(Y("The attachment '%1%' could not be read.\n")) % attachment->name);
-  }
+  // The content is copied from the file when the attachments are
+  // written instead of being held in memory.
+  attachment->data_file_name = arg;
+  attachment->data_size      = size;
 
   add_attachment(attachment);
 }
@@ -2087,6 +2185,10 @@ handle_identification_args(std::vector<std::string> &args) {
       parse_arg_probe_range(next_arg);
       args.erase(this_arg_itr, next_arg_itr + 1);
 
+    } else if (*this_arg_itr == "--identification-cache") {
+      s_use_identification_cache = true;
+      this_arg_itr               = args.erase(this_arg_itr);
+
     } else
       ++this_arg_itr;
   }
@@ -2135,8 +2237,128 @@ handle_identification_args(std::vector<std::string> &args) {
   mxexit();
 }
 
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+/** \brief Handle a single request in identification server mode
+
+   The request is a JSON array of command line arguments as they would
+   be given to a normal identification run, e.g. <tt>["--identify",
+   "file.mkv"]</tt>. It is handled in a child process forked from the
+   server so that the initialization done at startup doesn't have to
+   be repeated and the global state of the server stays untouched. The
+   child's output is captured through a pipe.
+
+   Blu-ray playlists and clip info files the request refers to are
+   parsed by the server itself before the child is created. The
+   children inherit the parse caches, and the server keeps them for
+   later requests, e.g. for the other playlists of the same disc.
+
+   Returns the response: a JSON object with the keys \c exit_code and
+   \c output.
+*/
+static nlohmann::json
+handle_identification_request(std::string const &request) {
+  auto args = std::vector<std::string>{};
+
+  try {
+    auto json = mtx::json::parse(request);
+    if (!json.is_array())
+      throw std::invalid_argument{"not an array"};
+
+    for (auto const &arg : json)
+      args.emplace_back(arg.get<std::string>());
+
+  } catch (std::exception const &) {
+    return { { "exit_code", 2 }, { "output", Y("The request must be a JSON array of strings.") } };
+  }
+
+  for (auto const &arg : args)
+    mtx::bluray::prime_parse_caches(arg);
+
+  int fds[2];
+  if (0 != pipe(fds))
+    return { { "exit_code", 2 }, { "output", (boost::format(Y("Creating a pipe failed: %1%")) % strerror(errno)).str() } };
+
+  g_mm_stdio->flush();
+
+  auto pid = fork();
+  if (-1 == pid) {
+    close(fds[0]);
+    close(fds[1]);
+    return { { "exit_code", 2 }, { "output", (boost::format(Y("Creating a process for the request failed: %1%")) % strerror(errno)).str() } };
+  }
+
+  if (0 == pid) {
+    close(fds[0]);
+    dup2(fds[1], STDOUT_FILENO);
+    close(fds[1]);
+
+    args = parse_common_args(args);
+    handle_identification_args(args);
+
+    mxerror(Y("Only identification requests are supported in identification server mode.\n"));
+  }
+
+  close(fds[1]);
+
+  std::string output;
+  char buffer[4096];
+
+  while (true) {
+    auto num_read = read(fds[0], buffer, sizeof(buffer));
+    if ((-1 == num_read) && (EINTR == errno))
+      continue;
+    if (0 >= num_read)
+      break;
+    output.append(buffer, num_read);
+  }
+
+  close(fds[0]);
+
+  int status = 0;
+  while ((-1 == waitpid(pid, &status, 0)) && (EINTR == errno))
+    ;
+
+  return { { "exit_code", WIFEXITED(status) ? WEXITSTATUS(status) : 2 }, { "output", output } };
+}
+#endif
+
+/** \brief Run mkvmerge as a long-lived identification server
+
+   Each line read from stdin is one request. For each of them exactly
+   one line containing the response is written to stdout. See
+   \c handle_identification_request for the format. The server exits
+   once stdin is closed.
+*/
+static void
+run_identification_server() {
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+  std::string request;
+
+  while (std::getline(std::cin, request)) {
+    strip(request);
+    if (request.empty())
+      continue;
+
+    auto response = mtx::json::dump(handle_identification_request(request)) + "\n";
+    g_mm_stdio->puts(response);
+    g_mm_stdio->flush();
+  }
+
+  mxexit();
+
+#else
+  mxerror(Y("The identification server mode is not supported on this operating system.\n"));
+#endif
+}
+
 static void
 parse_args(std::vector<std::string> args) {
+  if (brng::find(args, "--identification-server") != args.end()) {
+    if (1 != args.size())
+      mxerror(Y("'--identification-server' cannot be used with other options.\n"));
+    run_identification_server();
+  }
+
   handle_identification_args(args);
 
   // First parse options that either just print some infos and then exit.
@@ -2164,6 +2386,12 @@ parse_args(std::vector<std::string> args) {
 
   }
 
+  // If the destination file is written to the standard output then
+  // the messages must go somewhere else.
+  for (auto sit = args.cbegin(), sit_end = args.cend(); sit != sit_end; sit++)
+    if (((*sit == "-o") || (*sit == "--output")) && ((sit + 1) != sit_end) && (*(sit + 1) == "-") && !stdio_redirected())
+      redirect_stdio(mm_io_cptr{new mm_stdio_c{stderr}});
+
   mxinfo(boost::format("%1%\n") % get_version_info("mkvmerge", vif_full));
 
   // Now parse options that are needed right at the beginning.
@@ -2192,6 +2420,9 @@ parse_args(std::vector<std::string> args) {
     usage(2);
   }
 
+  if (g_outfile == "-")
+    g_streaming_output = true;
+
   if (!outputting_webm() && is_webm_file_name(g_outfile)) {
     set_output_compatibility(OC_WEBM);
     mxinfo(boost::format(Y("Automatically enabling WebM compliance mode due to destination file name extension.\n")));
@@ -2259,6 +2490,15 @@ parse_args(std::vector<std::string> args) {
 
       sit++;
 
+    } else if (this_arg == "--split-parallel") {
+      if ((no_next_arg) || (next_arg[0] == 0))
+        mxerror(Y("'--split-parallel' lacks the number of files.\n"));
+
+      if (!parse_number(next_arg, g_split_max_parallel_parts) || (1 > g_split_max_parallel_parts))
+        mxerror(Y("Wrong argument to '--split-parallel'.\n"));
+
+      sit++;
+
     } else if (this_arg == "--link") {
       g_no_linking = false;
 
@@ -2299,7 +2539,21 @@ parse_args(std::vector<std::string> args) {
     else if (this_arg == "--clusters-in-meta-seek")
       g_write_meta_seek_for_clusters = true;
 
-    else if (this_arg == "--disable-lacing")
+    else if (this_arg == "--streaming-output")
+      g_streaming_output = true;
+
+    else if (this_arg == "--latency-target") {
+      if ((no_next_arg) || (next_arg[0] == 0))
+        mxerror(Y("'--latency-target' lacks the number of milliseconds.\n"));
+
+      int64_t latency_target_ms = 0;
+      if (!parse_number(next_arg, latency_target_ms) || (10 > latency_target_ms) || (32000 < latency_target_ms))
+        mxerror(boost::format(Y("Latency target '%1%' out of range (10..32000).\n")) % next_arg);
+
+      g_latency_target = latency_target_ms * 1000000;
+      sit++;
+
+    } else if (this_arg == "--disable-lacing")
       g_no_lacing = true;
 
     else if (this_arg == "--enable-durations")
@@ -2415,7 +2669,18 @@ parse_args(std::vector<std::string> args) {
     } else if (this_arg == "--no-chapters")
       ti->m_no_chapters = true;
 
-    else if ((this_arg == "-M") || (this_arg == "--no-attachments"))
+    else if (this_arg == "--follow-growing-file") {
+      if ((no_next_arg) || (next_arg[0] == 0))
+        mxerror(Y("'--follow-growing-file' lacks the idle timeout.\n"));
+
+      double idle_timeout = 0;
+      if (!parse_number(next_arg, idle_timeout) || (0 >= idle_timeout))
+        mxerror(Y("Wrong argument to '--follow-growing-file'.\n"));
+
+      ti->m_follow_growing_file = std::max<int64_t>(static_cast<int64_t>(idle_timeout * 1000), 1);
+      sit++;
+
+    } else if ((this_arg == "-M") || (this_arg == "--no-attachments"))
       ti->m_attach_mode_list.set_none();
 
     else if ((this_arg == "-m") || (this_arg == "--attachments")) {
@@ -2797,6 +3062,13 @@ parse_args(std::vector<std::string> args) {
   if (!g_cluster_helper->splitting() && !g_no_linking)
     mxwarn(Y("'--link' is only useful in combination with '--split'.\n"));
 
+  if (g_streaming_output && (g_cluster_helper->splitting() || !g_splitting_by_chapters_arg.empty()))
+    mxerror(Y("Splitting cannot be used with streaming output.\n"));
+
+  // Clusters must not span more than the latency target.
+  if (g_latency_target)
+    g_max_ns_per_cluster = std::min(g_max_ns_per_cluster, g_latency_target);
+
   if (!inputs_found && g_files.empty())
     mxerror(Y("No source files were given.\n"));
 }
@@ -2933,6 +3205,113 @@ create_append_mappings_for_playlists() {
   }
 }
 
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+/** \brief Create the planned split parts in child processes
+
+   One child process is forked per output file with at most
+   \c g_split_max_parallel_parts of them running at the same time. The
+   fork happens right after the command line has been parsed and
+   before any file has been opened. Each child therefore creates its
+   own readers and runs the regular multiplexing code with its split
+   points restricted to its own output file.
+
+   Returns in the child processes only. The parent waits for all
+   children to finish and exits with the worst exit code reported by
+   them.
+*/
+static void
+create_split_parts_in_child_processes(std::size_t num_parts) {
+  std::unordered_map<pid_t, std::size_t> running;
+  auto exit_code = 0;
+
+  auto wait_for_child = [&running, &exit_code]() {
+    int status = 0;
+    auto pid   = waitpid(-1, &status, 0);
+    if (-1 == pid)
+      return;
+
+    running.erase(pid);
+
+    auto child_exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+    exit_code            = std::max(exit_code, child_exit_code);
+  };
+
+  // Make sure buffered output isn't written a second time by each child.
+  g_mm_stdio->flush();
+
+  for (auto part_idx = 0u; part_idx < num_parts; ++part_idx) {
+    while (running.size() >= static_cast<std::size_t>(g_split_max_parallel_parts))
+      wait_for_child();
+
+    auto pid = fork();
+    if (-1 == pid)
+      mxerror(boost::format(Y("Creating a process for the split part %1% failed: %2%\n")) % (part_idx + 1) % strerror(errno));
+
+    if (0 == pid) {
+      g_cluster_helper->restrict_to_parallel_split_part(part_idx);
+      g_file_num      = part_idx + 1;
+      g_suppress_info = true;
+      return;
+    }
+
+    running[pid] = part_idx;
+  }
+
+  while (!running.empty())
+    wait_for_child();
+
+  if (0 == exit_code)
+    mxinfo(boost::format(NY("%1% file has been created.\n", "%1% files have been created.\n", num_parts)) % num_parts);
+
+  mxexit(0 != exit_code ? exit_code : -1);
+}
+#endif
+
+/** \brief Check whether all source files can skip discarded data by seeking
+
+   Each child process creating a split part has to skip everything
+   before its part. Only the readers implementing
+   \c seek_to_key_frame_before() can do that without reading and
+   discarding all of the data. With any other file each child would
+   read the whole source up to its part.
+*/
+static bool
+all_files_support_split_seeking() {
+  for (auto const &file : g_files)
+    if (   file->is_playlist
+        || file->appending
+        || !mtx::included_in(file->type, FILE_TYPE_AVI, FILE_TYPE_MATROSKA, FILE_TYPE_QTMP4))
+      return false;
+
+  return true;
+}
+
+static void
+split_parts_in_parallel_if_requested() {
+  if ((1 >= g_split_max_parallel_parts) || g_identifying || (!g_cluster_helper->splitting() && g_splitting_by_chapters_arg.empty()))
+    return;
+
+  auto plan = g_cluster_helper->plan_parallel_split_parts();
+
+  if (   !g_no_linking
+      || !g_splitting_by_chapters_arg.empty()
+      || plan.empty()
+      || (plan.size() > static_cast<std::size_t>(g_split_max_num_files))
+      || !all_files_support_split_seeking()) {
+    mxwarn(Y("The split parts cannot be created in parallel with the current splitting mode or options. They will be created one after the other instead.\n"));
+    return;
+  }
+
+  if (1 == plan.size())
+    return;
+
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+  create_split_parts_in_child_processes(plan.size());
+#else
+  mxwarn(Y("Creating split parts in parallel is not supported on this operating system. They will be created one after the other instead.\n"));
+#endif
+}
+
 /** \brief Global program initialization
 
    Both platform dependant and independant initialization is done here.
@@ -2974,6 +3353,8 @@ main(int argc,
 
   parse_args(args);
 
+  split_parts_in_parallel_if_requested();
+
   int64_t start = mtx::sys::get_current_time_millis();
 
   add_filelists_for_playlists();
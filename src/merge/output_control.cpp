@@ -53,6 +53,7 @@
 #include "common/date_time.h"
 #include "common/debugging.h"
 #include "common/ebml.h"
+#include "common/endian.h"
 #include "common/fs_sys_helpers.h"
 #include "common/hacks.h"
 #include "common/mm_io_x.h"
@@ -81,6 +82,65 @@ namespace libmatroska {
       SetPrecision(prec);
     }
   };
+
+  // File data that's copied from a source file into the output file
+  // while rendering instead of being kept in memory.
+  class KaxStreamedFileData: public KaxFileData {
+  protected:
+    std::string m_file_name;
+    uint64_t m_position;
+
+  public:
+    KaxStreamedFileData(std::string const &file_name,
+                        uint64_t position,
+                        uint64_t size)
+      : KaxFileData()
+      , m_file_name{file_name}
+      , m_position{position}
+    {
+      SetBuffer(nullptr, size);
+    }
+
+    virtual EbmlElement *Clone() const override {
+      return new KaxStreamedFileData(*this);
+    }
+
+    virtual filepos_t RenderData(IOCallback &output,
+                                 bool,
+                                 bool) override {
+      auto size   = static_cast<uint64_t>(GetSize());
+      auto copied = uint64_t{};
+
+      try {
+        mm_file_io_c in{m_file_name};
+        in.setFilePointer(m_position);
+
+        auto out = dynamic_cast<mm_io_c *>(&output);
+        if (out)
+          copied = out->copy_from(in, size);
+
+        else {
+          auto buffer = memory_c::alloc(std::min<uint64_t>(size, 1024 * 1024));
+
+          while (copied < size) {
+            auto num_read = in.read(buffer->get_buffer(), std::min<uint64_t>(size - copied, buffer->get_size()));
+            if (!num_read)
+              break;
+
+            output.writeFully(buffer->get_buffer(), num_read);
+            copied += num_read;
+          }
+        }
+
+      } catch (mtx::mm_io::exception &) {
+      }
+
+      if (copied != size)
+        mxerror(boost::format(Y("The attachment data could not be read from '%1%'.\n")) % m_file_name);
+
+      return size;
+    }
+  };
 }
 
 std::vector<packetizer_t> g_packetizers;
@@ -110,6 +170,8 @@ bool g_no_linking                           = true;
 bool g_use_durations                        = false;
 bool g_no_track_statistics_tags             = false;
 bool g_write_date                           = true;
+bool g_streaming_output                     = false;
+int64_t g_latency_target                    = 0;
 
 double g_timecode_scale                     = TIMECODE_SCALE;
 timecode_scale_mode_e g_timecode_scale_mode = TIMECODE_SCALE_MODE_NORMAL;
@@ -146,6 +208,7 @@ int64_t g_tags_size                         = 0;
 int g_file_num = 1;
 
 int g_split_max_num_files                   = 65535;
+int g_split_max_parallel_parts              = 1;
 std::string g_splitting_by_chapters_arg;
 
 append_mode_e g_append_mode                 = APPEND_MODE_FILE_BASED;
@@ -176,6 +239,10 @@ static std::vector<std::tuple<timestamp_c, std::string, std::string>> s_addition
 
 static mm_io_cptr s_out;
 
+// With streaming output: the actual output until the headers have been
+// written to it. s_out is a memory buffer until then.
+static mm_io_cptr s_streaming_sink;
+
 static bitvalue_c s_seguid_prev(128), s_seguid_current(128), s_seguid_next(128);
 
 static int s_display_files_done           = 0;
@@ -235,35 +302,41 @@ sighandler(int /* signum */) {
            "Ctrl+C). Trying to sanitize the file. If mkvmerge hangs during "
            "this process you'll have to kill it manually.\n"));
 
+  write_streaming_output_headers();
+
   mxinfo(Y("The file is being fixed, part 1/4..."));
   // Render the cues.
   if (g_write_cues && g_cue_writing_requested)
     cues_c::get().write(*s_out, *g_kax_sh_main);
   mxinfo(Y(" done\n"));
 
-  mxinfo(Y("The file is being fixed, part 2/4..."));
-  // Now re-render the kax_duration and fill in the biggest timecode
-  // as the file's duration.
-  s_out->save_pos(s_kax_duration->GetElementPosition());
-  s_kax_duration->SetValue(calculate_file_duration());
-  s_kax_duration->Render(*s_out);
-  s_out->restore_pos();
-  mxinfo(Y(" done\n"));
-
-  mxinfo(Y("The file is being fixed, part 3/4..."));
-  if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
-    g_kax_sh_main->UpdateSize();
-    if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
-      mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. %1%\n")) % BUGMSG);
-  }
-  mxinfo(Y(" done\n"));
+  // Nothing that has already been written can be changed with
+  // streaming output.
+  if (!g_streaming_output) {
+    mxinfo(Y("The file is being fixed, part 2/4..."));
+    // Now re-render the kax_duration and fill in the biggest timecode
+    // as the file's duration.
+    s_out->save_pos(s_kax_duration->GetElementPosition());
+    s_kax_duration->SetValue(calculate_file_duration());
+    s_kax_duration->Render(*s_out);
+    s_out->restore_pos();
+    mxinfo(Y(" done\n"));
+
+    mxinfo(Y("The file is being fixed, part 3/4..."));
+    if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
+      g_kax_sh_main->UpdateSize();
+      if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
+        mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. %1%\n")) % BUGMSG);
+    }
+    mxinfo(Y(" done\n"));
 
-  mxinfo(Y("The file is being fixed, part 4/4..."));
-  // Set the correct size for the segment.
-  if (g_kax_segment->ForceSize(s_out->getFilePointer() - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
-    g_kax_segment->OverwriteHead(*s_out);
+    mxinfo(Y("The file is being fixed, part 4/4..."));
+    // Set the correct size for the segment.
+    if (g_kax_segment->ForceSize(s_out->getFilePointer() - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
+      g_kax_segment->OverwriteHead(*s_out);
 
-  mxinfo(Y(" done\n"));
+    mxinfo(Y(" done\n"));
+  }
 
   // Manually close s_out because cleanup() will discard any remaining
   // write buffer content in s_out.
@@ -357,10 +430,18 @@ add_tags(KaxTag *tags) {
 /** \brief Add an attachment
 
    \param attachment The attachment specification to add
-   \return The attachment UID created for this attachment.
+   \return The attachment UID created for this attachment. 0 if the
+     attachment is added later because the headers of its source file
+     are parsed in another thread.
 */
 int64_t
 add_attachment(attachment_cptr const &attachment) {
+  // The order the attachments are added in determines their IDs.
+  if (auto deferred_actions = mxmsg_capture_c::current()) {
+    deferred_actions->emplace_back([attachment]() { add_attachment(attachment); });
+    return 0;
+  }
+
   // If the attachment is coming from an existing file then we should
   // check if we already have another attachment stored. This can happen
   // if we're concatenating files.
@@ -371,7 +452,7 @@ add_attachment(attachment_cptr const &attachment) {
           ||
           (   (ex_attachment->name             == attachment->name)
            && (ex_attachment->description      == attachment->description)
-           && (ex_attachment->data->get_size() == attachment->data->get_size())
+           && (ex_attachment->get_size()        == attachment->get_size())
            && (ex_attachment->source_file      != attachment->source_file)
            && !attachment->source_file.empty()))
         return attachment->id;
@@ -494,6 +575,22 @@ render_ebml_head(mm_io_c *out) {
   s_head->Render(*out, true);
 }
 
+static bool
+streaming_output_headers_written() {
+  return g_streaming_output && s_out && !s_streaming_sink;
+}
+
+static void
+warn_about_header_changes_in_streaming_output() {
+  static auto s_warning_shown = false;
+
+  if (s_warning_shown)
+    return;
+
+  mxwarn(Y("The headers have changed after they have been written to the streaming output. The changes cannot be applied as the output is not seekable.\n"));
+  s_warning_shown = true;
+}
+
 void
 rerender_ebml_head() {
   mm_io_c *out = g_cluster_helper->get_output();
@@ -501,6 +598,11 @@ rerender_ebml_head() {
   if (!out || !s_head)
     return;
 
+  if (streaming_output_headers_written()) {
+    warn_about_header_changes_in_streaming_output();
+    return;
+  }
+
   out->save_pos(s_head->GetElementPosition());
   render_ebml_head(out);
   out->restore_pos();
@@ -555,10 +657,16 @@ render_headers(mm_io_c *out) {
 
     s_kax_infos = std::make_unique<KaxInfo>();
 
-    s_kax_duration = new KaxMyDuration{ !g_video_packetizer || (TIMECODE_SCALE_MODE_AUTO == g_timecode_scale_mode) ? EbmlFloat::FLOAT_64 : EbmlFloat::FLOAT_32};
+    // The duration is only known at the end. It's left out if it
+    // cannot be filled in then.
+    if (!g_streaming_output) {
+      s_kax_duration = new KaxMyDuration{ !g_video_packetizer || (TIMECODE_SCALE_MODE_AUTO == g_timecode_scale_mode) ? EbmlFloat::FLOAT_64 : EbmlFloat::FLOAT_32};
+
+      s_kax_duration->SetValue(0.0);
+      s_kax_infos->PushElement(*s_kax_duration);
 
-    s_kax_duration->SetValue(0.0);
-    s_kax_infos->PushElement(*s_kax_duration);
+    } else
+      s_kax_duration = nullptr;
 
     if (s_muxing_app.empty()) {
       if (!hack_engaged(ENGAGE_NO_VARIABLE_DATA)) {
@@ -846,6 +954,11 @@ shrink_void_and_rerender_track_headers(int64_t new_void_size) {
 */
 void
 rerender_track_headers() {
+  if (streaming_output_headers_written()) {
+    warn_about_header_changes_in_streaming_output();
+    return;
+  }
+
   g_kax_tracks->UpdateSize(false);
 
   auto position_before    = s_out->getFilePointer();
@@ -879,6 +992,11 @@ rerender_track_headers() {
 
    This function also makes sure that no duplicates are output. This might
    happen when appending files.
+
+   With streaming output the attachments are only created here. They're
+   written directly to the actual output after the headers instead of
+   being buffered in memory along with them; see
+   \c write_streaming_output_headers().
 */
 static void
 render_attachments(IOCallback *out) {
@@ -907,15 +1025,19 @@ render_attachments(IOCallback *out) {
       GetChild<KaxFileName>(kax_a).SetValueUTF8(name);
       GetChild<KaxFileUID >(kax_a).SetValue(attch.id);
 
-      GetChild<KaxFileData>(*kax_a).CopyBuffer(attch.data->get_buffer(), attch.data->get_size());
+      if (attch.data)
+        GetChild<KaxFileData>(*kax_a).CopyBuffer(attch.data->get_buffer(), attch.data->get_size());
+      else
+        kax_a->PushElement(*new KaxStreamedFileData{attch.data_file_name, attch.data_position, attch.data_size});
     }
   }
 
-  if (s_kax_as->ListSize() != 0)
-    s_kax_as->Render(*out);
-  else
+  if (s_kax_as->ListSize() == 0)
     // Delete the kax_as pointer so that it won't be referenced in a seek head.
     s_kax_as.reset();
+
+  else if (!s_streaming_sink)
+    s_kax_as->Render(*out);
 }
 
 /** \brief Check the complete append mapping mechanism
@@ -1146,9 +1268,9 @@ void
 calc_attachment_sizes() {
   // Calculate the size of all attachments for split control.
   for (auto &att : g_attachments) {
-    g_attachment_sizes_first += att->data->get_size();
+    g_attachment_sizes_first += att->get_size();
     if (att->to_all_files)
-      g_attachment_sizes_others += att->data->get_size();
+      g_attachment_sizes_others += att->get_size();
   }
 }
 
@@ -1288,7 +1410,7 @@ add_tags_from_cue_chapters() {
  */
 static void
 render_chapter_void_placeholder() {
-  if ((0 >= s_max_chapter_size) && (chapter_generation_mode_e::none == g_cluster_helper->get_chapter_generation_mode()))
+  if (g_streaming_output || ((0 >= s_max_chapter_size) && (chapter_generation_mode_e::none == g_cluster_helper->get_chapter_generation_mode())))
     return;
 
   auto size           = s_max_chapter_size + (chapter_generation_mode_e::none == g_cluster_helper->get_chapter_generation_mode() ? 100 : 1000);
@@ -1339,7 +1461,17 @@ create_next_output_file() {
 
   // Open the output file.
   try {
-    s_out = !g_cluster_helper->discarding() ? mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024) : mm_io_cptr{ new mm_null_io_c{this_outfile} };
+    if (g_cluster_helper->discarding())
+      s_out = mm_io_cptr{ new mm_null_io_c{this_outfile} };
+
+    else if (g_streaming_output) {
+      auto sink        = this_outfile == "-" ? static_cast<mm_io_c *>(new mm_stdio_c) : new mm_file_io_c{this_outfile, MODE_CREATE};
+      s_streaming_sink = mm_io_cptr{ new mm_write_buffer_io_c{sink, 1024 * 1024} };
+      s_out            = mm_io_cptr{ new mm_mem_io_c{nullptr, 0, 1024 * 1024} };
+
+    } else
+      s_out = mm_write_buffer_io_c::open(this_outfile, 20 * 1024 * 1024);
+
   } catch (mtx::mm_io::exception &ex) {
     mxerror(boost::format(Y("The file '%1%' could not be opened for writing: %2%.\n")) % this_outfile % ex);
   }
@@ -1365,6 +1497,67 @@ create_next_output_file() {
   ++g_file_num;
 }
 
+/** \brief Writes the headers to the streaming output
+
+   With streaming output the headers are rendered into memory first so
+   that the packetizers can still change them until the first cluster
+   is rendered. Then the meta seek element at the front is filled with
+   the elements written so far, the segment size is set to 'unknown',
+   and the headers are written to the actual output. Nothing written to
+   it is modified afterwards.
+
+   The attachments aren't part of the buffered headers. They're copied
+   to the actual output right after them. Their position is therefore
+   known before they're rendered and can be entered into the meta seek
+   element.
+*/
+void
+write_streaming_output_headers() {
+  if (!s_streaming_sink)
+    return;
+
+  auto attachments_position = s_out->getFilePointer();
+
+  if (s_kax_as) {
+    auto seek_id = memory_c::alloc(4);
+    put_uint32_be(seek_id->get_buffer(), EBML_ID(KaxAttachments).GetValue());
+
+    g_kax_sh_main->PushElement(*cons<KaxSeek>(new KaxSeekID,       seek_id,
+                                              new KaxSeekPosition, g_kax_segment->GetRelativePosition(attachments_position)));
+  }
+
+  if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
+    g_kax_sh_main->UpdateSize();
+    if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
+      mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. Size needed: %1%. %2%\n"))
+             % g_kax_sh_main->ElementSize() % BUGMSG);
+  }
+
+  // The segment size has been written with eight bytes. All bits of
+  // the value set means 'unknown'.
+  unsigned char const unknown_size[8] = { 0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+  s_out->save_pos(g_kax_segment->GetElementPosition() + g_kax_segment->HeadSize() - 8);
+  s_out->write(unknown_size, 8);
+  s_out->restore_pos();
+
+  auto headers = static_cast<mm_mem_io_c *>(s_out.get());
+  s_streaming_sink->write(headers->get_buffer(), headers->getFilePointer());
+
+  s_out = s_streaming_sink;
+  s_streaming_sink.reset();
+
+  g_cluster_helper->set_output(s_out.get());
+
+  if (!s_kax_as)
+    return;
+
+  s_kax_as->Render(*s_out);
+
+  if (s_kax_as->GetElementPosition() != attachments_position)
+    mxwarn(boost::format(Y("The attachments were not written at the position entered into the meta seek element. %1%\n")) % BUGMSG);
+}
+
 static void
 add_chapters_for_current_part() {
   auto s_debug = debugging_option_c{"splitting_chapters"};
@@ -1453,7 +1646,8 @@ render_chapters() {
   }
 
   if (!replaced) {
-    s_out->setFilePointer(0, seek_end);
+    if (!g_streaming_output)
+      s_out->setFilePointer(0, seek_end);
     s_chapters_in_this_file->Render(*s_out);
   }
 
@@ -1473,55 +1667,20 @@ set_track_statistics_tags(KaxTags *tags) {
   return tags;
 }
 
-/** \brief Finishes and closes the current file
+/** \brief Updates the segment duration and the segment info
 
-   Renders the data that is generated during the muxing run. The cues
-   and meta seek information are rendered at the end. If splitting is
-   active the chapters are stripped to those that actually lie in this
-   file and rendered at the front.  The segment duration and the
-   segment size are set to their actual values.
+   Fills in the biggest timecode as the file's duration. If splitting
+   is active and this is the last part then handle the 'next segment
+   UID'. If it was given on the command line then set it here.
+   Otherwise remove an existing one (e.g. from file linking during
+   splitting).
 */
-void
-finish_file(bool last_file,
-            bool create_new_file,
-            bool previously_discarding) {
-  if (g_kax_chapters && !previously_discarding)
-    add_chapters_for_current_part();
-
-  if (!last_file && !create_new_file)
-    return;
-
-  run_before_file_finished_packetizer_hooks();
-
-  bool do_output = verbose && !dynamic_cast<mm_null_io_c *>(s_out.get());
-  if (do_output)
-    mxinfo("\n");
-
-  // Render the track headers a second time if the user has requested that.
-  if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
-    auto second_tracks = clone(g_kax_tracks);
-    second_tracks->Render(*s_out);
-    g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
-  }
-
-  // Render the cues.
-  if (g_write_cues && g_cue_writing_requested) {
-    if (do_output)
-      mxinfo(Y("The cue entries (the index) are being written...\n"));
-    cues_c::get().write(*s_out, *g_kax_sh_main);
-  }
-
-  // Now re-render the s_kax_duration and fill in the biggest timecode
-  // as the file's duration.
+static void
+update_duration_and_segment_info(bool last_file) {
   s_out->save_pos(s_kax_duration->GetElementPosition());
   s_kax_duration->SetValue(calculate_file_duration());
   s_kax_duration->Render(*s_out);
 
-  // If splitting is active and this is the last part then handle the
-  // 'next segment UID'. If it was given on the command line then set it here.
-  // Otherwise remove an existing one (e.g. from file linking during
-  // splitting).
-
   s_kax_infos->UpdateSize(true);
   int64_t info_size = s_kax_infos->ElementSize();
   int changed       = 0;
@@ -1561,6 +1720,49 @@ finish_file(bool last_file,
     }
   }
   s_out->restore_pos();
+}
+
+/** \brief Finishes and closes the current file
+
+   Renders the data that is generated during the muxing run. The cues
+   and meta seek information are rendered at the end. If splitting is
+   active the chapters are stripped to those that actually lie in this
+   file and rendered at the front.  The segment duration and the
+   segment size are set to their actual values.
+*/
+void
+finish_file(bool last_file,
+            bool create_new_file,
+            bool previously_discarding) {
+  if (g_kax_chapters && !previously_discarding)
+    add_chapters_for_current_part();
+
+  if (!last_file && !create_new_file)
+    return;
+
+  run_before_file_finished_packetizer_hooks();
+  write_streaming_output_headers();
+
+  bool do_output = verbose && !dynamic_cast<mm_null_io_c *>(s_out.get());
+  if (do_output)
+    mxinfo("\n");
+
+  // Render the track headers a second time if the user has requested that.
+  if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
+    auto second_tracks = clone(g_kax_tracks);
+    second_tracks->Render(*s_out);
+    g_kax_sh_main->IndexThis(*second_tracks, *g_kax_segment);
+  }
+
+  // Render the cues.
+  if (g_write_cues && g_cue_writing_requested) {
+    if (do_output)
+      mxinfo(Y("The cue entries (the index) are being written...\n"));
+    cues_c::get().write(*s_out, *g_kax_sh_main);
+  }
+
+  if (!g_streaming_output)
+    update_duration_and_segment_info(last_file);
 
   // Render the segment info a second time if the user has requested that.
   if (hack_engaged(ENGAGE_WRITE_HEADERS_TWICE)) {
@@ -1615,17 +1817,21 @@ finish_file(bool last_file,
     s_kax_as.reset();
   }
 
-  if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
-    g_kax_sh_main->UpdateSize();
-    if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
-      mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. Size needed: %1%. %2%\n"))
-             % g_kax_sh_main->ElementSize() % BUGMSG);
-  }
+  // With streaming output the meta seek element has been written
+  // along with the headers, and the segment size remains 'unknown'.
+  if (!g_streaming_output) {
+    if ((g_kax_sh_main->ListSize() > 0) && !hack_engaged(ENGAGE_NO_META_SEEK)) {
+      g_kax_sh_main->UpdateSize();
+      if (s_kax_sh_void->ReplaceWith(*g_kax_sh_main, *s_out, true) == INVALID_FILEPOS_T)
+        mxwarn(boost::format(Y("This should REALLY not have happened. The space reserved for the first meta seek element was too small. Size needed: %1%. %2%\n"))
+               % g_kax_sh_main->ElementSize() % BUGMSG);
+    }
 
-  // Set the correct size for the segment.
-  int64_t final_file_size = s_out->getFilePointer();
-  if (g_kax_segment->ForceSize(final_file_size - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
-    g_kax_segment->OverwriteHead(*s_out);
+    // Set the correct size for the segment.
+    int64_t final_file_size = s_out->getFilePointer();
+    if (g_kax_segment->ForceSize(final_file_size - g_kax_segment->GetElementPosition() - g_kax_segment->HeadSize()))
+      g_kax_segment->OverwriteHead(*s_out);
+  }
 
   s_out.reset();
 
@@ -1647,6 +1853,7 @@ force_close_output_file() {
     wb_out->discard_buffer();
 
   s_out.reset();
+  s_streaming_sink.reset();
 }
 
 static void establish_deferred_connections(filelist_t &file);
@@ -2019,6 +2226,56 @@ select_winning_packetizer() {
   return winner;
 }
 
+static bool
+can_seek_in_file(filelist_t const &file) {
+  if (   file.done
+      || file.is_playlist
+      || file.appending
+      || file.appended_to
+      || !file.reader
+      || file.restricted_timecode_min.valid()
+      || file.restricted_timecode_max.valid())
+    return false;
+
+  for (auto ptzr : file.reader->m_reader_packetizers)
+    if (ptzr->are_timestamps_modified())
+      return false;
+
+  return true;
+}
+
+/** \brief Skip data that would be discarded anyway
+
+   When only certain parts are kept with '--split parts:...' then all
+   readers that support it are told to seek to the last key frame
+   before the start of the next range to keep. The data in between is
+   never read. Packets that have already been queued are discarded by
+   the cluster helper as usual.
+*/
+static void
+skip_discarded_range_by_seeking() {
+  static auto s_debug   = debugging_option_c{"split_seeking"};
+  static auto s_skipped = timestamp_c{};
+
+  if (s_appending_files || !g_cluster_helper)
+    return;
+
+  auto range_end = g_cluster_helper->get_discarded_range_end();
+  if (!range_end.valid() || (s_skipped.valid() && (range_end <= s_skipped)))
+    return;
+
+  s_skipped = range_end;
+
+  for (auto &file : g_files) {
+    if (!can_seek_in_file(*file))
+      continue;
+
+    auto seeked = file->reader->seek_to_key_frame_before(range_end);
+
+    mxdebug_if(s_debug, boost::format("skip_discarded_range_by_seeking: file %1% range end %2% seeked? %3%\n") % file->name % format_timestamp(range_end) % seeked);
+  }
+}
+
 static void
 discard_queued_packets() {
   for (auto &ptzr : g_packetizers)
@@ -2037,6 +2294,10 @@ void
 main_loop() {
   // Let's go!
   while (1) {
+    // Step 0: Don't read data that would only be discarded if the
+    // readers can seek to where the next kept part starts.
+    skip_discarded_range_by_seeking();
+
     // Step 1: Make sure a packet is available for each output
     // as long we haven't already processed the last one.
     pull_packetizers_for_packets();
@@ -2079,6 +2340,9 @@ main_loop() {
 
   if (1 <= verbose)
     display_progress(true);
+
+  if (g_latency_target && (1 <= verbose))
+    g_cluster_helper->report_latency();
 }
 
 /** \brief Deletes the file readers and other associated objects
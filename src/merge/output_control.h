@@ -97,6 +97,15 @@ struct attachment_t {
   bool to_all_files{};
   memory_cptr data;
   int64_t ui_id{};
+
+  // Attachments without data in memory are copied from this file
+  // when they're rendered.
+  std::string data_file_name;
+  uint64_t data_position{}, data_size{};
+
+  uint64_t get_size() const {
+    return data ? data->get_size() : data_size;
+  }
 };
 using attachment_cptr = std::shared_ptr<attachment_t>;
 
@@ -172,6 +181,7 @@ extern float g_video_fps;
 extern generic_packetizer_c *g_video_packetizer;
 
 extern bool g_write_cues, g_cue_writing_requested, g_write_date;
+extern bool g_streaming_output;
 extern bool g_no_lacing, g_no_linking, g_use_durations, g_no_track_statistics_tags;
 
 extern bool g_identifying;
@@ -181,10 +191,11 @@ extern int g_file_num;
 extern int64_t g_file_sizes;
 
 extern int64_t g_max_ns_per_cluster;
+extern int64_t g_latency_target;
 extern int g_max_blocks_per_cluster;
 extern int g_default_tracks[3], g_default_tracks_priority[3];
 
-extern int g_split_max_num_files;
+extern int g_split_max_num_files, g_split_max_parallel_parts;
 extern std::string g_splitting_by_chapters_arg;
 
 extern append_mode_e g_append_mode;
@@ -205,6 +216,7 @@ void add_chapter_atom(timestamp_c const &start_timestamp, std::string const &nam
 void create_next_output_file();
 void finish_file(bool last_file, bool create_new_file = false, bool previously_discarding = false);
 void force_close_output_file();
+void write_streaming_output_headers();
 void rerender_track_headers();
 void rerender_ebml_head();
 std::string create_output_name();
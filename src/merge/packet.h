@@ -60,6 +60,7 @@ struct packet_t {
   int64_t timecode, bref, fref, duration, assigned_timecode;
   int64_t timecode_before_factory;
   int64_t unmodified_assigned_timecode, unmodified_duration;
+  int64_t received_at_ms; // wall clock; only set with --latency-target
   boost::optional<uint64_t> uncompressed_size;
   timestamp_c discard_padding, output_order_timecode;
   bool duration_mandatory, superseeded, gap_following, factory_applied;
@@ -81,6 +82,7 @@ struct packet_t {
     , timecode_before_factory{}
     , unmodified_assigned_timecode{}
     , unmodified_duration{}
+    , received_at_ms{}
     , discard_padding{}
     , duration_mandatory{}
     , superseeded{}
@@ -109,6 +111,7 @@ struct packet_t {
     , timecode_before_factory{}
     , unmodified_assigned_timecode{}
     , unmodified_duration{}
+    , received_at_ms{}
     , discard_padding{}
     , duration_mandatory{}
     , superseeded{}
@@ -137,6 +140,7 @@ struct packet_t {
     , timecode_before_factory{}
     , unmodified_assigned_timecode{}
     , unmodified_duration{}
+    , received_at_ms{}
     , discard_padding{}
     , duration_mandatory{}
     , superseeded{}
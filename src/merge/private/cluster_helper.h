@@ -46,10 +46,12 @@ public:
   bool first_video_keyframe_seen{};
   mm_io_c *out{};
 
+  int64_t latency_sum{}, latency_max{}, latency_num_packets{};
+
   std::vector<split_point_c> split_points;
   std::vector<split_point_c>::iterator current_split_point{split_points.begin()};
 
-  bool discarding{}, splitting_and_processed_fully{};
+  bool discarding{}, splitting_and_processed_fully{}, force_many_files{};
 
   chapter_generation_mode_e chapter_generation_mode{chapter_generation_mode_e::none};
   translatable_string_c chapter_generation_name_template{YT("Chapter <NUM:2>")};
@@ -13,6 +13,9 @@
 #include "common/common_pch.h"
 
 // #include "common/logger.h"
+#include "common/list_utils.h"
+#include "common/locale.h"
+#include "common/mm_growing_file_io.h"
 #include "common/mm_mpls_multi_file_io.h"
 #include "common/mm_read_buffer_io.h"
 #include "common/strings/formatting.h"
@@ -56,6 +59,7 @@
 #include "input/r_wavpack.h"
 #include "input/r_webvtt.h"
 #include "merge/filelist.h"
+#include "merge/header_parser.h"
 #include "merge/input_x.h"
 #include "merge/reader_detection_and_creation.h"
 
@@ -69,9 +73,16 @@ file_names_to_paths(const std::vector<std::string> &file_names) {
 }
 
 static mm_io_cptr
-open_input_file(filelist_t &file) {
+open_input_file(filelist_t &file,
+                mm_growing_file_io_c **growing_file = nullptr) {
   try {
-    if (file.all_names.size() == 1)
+    if (growing_file) {
+      // Not buffered: mm_read_buffer_io_c never reads past the size the
+      // file had when its buffer was refilled.
+      *growing_file = new mm_growing_file_io_c(file.name, file.ti->m_follow_growing_file);
+      return mm_io_cptr(*growing_file);
+
+    } else if (file.all_names.size() == 1)
       return mm_io_cptr(new mm_read_buffer_io_c(new mm_file_io_c(file.name), 1 << 17));
 
     else {
@@ -300,126 +311,211 @@ get_file_type(filelist_t &file) {
   file.type     = result.first;
 }
 
+/** \brief Open a source file and instantiate its reader
+
+   The reader's headers are not parsed yet.
+*/
+static void
+create_reader(filelist_t &file,
+              mm_growing_file_io_c *&growing_file) {
+  if (file.ti->m_follow_growing_file && (   file.playlist_mpls_in
+                                         || (file.all_names.size() != 1)
+                                         || !mtx::included_in(file.type, FILE_TYPE_MATROSKA, FILE_TYPE_MPEG_TS))) {
+    mxwarn_fn(file.ti->m_fname, Y("Following a growing file is only supported for single MPEG transport stream and Matroska files. The option '--follow-growing-file' will be ignored.\n"));
+    file.ti->m_follow_growing_file = 0;
+  }
+
+  mm_io_cptr input_file = file.playlist_mpls_in              ? std::static_pointer_cast<mm_io_c>(file.playlist_mpls_in)
+                        : file.ti->m_follow_growing_file ? open_input_file(file, &growing_file)
+                        :                                     open_input_file(file);
+
+  switch (file.type) {
+    case FILE_TYPE_AAC:
+      file.reader.reset(new aac_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_AC3:
+      file.reader.reset(new ac3_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_AVC_ES:
+      file.reader.reset(new avc_es_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_HEVC_ES:
+      file.reader.reset(new hevc_es_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_AVI:
+      file.reader.reset(new avi_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_COREAUDIO:
+      file.reader.reset(new coreaudio_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_DIRAC:
+      file.reader.reset(new dirac_es_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_DTS:
+      file.reader.reset(new dts_reader_c(*file.ti, input_file));
+      break;
+#if defined(HAVE_FLAC_FORMAT_H)
+    case FILE_TYPE_FLAC:
+      file.reader.reset(new flac_reader_c(*file.ti, input_file));
+      break;
+#endif
+    case FILE_TYPE_FLV:
+      file.reader.reset(new flv_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_HDMV_TEXTST:
+      file.reader.reset(new hdmv_textst_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_IVF:
+      file.reader.reset(new ivf_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_MATROSKA:
+      file.reader.reset(new kax_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_MP3:
+      file.reader.reset(new mp3_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_MPEG_ES:
+      file.reader.reset(new mpeg_es_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_MPEG_PS:
+      file.reader.reset(new mpeg_ps_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_MPEG_TS:
+      file.reader.reset(new mtx::mpeg_ts::reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_OGM:
+      file.reader.reset(new ogm_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_PGSSUP:
+      file.reader.reset(new pgssup_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_QTMP4:
+      file.reader.reset(new qtmp4_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_REAL:
+      file.reader.reset(new real_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_SSA:
+      file.reader.reset(new ssa_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_SRT:
+      file.reader.reset(new srt_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_TRUEHD:
+      file.reader.reset(new truehd_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_TTA:
+      file.reader.reset(new tta_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_USF:
+      file.reader.reset(new usf_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_VC1:
+      file.reader.reset(new vc1_es_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_VOBBTN:
+      file.reader.reset(new vobbtn_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_VOBSUB:
+      file.reader.reset(new vobsub_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_WAV:
+      file.reader.reset(new wav_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_WAVPACK4:
+      file.reader.reset(new wavpack_reader_c(*file.ti, input_file));
+      break;
+    case FILE_TYPE_WEBVTT:
+      file.reader.reset(new webvtt_reader_c(*file.ti, input_file));
+      break;
+    default:
+      mxerror(boost::format(Y("EVIL internal bug! (unknown file type). %1%\n")) % BUGMSG);
+      break;
+  }
+}
+
+/** \brief Whether or not a reader's headers can be parsed in another thread
+
+   These readers keep all of their state in the reader object while
+   parsing their headers. They're also the ones that may have to read
+   a lot of data for it: the MPEG TS reader probes a large part of the
+   file, the MP4 reader parses the whole 'moov' or 'moof' atom tree and
+   the Matroska reader searches for cues, chapters and tags.
+*/
+static bool
+can_parse_headers_concurrently(file_type_e type) {
+  return mtx::included_in(type, FILE_TYPE_MATROSKA, FILE_TYPE_MPEG_TS, FILE_TYPE_QTMP4);
+}
+
 /** \brief Creates the file readers
 
    For each file the appropriate file reader class is instantiated.
    The newly created class must read all track information in its
    constructor and throw an exception in case of an error. Otherwise
    it is assumed that the file can be handled.
+
+   The headers of several files are parsed concurrently if possible.
+   All messages are output in the order the files were given in
+   nonetheless.
 */
 void
 create_readers() {
   static auto s_debug_timecode_restrictions = debugging_option_c{"timecode_restrictions"};
+  static auto s_debug_single_threaded       = debugging_option_c{"header_parser_single_threaded"};
+
+  std::vector<header_parser_c::job_t> jobs(g_files.size());
+  std::vector<header_parser_c::job_t *> concurrent_jobs;
+  std::vector<mm_growing_file_io_c *> growing_files(g_files.size(), nullptr);
+
+  // Messages output while opening the files are deferred as well so
+  // that they're output in order with the ones output while parsing
+  // the headers. Reporting an error exits, so the files after the
+  // first one that cannot be opened aren't needed.
+  for (auto idx = 0u; idx < g_files.size(); ++idx) {
+    auto &file = *g_files[idx];
+    auto &job  = jobs[idx];
+
+    mxmsg_capture_c capture{job.m_deferred_actions};
 
-  for (auto &file : g_files) {
     try {
-      mm_io_cptr input_file = file->playlist_mpls_in ? std::static_pointer_cast<mm_io_c>(file->playlist_mpls_in) : open_input_file(*file);
-
-      switch (file->type) {
-        case FILE_TYPE_AAC:
-          file->reader.reset(new aac_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AC3:
-          file->reader.reset(new ac3_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AVC_ES:
-          file->reader.reset(new avc_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_HEVC_ES:
-          file->reader.reset(new hevc_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_AVI:
-          file->reader.reset(new avi_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_COREAUDIO:
-          file->reader.reset(new coreaudio_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_DIRAC:
-          file->reader.reset(new dirac_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_DTS:
-          file->reader.reset(new dts_reader_c(*file->ti, input_file));
-          break;
-#if defined(HAVE_FLAC_FORMAT_H)
-        case FILE_TYPE_FLAC:
-          file->reader.reset(new flac_reader_c(*file->ti, input_file));
-          break;
-#endif
-        case FILE_TYPE_FLV:
-          file->reader.reset(new flv_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_HDMV_TEXTST:
-          file->reader.reset(new hdmv_textst_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_IVF:
-          file->reader.reset(new ivf_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MATROSKA:
-          file->reader.reset(new kax_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MP3:
-          file->reader.reset(new mp3_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_ES:
-          file->reader.reset(new mpeg_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_PS:
-          file->reader.reset(new mpeg_ps_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_MPEG_TS:
-          file->reader.reset(new mtx::mpeg_ts::reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_OGM:
-          file->reader.reset(new ogm_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_PGSSUP:
-          file->reader.reset(new pgssup_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_QTMP4:
-          file->reader.reset(new qtmp4_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_REAL:
-          file->reader.reset(new real_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_SSA:
-          file->reader.reset(new ssa_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_SRT:
-          file->reader.reset(new srt_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_TRUEHD:
-          file->reader.reset(new truehd_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_TTA:
-          file->reader.reset(new tta_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_USF:
-          file->reader.reset(new usf_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VC1:
-          file->reader.reset(new vc1_es_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VOBBTN:
-          file->reader.reset(new vobbtn_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_VOBSUB:
-          file->reader.reset(new vobsub_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WAV:
-          file->reader.reset(new wav_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WAVPACK4:
-          file->reader.reset(new wavpack_reader_c(*file->ti, input_file));
-          break;
-        case FILE_TYPE_WEBVTT:
-          file->reader.reset(new webvtt_reader_c(*file->ti, input_file));
-          break;
-        default:
-          mxerror(boost::format(Y("EVIL internal bug! (unknown file type). %1%\n")) % BUGMSG);
-          break;
-      }
-
-      file->reader->read_headers();
+      create_reader(file, growing_files[idx]);
+      job.m_read_headers = [&file]() { file.reader->read_headers(); };
+
+    } catch (...) {
+      job.m_exception = std::current_exception();
+      break;
+    }
+
+    if (!s_debug_single_threaded && can_parse_headers_concurrently(file.type))
+      concurrent_jobs.push_back(&job);
+  }
+
+  header_parser_c parser{concurrent_jobs, header_parser_c::default_num_threads(concurrent_jobs.size())};
+
+  for (auto idx = 0u; idx < g_files.size(); ++idx) {
+    auto &file = g_files[idx];
+    auto &job  = jobs[idx];
+
+    try {
+      // All threads have stopped before an error is reported as that
+      // exits, and before headers are parsed in this thread as those
+      // readers may access global state.
+      parser.wait_for(job);
+
+      for (auto const &action : job.m_deferred_actions)
+        action();
+
+      if (job.m_exception)
+        std::rethrow_exception(job.m_exception);
+
+      if (!job.m_done)
+        file->reader->read_headers();
+
+      // Only wait for more data once the headers have been parsed.
+      // Probing them must not block at the current end of the file.
+      if (growing_files[idx])
+        growing_files[idx]->enable_following(true);
+
       file->reader->set_timecode_restrictions(file->restricted_timecode_min, file->restricted_timecode_max);
 
       // Re-calculate file size because the reader might switch to a
@@ -14,7 +14,9 @@
 
 #include "common/common_pch.h"
 
+#include "common/binary_timestamps.h"
 #include "common/mm_io.h"
+#include "common/mm_read_buffer_io.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "merge/timestamp_factory.h"
@@ -26,13 +28,24 @@ timestamp_factory_c::create(const std::string &file_name,
   if (file_name.empty())
     return timestamp_factory_cptr{};
 
-  mm_io_c *in = nullptr;           // avoid gcc warning
+  mm_io_cptr in;
+  auto binary = false;
+
   try {
-    in = new mm_text_io_c(new mm_file_io_c(file_name));
+    auto file = new mm_file_io_c(file_name);
+    binary    = mtx::binary_timestamps::probe(*file);
+    in        = binary ? mm_io_cptr{new mm_read_buffer_io_c(file, 128 * 1024)} : mm_io_cptr{new mm_text_io_c(file)};
   } catch(...) {
     mxerror(boost::format(Y("The timecode file '%1%' could not be opened for reading.\n")) % file_name);
   }
 
+  if (binary) {
+    auto factory = timestamp_factory_cptr{new timestamp_factory_v2_c(file_name, source_name, tid, 2, true)};
+    factory->parse(in);
+
+    return factory;
+  }
+
   std::string line;
   int version = -1;
   if (!in->getline2(line) || !balg::istarts_with(line, "# timecode format v") || !parse_number(&line[strlen("# timecode format v")], version))
@@ -52,8 +65,7 @@ timestamp_factory_c::create(const std::string &file_name,
   else
     mxerror(boost::format(Y("The timecode file '%1%' contains an unsupported/unrecognized format (version %2%).\n")) % file_name % version);
 
-  factory->parse(*in);
-  delete in;
+  factory->parse(in);
 
   return timestamp_factory_cptr(factory);
 }
@@ -65,7 +77,7 @@ timestamp_factory_c::create_fps_factory(int64_t default_duration,
 }
 
 void
-timestamp_factory_v1_c::parse(mm_io_c &in) {
+timestamp_factory_v1_c::parse(mm_io_cptr const &in) {
   std::string line;
   timecode_range_c t;
   std::vector<timecode_range_c>::iterator iit;
@@ -73,7 +85,7 @@ timestamp_factory_v1_c::parse(mm_io_c &in) {
 
   int line_no = 1;
   do {
-    if (!in.getline2(line))
+    if (!in->getline2(line))
       mxerror(boost::format(Y("The timecode file '%1%' does not contain a valid 'Assume' line with the default number of frames per second.\n")) % m_file_name);
     line_no++;
     strip(line);
@@ -90,7 +102,7 @@ timestamp_factory_v1_c::parse(mm_io_c &in) {
   if (!parse_number(line.c_str(), m_default_fps))
     mxerror(boost::format(Y("The timecode file '%1%' does not contain a valid 'Assume' line with the default number of frames per second.\n")) % m_file_name);
 
-  while (in.getline2(line)) {
+  while (in->getline2(line)) {
     line_no++;
     strip(line, true);
     if (line.empty() || ('#' == line[0]))
@@ -183,16 +195,60 @@ timestamp_factory_v1_c::get_at(uint64_t frame) {
   return (int64_t)(t->base_timecode + 1000000000.0 * (frame - t->start_frame) / t->fps);
 }
 
+/** \brief Prepare reading the timestamps
+
+   The timestamps are not kept in memory. They are read from the file
+   one by one as the packetizer asks for them.
+
+   Text files are read once up front in order to verify that they're
+   valid and to determine the default duration. Binary files contain
+   both the number of timestamps and the default duration in their
+   header and don't have to be read in advance.
+*/
 void
-timestamp_factory_v2_c::parse(mm_io_c &in) {
+timestamp_factory_v2_c::parse(mm_io_cptr const &in) {
+  m_in = in;
+
+  if (m_binary)
+    parse_binary();
+  else
+    parse_text();
+
+  m_next_timestamp_valid = read_next_timestamp(m_next_timestamp);
+}
+
+void
+timestamp_factory_v2_c::parse_binary() {
+  mtx::binary_timestamps::header_t header;
+
+  if (!mtx::binary_timestamps::read_header(*m_in, header))
+    mxerror(boost::format(Y("The binary timecode file '%1%' is damaged or truncated.\n")) % m_file_name);
+
+  if (!header.num_timestamps)
+    mxerror(boost::format(Y("The timecode file '%1%' does not contain any valid entry.\n")) % m_file_name);
+
+  m_num_timestamps       = header.num_timestamps;
+  m_most_common_duration = header.default_duration;
+  m_first_position       = m_in->getFilePointer();
+
+  if (0 < header.default_duration)
+    m_default_duration = header.default_duration;
+
+  mxdebug_if(m_debug, boost::format("ext_timecodes: binary, %1% entries, default duration %2%\n") % m_num_timestamps % header.default_duration);
+}
+
+void
+timestamp_factory_v2_c::parse_text() {
   std::string line;
   std::map<int64_t, int64_t> dur_map;
 
-  int64_t dur_sum          = 0;
-  int line_no              = 0;
-  double previous_timecode = 0;
+  int line_no                = 0;
+  double previous_timecode   = 0;
+  int64_t previous_timestamp = 0;
+
+  m_first_position = m_in->getFilePointer();
 
-  while (in.getline2(line)) {
+  while (m_in->getline2(line)) {
     line_no++;
     strip(line);
     if ((line.length() == 0) || (line[0] == '#'))
@@ -211,22 +267,19 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
                               "the first timecodes being '0', '40', '80', '120' etc and. not '0', '120', '40', '80' etc.\n\n"
                               "If you really have to specify non-sorted timecodes then use the timecode format v4. "
                               "It is identical to format v2 but allows non-sorted timecodes.\n"))
-              % in.get_file_name());
+              % m_in->get_file_name());
 
     previous_timecode = timecode;
-    m_timecodes.push_back((int64_t)(timecode * 1000000));
-    if (m_timecodes.size() > 1) {
-      int64_t duration = m_timecodes[m_timecodes.size() - 1] - m_timecodes[m_timecodes.size() - 2];
-      if (dur_map.find(duration) == dur_map.end())
-        dur_map[duration] = 1;
-      else
-        dur_map[duration] = dur_map[duration] + 1;
-      dur_sum += duration;
-      m_durations.push_back(duration);
-    }
+    auto timestamp    = static_cast<int64_t>(timecode * 1000000);
+
+    if (m_num_timestamps)
+      ++dur_map[timestamp - previous_timestamp];
+
+    previous_timestamp = timestamp;
+    ++m_num_timestamps;
   }
 
-  if (m_timecodes.empty())
+  if (!m_num_timestamps)
     mxerror(boost::format(Y("The timecode file '%1%' does not contain any valid entry.\n")) % m_file_name);
 
   if (m_debug) {
@@ -235,8 +288,7 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
     mxdebug("----------+---------------------\n");
   }
 
-  dur_sum = -1;
-  std::pair<int64_t, int64_t> entry;
+  int64_t dur_sum = -1;
   for (auto entry : dur_map) {
     if ((0 > dur_sum) || (dur_map[dur_sum] < entry.second))
       dur_sum = entry.first;
@@ -249,54 +301,83 @@ timestamp_factory_v2_c::parse(mm_io_c &in) {
   if (0 < dur_sum)
     m_default_duration = dur_sum;
 
-  m_durations.push_back(dur_sum);
+  m_most_common_duration = dur_sum;
+
+  m_in->setFilePointer(m_first_position);
 }
 
 bool
-timestamp_factory_v2_c::get_next(packet_cptr &packet) {
-  if ((static_cast<size_t>(m_frameno) >= m_timecodes.size()) && !m_warning_printed) {
-    mxwarn_tid(m_source_name, m_tid,
-               boost::format(Y("The number of external timecodes %1% is smaller than the number of frames in this track. "
-                               "The remaining frames of this track might not be timestamped the way you intended them to be. mkvmerge might even crash.\n"))
-               % m_timecodes.size());
-    m_warning_printed = true;
-
-    if (m_timecodes.empty()) {
-      packet->assigned_timecode = 0;
-      if (!m_preserve_duration || (0 >= packet->duration))
-        packet->duration = 0;
+timestamp_factory_v2_c::read_next_timestamp(int64_t &timestamp) {
+  if (m_num_timestamps_read >= m_num_timestamps)
+    return false;
 
-    } else {
-      packet->assigned_timecode = m_timecodes.back();
-      if (!m_preserve_duration || (0 >= packet->duration))
-        packet->duration = m_timecodes.back();
+  try {
+    if (m_binary)
+      timestamp = static_cast<int64_t>(m_in->read_uint64_be());
+
+    else {
+      std::string line;
+      double timecode;
+
+      do {
+        if (!m_in->getline2(line))
+          return false;
+        strip(line);
+      } while (line.empty() || ('#' == line[0]) || !parse_number(line.c_str(), timecode));
+
+      timestamp = static_cast<int64_t>(timecode * 1000000);
+    }
+
+  } catch (mtx::mm_io::exception &) {
+    return false;
+  }
+
+  ++m_num_timestamps_read;
+
+  return true;
+}
+
+bool
+timestamp_factory_v2_c::get_next(packet_cptr &packet) {
+  if (!m_next_timestamp_valid) {
+    if (!m_warning_printed) {
+      mxwarn_tid(m_source_name, m_tid,
+                 boost::format(Y("The number of external timecodes %1% is smaller than the number of frames in this track. "
+                                 "The remaining frames of this track might not be timestamped the way you intended them to be. mkvmerge might even crash.\n"))
+                 % m_num_timestamps);
+      m_warning_printed = true;
     }
 
+    packet->assigned_timecode = m_current_timestamp;
+    if (!m_preserve_duration || (0 >= packet->duration))
+      packet->duration = m_current_timestamp;
+
     return false;
   }
 
-  packet->assigned_timecode = m_timecodes[m_frameno];
+  m_current_timestamp    = m_next_timestamp;
+  m_next_timestamp_valid = read_next_timestamp(m_next_timestamp);
+
+  packet->assigned_timecode = m_current_timestamp;
   if (!m_preserve_duration || (0 >= packet->duration))
-    packet->duration = m_durations[m_frameno];
+    packet->duration = m_next_timestamp_valid ? m_next_timestamp - m_current_timestamp : m_most_common_duration;
   m_frameno++;
 
   return false;
 }
 
 void
-timestamp_factory_v3_c::parse(mm_io_c &in) {
+timestamp_factory_v3_c::parse(mm_io_cptr const &in) {
   std::string line;
-  timecode_duration_c t;
-  std::vector<timecode_duration_c>::iterator iit;
-  std::vector<timecode_duration_c>::const_iterator pit;
 
   std::string err_msg_assume = (boost::format(Y("The timecode file '%1%' does not contain a valid 'Assume' line with the default number of frames per second.\n")) % m_file_name).str();
 
-  int line_no = 1;
+  m_in      = in;
+  m_line_no = 1;
   do {
-    if (!in.getline2(line))
+    if (!m_in->getline2(line))
       mxerror(err_msg_assume);
-    line_no++;
+    m_line_no++;
     strip(line);
     if ((line.length() != 0) && (line[0] != '#'))
       break;
@@ -310,8 +391,22 @@ timestamp_factory_v3_c::parse(mm_io_c &in) {
   if (!parse_number(line.c_str(), m_default_fps))
     mxerror(err_msg_assume);
 
-  while (in.getline2(line)) {
-    line_no++;
+  mxdebug_if(m_debug, boost::format("ext_timecodes: Version 3, default fps %1%\n") % m_default_fps);
+}
+
+/** \brief Read the next valid entry from the file
+
+   The entries are read one at a time while the packets are
+   timestamped. After the last entry an entry with the default FPS and
+   an infinite duration is returned.
+*/
+timecode_duration_c
+timestamp_factory_v3_c::read_next_duration() {
+  std::string line;
+  timecode_duration_c t;
+
+  while (m_in->getline2(line)) {
+    m_line_no++;
     strip(line, true);
     if ((line.length() == 0) || (line[0] == '#'))
       continue;
@@ -336,7 +431,7 @@ timestamp_factory_v3_c::parse(mm_io_c &in) {
         t.fps = m_default_fps;
 
       else if ((2 != parts.size()) || !parse_number(parts[1], t.fps)) {
-        mxwarn(boost::format(Y("Line %1% of the timecode file '%2%' could not be parsed.\n")) % line_no % m_file_name);
+        mxwarn(boost::format(Y("Line %1% of the timecode file '%2%' could not be parsed.\n")) % m_line_no % m_file_name);
         continue;
       }
       t.duration = (int64_t)(1000000000.0 * dur);
@@ -344,55 +439,66 @@ timestamp_factory_v3_c::parse(mm_io_c &in) {
 
     if ((t.fps < 0) || (t.duration <= 0)) {
       mxwarn(boost::format(Y("Line %1% of the timecode file '%2%' contains inconsistent data (e.g. the duration or the FPS are smaller than zero).\n"))
-             % line_no % m_file_name);
+             % m_line_no % m_file_name);
       continue;
     }
 
-    m_durations.push_back(t);
-  }
+    ++m_num_durations;
+    mxdebug_if(m_debug, boost::format("durations:%1% entry for %2% with %3% FPS\n") % (t.is_gap ? " gap" : "") % t.duration % t.fps);
 
-  mxdebug_if(m_debug, boost::format("ext_timecodes: Version 3, default fps %1%, %2% entries.\n") % m_default_fps % m_durations.size());
+    return t;
+  }
 
-  if (m_durations.size() == 0)
+  if (!m_num_durations) {
     mxwarn(boost::format(Y("The timecode file '%1%' does not contain any valid entry.\n")) % m_file_name);
+    m_num_durations = 1;
+  }
 
   t.duration = 0xfffffffffffffffll;
   t.is_gap   = false;
   t.fps      = m_default_fps;
-  m_durations.push_back(t);
 
-  for (iit = m_durations.begin(); iit < m_durations.end(); iit++)
-    mxdebug_if(m_debug, boost::format("durations:%1% entry for %2% with %3% FPS\n") % (iit->is_gap ? " gap" : "") % iit->duration % iit->fps);
+  return t;
+}
+
+timecode_duration_c &
+timestamp_factory_v3_c::get_current_duration() {
+  if (!m_duration_valid) {
+    m_duration       = read_next_duration();
+    m_duration_valid = true;
+  }
+
+  return m_duration;
 }
 
 bool
 timestamp_factory_v3_c::get_next(packet_cptr &packet) {
   bool result = false;
 
-  if (m_durations[m_current_duration].is_gap) {
+  if (get_current_duration().is_gap) {
     // find the next non-gap
-    size_t duration_index = m_current_duration;
-    while (m_durations[duration_index].is_gap || (0 == m_durations[duration_index].duration)) {
-      m_current_offset += m_durations[duration_index].duration;
-      duration_index++;
+    while (get_current_duration().is_gap || (0 == get_current_duration().duration)) {
+      m_current_offset += get_current_duration().duration;
+      m_duration_valid  = false;
     }
-    m_current_duration = duration_index;
-    result             = true;
+    result = true;
     // yes, there is a gap before this frame
   }
 
+  auto &duration = get_current_duration();
+
   packet->assigned_timecode = m_current_offset + m_current_timecode;
   // If default_fps is 0 then the duration is unchanged, usefull for audio.
-  if (m_durations[m_current_duration].fps && (!m_preserve_duration || (0 >= packet->duration)))
-    packet->duration = (int64_t)(1000000000.0 / m_durations[m_current_duration].fps);
+  if (duration.fps && (!m_preserve_duration || (0 >= packet->duration)))
+    packet->duration = (int64_t)(1000000000.0 / duration.fps);
 
   packet->duration   /= packet->time_factor;
   m_current_timecode += packet->duration;
 
-  if (m_current_timecode >= m_durations[m_current_duration].duration) {
-    m_current_offset   += m_durations[m_current_duration].duration;
+  if (m_current_timecode >= duration.duration) {
+    m_current_offset   += duration.duration;
     m_current_timecode  = 0;
-    m_current_duration++;
+    m_duration_valid    = false;
   }
 
   mxdebug_if(m_debug, boost::format("ext_timecodes v3: tc %1% dur %2%\n") % packet->assigned_timecode % packet->duration);
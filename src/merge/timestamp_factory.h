@@ -70,7 +70,7 @@ public:
   virtual ~timestamp_factory_c() {
   }
 
-  virtual void parse(mm_io_c &) {
+  virtual void parse(mm_io_cptr const &) {
   }
   virtual bool get_next(packet_cptr &packet) {
     // No gap is following!
@@ -113,7 +113,7 @@ public:
   virtual ~timestamp_factory_v1_c() {
   }
 
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual double get_default_duration(double proposal) {
     return 0.0 != m_default_fps ? 1000000000.0 / m_default_fps : proposal;
@@ -125,7 +125,11 @@ protected:
 
 class timestamp_factory_v2_c: public timestamp_factory_c {
 protected:
-  std::vector<int64_t> m_timecodes, m_durations;
+  mm_io_cptr m_in;
+  bool m_binary;
+  uint64_t m_num_timestamps, m_num_timestamps_read, m_first_position;
+  int64_t m_current_timestamp, m_next_timestamp, m_most_common_duration;
+  bool m_next_timestamp_valid;
   int64_t m_frameno;
   double m_default_duration;
   bool m_warning_printed;
@@ -133,8 +137,17 @@ protected:
 public:
   timestamp_factory_v2_c(const std::string &file_name,
                         const std::string &source_name,
-                        int64_t tid, int version)
+                        int64_t tid, int version,
+                        bool binary = false)
     : timestamp_factory_c(file_name, source_name, tid, version)
+    , m_binary(binary)
+    , m_num_timestamps(0)
+    , m_num_timestamps_read(0)
+    , m_first_position(0)
+    , m_current_timestamp(0)
+    , m_next_timestamp(0)
+    , m_most_common_duration(0)
+    , m_next_timestamp_valid(false)
     , m_frameno(0)
     , m_default_duration(0)
     , m_warning_printed(false)
@@ -143,17 +156,25 @@ public:
   virtual ~timestamp_factory_v2_c() {
   }
 
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual double get_default_duration(double proposal) {
     return m_default_duration != 0 ? m_default_duration : proposal;
   }
+
+protected:
+  virtual void parse_text();
+  virtual void parse_binary();
+  virtual bool read_next_timestamp(int64_t &timestamp);
 };
 
 class timestamp_factory_v3_c: public timestamp_factory_c {
 protected:
-  std::vector<timecode_duration_c> m_durations;
-  size_t m_current_duration;
+  mm_io_cptr m_in;
+  timecode_duration_c m_duration;
+  bool m_duration_valid;
+  int m_line_no;
+  uint64_t m_num_durations;
   int64_t m_current_timecode;
   int64_t m_current_offset;
   double m_default_fps;
@@ -163,17 +184,23 @@ public:
                         const std::string &source_name,
                         int64_t tid)
     : timestamp_factory_c(file_name, source_name, tid, 3)
-    , m_current_duration(0)
+    , m_duration_valid(false)
+    , m_line_no(0)
+    , m_num_durations(0)
     , m_current_timecode(0)
     , m_current_offset(0)
     , m_default_fps(0.0)
   {
   }
-  virtual void parse(mm_io_c &in);
+  virtual void parse(mm_io_cptr const &in);
   virtual bool get_next(packet_cptr &packet);
   virtual bool contains_gap() {
     return true;
   }
+
+protected:
+  virtual timecode_duration_c &get_current_duration();
+  virtual timecode_duration_c read_next_duration();
 };
 
 class forced_default_duration_timestamp_factory_c: public timestamp_factory_c {
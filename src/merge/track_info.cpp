@@ -38,6 +38,7 @@ track_info_c::track_info_c()
   , m_nalu_size_length{}
   , m_no_chapters{}
   , m_no_global_tags{}
+  , m_follow_growing_file{}
   , m_avi_audio_sync_enabled{}
   , m_avi_audio_data_rate{}
 {
@@ -169,6 +170,8 @@ track_info_c::operator =(const track_info_c &src) {
   m_no_chapters                = src.m_no_chapters;
   m_no_global_tags             = src.m_no_global_tags;
 
+  m_follow_growing_file        = src.m_follow_growing_file;
+
   m_chapter_charset            = src.m_chapter_charset;
   m_chapter_language           = src.m_chapter_language;
 
@@ -353,6 +353,9 @@ public:
 
   bool m_no_chapters, m_no_global_tags;
 
+  // Idle timeout in ms for following a growing file; 0 = don't follow
+  int64_t m_follow_growing_file;
+
   // Some file formats can contain chapters, but for some the charset
   // cannot be identified unambiguously (*cough* OGM *cough*).
   std::string m_chapter_charset, m_chapter_language;
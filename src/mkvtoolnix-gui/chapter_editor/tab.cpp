@@ -375,7 +375,7 @@ Tab::loadFromMatroskaFile() {
 
   d->analyzer = std::make_unique<QtKaxAnalyzer>(this, d->fileName);
 
-  if (!d->analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).set_open_mode(MODE_READ).process()) {
+  if (!d->analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).set_open_mode(MODE_READ).set_use_index_cache(true).process()) {
     auto text = Q("%1 %2")
       .arg(QY("The file you tried to open (%1) could not be read successfully.").arg(d->fileName))
       .arg(QY("Possible reasons are: the file is not a Matroska file; the file is write-protected; the file is locked by another process; you do not have permission to access the file."));
@@ -717,7 +717,7 @@ Tab::saveToMatroskaImpl(bool requireNewFileName) {
 
     if (doRequireNewFileName || (QFileInfo{newFileName}.lastModified() != d->fileModificationTime)) {
       d->analyzer = std::make_unique<QtKaxAnalyzer>(this, newFileName);
-      if (!d->analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).process()) {
+      if (!d->analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).set_use_index_cache(true).process()) {
         auto text = Q("%1 %2")
           .arg(QY("The file you tried to open (%1) could not be read successfully.").arg(newFileName))
           .arg(QY("Possible reasons are: the file is not a Matroska file; the file is write-protected; the file is locked by another process; you do not have permission to access the file."));
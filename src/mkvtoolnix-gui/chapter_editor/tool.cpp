@@ -348,7 +348,7 @@ Tool::removeChaptersFromExistingMatroskaFile() {
 
   auto analyzer = std::make_unique<QtKaxAnalyzer>(this, fileName);
 
-  if (!analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).process()) {
+  if (!analyzer->set_parse_mode(kax_analyzer_c::parse_mode_fast).set_use_index_cache(true).process()) {
     auto text = Q("%1 %2")
       .arg(QY("The file you tried to open (%1) could not be read successfully.").arg(fileName))
       .arg(QY("Possible reasons are: the file is not a Matroska file; the file is write-protected; the file is locked by another process; you do not have permission to access the file."));
@@ -1,12 +1,15 @@
 #include "common/common_pch.h"
 
 #include <QAtomicInt>
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QThreadPool>
 #include <QTimer>
+#include <QtConcurrent>
 
 #include "common/qt.h"
 #include "mkvtoolnix-gui/merge/file_identification_thread.h"
@@ -19,14 +22,25 @@ namespace mtx { namespace gui { namespace Merge {
 class FileIdentificationWorkerPrivate {
   friend class FileIdentificationWorker;
 
+  // The size and modification time of a pre-identified file at the
+  // time it was identified. The result is only used if neither has
+  // changed by the time the file is handled.
+  struct PreIdentifiedFile {
+    std::shared_ptr<Util::FileIdentifier> m_identifier;
+    qint64 m_size;
+    QDateTime m_lastModified;
+  };
+
   struct IdentificationPack {
     QStringList m_fileNames;
     bool m_append;
     QModelIndex m_sourceFileIdx;
     QList<SourceFilePtr> m_identifiedFiles;
+    bool m_preIdentified{};
   };
 
   QList<IdentificationPack> m_toIdentify;
+  QHash<QString, PreIdentifiedFile> m_preIdentifiedFiles;
   QMutex m_mutex;
   QAtomicInteger<bool> m_abortPlaylistScan;
   boost::regex m_simpleChaptersRE, m_xmlChaptersRE, m_xmlSegmentInfoRE, m_xmlTagsRE;
@@ -38,6 +52,25 @@ class FileIdentificationWorkerPrivate {
 
 using namespace mtx::gui;
 
+namespace {
+
+std::shared_ptr<Util::FileIdentifier>
+identifyFile(QString const &fileName) {
+  auto identifier = std::make_shared<Util::FileIdentifier>(fileName);
+  identifier->identify();
+
+  return identifier;
+}
+
+// Runs the identification in the threads of the global thread
+// pool. Each of them talks to its own mkvmerge identification server.
+QList<std::shared_ptr<Util::FileIdentifier>>
+identifyFilesInParallel(QStringList const &fileNames) {
+  return QtConcurrent::blockingMapped<QList<std::shared_ptr<Util::FileIdentifier>>>(fileNames, identifyFile);
+}
+
+}
+
 FileIdentificationWorker::FileIdentificationWorker(QObject *parent)
   : QObject{parent}
   , d_ptr{new FileIdentificationWorkerPrivate{}}
@@ -96,6 +129,7 @@ FileIdentificationWorker::identifyFiles() {
 
   while (true) {
     QString fileName;
+    QStringList fileNames;
 
     {
       QMutexLocker lock{&d->m_mutex};
@@ -115,10 +149,24 @@ FileIdentificationWorker::identifyFiles() {
         emit filesIdentified(pack.m_identifiedFiles, pack.m_append, pack.m_sourceFileIdx);
         d->m_toIdentify.removeFirst();
 
+        // Files that were skipped, e.g. because they were handled as
+        // chapters, don't keep their results for later packs.
+        d->m_preIdentifiedFiles.clear();
+
         continue;
       }
 
-      fileName = pack.m_fileNames.takeFirst();
+      if (!pack.m_preIdentified) {
+        pack.m_preIdentified = true;
+        fileNames            = pack.m_fileNames;
+      } else
+        fileName = pack.m_fileNames.takeFirst();
+    }
+
+    if (!fileNames.isEmpty()) {
+      preIdentifyFiles(fileNames);
+      fileNames.clear();
+      continue;
     }
 
     auto result = identifyThisFile(fileName);
@@ -216,16 +264,29 @@ FileIdentificationWorker::scanPlaylists(QFileInfoList const &files) {
 
   QList<SourceFilePtr> identifiedPlaylists;
 
+  QStringList fileNames;
+  for (auto const &file : files)
+    fileNames << file.filePath();
+
+  // All playlists are queued in the global thread pool at once so that
+  // a single slow playlist doesn't hold up the others. Pending ones are
+  // dropped if the user aborts the scan.
+  auto future = QtConcurrent::mapped(fileNames, identifyFile);
+
   for (auto idx = 0; idx < numFiles; ++idx) {
-    Util::FileIdentifier identifier{files[idx].filePath()};
-    if (identifier.identify())
-      identifiedPlaylists << identifier.file();
+    auto identifier = future.resultAt(idx);
+
+    if (identifier->succeeded())
+      identifiedPlaylists << identifier->file();
     else
-      qDebug() << "the error of my ways" << identifier.errorTitle() << identifier.errorText();
+      qDebug() << "the error of my ways" << identifier->errorTitle() << identifier->errorText();
 
     if (d->m_abortPlaylistScan) {
       qDebug() << "FileIdentificationWorker::scanPlaylists: scan aborted";
 
+      future.cancel();
+      future.waitForFinished();
+
       emit playlistScanFinished();
 
       return Result::Continue;
@@ -255,8 +316,69 @@ FileIdentificationWorker::scanPlaylists(QFileInfoList const &files) {
   return Result::Wait;
 }
 
+/** \brief Identify the files of a pack before they're handled one by one
+
+   Blu-ray index files are skipped as they aren't identified but lead
+   to a playlist scan instead. The results are used by \c
+   identifyThisFile.
+*/
+void
+FileIdentificationWorker::preIdentifyFiles(QStringList const &fileNames) {
+  Q_D(FileIdentificationWorker);
+
+  d->m_preIdentifiedFiles.clear();
+
+  QStringList toIdentify;
+  QList<QFileInfo> infos;
+
+  for (auto const &fileName : fileNames) {
+    // The file's state is recorded before identifying it so that
+    // changes made while it's being identified are noticed, too.
+    auto info = QFileInfo{fileName};
+    if (info.completeSuffix().toLower() == Q("bdmv"))
+      continue;
+
+    toIdentify << fileName;
+    infos      << info;
+  }
+
+  if (toIdentify.count() < 2)
+    return;
+
+  qDebug() << "FileIdentificationWorker::preIdentifyFiles: identifying" << toIdentify.count() << "files in parallel";
+
+  auto identifiers = identifyFilesInParallel(toIdentify);
+  for (auto idx = 0; idx < identifiers.count(); ++idx)
+    d->m_preIdentifiedFiles[toIdentify[idx]] = { identifiers[idx], infos[idx].size(), infos[idx].lastModified() };
+}
+
+/** \brief Return the pre-identified result for a file if it's still valid
+
+   The entry is removed in any case. It is only returned if the file's
+   size and modification time haven't changed since it was identified.
+*/
+std::shared_ptr<Util::FileIdentifier>
+FileIdentificationWorker::takePreIdentifiedFile(QString const &fileName) {
+  Q_D(FileIdentificationWorker);
+
+  if (!d->m_preIdentifiedFiles.contains(fileName))
+    return {};
+
+  auto preIdentified = d->m_preIdentifiedFiles.take(fileName);
+  auto info          = QFileInfo{fileName};
+
+  if ((info.size() == preIdentified.m_size) && (info.lastModified() == preIdentified.m_lastModified))
+    return preIdentified.m_identifier;
+
+  qDebug() << "FileIdentificationWorker::takePreIdentifiedFile: file changed since it was identified:" << fileName;
+
+  return {};
+}
+
 FileIdentificationWorker::Result
 FileIdentificationWorker::identifyThisFile(QString const &fileName) {
+  Q_D(FileIdentificationWorker);
+
   qDebug() << "FileIdentificationWorker::identifyThisFile: starting for" << fileName;
   qDebug() << "FileIdentificationWorker::identifyThisFile: thread ID:" << QThread::currentThreadId();
 
@@ -271,20 +393,23 @@ FileIdentificationWorker::identifyThisFile(QString const &fileName) {
     return *result;
   }
 
-  Util::FileIdentifier identifier{fileName};
-  if (!identifier.identify()) {
+  auto identifier = takePreIdentifiedFile(fileName);
+  if (!identifier)
+    identifier = identifyFile(fileName);
+
+  if (!identifier->succeeded()) {
     qDebug() << "FileIdentificationWorker::identifyThisFile: failed";
-    emit identificationFailed(identifier.errorTitle(), identifier.errorText());
+    emit identificationFailed(identifier->errorTitle(), identifier->errorText());
     return Result::Wait;
   }
 
-  result = handleIdentifiedPlaylist(identifier.file());
+  result = handleIdentifiedPlaylist(identifier->file());
   if (result) {
     qDebug() << "FileIdentificationWorker::identifyThisFile: identified as playlist & handled accordingly";
     return *result;
   }
 
-  addIdentifiedFile(identifier.file());
+  addIdentifiedFile(identifier->file());
 
   return Result::Continue;
 }
@@ -10,7 +10,13 @@
 
 #include "mkvtoolnix-gui/merge/source_file.h"
 
-namespace mtx { namespace gui { namespace Merge {
+namespace mtx { namespace gui {
+
+namespace Util {
+class FileIdentifier;
+}
+
+namespace Merge {
 
 using namespace mtx::gui;
 
@@ -70,6 +76,8 @@ protected:
   bool handleFileThatShouldBeSelectedElsewhere(QString const &fileName);
   boost::optional<FileIdentificationWorker::Result> handleBluRayMainFile(QString const &fileName);
   boost::optional<FileIdentificationWorker::Result> handleIdentifiedPlaylist(SourceFilePtr const &sourceFile);
+  void preIdentifyFiles(QStringList const &fileNames);
+  std::shared_ptr<Util::FileIdentifier> takePreIdentifiedFile(QString const &fileName);
   Result identifyThisFile(QString const &fileName);
 
   Result scanPlaylists(QFileInfoList const &fileNames);
@@ -4,7 +4,10 @@
 #include <QDir>
 #include <QFile>
 #include <QMessageBox>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRegularExpression>
+#include <QSet>
 #include <QStringList>
 
 #include "common/checksums/base_fwd.h"
@@ -16,6 +19,7 @@
 #include "mkvtoolnix-gui/merge/source_file.h"
 #include "mkvtoolnix-gui/util/cache.h"
 #include "mkvtoolnix-gui/util/file_identifier.h"
+#include "mkvtoolnix-gui/util/identification_server.h"
 #include "mkvtoolnix-gui/util/json.h"
 #include "mkvtoolnix-gui/util/process.h"
 #include "mkvtoolnix-gui/util/settings.h"
@@ -39,6 +43,27 @@ class FileIdentifierPrivate {
 
 using namespace mtx::gui;
 
+namespace {
+
+// mkvmerge executables that don't know "--identification-cache",
+// e.g. older versions configured in the preferences.
+QMutex s_withoutIdentificationCacheMutex;
+QSet<QString> s_executablesWithoutIdentificationCache;
+
+bool
+supportsIdentificationCache(QString const &executable) {
+  QMutexLocker lock{&s_withoutIdentificationCacheMutex};
+  return !s_executablesWithoutIdentificationCache.contains(executable);
+}
+
+void
+markAsWithoutIdentificationCache(QString const &executable) {
+  QMutexLocker lock{&s_withoutIdentificationCacheMutex};
+  s_executablesWithoutIdentificationCache << executable;
+}
+
+}
+
 FileIdentifier::FileIdentifier(QString const &fileName)
   : d_ptr{new FileIdentifierPrivate{QDir::toNativeSeparators(fileName)}}
 {
@@ -63,14 +88,56 @@ FileIdentifier::identify() {
 
   auto &cfg = Settings::get();
 
-  auto args = QStringList{} << "--output-charset" << "utf-8" << "--identification-format" << "json" << "--identify" << d->m_fileName;
+  auto args = QStringList{} << "--identification-format" << "json" << "--identify" << d->m_fileName;
 
   addProbeRangePercentageArg(args, cfg.m_probeRangePercentage);
 
   if (cfg.m_defaultAdditionalMergeOptions.contains(Q("keep_last_chapter_in_mpls")))
     args << "--engage" << "keep_last_chapter_in_mpls";
 
-  auto process  = Process::execute(cfg.actualMkvmergeExe(), args);
+  auto executable = cfg.actualMkvmergeExe();
+
+  if (supportsIdentificationCache(executable)) {
+    // Older versions reject the option as it's not a valid argument in
+    // identification mode. It's therefore passed last so that its name
+    // is part of the error message.
+    if (!runMkvmerge(QStringList{args} << "--identification-cache"))
+      return false;
+
+    if ((2 == d->m_exitCode) && d->m_output.join(Q("\n")).contains(Q("--identification-cache"))) {
+      markAsWithoutIdentificationCache(executable);
+
+      if (!runMkvmerge(args))
+        return false;
+    }
+
+  } else if (!runMkvmerge(args))
+    return false;
+
+  d->m_succeeded = parseOutput();
+
+  storeResultInCache();
+
+  setDefaults();
+
+  return d->m_succeeded;
+}
+
+bool
+FileIdentifier::runMkvmerge(QStringList const &args) {
+  Q_D(FileIdentifier);
+
+  auto result = IdentificationServer::forCurrentThread().identify(args, d->m_exitCode, d->m_output);
+
+  if (result == IdentificationServer::Result::Identified)
+    return true;
+
+  if (result == IdentificationServer::Result::TimedOut) {
+    setError(QY("Error executing mkvmerge"), QY("mkvmerge did not respond within %1 seconds while identifying the file.").arg(Settings::get().m_identificationServerTimeout));
+    return false;
+  }
+
+  auto process  = Process::execute(Settings::get().actualMkvmergeExe(), QStringList{} << "--output-charset" << "utf-8" << args);
   d->m_exitCode = process->process().exitCode();
 
   if (process->hasError()) {
@@ -78,12 +145,15 @@ FileIdentifier::identify() {
     return false;
   }
 
-  d->m_output    = process->output();
-  d->m_succeeded = parseOutput();
+  d->m_output = process->output();
 
-  storeResultInCache();
+  return true;
+}
 
-  setDefaults();
+bool
+FileIdentifier::succeeded()
+  const {
+  Q_D(const FileIdentifier);
 
   return d->m_succeeded;
 }
@@ -26,6 +26,7 @@ public:
   virtual ~FileIdentifier();
 
   virtual bool identify();
+  virtual bool succeeded() const;
 
   virtual QString const &fileName() const;
   virtual void setFileName(QString const &fileName);
@@ -43,6 +44,8 @@ public:
   static void cleanAllCacheFiles();
 
 protected:
+  virtual bool runMkvmerge(QStringList const &args);
+
   virtual bool parseOutput();
   virtual void parseAttachment(QVariantMap const &obj);
   virtual void parseChapters(QVariantMap const &obj);
@@ -0,0 +1,154 @@
+#include "common/common_pch.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QRegExp>
+#include <QThreadStorage>
+
+#include "common/json.h"
+#include "common/qt.h"
+#include "mkvtoolnix-gui/util/identification_server.h"
+#include "mkvtoolnix-gui/util/settings.h"
+
+namespace mtx { namespace gui { namespace Util {
+
+namespace {
+
+// How often to check whether the server is still running while
+// waiting for its response.
+int const s_pollInterval = 1000;
+
+}
+
+IdentificationServer::IdentificationServer() {
+}
+
+IdentificationServer::~IdentificationServer() {
+  stop();
+}
+
+bool
+IdentificationServer::start(QString const &executable) {
+  stop();
+
+  m_executable = executable;
+
+  m_process.start(executable, QStringList{} << "--output-charset" << "utf-8" << "--identification-server");
+  if (m_process.waitForStarted(-1))
+    return true;
+
+  qDebug() << "IdentificationServer::start: starting the server failed:" << m_process.errorString();
+
+  m_failed = true;
+
+  return false;
+}
+
+void
+IdentificationServer::stop() {
+  if (m_process.state() == QProcess::NotRunning)
+    return;
+
+  // Closing stdin tells the server to exit.
+  m_process.closeWriteChannel();
+
+  if (!m_process.waitForFinished(1000)) {
+    m_process.kill();
+    m_process.waitForFinished(-1);
+  }
+}
+
+/** \brief Let the server identify a file
+
+   \c args are the arguments for a normal identification run without
+   the ones common to all programs. Returns \c NotAvailable if the
+   server isn't available, e.g. because the configured mkvmerge
+   executable doesn't support the identification server mode. The
+   caller should run mkvmerge for this file directly in that case.
+
+   Identifying large files or files on network shares can take a long
+   time. The server is therefore waited for as long as it is running,
+   unless it doesn't output anything for the configured number of
+   seconds (zero meaning no limit). It is then considered hung, killed
+   and \c TimedOut is returned. Running mkvmerge directly would most
+   likely take just as long, so the caller should report an error.
+*/
+IdentificationServer::Result
+IdentificationServer::identify(QStringList const &args,
+                               int &exitCode,
+                               QStringList &output) {
+  auto executable = Settings::get().actualMkvmergeExe();
+  auto timeout    = static_cast<qint64>(Settings::get().m_identificationServerTimeout) * 1000;
+
+  if (m_failed && (executable == m_executable))
+    return Result::NotAvailable;
+
+  m_failed = false;
+
+  if (   ((m_process.state() == QProcess::NotRunning) || (executable != m_executable))
+      && !start(executable))
+    return Result::NotAvailable;
+
+  auto request = nlohmann::json::array();
+  for (auto const &arg : args)
+    request.push_back(to_utf8(arg));
+
+  m_process.write(QByteArray::fromStdString(mtx::json::dump(request) + "\n"));
+
+  QElapsedTimer waiting;
+  waiting.start();
+
+  while (!m_process.canReadLine()) {
+    if (m_process.waitForReadyRead(s_pollInterval)) {
+      waiting.restart();
+      continue;
+    }
+
+    // A server that exited without responding isn't supported by the
+    // executable.
+    if (m_process.state() == QProcess::NotRunning) {
+      qDebug() << "IdentificationServer::identify: the server exited without responding; error" << m_process.errorString();
+      m_failed = true;
+      return Result::NotAvailable;
+    }
+
+    if (!timeout || (waiting.elapsed() < timeout))
+      continue;
+
+    // One that hangs is killed and started again for the next file.
+    qDebug() << "IdentificationServer::identify: the server did not respond within" << timeout << "ms; killing it";
+
+    m_process.kill();
+    m_process.waitForFinished(-1);
+
+    return Result::TimedOut;
+  }
+
+  try {
+    auto response = mtx::json::parse(m_process.readLine().toStdString());
+    exitCode      = response["exit_code"].get<int>();
+    output        = Q(response["output"].get<std::string>()).split(QRegExp{"\r?\n"});
+
+    return Result::Identified;
+
+  } catch (std::exception const &ex) {
+    qDebug() << "IdentificationServer::identify: invalid response:" << ex.what();
+  }
+
+  stop();
+  m_failed = true;
+
+  return Result::NotAvailable;
+}
+
+IdentificationServer &
+IdentificationServer::forCurrentThread() {
+  static QThreadStorage<IdentificationServer *> s_servers;
+
+  if (!s_servers.hasLocalData())
+    s_servers.setLocalData(new IdentificationServer);
+
+  return *s_servers.localData();
+}
+
+}}}
@@ -0,0 +1,45 @@
+#ifndef MTX_MKVTOOLNIX_GUI_UTIL_IDENTIFICATION_SERVER_H
+#define MTX_MKVTOOLNIX_GUI_UTIL_IDENTIFICATION_SERVER_H
+
+#include "common/common_pch.h"
+
+#include <QProcess>
+#include <QStringList>
+
+namespace mtx { namespace gui { namespace Util {
+
+// A long-running "mkvmerge --identification-server" process. Each
+// thread uses its own instance as QProcess objects cannot be shared
+// between threads. The instances used by the threads of the global
+// thread pool therefore form the pool of servers for identifying
+// files in parallel.
+class IdentificationServer {
+protected:
+  QProcess m_process;
+  QString m_executable;
+  bool m_failed{};
+
+public:
+  enum class Result {
+    Identified,
+    NotAvailable,
+    TimedOut,
+  };
+
+public:
+  IdentificationServer();
+  ~IdentificationServer();
+
+  Result identify(QStringList const &args, int &exitCode, QStringList &output);
+
+protected:
+  bool start(QString const &executable);
+  void stop();
+
+public:
+  static IdentificationServer &forCurrentThread();
+};
+
+}}}
+
+#endif // MTX_MKVTOOLNIX_GUI_UTIL_IDENTIFICATION_SERVER_H
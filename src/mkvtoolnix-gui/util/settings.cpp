@@ -240,6 +240,7 @@ Settings::load() {
 
   m_scanForPlaylistsPolicy             = static_cast<ScanForPlaylistsPolicy>(reg.value("scanForPlaylistsPolicy", static_cast<int>(AskBeforeScanning)).toInt());
   m_minimumPlaylistDuration            = reg.value("minimumPlaylistDuration", 120).toUInt();
+  m_identificationServerTimeout        = reg.value("identificationServerTimeout", 300).toUInt();
 
   m_setAudioDelayFromFileName          = reg.value("setAudioDelayFromFileName", true).toBool();
   m_autoSetFileTitle                   = reg.value("autoSetFileTitle",          true).toBool();
@@ -484,6 +485,7 @@ Settings::save()
 
   reg.setValue("scanForPlaylistsPolicy",             static_cast<int>(m_scanForPlaylistsPolicy));
   reg.setValue("minimumPlaylistDuration",            m_minimumPlaylistDuration);
+  reg.setValue("identificationServerTimeout",        m_identificationServerTimeout);
 
   reg.setValue("setAudioDelayFromFileName",          m_setAudioDelayFromFileName);
   reg.setValue("autoSetFileTitle",                   m_autoSetFileTitle);
@@ -146,7 +146,7 @@ public:
   bool m_uniqueOutputFileNames, m_autoClearOutputFileName;
 
   ScanForPlaylistsPolicy m_scanForPlaylistsPolicy;
-  unsigned int m_minimumPlaylistDuration;
+  unsigned int m_minimumPlaylistDuration, m_identificationServerTimeout;
 
   JobRemovalPolicy m_jobRemovalPolicy;
   bool m_removeOldJobs;
@@ -0,0 +1,308 @@
+/*
+   mkvpropedit -- utility for editing properties of existing Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#include "common/common_pch.h"
+
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <errno.h>
+# include <string.h>
+# include <unistd.h>
+#endif
+
+#include "common/json.h"
+#include "common/mm_io_x.h"
+#include "common/strings/editing.h"
+#include "common/unique_numbers.h"
+#include "propedit/batch.h"
+#include "propedit/propedit_cli_parser.h"
+
+static debugging_option_c s_debug{"propedit_batch"};
+
+static batch_jobs_t
+parse_json_batch_jobs(std::string const &content) {
+  auto json = nlohmann::json{};
+
+  try {
+    json = mtx::json::parse(content);
+  } catch (std::exception const &ex) {
+    throw std::invalid_argument{(boost::format(Y("The JSON job file contains an error: %1%")) % ex.what()).str()};
+  }
+
+  if (!json.is_array())
+    throw std::invalid_argument{Y("The JSON job file must contain an array of jobs.")};
+
+  batch_jobs_t jobs;
+
+  for (auto const &entry : json) {
+    batch_job_t job;
+
+    if (entry.is_string())
+      job.m_file_name = entry.get<std::string>();
+
+    else if (entry.is_object() && entry.count("file") && entry["file"].is_string()) {
+      job.m_file_name = entry["file"].get<std::string>();
+
+      if (entry.count("arguments")) {
+        if (!entry["arguments"].is_array())
+          throw std::invalid_argument{(boost::format(Y("The arguments of the job for '%1%' must be an array of strings.")) % job.m_file_name).str()};
+
+        for (auto const &argument : entry["arguments"]) {
+          if (!argument.is_string())
+            throw std::invalid_argument{(boost::format(Y("The arguments of the job for '%1%' must be an array of strings.")) % job.m_file_name).str()};
+          job.m_arguments.push_back(argument.get<std::string>());
+        }
+      }
+
+    } else
+      throw std::invalid_argument{Y("Each job must either be a file name or an object with the key 'file' and an optional key 'arguments'.")};
+
+    if (job.m_file_name.empty())
+      throw std::invalid_argument{Y("A job without a file name was found.")};
+
+    jobs.push_back(job);
+  }
+
+  return jobs;
+}
+
+/** \brief Parse the content of a batch file
+
+   The content can either be a JSON array or a plain list of file
+   names. Each entry of the JSON array is either a file name or an
+   object with the keys \c file and \c arguments, the latter being the
+   actions to apply to that file in addition to the ones given on the
+   command line. In a plain list each non-empty line not starting with
+   \c # is taken as a file name.
+
+   Throws \c std::invalid_argument if the content is not valid.
+*/
+batch_jobs_t
+parse_batch_jobs(std::string const &content) {
+  auto stripped = strip_copy(content, true);
+
+  if (!stripped.empty() && (stripped[0] == '['))
+    return parse_json_batch_jobs(stripped);
+
+  batch_jobs_t jobs;
+
+  for (auto line : split(normalize_line_endings(content), "\n")) {
+    strip_back(line);
+
+    if (line.empty() || (line[0] == '#') || strip_copy(line).empty())
+      continue;
+
+    jobs.push_back(batch_job_t{line, {}});
+  }
+
+  return jobs;
+}
+
+/** \brief Group the jobs by the file they modify
+
+   All jobs for the same file end up in the same group in the order
+   they were given. Groups are processed by a single worker each so
+   that a file is never modified by two workers at the same time.
+*/
+std::vector<batch_jobs_t>
+group_batch_jobs_by_file(batch_jobs_t const &jobs) {
+  std::vector<batch_jobs_t> groups;
+  std::unordered_map<std::string, std::size_t> group_idx_by_file;
+
+  for (auto const &job : jobs) {
+    // Files that don't exist (yet) are keyed by their canonical
+    // directory so that e.g. "a.mkv" and "./a.mkv" still match.
+    boost::system::error_code ec;
+    auto path = bfs::absolute(bfs::path{job.m_file_name});
+    auto key  = bfs::canonical(path, ec).string();
+
+    if (ec) {
+      auto directory = bfs::canonical(path.parent_path(), ec);
+      key            = ec ? path.string() : (directory / path.filename()).string();
+    }
+
+    auto itr = group_idx_by_file.find(key);
+
+    if (itr != group_idx_by_file.end()) {
+      groups[itr->second].push_back(job);
+      continue;
+    }
+
+    group_idx_by_file[key] = groups.size();
+    groups.push_back(batch_jobs_t{job});
+  }
+
+  return groups;
+}
+
+static void
+run_batch_jobs(options_cptr const &options,
+               batch_jobs_t const &jobs,
+               std::function<void(options_cptr &)> const &runner) {
+  for (auto const &job : jobs) {
+    auto args = options->m_batch_arguments;
+    brng::copy(job.m_arguments, std::back_inserter(args));
+    args.push_back(job.m_file_name);
+
+    mxdebug_if(s_debug, boost::format("propedit_batch: running job for %1% with %2% argument(s)\n") % job.m_file_name % job.m_arguments.size());
+
+    clear_list_of_unique_numbers(UNIQUE_ALL_IDS);
+
+    auto job_options = propedit_cli_parser_c(args).run();
+    if (!job_options->m_batch_file_name.empty())
+      mxerror(Y("'--batch' cannot be used inside a batch job.\n"));
+
+    runner(job_options);
+  }
+}
+
+static void
+report_batch_result(std::string const &file_name,
+                    int exit_code) {
+  if (0 == exit_code)
+    mxinfo(boost::format(Y("'%1%': the file has been processed successfully.\n")) % file_name);
+
+  else if (1 == exit_code)
+    mxinfo(boost::format(Y("'%1%': the file has been processed, but there were warnings.\n")) % file_name);
+
+  else
+    mxinfo(boost::format(Y("'%1%': the file could not be processed.\n")) % file_name);
+}
+
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+/** \brief Process the groups of jobs in child processes
+
+   One child process is forked per file with at most
+   <tt>options->m_batch_num_jobs</tt> of them running at the same
+   time. The child processes use the same code as a single-file run
+   does. An error in one of them therefore only aborts the work on
+   that file. Warnings and errors are prefixed with the file name as
+   the output of several children is interleaved.
+
+   Returns the worst exit code reported by the children.
+*/
+static int
+run_batch_in_child_processes(options_cptr const &options,
+                             std::vector<batch_jobs_t> const &groups,
+                             std::function<void(options_cptr &)> const &runner) {
+  std::unordered_map<pid_t, std::size_t> running;
+  auto exit_code      = 0;
+  auto num_successful = 0u;
+
+  auto wait_for_child = [&]() {
+    int status = 0;
+    auto pid   = waitpid(-1, &status, 0);
+    if (-1 == pid)
+      return;
+
+    auto itr = running.find(pid);
+    if (itr == running.end())
+      return;
+
+    auto child_exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 2;
+    exit_code            = std::max(exit_code, child_exit_code);
+
+    if (2 > child_exit_code)
+      ++num_successful;
+
+    report_batch_result(groups[itr->second][0].m_file_name, child_exit_code);
+    running.erase(itr);
+  };
+
+  // Make sure buffered output isn't written a second time by each child.
+  g_mm_stdio->flush();
+
+  for (auto group_idx = 0u; group_idx < groups.size(); ++group_idx) {
+    while (running.size() >= options->m_batch_num_jobs)
+      wait_for_child();
+
+    auto pid = fork();
+    if (-1 == pid)
+      mxerror(boost::format(Y("Creating a process for the file '%1%' failed: %2%\n")) % groups[group_idx][0].m_file_name % strerror(errno));
+
+    if (0 == pid) {
+      auto const &file_name = groups[group_idx][0].m_file_name;
+
+      g_suppress_info = true;
+
+      set_mxmsg_handler(MXMSG_WARNING, [&file_name](unsigned int, std::string const &warning) {
+        if (g_suppress_warnings)
+          return;
+
+        mxmsg(MXMSG_WARNING, (boost::format(Y("'%1%': %2%")) % file_name % warning).str());
+        g_warning_issued = true;
+      });
+
+      set_mxmsg_handler(MXMSG_ERROR, [&file_name](unsigned int, std::string const &error) {
+        mxmsg(MXMSG_ERROR, (boost::format(Y("'%1%': %2%")) % file_name % error).str());
+        mxexit(2);
+      });
+
+      run_batch_jobs(options, groups[group_idx], runner);
+      mxexit();
+    }
+
+    running[pid] = group_idx;
+  }
+
+  while (!running.empty())
+    wait_for_child();
+
+  mxinfo(boost::format(NY("%1% of %2% file has been processed successfully.\n", "%1% of %2% files have been processed successfully.\n", groups.size())) % num_successful % groups.size());
+
+  return exit_code;
+}
+#endif
+
+/** \brief Apply the jobs from the batch file given with \c --batch
+
+   The jobs for different files are processed in parallel by up to
+   <tt>options->m_batch_num_jobs</tt> worker processes. On systems
+   without \c fork() they're processed one after the other instead. \c runner is called
+   for each job with the options parsed from the arguments given on
+   the command line, the job's own arguments and its file name.
+*/
+void
+run_batch(options_cptr const &options,
+          std::function<void(options_cptr &)> const &runner) {
+  memory_cptr content;
+
+  try {
+    content = mm_file_io_c::slurp(options->m_batch_file_name);
+  } catch (mtx::mm_io::exception &ex) {
+    mxerror(boost::format(Y("The file '%1%' could not be opened for reading: %2%.\n")) % options->m_batch_file_name % ex);
+  }
+
+  batch_jobs_t jobs;
+
+  try {
+    jobs = parse_batch_jobs(std::string{reinterpret_cast<char const *>(content->get_buffer()), content->get_size()});
+  } catch (std::invalid_argument const &ex) {
+    mxerror(boost::format(Y("The batch file '%1%' is invalid: %2%\n")) % options->m_batch_file_name % ex.what());
+  }
+
+  if (jobs.empty())
+    mxerror(boost::format(Y("The batch file '%1%' does not contain any jobs.\n")) % options->m_batch_file_name);
+
+  auto groups = group_batch_jobs_by_file(jobs);
+
+  mxdebug_if(s_debug, boost::format("propedit_batch: %1% job(s) for %2% file(s), %3% worker(s)\n") % jobs.size() % groups.size() % options->m_batch_num_jobs);
+
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+  mxexit(run_batch_in_child_processes(options, groups, runner));
+#endif
+
+  // Without worker processes any error aborts the whole batch.
+  for (auto const &group : groups) {
+    run_batch_jobs(options, group, runner);
+    report_batch_result(group[0].m_file_name, g_warning_issued ? 1 : 0);
+  }
+}
@@ -0,0 +1,30 @@
+/*
+   mkvpropedit -- utility for editing properties of existing Matroska files
+
+   Distributed under the GPL v2
+   see the file COPYING for details
+   or visit http://www.gnu.org/copyleft/gpl.html
+
+   Written by Moritz Bunkus <moritz@bunkus.org>.
+*/
+
+#ifndef MTX_PROPEDIT_BATCH_H
+#define MTX_PROPEDIT_BATCH_H
+
+#include "common/common_pch.h"
+
+#include "propedit/options.h"
+
+struct batch_job_t {
+  std::string m_file_name;
+  std::vector<std::string> m_arguments;
+};
+
+using batch_jobs_t = std::vector<batch_job_t>;
+
+batch_jobs_t parse_batch_jobs(std::string const &content);
+std::vector<batch_jobs_t> group_batch_jobs_by_file(batch_jobs_t const &jobs);
+
+void run_batch(options_cptr const &options, std::function<void(options_cptr &)> const &runner);
+
+#endif // MTX_PROPEDIT_BATCH_H
@@ -10,6 +10,8 @@
 
 #include "common/common_pch.h"
 
+#include <thread>
+
 #include <matroska/KaxChapters.h>
 #include <matroska/KaxTag.h>
 #include <matroska/KaxTags.h>
@@ -23,12 +25,20 @@
 
 options_c::options_c()
   : m_show_progress(false)
+  , m_use_index_cache(false)
   , m_parse_mode(kax_analyzer_c::parse_mode_fast)
+  , m_batch_num_jobs(std::max(std::thread::hardware_concurrency(), 1u))
 {
 }
 
 void
 options_c::validate() {
+  if (!m_batch_file_name.empty()) {
+    if (!m_file_name.empty())
+      mxerror(boost::format(Y("A file name ('%1%') cannot be given together with '--batch'.\n")) % m_file_name);
+    return;
+  }
+
   if (m_file_name.empty())
     mxerror(Y("No file name given.\n"));
 
@@ -127,10 +137,14 @@ options_c::dump_info()
   mxinfo(boost::format("options:\n"
                        "  file_name:     %1%\n"
                        "  show_progress: %2%\n"
-                       "  parse_mode:    %3%\n")
+                       "  parse_mode:    %3%\n"
+                       "  batch_file:    %4%\n"
+                       "  batch_jobs:    %5%\n")
          % m_file_name
          % m_show_progress
-         % static_cast<int>(m_parse_mode));
+         % static_cast<int>(m_parse_mode)
+         % m_batch_file_name
+         % m_batch_num_jobs);
 
   for (auto &target : m_targets)
     target->dump_info();
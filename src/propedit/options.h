@@ -23,8 +23,11 @@ class options_c {
 public:
   std::string m_file_name;
   std::vector<target_cptr> m_targets;
-  bool m_show_progress;
+  bool m_show_progress, m_use_index_cache;
   kax_analyzer_c::parse_mode_e m_parse_mode;
+  std::string m_batch_file_name;
+  std::vector<std::string> m_batch_arguments;
+  unsigned int m_batch_num_jobs;
 
 public:
   options_c();
@@ -20,6 +20,7 @@
 #include "common/mm_io_x.h"
 #include "common/unique_numbers.h"
 #include "common/version.h"
+#include "propedit/batch.h"
 #include "propedit/propedit_cli_parser.h"
 
 static void
@@ -127,6 +128,7 @@ run(options_cptr &options) {
   try {
     ok = analyzer
       ->set_parse_mode(options->m_parse_mode)
+      .set_use_index_cache(options->m_use_index_cache)
       .set_open_mode(MODE_WRITE)
       .set_throw_on_error(true)
       .process();
@@ -157,8 +159,6 @@ run(options_cptr &options) {
 
   } else
     mxinfo(Y("No changes were made.\n"));
-
-  mxexit();
 }
 
 static
@@ -185,7 +185,10 @@ main(int argc,
     options->dump_info();
   }
 
-  run(options);
+  if (!options->m_batch_file_name.empty())
+    run_batch(options, run);
+  else
+    run(options);
 
   mxexit();
 }
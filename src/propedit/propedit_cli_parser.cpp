@@ -14,6 +14,7 @@
 #include "common/common_pch.h"
 
 #include "common/ebml.h"
+#include "common/list_utils.h"
 #include "common/strings/formatting.h"
 #include "common/strings/parsing.h"
 #include "common/translation.h"
@@ -35,6 +36,40 @@ propedit_cli_parser_c::set_parse_mode() {
   }
 }
 
+void
+propedit_cli_parser_c::enable_index_cache() {
+  m_options->m_use_index_cache = true;
+}
+
+void
+propedit_cli_parser_c::set_batch_file_name() {
+  if (!m_options->m_batch_file_name.empty())
+    mxerror(boost::format(Y("'%1%' can only be used once.\n")) % m_current_arg);
+
+  m_options->m_batch_file_name = m_next_arg;
+}
+
+void
+propedit_cli_parser_c::set_batch_num_jobs() {
+  if (!parse_number(m_next_arg, m_options->m_batch_num_jobs) || !m_options->m_batch_num_jobs)
+    mxerror(boost::format(Y("Invalid number of jobs in '%1% %2%'.\n")) % m_current_arg % m_next_arg);
+}
+
+// In batch mode all arguments apart from the batch options themselves
+// are given to each job.
+void
+propedit_cli_parser_c::collect_batch_arguments() {
+  if (m_options->m_batch_file_name.empty())
+    return;
+
+  for (auto idx = 0u, num_args = static_cast<unsigned int>(m_args.size()); idx < num_args; ++idx) {
+    if (mtx::included_in(m_args[idx], "--batch", "--batch-jobs"))
+      ++idx;
+    else
+      m_options->m_batch_arguments.push_back(m_args[idx]);
+  }
+}
+
 void
 propedit_cli_parser_c::add_target() {
   try {
@@ -204,10 +239,16 @@ propedit_cli_parser_c::set_file_name() {
 void
 propedit_cli_parser_c::init_parser() {
   add_information(YT("mkvpropedit [options] <file> <actions>"));
+  add_information(YT("mkvpropedit [options] --batch <batch-file> <actions>"));
 
   add_section_header(YT("Options"));
   OPT("l|list-property-names",      list_property_names, YT("List all valid property names and exit"));
   OPT("p|parse-mode=<mode>",        set_parse_mode,      YT("Sets the Matroska parser mode to 'fast' (default) or 'full'"));
+  OPT("index-cache",                enable_index_cache,  YT("Stores the positions of the file's top level elements in a cache and re-uses them "
+                                                            "as long as the file has not been modified otherwise"));
+  OPT("batch=<file>",               set_batch_file_name, YT("Processes all files listed in 'file' instead of a single file. 'file' is either a list of "
+                                                            "file names or a JSON array of jobs (see man page for syntax)"));
+  OPT("batch-jobs=<n>",             set_batch_num_jobs,  YT("Processes up to n files from the batch file at the same time (default: number of CPUs)"));
 
   add_section_header(YT("Actions for handling properties"));
   OPT("e|edit=<selector>",          add_target,          YT("Sets the Matroska file section that all following add/set/delete "
@@ -282,6 +323,7 @@ propedit_cli_parser_c::run() {
 
   parse_args();
   validate();
+  collect_batch_arguments();
 
   m_options->options_parsed();
   m_options->validate();
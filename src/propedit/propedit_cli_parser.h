@@ -37,6 +37,10 @@ protected:
   void add_tags();
   void add_chapters();
   void set_parse_mode();
+  void enable_index_cache();
+  void set_batch_file_name();
+  void set_batch_num_jobs();
+  void collect_batch_arguments();
   void set_file_name();
 
   void set_attachment_name();
@@ -0,0 +1,56 @@
+#include "common/common_pch.h"
+
+#include "common/binary_timestamps.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<int64_t> const s_timestamps{ 0, 40000000, 80000000, 120000000, 160000000, 200000000 };
+
+TEST(BinaryTimestamps, WriteAndReadHeader) {
+  mm_mem_io_c out{nullptr, 0, 1000};
+  mtx::binary_timestamps::write(out, s_timestamps, 40000000);
+
+  EXPECT_EQ(mtx::binary_timestamps::header_size + s_timestamps.size() * 8, out.get_size());
+  EXPECT_TRUE(mtx::binary_timestamps::probe(out));
+
+  mtx::binary_timestamps::header_t header;
+  ASSERT_TRUE(mtx::binary_timestamps::read_header(out, header));
+  EXPECT_EQ(40000000, header.default_duration);
+  EXPECT_EQ(s_timestamps.size(), header.num_timestamps);
+  EXPECT_EQ(mtx::binary_timestamps::header_size, out.getFilePointer());
+
+  for (auto timestamp : s_timestamps)
+    EXPECT_EQ(timestamp, static_cast<int64_t>(out.read_uint64_be()));
+}
+
+TEST(BinaryTimestamps, TruncatedFile) {
+  mm_mem_io_c out{nullptr, 0, 1000};
+  mtx::binary_timestamps::write(out, s_timestamps, 40000000);
+
+  mm_mem_io_c truncated{out.get_buffer(), out.get_size() - 1};
+  mtx::binary_timestamps::header_t header;
+
+  EXPECT_TRUE(mtx::binary_timestamps::probe(truncated));
+  EXPECT_FALSE(mtx::binary_timestamps::read_header(truncated, header));
+}
+
+TEST(BinaryTimestamps, TextFile) {
+  std::string text{"# timecode format v2\n0\n40\n"};
+  mm_mem_io_c in{reinterpret_cast<unsigned char const *>(text.c_str()), text.length()};
+  mtx::binary_timestamps::header_t header;
+
+  EXPECT_FALSE(mtx::binary_timestamps::probe(in));
+  EXPECT_FALSE(mtx::binary_timestamps::read_header(in, header));
+}
+
+TEST(BinaryTimestamps, DetermineDefaultDuration) {
+  EXPECT_EQ(40000000, mtx::binary_timestamps::determine_default_duration(s_timestamps));
+  EXPECT_EQ(40,       mtx::binary_timestamps::determine_default_duration({ 0, 40, 80, 100, 140 }));
+  EXPECT_EQ(10,       mtx::binary_timestamps::determine_default_duration({ 0, 10, 30 }));
+  EXPECT_EQ(0,        mtx::binary_timestamps::determine_default_duration({ 100 }));
+  EXPECT_EQ(0,        mtx::binary_timestamps::determine_default_duration({}));
+}
+
+}
@@ -0,0 +1,119 @@
+#include "common/common_pch.h"
+
+#include "common/bluray_parse_cache.h"
+#include "common/bluray_util.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct test_parser_c {
+  unsigned int m_parse_run;
+};
+
+class BlurayParseCache: public ::testing::Test {
+protected:
+  bfs::path m_dir;
+  mtx::bluray::parse_cache_c<test_parser_c> m_cache;
+  unsigned int m_num_parsed{};
+
+  virtual void SetUp() override {
+    m_dir = bfs::temp_directory_path() / bfs::unique_path();
+    bfs::create_directories(m_dir / "BDMV" / "CLIPINF");
+    bfs::create_directories(m_dir / "BDMV" / "PLAYLIST");
+    bfs::create_directories(m_dir / "BDMV" / "STREAM");
+  }
+
+  virtual void TearDown() override {
+    boost::system::error_code ec;
+    bfs::remove_all(m_dir, ec);
+  }
+
+  void
+  write_file(bfs::path const &file_name,
+             std::string const &content,
+             std::time_t modification_time = 1000000000) {
+    mm_file_io_c{file_name.string(), MODE_CREATE}.puts(content);
+    bfs::last_write_time(file_name, modification_time);
+  }
+
+  unsigned int
+  get(bfs::path const &file_name) {
+    return m_cache.get(file_name.string(), [this]() { return std::make_shared<test_parser_c>(test_parser_c{ ++m_num_parsed }); })->m_parse_run;
+  }
+};
+
+TEST_F(BlurayParseCache, SecondLookupDoesNotParseAgain) {
+  auto file_name = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+  write_file(file_name, "clip info");
+
+  EXPECT_EQ(1u, get(file_name));
+  EXPECT_EQ(1u, get(file_name));
+  EXPECT_EQ(1u, m_num_parsed);
+}
+
+TEST_F(BlurayParseCache, DifferentSpellingsShareTheEntry) {
+  auto file_name = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+  write_file(file_name, "clip info");
+
+  EXPECT_EQ(1u, get(m_dir / "BDMV" / "PLAYLIST" / ".." / "CLIPINF" / "00001.clpi"));
+  EXPECT_EQ(1u, get(m_dir / "BDMV" / "STREAM"   / ".." / "CLIPINF" / "00001.clpi"));
+  EXPECT_EQ(1u, get(file_name));
+  EXPECT_EQ(1u, m_num_parsed);
+}
+
+TEST_F(BlurayParseCache, ModifiedFilesAreParsedAgain) {
+  auto file_name = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+  write_file(file_name, "clip info");
+  EXPECT_EQ(1u, get(file_name));
+
+  write_file(file_name, "other clip info");
+  EXPECT_EQ(2u, get(file_name));
+
+  write_file(file_name, "other clip info", 1000000001);
+  EXPECT_EQ(3u, get(file_name));
+  EXPECT_EQ(3u, get(file_name));
+}
+
+TEST_F(BlurayParseCache, MissingFilesAreNotCached) {
+  auto file_name = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+
+  EXPECT_EQ(1u, get(file_name));
+  EXPECT_EQ(2u, get(file_name));
+}
+
+#if defined(SYS_UNIX) || defined(SYS_APPLE)
+TEST_F(BlurayParseCache, EntriesAreInheritedByChildProcesses) {
+  auto file_name = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+  write_file(file_name, "clip info");
+
+  // This is what the identification server does: parse in the
+  // long-lived process, use the result in the one created for the
+  // request.
+  get(file_name);
+
+  ::testing::FLAGS_gtest_death_test_style = "fast";
+
+  EXPECT_EXIT({
+    get(file_name);
+    std::exit(m_num_parsed == 1 ? 0 : 1);
+  }, ::testing::ExitedWithCode(0), "");
+}
+#endif
+
+TEST_F(BlurayParseCache, FindOtherFile) {
+  auto m2ts = m_dir / "BDMV" / "STREAM"  / "00001.m2ts";
+  auto clpi = m_dir / "BDMV" / "CLIPINF" / "00001.clpi";
+
+  write_file(m2ts, "stream");
+
+  EXPECT_TRUE(mtx::bluray::find_other_file(m2ts, "clipinf", ".clpi").empty());
+
+  write_file(clpi, "clip info");
+
+  auto found = mtx::bluray::find_other_file(m2ts, "clipinf", ".clpi");
+  ASSERT_FALSE(found.empty());
+  EXPECT_TRUE(bfs::equivalent(clpi, found));
+}
+
+}
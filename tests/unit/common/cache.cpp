@@ -0,0 +1,251 @@
+#include "common/common_pch.h"
+
+#include "common/cache.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class CacheTest: public ::testing::Test {
+protected:
+  bfs::path m_dir;
+
+  virtual void SetUp() override {
+    m_dir = bfs::temp_directory_path() / bfs::unique_path();
+    bfs::create_directories(m_dir);
+  }
+
+  virtual void TearDown() override {
+    boost::system::error_code ec;
+    bfs::remove_all(m_dir, ec);
+  }
+
+  std::vector<std::string>
+  entries()
+    const {
+    std::vector<std::string> names;
+
+    for (bfs::directory_iterator itr{m_dir}, end; itr != end; ++itr)
+      names.emplace_back(itr->path().filename().string());
+
+    std::sort(names.begin(), names.end());
+
+    return names;
+  }
+
+  void
+  set_last_used(std::string const &name,
+                std::time_t last_used) {
+    bfs::last_write_time(m_dir / name, last_used);
+  }
+};
+
+mtx::cache::file_identity_t
+identity(uint64_t size,
+         int64_t modification_time = 1000) {
+  mtx::cache::file_identity_t result;
+
+  result.m_size              = size;
+  result.m_inode             = 42;
+  result.m_modification_time = modification_time;
+
+  return result;
+}
+
+TEST(Cache, Key) {
+  auto relative = std::string{"some_file.mkv"};
+  auto absolute = bfs::absolute(bfs::path{relative}).string();
+  auto key      = mtx::cache::get_cache_key(relative);
+
+  EXPECT_EQ(32u, key.length());
+  EXPECT_EQ(key, mtx::cache::get_cache_key(absolute));
+  EXPECT_EQ(key, mtx::cache::get_cache_key(relative, ""));
+  EXPECT_NE(key, mtx::cache::get_cache_key("other_file.mkv"));
+  EXPECT_NE(key, mtx::cache::get_cache_key(relative, "variant"));
+  EXPECT_NE(mtx::cache::get_cache_key(relative, "variant 1"), mtx::cache::get_cache_key(relative, "variant 2"));
+}
+
+TEST(Cache, FileIdentityRoundTrip) {
+  auto original = identity(123456789, 987654321);
+  auto restored = mtx::cache::file_identity_t::from_json(original.to_json());
+
+  ASSERT_TRUE(!!restored);
+  EXPECT_TRUE(original == *restored);
+  EXPECT_TRUE(original != identity(123456789, 987654322));
+  EXPECT_TRUE(original != identity(123456790, 987654321));
+
+  EXPECT_FALSE(!!mtx::cache::file_identity_t::from_json(nlohmann::json{ { "size", 1 } }));
+}
+
+TEST_F(CacheTest, WriteReplacesEntriesAtomically) {
+  auto name = m_dir / mtx::cache::get_cache_key("file.mkv");
+
+  ASSERT_TRUE(mtx::cache::write(name, nlohmann::json{ { "value", 1 } }));
+  EXPECT_EQ(std::vector<std::string>{ name.filename().string() }, entries());
+
+  auto json = mtx::cache::read(name);
+  ASSERT_TRUE(!!json);
+  EXPECT_EQ(1, json->at("value").get<int>());
+  EXPECT_TRUE(json->count("program_version"));
+
+  ASSERT_TRUE(mtx::cache::write(name, nlohmann::json{ { "value", 2 } }));
+  EXPECT_EQ(std::vector<std::string>{ name.filename().string() }, entries());
+  EXPECT_EQ(2, mtx::cache::read(name)->at("value").get<int>());
+}
+
+TEST_F(CacheTest, WriteFailureLeavesNoTemporaryFiles) {
+  auto name = m_dir / "does_not_exist" / "entry";
+
+  EXPECT_FALSE(mtx::cache::write(name, nlohmann::json{ { "value", 1 } }));
+  EXPECT_TRUE(entries().empty());
+}
+
+TEST_F(CacheTest, ReadIgnoresInvalidEntries) {
+  auto name = m_dir / "entry";
+
+  EXPECT_FALSE(!!mtx::cache::read(name));
+
+  mm_file_io_c{name.string(), MODE_CREATE}.puts("{ not JSON");
+  EXPECT_FALSE(!!mtx::cache::read(name));
+
+  mm_file_io_c{name.string(), MODE_CREATE}.puts("{ \"program_version\": \"mkvmerge v0.0.1 ('Old') 64-bit\" }");
+  EXPECT_FALSE(!!mtx::cache::read(name));
+}
+
+TEST_F(CacheTest, ReadForFileChecksTheIdentity) {
+  auto name = m_dir / "entry";
+
+  ASSERT_TRUE(mtx::cache::write_for_file(name, identity(1000), 1000, nlohmann::json{ { "value", 1 } }));
+
+  auto json = mtx::cache::read_for_file(name, identity(1000));
+  ASSERT_TRUE(!!json);
+  EXPECT_EQ(1, json->at("value").get<int>());
+
+  EXPECT_FALSE(!!mtx::cache::read_for_file(name, identity(1001)));
+  EXPECT_FALSE(!!mtx::cache::read_for_file(name, identity(1000, 1001)));
+
+  ASSERT_TRUE(mtx::cache::write(name, nlohmann::json{ { "value", 1 } }));
+  EXPECT_FALSE(!!mtx::cache::read_for_file(name, identity(1000)));
+}
+
+TEST_F(CacheTest, WriteForFileRequiresResultsForTheWholeFile) {
+  auto name = m_dir / "entry";
+
+  EXPECT_FALSE(mtx::cache::write_for_file(name, identity(1000), 3000, nlohmann::json{ { "value", 1 } }));
+  EXPECT_FALSE(mtx::cache::write_for_file(name, identity(1000),  999, nlohmann::json{ { "value", 1 } }));
+  EXPECT_TRUE(entries().empty());
+
+  EXPECT_TRUE(mtx::cache::write_for_file(name, identity(1000), 1000, nlohmann::json{ { "value", 1 } }));
+  EXPECT_EQ(std::vector<std::string>{ "entry" }, entries());
+}
+
+TEST(Cache, MessagesAreRecordedAndReplayed) {
+  std::vector<std::pair<unsigned int, std::string>> output;
+
+  auto previous_info_handler    = get_mxmsg_handler(MXMSG_INFO);
+  auto previous_warning_handler = get_mxmsg_handler(MXMSG_WARNING);
+  auto capture                  = [&output](unsigned int level, std::string const &message) { output.emplace_back(level, message); };
+
+  set_mxmsg_handler(MXMSG_INFO,    capture);
+  set_mxmsg_handler(MXMSG_WARNING, capture);
+
+  auto messages = nlohmann::json{};
+
+  {
+    mtx::cache::message_recorder_c recorder;
+
+    mxinfo("first\n");
+    mxwarn(std::string{"second\n"});
+    mxinfo("third\n");
+
+    messages = recorder.get_messages();
+  }
+
+  std::vector<std::pair<unsigned int, std::string>> const expected{
+    { MXMSG_INFO,    "first\n"  },
+    { MXMSG_WARNING, "second\n" },
+    { MXMSG_INFO,    "third\n"  },
+  };
+
+  // The messages are passed on while they're being recorded.
+  EXPECT_EQ(expected, output);
+  EXPECT_EQ(3u, messages.size());
+
+  // The previous handlers are active again.
+  output.clear();
+  mxinfo("not recorded\n");
+  EXPECT_EQ(1u, output.size());
+
+  output.clear();
+  mtx::cache::replay_messages(mtx::json::parse(mtx::json::dump(messages)));
+  EXPECT_EQ(expected, output);
+
+  EXPECT_ANY_THROW(mtx::cache::replay_messages(nlohmann::json::array({ nlohmann::json{ { "level", MXMSG_INFO } } })));
+
+  set_mxmsg_handler(MXMSG_INFO,    previous_info_handler);
+  set_mxmsg_handler(MXMSG_WARNING, previous_warning_handler);
+}
+
+TEST_F(CacheTest, TrimRemovesLeastRecentlyUsedEntries) {
+  auto content = nlohmann::json{ { "data", std::string(1000, 'x') } };
+
+  for (auto const &name : std::vector<std::string>{ "a", "b", "c", "d" })
+    ASSERT_TRUE(mtx::cache::write(m_dir / name, content));
+
+  auto entry_size = bfs::file_size(m_dir / "a");
+
+  set_last_used("a", 4000);
+  set_last_used("b", 1000);
+  set_last_used("c", 3000);
+  set_last_used("d", 2000);
+
+  mtx::cache::trim_dir(m_dir, 4 * entry_size);
+  EXPECT_EQ(std::vector<std::string>({ "a", "b", "c", "d", "total_size" }), entries());
+
+  mtx::cache::trim_dir(m_dir, 2 * entry_size + 1);
+  EXPECT_EQ(std::vector<std::string>({ "a", "c", "total_size" }), entries());
+
+  mtx::cache::touch(m_dir / "c");
+  mtx::cache::trim_dir(m_dir, entry_size);
+  EXPECT_EQ(std::vector<std::string>({ "c", "total_size" }), entries());
+}
+
+TEST_F(CacheTest, WriteOnlyTrimsOnceTheLimitIsExceeded) {
+  auto content  = nlohmann::json{ { "data", std::string(1000, 'x') } };
+  auto max_size = uint64_t{10000};
+
+  ASSERT_TRUE(mtx::cache::write(m_dir / "a", content, max_size));
+  EXPECT_EQ(std::vector<std::string>({ "a", "total_size" }), entries());
+
+  auto entry_size = bfs::file_size(m_dir / "a");
+  set_last_used("a", 1000);
+
+  // Files not written via the cache functions aren't noticed until the
+  // directory is scanned again.
+  mm_file_io_c{(m_dir / "unaccounted").string(), MODE_CREATE}.puts(std::string(max_size, 'y'));
+  set_last_used("unaccounted", 2000);
+
+  ASSERT_TRUE(mtx::cache::write(m_dir / "b", content, max_size));
+  EXPECT_EQ(std::vector<std::string>({ "a", "b", "total_size", "unaccounted" }), entries());
+
+  // Replacing an entry doesn't count its old size twice.
+  for (auto idx = 0; idx < 20; ++idx)
+    ASSERT_TRUE(mtx::cache::write(m_dir / "b", content, max_size));
+  EXPECT_EQ(std::vector<std::string>({ "a", "b", "total_size", "unaccounted" }), entries());
+
+  auto num_entries = static_cast<unsigned int>(max_size / entry_size);
+  for (auto idx = 2u; idx < num_entries; ++idx)
+    ASSERT_TRUE(mtx::cache::write(m_dir / (boost::format("e%1%") % idx).str(), content, max_size));
+  EXPECT_EQ(num_entries + 2, entries().size());
+
+  // This one exceeds the limit: the directory is scanned, and the
+  // least recently used entries are removed.
+  ASSERT_TRUE(mtx::cache::write(m_dir / "last", content, max_size));
+
+  auto remaining = entries();
+  EXPECT_FALSE(brng::find(remaining, "a")           != remaining.end());
+  EXPECT_FALSE(brng::find(remaining, "unaccounted") != remaining.end());
+  EXPECT_TRUE( brng::find(remaining, "last")        != remaining.end());
+}
+
+}
@@ -0,0 +1,160 @@
+#include "common/common_pch.h"
+
+#include "common/flac_frame_parser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace mtx::flac;
+
+// Bitwise implementations of the CRCs as described in the FLAC format
+// specification.
+unsigned int
+crc(std::vector<unsigned char> const &data,
+    unsigned int bits,
+    unsigned int polynomial) {
+  auto top_bit = 1u << (bits - 1);
+  auto mask    = (1u << bits) - 1;
+  auto value   = 0u;
+
+  for (auto byte : data) {
+    value ^= static_cast<unsigned int>(byte) << (bits - 8);
+    for (auto bit = 0; bit < 8; ++bit)
+      value = ((value & top_bit) ? (value << 1) ^ polynomial : value << 1) & mask;
+  }
+
+  return value;
+}
+
+// A frame with a fixed block size of 4096 samples, 44.1 kHz, stereo,
+// 16 bits per sample. The "subframes" are filled with payload.
+std::vector<unsigned char>
+create_frame(unsigned int frame_number,
+             std::vector<unsigned char> const &payload) {
+  std::vector<unsigned char> frame{ 0xff, 0xf8, 0xc9, 0x18, static_cast<unsigned char>(frame_number) };
+
+  frame.push_back(crc(frame, 8, 0x07));
+  frame.insert(frame.end(), payload.begin(), payload.end());
+
+  auto crc16 = crc(frame, 16, 0x8005);
+  frame.push_back(crc16 >> 8);
+  frame.push_back(crc16 & 0xff);
+
+  return frame;
+}
+
+std::vector<std::vector<unsigned char>>
+create_frames() {
+  std::vector<std::vector<unsigned char>> frames;
+
+  for (auto frame_number = 0u; frame_number < 20; ++frame_number) {
+    std::vector<unsigned char> payload;
+
+    for (auto idx = 0u; idx < 100 + frame_number * 37; ++idx)
+      payload.push_back(static_cast<unsigned char>(idx * 7 + frame_number));
+
+    frames.push_back(create_frame(frame_number, payload));
+  }
+
+  return frames;
+}
+
+std::vector<std::vector<unsigned char>>
+parse(std::vector<unsigned char> const &stream,
+      std::size_t chunk_size,
+      frame_parser_c &parser) {
+  std::vector<std::vector<unsigned char>> frames;
+
+  for (auto position = 0u; position < stream.size(); position += chunk_size) {
+    parser.add_bytes(&stream[position], std::min<std::size_t>(chunk_size, stream.size() - position));
+
+    while (parser.frame_available()) {
+      auto frame = parser.get_frame();
+      frames.emplace_back(frame->get_buffer(), frame->get_buffer() + frame->get_size());
+    }
+  }
+
+  parser.flush();
+
+  while (parser.frame_available()) {
+    auto frame = parser.get_frame();
+    frames.emplace_back(frame->get_buffer(), frame->get_buffer() + frame->get_size());
+  }
+
+  return frames;
+}
+
+std::vector<unsigned char>
+concatenate(std::vector<std::vector<unsigned char>> const &frames) {
+  std::vector<unsigned char> stream;
+
+  for (auto const &frame : frames)
+    stream.insert(stream.end(), frame.begin(), frame.end());
+
+  return stream;
+}
+
+TEST(FlacFrameParser, FrameHeaders) {
+  auto frame = create_frame(0, { 0x00 });
+
+  EXPECT_EQ(6,  frame_parser_c::get_frame_header_size(frame.data(), frame.size()));
+  EXPECT_EQ(-1, frame_parser_c::get_frame_header_size(frame.data(), 5));
+
+  frame[5] ^= 0x01;
+  EXPECT_EQ(0,  frame_parser_c::get_frame_header_size(frame.data(), frame.size()));
+
+  unsigned char const reserved_sample_rate[] = { 0xff, 0xf8, 0xcf, 0x18, 0x00, 0x00 };
+  EXPECT_EQ(0,  frame_parser_c::get_frame_header_size(reserved_sample_rate, sizeof(reserved_sample_rate)));
+}
+
+TEST(FlacFrameParser, Splitting) {
+  auto frames = create_frames();
+  auto stream = concatenate(frames);
+
+  for (auto chunk_size : std::vector<std::size_t>{ 1, 7, 500, 100000 }) {
+    frame_parser_c parser;
+    EXPECT_EQ(frames, parse(stream, chunk_size, parser)) << chunk_size;
+    EXPECT_EQ(0u, parser.get_garbage_size());
+  }
+}
+
+TEST(FlacFrameParser, SyncCodeInsideFrame) {
+  // The payload contains a valid frame header which must not be
+  // mistaken for the start of the next frame.
+  auto fake_header = create_frame(1, {});
+  fake_header.resize(6);
+
+  std::vector<std::vector<unsigned char>> frames{ create_frame(0, fake_header), create_frame(1, { 1, 2, 3 }) };
+
+  frame_parser_c parser;
+  EXPECT_EQ(frames, parse(concatenate(frames), 3, parser));
+}
+
+TEST(FlacFrameParser, GarbageAndTrailingData) {
+  auto frames = create_frames();
+  auto stream = concatenate(frames);
+
+  stream.insert(stream.begin(), { 'x', 0xff, 'y' });
+  for (auto c : std::string{"TAGtrailing data"})
+    stream.push_back(c);
+
+  frame_parser_c parser;
+  EXPECT_EQ(frames, parse(stream, 64, parser));
+  EXPECT_EQ(3u + 16u, parser.get_garbage_size());
+}
+
+TEST(FlacFrameParser, SeekPoints) {
+  auto frames = create_frames();
+
+  // Damage the second frame's CRC-16. Without a seek point the second
+  // and third frames would be merged.
+  frames[1].back() ^= 0xff;
+
+  frame_parser_c parser;
+  parser.set_seek_point_offsets({ frames[0].size() + frames[1].size() });
+
+  EXPECT_EQ(frames, parse(concatenate(frames), 1000, parser));
+}
+
+}
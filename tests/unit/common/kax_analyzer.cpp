@@ -0,0 +1,194 @@
+#include "common/common_pch.h"
+
+#include <ebml/EbmlVoid.h>
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxInfo.h>
+
+#include "common/cache.h"
+#include "common/kax_analyzer.h"
+#include "common/mm_io.h"
+
+#include "gtest/gtest.h"
+
+using namespace libebml;
+using namespace libmatroska;
+
+namespace {
+
+unsigned char const s_ebml_head[] = {
+  0x1a, 0x45, 0xdf, 0xa3, 0x8b,                         // EBML head
+  0x42, 0x82, 0x88, 'm', 'a', 't', 'r', 'o', 's', 'k', 'a', //   doc type
+};
+
+unsigned char const s_info[] = {
+  0x15, 0x49, 0xa9, 0x66, 0x87,                         // segment info
+  0x2a, 0xd7, 0xb1, 0x83, 0x0f, 0x42, 0x40,             //   timestamp scale
+};
+
+unsigned char const s_cluster[] = {
+  0x1f, 0x43, 0xb6, 0x75, 0x8a,                         // cluster
+  0xe7, 0x81, 0x00,                                     //   cluster timestamp
+  0xa3, 0x85, 0x81, 0x00, 0x00, 0x80, 0xaa,             //   simple block
+};
+
+unsigned char const s_void[] = {
+  0xec, 0x82, 0x00, 0x00,                               // EBML void
+};
+
+class test_kax_analyzer_c: public kax_analyzer_c {
+public:
+  bool m_loaded_from_cache{};
+
+public:
+  test_kax_analyzer_c(std::string const &file_name)
+    : kax_analyzer_c{file_name}
+  {
+  }
+
+  std::vector<std::pair<uint32_t, uint64_t>>
+  get_elements()
+    const {
+    std::vector<std::pair<uint32_t, uint64_t>> elements;
+
+    for (auto const &id : std::vector<EbmlId>{ EBML_ID(KaxInfo), EBML_ID(EbmlVoid), EBML_ID(KaxCluster) })
+      with_elements(id, [&elements](kax_analyzer_data_c const &data) { elements.emplace_back(EBML_ID_VALUE(data.m_id), data.m_pos); });
+
+    brng::sort(elements, [](std::pair<uint32_t, uint64_t> const &a, std::pair<uint32_t, uint64_t> const &b) { return a.second < b.second; });
+
+    return elements;
+  }
+
+protected:
+  virtual bool
+  load_index_cache() override {
+    m_loaded_from_cache = kax_analyzer_c::load_index_cache();
+    return m_loaded_from_cache;
+  }
+};
+
+class KaxAnalyzerIndexCache: public ::testing::Test {
+protected:
+  bfs::path m_dir, m_file_name;
+
+  virtual void SetUp() override {
+    m_dir       = bfs::temp_directory_path() / bfs::unique_path();
+    m_file_name = m_dir / "file.mkv";
+
+    bfs::create_directories(m_dir / "cache");
+    mtx::cache::set_base_dir(m_dir / "cache");
+  }
+
+  virtual void TearDown() override {
+    mtx::cache::set_base_dir({});
+
+    boost::system::error_code ec;
+    bfs::remove_all(m_dir, ec);
+  }
+
+  void
+  write_file(bool with_void,
+             std::time_t modification_time = 1000000000) {
+    std::vector<unsigned char> segment_content;
+
+    segment_content.insert(segment_content.end(), &s_info[0],    &s_info[sizeof(s_info)]);
+    if (with_void)
+      segment_content.insert(segment_content.end(), &s_void[0], &s_void[sizeof(s_void)]);
+    segment_content.insert(segment_content.end(), &s_cluster[0], &s_cluster[sizeof(s_cluster)]);
+
+    unsigned char const segment_head[] = { 0x18, 0x53, 0x80, 0x67, static_cast<unsigned char>(0x80 | segment_content.size()) };
+
+    {
+      mm_file_io_c out{m_file_name.string(), MODE_CREATE};
+
+      out.write(s_ebml_head,            sizeof(s_ebml_head));
+      out.write(segment_head,           sizeof(segment_head));
+      out.write(segment_content.data(), segment_content.size());
+    }
+
+    bfs::last_write_time(m_file_name, modification_time);
+  }
+
+  std::unique_ptr<test_kax_analyzer_c>
+  analyze(kax_analyzer_c::parse_mode_e parse_mode = kax_analyzer_c::parse_mode_full,
+          bool use_index_cache = true) {
+    auto analyzer = std::make_unique<test_kax_analyzer_c>(m_file_name.string());
+
+    EXPECT_TRUE(analyzer->set_parse_mode(parse_mode).set_open_mode(MODE_READ).set_use_index_cache(use_index_cache).process());
+
+    return analyzer;
+  }
+};
+
+TEST_F(KaxAnalyzerIndexCache, UsedForUnmodifiedFiles) {
+  write_file(false);
+
+  auto scanned = analyze();
+  EXPECT_FALSE(scanned->m_loaded_from_cache);
+  EXPECT_EQ(2u, scanned->get_elements().size());
+
+  auto cached = analyze();
+  EXPECT_TRUE(cached->m_loaded_from_cache);
+  EXPECT_EQ(scanned->get_elements(), cached->get_elements());
+}
+
+TEST_F(KaxAnalyzerIndexCache, NotUsedUnlessEnabled) {
+  write_file(false);
+
+  analyze(kax_analyzer_c::parse_mode_full, false);
+  EXPECT_FALSE(analyze()->m_loaded_from_cache);
+  EXPECT_FALSE(analyze(kax_analyzer_c::parse_mode_full, false)->m_loaded_from_cache);
+}
+
+TEST_F(KaxAnalyzerIndexCache, RejectedAfterTheFileHasBeenModified) {
+  write_file(false);
+  auto before = analyze()->get_elements();
+
+  write_file(true);
+
+  auto after = analyze();
+  EXPECT_FALSE(after->m_loaded_from_cache);
+  EXPECT_EQ(3u, after->get_elements().size());
+  EXPECT_NE(before, after->get_elements());
+
+  // The new index has been stored.
+  auto cached = analyze();
+  EXPECT_TRUE(cached->m_loaded_from_cache);
+  EXPECT_EQ(after->get_elements(), cached->get_elements());
+}
+
+TEST_F(KaxAnalyzerIndexCache, RejectedAfterTheModificationTimeHasChanged) {
+  write_file(false, 1000000000);
+  analyze();
+
+  // Same size, same content, only the modification time differs.
+  write_file(false, 1000000001);
+  EXPECT_FALSE(analyze()->m_loaded_from_cache);
+  EXPECT_TRUE(analyze()->m_loaded_from_cache);
+}
+
+TEST_F(KaxAnalyzerIndexCache, RejectedForOtherParseModes) {
+  write_file(false);
+  analyze(kax_analyzer_c::parse_mode_full);
+
+  EXPECT_FALSE(analyze(kax_analyzer_c::parse_mode_fast)->m_loaded_from_cache);
+  EXPECT_TRUE(analyze(kax_analyzer_c::parse_mode_fast)->m_loaded_from_cache);
+  EXPECT_FALSE(analyze(kax_analyzer_c::parse_mode_full)->m_loaded_from_cache);
+}
+
+#if !defined(SYS_WINDOWS)
+TEST_F(KaxAnalyzerIndexCache, RejectedForReplacedFiles) {
+  write_file(false);
+  analyze();
+
+  // A different file with the same name, size and modification time.
+  auto other_name = m_dir / "other.mkv";
+  bfs::copy_file(m_file_name, other_name);
+  bfs::remove(m_file_name);
+  bfs::rename(other_name, m_file_name);
+  bfs::last_write_time(m_file_name, 1000000000);
+
+  EXPECT_FALSE(analyze()->m_loaded_from_cache);
+}
+#endif
+
+}
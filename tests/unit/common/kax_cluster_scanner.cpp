@@ -0,0 +1,99 @@
+#include "common/common_pch.h"
+
+#include "common/kax_cluster_scanner.h"
+#include "common/mm_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+unsigned char const s_cluster_content[] = {
+  0xe7, 0x81, 0x0a,                                     // cluster timestamp 10
+  0xa3, 0x86, 0x81, 0x00, 0x05, 0x80, 0xaa, 0xbb,       // simple block, track 1, +5, key frame
+  0xa0, 0x8e,                                           // block group
+  0xa1, 0x86, 0x82, 0xff, 0xfe, 0x00, 0xcc, 0xdd,       //   block, track 2, -2
+  0x9b, 0x81, 0x14,                                     //   block duration 20
+  0xfb, 0x81, 0xff,                                     //   reference block
+  0xa3, 0x89, 0x81, 0x00, 0x06, 0x02, 0x01, 0x02, 0x11, 0x22, 0x33, // simple block, track 1, +6, Xiph lacing with two frames
+};
+
+unsigned char const s_cues[] = { 0x1c, 0x53, 0xbb, 0x6b, 0x80 };
+
+std::vector<unsigned char>
+create_file(bool unknown_size) {
+  std::vector<unsigned char> file{ 0x1f, 0x43, 0xb6, 0x75, static_cast<unsigned char>(unknown_size ? 0xff : 0x80 | sizeof(s_cluster_content)) };
+
+  file.insert(file.end(), &s_cluster_content[0], &s_cluster_content[sizeof(s_cluster_content)]);
+  file.insert(file.end(), &s_cues[0],            &s_cues[sizeof(s_cues)]);
+
+  return file;
+}
+
+std::vector<kax_cluster_scanner_c::block_t>
+scan(std::vector<unsigned char> const &file,
+     boost::optional<uint64_t> &next_position) {
+  std::vector<kax_cluster_scanner_c::block_t> blocks;
+  mm_mem_io_c in{file.data(), file.size()};
+
+  next_position = kax_cluster_scanner_c{in, 1000000, file.size()}.scan_clusters(0, [&blocks](kax_cluster_scanner_c::block_t const &block) { blocks.push_back(block); });
+
+  return blocks;
+}
+
+void
+check_blocks(std::vector<kax_cluster_scanner_c::block_t> const &blocks) {
+  ASSERT_EQ(3u, blocks.size());
+
+  EXPECT_TRUE(blocks[0].m_is_simple_block);
+  EXPECT_TRUE(blocks[0].m_is_key);
+  EXPECT_EQ(8u,         blocks[0].m_position);
+  EXPECT_EQ(1u,         blocks[0].m_track_number);
+  EXPECT_EQ(15000000,   blocks[0].m_timestamp);
+  EXPECT_EQ(1u,         blocks[0].m_num_frames);
+  EXPECT_EQ(2u,         blocks[0].m_frame_bytes);
+
+  EXPECT_FALSE(blocks[1].m_is_simple_block);
+  EXPECT_EQ(2u,         blocks[1].m_track_number);
+  EXPECT_EQ(8000000,    blocks[1].m_timestamp);
+  EXPECT_EQ(1u,         blocks[1].m_num_references);
+  ASSERT_TRUE(!!blocks[1].m_duration);
+  EXPECT_EQ(20000000,   *blocks[1].m_duration);
+  EXPECT_EQ(2u,         blocks[1].m_frame_bytes);
+
+  EXPECT_FALSE(blocks[2].m_is_key);
+  EXPECT_EQ(16000000,   blocks[2].m_timestamp);
+  EXPECT_EQ(2u,         blocks[2].m_num_frames);
+  EXPECT_EQ(3u,         blocks[2].m_frame_bytes);
+}
+
+TEST(KaxClusterScanner, KnownSize) {
+  boost::optional<uint64_t> next_position;
+  auto file   = create_file(false);
+  auto blocks = scan(file, next_position);
+
+  check_blocks(blocks);
+  ASSERT_TRUE(!!next_position);
+  EXPECT_EQ(file.size() - sizeof(s_cues), *next_position);
+}
+
+TEST(KaxClusterScanner, UnknownSize) {
+  boost::optional<uint64_t> next_position;
+  auto file   = create_file(true);
+  auto blocks = scan(file, next_position);
+
+  check_blocks(blocks);
+  ASSERT_TRUE(!!next_position);
+  EXPECT_EQ(file.size() - sizeof(s_cues), *next_position);
+}
+
+TEST(KaxClusterScanner, Invalid) {
+  boost::optional<uint64_t> next_position;
+  auto file = create_file(false);
+
+  file[4] = 0x80 | (sizeof(s_cluster_content) + 10);
+  scan(file, next_position);
+
+  EXPECT_FALSE(!!next_position);
+}
+
+}
@@ -0,0 +1,72 @@
+#include "common/common_pch.h"
+
+#include <matroska/KaxCluster.h>
+#include <matroska/KaxClusterData.h>
+
+#include "common/ebml.h"
+#include "common/kax_file.h"
+#include "common/mm_io.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+void
+add_cluster(std::vector<unsigned char> &file,
+            unsigned char timecode) {
+  file.insert(file.end(), { 0x1f, 0x43, 0xb6, 0x75, 0x83, 0xe7, 0x81, timecode });
+}
+
+std::vector<unsigned char>
+create_damaged_file(std::size_t num_garbage_bytes) {
+  std::vector<unsigned char> file(num_garbage_bytes, 0x42);
+
+  // A cluster ID with an empty cluster directly in front of valid
+  // clusters. Only the missing timecode gives it away.
+  file.insert(file.end(), { 0x1f, 0x43, 0xb6, 0x75, 0x80 });
+
+  for (auto timecode = 1; 5 > timecode; ++timecode)
+    add_cluster(file, timecode);
+
+  file.insert(file.end(), { 0x1c, 0x53, 0xbb, 0x6b, 0x80 }); // cues
+
+  return file;
+}
+
+void
+check_resync(std::size_t num_garbage_bytes) {
+  auto file = create_damaged_file(num_garbage_bytes);
+  mm_mem_io_c in{file.data(), file.size()};
+  kax_file_c kax_file{in};
+
+  kax_file.enable_reporting(false);
+
+  auto cluster = std::unique_ptr<KaxCluster>{kax_file.resync_to_cluster()};
+
+  ASSERT_TRUE(!!cluster);
+  EXPECT_TRUE(kax_file.was_resynced());
+  EXPECT_EQ(num_garbage_bytes + 5, cluster->GetElementPosition());
+  EXPECT_EQ(1u, FindChildValue<KaxClusterTimecode>(cluster.get()));
+}
+
+TEST(KaxFile, ResyncRejectsClustersWithoutTimecode) {
+  check_resync(100);
+}
+
+TEST(KaxFile, ResyncAcrossWindowBoundaries) {
+  // The candidates are located right at the end of the first search
+  // window.
+  check_resync(1024 * 1024 - 20);
+}
+
+TEST(KaxFile, ResyncFailsWithoutClusters) {
+  std::vector<unsigned char> file(1000, 0x42);
+  mm_mem_io_c in{file.data(), file.size()};
+  kax_file_c kax_file{in};
+
+  kax_file.enable_reporting(false);
+
+  EXPECT_TRUE(!kax_file.resync_to_cluster());
+}
+
+}
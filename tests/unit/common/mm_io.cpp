@@ -1,9 +1,15 @@
 #include "common/common_pch.h"
 
+#include <chrono>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "tests/unit/util.h"
 
+#include "common/fs_sys_helpers.h"
+#include "common/mm_growing_file_io.h"
 #include "common/mm_io_x.h"
+#include "common/mm_write_buffer_io.h"
 
 namespace {
 
@@ -16,4 +22,187 @@ TEST(MmIo, Slurp) {
   ASSERT_THROW(mm_file_io_c::slurp("doesnotexist"), mtx::mm_io::exception);
 }
 
+std::vector<std::string>
+read_lines(std::string const &content) {
+  std::vector<std::string> lines;
+  mm_text_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.data()), content.size()}};
+
+  while (!in.eof())
+    lines.push_back(in.getline());
+
+  return lines;
+}
+
+TEST(MmTextIo, LineEndings) {
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "three" }), read_lines("one\ntwo\n\nthree"));
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "three" }), read_lines("one\r\ntwo\r\n\r\nthree\r\n"));
+  EXPECT_EQ((std::vector<std::string>{ "one", "two", "", "three" }), read_lines("one\rtwo\r\rthree\r"));
+}
+
+TEST(MmTextIo, Utf8AndUtf16) {
+  EXPECT_EQ((std::vector<std::string>{ "ä b", "c" }), read_lines("\xef\xbb\xbf\xc3\xa4 b\nc\n"));
+  EXPECT_EQ((std::vector<std::string>{ "ä", "b" }),   read_lines(std::string{"\xff\xfe\xe4\x00\x0a\x00\x62\x00\x0a\x00", 10}));
+}
+
+TEST(MmTextIo, LinesCrossingTheBuffer) {
+  auto long_line = std::string(100000, 'x');
+  auto lines     = read_lines(std::string{"first\r\n"} + long_line + "\r\n" + long_line + "y\r\nlast");
+
+  ASSERT_EQ(4u, lines.size());
+  EXPECT_EQ("first",         lines[0]);
+  EXPECT_EQ(long_line,       lines[1]);
+  EXPECT_EQ(long_line + "y", lines[2]);
+  EXPECT_EQ("last",          lines[3]);
+}
+
+std::string
+create_data(std::size_t size,
+            char first) {
+  std::string data(size, first);
+
+  for (auto idx = 0u; idx < size; ++idx)
+    data[idx] = first + (idx % 26);
+
+  return data;
+}
+
+TEST(MmWriteBufferIo, Writev) {
+  auto small  = create_data(10,          'a');
+  auto medium = create_data(100,         'A');
+  auto large  = create_data(3000000,     'a');
+
+  mm_mem_io_c mem{nullptr, 0, 1000};
+  auto expected = std::string{};
+
+  {
+    mm_write_buffer_io_c out{&mem, 256, false};
+
+    auto write = [&out, &expected](std::initializer_list<std::string const *> pieces) {
+      std::vector<mm_io_c::iovec_t> iovecs;
+      for (auto piece : pieces) {
+        iovecs.push_back({ piece->data(), piece->size() });
+        expected += *piece;
+      }
+
+      auto expected_written = expected.size() - out.getFilePointer();
+      EXPECT_EQ(expected_written, out.writev(iovecs.data(), iovecs.size()));
+      EXPECT_EQ(expected.size(), out.getFilePointer());
+    };
+
+    write({ &small, &medium });                 // fits into the buffer
+    write({ &medium, &small, &medium });        // overflows the buffer, small tail stays buffered
+    write({ &large, &small });                  // large piece written directly
+    write({ &small, &large, &medium, &large }); // mixed
+    out.write(medium.data(), medium.size());
+    expected += medium;
+    out.write(large.data(), large.size());
+    expected += large;
+  }
+
+  ASSERT_EQ(expected.size(), mem.get_size());
+  EXPECT_TRUE(!memcmp(expected.data(), mem.get_buffer(), expected.size()));
+}
+
+TEST(MmFileIo, Writev) {
+  auto file_name = (bfs::temp_directory_path() / bfs::unique_path()).string();
+  auto header    = create_data(4,      'a');
+  auto payload   = create_data(200000, 'A');
+  auto expected  = header + header + payload + header;
+
+  {
+    mm_file_io_c out{file_name, MODE_CREATE};
+
+    out.write(header.data(), header.size());
+    EXPECT_EQ(header.size() + payload.size(), out.writev({ { header.data(), header.size() }, { payload.data(), payload.size() } }));
+    EXPECT_EQ(2 * header.size() + payload.size(), out.getFilePointer());
+
+    out.write(header.data(), header.size());
+    out.setFilePointer(0);
+    out.write(header.data(), header.size());
+    out.setFilePointer(0, seek_end);
+    EXPECT_EQ(expected.size(), out.getFilePointer());
+  }
+
+  auto content = mm_file_io_c::slurp(file_name);
+  bfs::remove(file_name);
+
+  EXPECT_EQ(expected, content);
+}
+
+TEST(MmGrowingFileIo, Following) {
+  auto file_name = (bfs::temp_directory_path() / bfs::unique_path()).string();
+  std::ofstream writer{file_name, std::ios::binary};
+
+  writer << "abc" << std::flush;
+
+  std::string content;
+
+  {
+    // Not following yet: reads at the end of the file return at once
+    // even with a long idle timeout.
+    mm_growing_file_io_c in{file_name, 10000};
+
+    auto start = mtx::sys::get_current_time_millis();
+    EXPECT_EQ(3u,    in.read(content, 10));
+    EXPECT_EQ("abc", content);
+    EXPECT_LT(mtx::sys::get_current_time_millis() - start, 5000);
+
+    // Following: a read at the end of the file waits for the data
+    // appended by another thread.
+    in.setFilePointer(3);
+    in.enable_following(true);
+
+    auto appender = std::thread{[&writer]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      writer << "def" << std::flush;
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      writer << "gh" << std::flush;
+    }};
+
+    EXPECT_EQ(5u,      in.read(content, 5));
+    EXPECT_EQ("defgh", content);
+
+    appender.join();
+
+    in.enable_following(false);
+    EXPECT_EQ(8, in.get_size());
+  }
+
+  {
+    // Reads return short once the file hasn't grown for the idle
+    // timeout.
+    mm_growing_file_io_c in{file_name, 300};
+
+    in.setFilePointer(6);
+    in.enable_following(true);
+
+    auto start = mtx::sys::get_current_time_millis();
+    EXPECT_EQ(2u,   in.read(content, 10));
+    EXPECT_EQ("gh", content);
+    EXPECT_GE(mtx::sys::get_current_time_millis() - start, 300);
+  }
+
+  writer.close();
+  bfs::remove(file_name);
+}
+
+TEST(MmTextIo, Positioning) {
+  std::string content{"\xef\xbb\xbf" "abc\ndef\nghi\n"};
+  mm_text_io_c in{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(content.data()), content.size()}};
+
+  EXPECT_EQ("abc", in.getline());
+  EXPECT_EQ(7u,    in.getFilePointer());
+  EXPECT_EQ("de",  in.getline(2));
+  EXPECT_EQ(9u,    in.getFilePointer());
+  EXPECT_EQ("f",   in.getline());
+
+  in.setFilePointer(0);
+  EXPECT_EQ(3u,    in.getFilePointer());
+  EXPECT_EQ("abc", in.getline());
+
+  in.setFilePointer(-4, seek_end);
+  EXPECT_EQ("ghi", in.getline());
+  EXPECT_TRUE(in.eof());
+}
+
 }
@@ -0,0 +1,123 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "common/mpeg.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::size_t>
+find_start_codes_naively(std::vector<unsigned char> const &buffer) {
+  std::vector<std::size_t> positions;
+
+  for (auto pos = std::size_t{2}; pos < buffer.size(); ++pos)
+    if (!buffer[pos - 2] && !buffer[pos - 1] && (1 == buffer[pos]))
+      positions.push_back(pos - 2);
+
+  return positions;
+}
+
+std::vector<unsigned char>
+to_rbsp(std::vector<unsigned char> const &nalu) {
+  auto rbsp = mtx::mpeg::nalu_to_rbsp(memory_c::clone(nalu.data(), nalu.size()));
+  return std::vector<unsigned char>(rbsp->get_buffer(), rbsp->get_buffer() + rbsp->get_size());
+}
+
+TEST(Mpeg, FindStartCodesSmallBuffers) {
+  std::vector<unsigned char> buffer{ 0x00, 0x00, 0x01, 0x65, 0x00, 0x00, 0x00, 0x01, 0x41, 0x00, 0x00, 0x01 };
+
+  EXPECT_EQ(std::vector<std::size_t>({ 0, 5, 9 }), mtx::mpeg::find_start_codes(buffer.data(), buffer.size()));
+  EXPECT_EQ(std::vector<std::size_t>{},            mtx::mpeg::find_start_codes(buffer.data(), 2));
+  EXPECT_EQ(std::vector<std::size_t>{ 0 },         mtx::mpeg::find_start_codes(buffer.data(), 3));
+  EXPECT_EQ(std::vector<std::size_t>{},            mtx::mpeg::find_start_codes(buffer.data() + 1, 3));
+}
+
+TEST(Mpeg, FindStartCodesInPartitions) {
+  auto size   = std::size_t{64 * 1024 + 7};
+  auto buffer = std::vector<unsigned char>(size, 0x55);
+
+  for (auto pos = std::size_t{0}; (pos + 3) < size; pos += 409) {
+    buffer[pos]     = 0x00;
+    buffer[pos + 1] = 0x00;
+    buffer[pos + 2] = pos % 3 ? 0x01 : 0x03;
+  }
+
+  buffer[size - 3] = 0x00;
+  buffer[size - 2] = 0x00;
+  buffer[size - 1] = 0x01;
+
+  // Place start codes in all positions around the partition
+  // boundaries.
+  for (auto num_partitions = 1u; num_partitions <= 16; ++num_partitions)
+    for (auto offset = 0u; offset < 5; ++offset) {
+      auto with_boundaries = buffer;
+
+      for (auto partition = 1u; partition < num_partitions; ++partition) {
+        auto pos = size * partition / num_partitions - 4 + offset;
+
+        with_boundaries[pos]     = 0x00;
+        with_boundaries[pos + 1] = 0x00;
+        with_boundaries[pos + 2] = 0x01;
+      }
+
+      EXPECT_EQ(find_start_codes_naively(with_boundaries), mtx::mpeg::find_start_codes(with_boundaries.data(), with_boundaries.size(), num_partitions)) << num_partitions << " " << offset;
+    }
+
+  // More partitions than bytes.
+  std::vector<unsigned char> small{ 0x00, 0x00, 0x01 };
+
+  EXPECT_EQ(std::vector<std::size_t>{ 0 }, mtx::mpeg::find_start_codes(small.data(), 3, 8));
+  EXPECT_EQ(std::vector<std::size_t>{},    mtx::mpeg::find_start_codes(small.data(), 2, 8));
+}
+
+TEST(Mpeg, NumPartitions) {
+  EXPECT_EQ(1u, mtx::mpeg::get_num_partitions(0,                    8));
+  EXPECT_EQ(1u, mtx::mpeg::get_num_partitions(2 * 1024 * 1024 - 1,  8));
+  EXPECT_EQ(2u, mtx::mpeg::get_num_partitions(2 * 1024 * 1024,      8));
+  EXPECT_EQ(8u, mtx::mpeg::get_num_partitions(16 * 1024 * 1024,     8));
+  EXPECT_EQ(1u, mtx::mpeg::get_num_partitions(16 * 1024 * 1024,     1));
+  EXPECT_LE(1u, mtx::mpeg::default_max_partitions());
+}
+
+TEST(Mpeg, RunPartitioned) {
+  for (auto num_partitions = 1u; num_partitions <= 8; ++num_partitions) {
+    std::vector<int> visited(100);
+
+    mtx::mpeg::run_partitioned(visited.size(), num_partitions, [&visited](std::size_t begin, std::size_t end) {
+      for (auto idx = begin; idx < end; ++idx)
+        ++visited[idx];
+    });
+
+    EXPECT_EQ(std::vector<int>(100, 1), visited) << num_partitions;
+  }
+
+  auto num_calls = 0;
+  mtx::mpeg::run_partitioned(0, 4, [&num_calls](std::size_t begin, std::size_t end) { ++num_calls; EXPECT_EQ(begin, end); });
+  EXPECT_EQ(1, num_calls);
+
+  // All partitions are done before the exception is passed on.
+  std::atomic<int> num_done{};
+  EXPECT_THROW(mtx::mpeg::run_partitioned(4, 4, [&num_done](std::size_t begin, std::size_t) {
+    if (1 == begin)
+      throw std::runtime_error{"failed"};
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ++num_done;
+  }), std::runtime_error);
+  EXPECT_EQ(3, num_done);
+}
+
+TEST(Mpeg, NaluToRbsp) {
+  EXPECT_EQ(std::vector<unsigned char>({ 0x65, 0x88 }),                    to_rbsp({ 0x65, 0x88 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x00, 0x00, 0x01 }),              to_rbsp({ 0x00, 0x00, 0x03, 0x01 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x00, 0x00, 0x00, 0x00 }),        to_rbsp({ 0x00, 0x00, 0x03, 0x00, 0x00, 0x03 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x41, 0x00, 0x00 }),              to_rbsp({ 0x41, 0x00, 0x00, 0x03 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x41, 0x00, 0x00, 0x00, 0x03 }),  to_rbsp({ 0x41, 0x00, 0x00, 0x03, 0x00, 0x03 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x00, 0x00, 0x00, 0x00, 0x02 }), to_rbsp({ 0x00, 0x00, 0x03, 0x00, 0x00, 0x03, 0x02 }));
+  EXPECT_EQ(std::vector<unsigned char>({ 0x00, 0x03, 0x00, 0x00 }),        to_rbsp({ 0x00, 0x03, 0x00, 0x00 }));
+}
+
+}
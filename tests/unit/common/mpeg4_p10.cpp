@@ -0,0 +1,272 @@
+#include "common/common_pch.h"
+
+#include "common/bit_writer.h"
+#include "common/mpeg.h"
+#include "common/mpeg4_p10.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using frame_t = std::tuple<std::string, int64_t, int64_t, int64_t, int64_t, uint64_t, bool, char>;
+
+class stream_generator_c {
+protected:
+  std::vector<unsigned char> m_stream;
+  uint32_t m_random{42};
+
+public:
+  std::vector<unsigned char> const &
+  get_stream()
+    const {
+    return m_stream;
+  }
+
+  unsigned char
+  random_byte() {
+    m_random = m_random * 1103515245 + 12345;
+    return (m_random >> 16) & 0xff;
+  }
+
+  static void
+  put_unsigned_golomb(bit_writer_c &w,
+                      unsigned int value) {
+    auto num_bits = 0u;
+    for (auto tmp = value + 1; 1 < tmp; tmp >>= 1)
+      ++num_bits;
+
+    w.put_bits(num_bits,     0);
+    w.put_bits(num_bits + 1, value + 1);
+  }
+
+  // Adds the RBSP written so far followed by random slice data, if
+  // requested, and the stop bit as a NALU.
+  void
+  add_nalu(bit_writer_c &w,
+           std::size_t payload_size = 0) {
+    if (!payload_size)
+      w.put_bit(1);             // rbsp_stop_one_bit
+    w.byte_align();
+
+    auto rbsp = w.get_buffer();
+    auto size = rbsp->get_size();
+
+    if (payload_size) {
+      rbsp->resize(size + payload_size + 1);
+
+      for (auto idx = 0u; idx < payload_size; ++idx)
+        rbsp->get_buffer()[size + idx] = (random_byte() % 4) ? random_byte() : 0x00;
+
+      rbsp->get_buffer()[size + payload_size] = 0x80;
+    }
+
+    auto nalu = mtx::mpeg::rbsp_to_nalu(rbsp);
+
+    if (random_byte() % 2)
+      m_stream.push_back(0x00);
+    m_stream.insert(m_stream.end(), { 0x00, 0x00, 0x01 });
+    m_stream.insert(m_stream.end(), nalu->get_buffer(), nalu->get_buffer() + nalu->get_size());
+
+    // trailing_zero_8bits
+    if (!(random_byte() % 8))
+      m_stream.insert(m_stream.end(), random_byte() % 3 + 1, 0x00);
+  }
+
+  void
+  add_sps(unsigned int width_in_mbs) {
+    bit_writer_c w;
+
+    w.put_bits(8, 0x67);                      // nal_ref_idc, nal_unit_type
+    w.put_bits(8, 66);                        // profile_idc
+    w.put_bits(8, 0);                         // constraint flags
+    w.put_bits(8, 30);                        // level_idc
+    put_unsigned_golomb(w, 0);                // seq_parameter_set_id
+    put_unsigned_golomb(w, 4);                // log2_max_frame_num_minus4
+    put_unsigned_golomb(w, 0);                // pic_order_cnt_type
+    put_unsigned_golomb(w, 4);                // log2_max_pic_order_cnt_lsb_minus4
+    put_unsigned_golomb(w, 1);                // max_num_ref_frames
+    w.put_bit(0);                             // gaps_in_frame_num_value_allowed_flag
+    put_unsigned_golomb(w, width_in_mbs - 1); // pic_width_in_mbs_minus1
+    put_unsigned_golomb(w, 1);                // pic_height_in_map_units_minus1
+    w.put_bit(1);                             // frame_mbs_only_flag
+    w.put_bit(1);                             // direct_8x8_inference_flag
+    w.put_bit(0);                             // frame_cropping_flag
+    w.put_bit(0);                             // vui_parameters_present_flag
+
+    add_nalu(w);
+  }
+
+  void
+  add_pps() {
+    bit_writer_c w;
+
+    w.put_bits(8, 0x68);                      // nal_ref_idc, nal_unit_type
+    put_unsigned_golomb(w, 0);                // pic_parameter_set_id
+    put_unsigned_golomb(w, 0);                // seq_parameter_set_id
+    w.put_bit(0);                             // entropy_coding_mode_flag
+    w.put_bit(0);                             // bottom_field_pic_order_in_frame_present_flag
+    put_unsigned_golomb(w, 0);                // num_slice_groups_minus1
+    put_unsigned_golomb(w, 0);                // num_ref_idx_l0_default_active_minus1
+    put_unsigned_golomb(w, 0);                // num_ref_idx_l1_default_active_minus1
+    w.put_bit(0);                             // weighted_pred_flag
+    w.put_bits(2, 0);                         // weighted_bipred_idc
+    put_unsigned_golomb(w, 0);                // pic_init_qp_minus26
+    put_unsigned_golomb(w, 0);                // pic_init_qs_minus26
+    put_unsigned_golomb(w, 0);                // chroma_qp_index_offset
+    w.put_bit(0);                             // deblocking_filter_control_present_flag
+    w.put_bit(0);                             // constrained_intra_pred_flag
+    w.put_bit(0);                             // redundant_pic_cnt_present_flag
+
+    add_nalu(w);
+  }
+
+  void
+  add_access_unit_delimiter() {
+    bit_writer_c w;
+
+    w.put_bits(8, 0x09);                      // nal_ref_idc, nal_unit_type
+    w.put_bits(3, 0);                         // primary_pic_type
+
+    add_nalu(w);
+  }
+
+  void
+  add_slice(unsigned int nalu_type,
+            unsigned int nal_ref_idc,
+            unsigned int slice_type,
+            unsigned int frame_num,
+            unsigned int pic_order_cnt_lsb,
+            unsigned int idr_pic_id,
+            unsigned int first_mb_in_slice,
+            unsigned int pps_id = 0) {
+    bit_writer_c w;
+
+    w.put_bits(3, nal_ref_idc);
+    w.put_bits(5, nalu_type);
+    put_unsigned_golomb(w, first_mb_in_slice);
+    put_unsigned_golomb(w, slice_type);
+    put_unsigned_golomb(w, pps_id);
+    w.put_bits(8, frame_num);
+    if (NALU_TYPE_IDR_SLICE == nalu_type)
+      put_unsigned_golomb(w, idr_pic_id);
+    w.put_bits(8, pic_order_cnt_lsb);
+
+    add_nalu(w, 500 + random_byte() * 8);
+  }
+
+  void
+  add_gop(unsigned int num_p_frames,
+          unsigned int idr_pic_id) {
+    add_access_unit_delimiter();
+    add_slice(NALU_TYPE_IDR_SLICE, 3, AVC_SLICE_TYPE2_I, 0, 0, idr_pic_id, 0);
+    if (idr_pic_id % 2)
+      add_slice(NALU_TYPE_IDR_SLICE, 3, AVC_SLICE_TYPE2_I, 0, 0, idr_pic_id, 4);
+
+    // P frames followed by a non-reference B frame displayed before them.
+    for (auto idx = 1u; idx <= num_p_frames; ++idx) {
+      auto num_slices = random_byte() % 3 + 1;
+
+      for (auto slice = 0u; slice < num_slices; ++slice)
+        add_slice(NALU_TYPE_NON_IDR_SLICE, 2, AVC_SLICE_TYPE2_P, idx, (idx * 4) % 256, 0, slice * 2);
+
+      add_slice(NALU_TYPE_NON_IDR_SLICE, 0, AVC_SLICE_TYPE2_B, idx + 1, (idx * 4 - 2) % 256, 0, 0);
+
+      // A slice referring to a PPS that doesn't exist.
+      if (!(random_byte() % 32))
+        add_slice(NALU_TYPE_NON_IDR_SLICE, 0, AVC_SLICE_TYPE2_B, idx + 1, (idx * 4 - 2) % 256, 0, 0, 5);
+    }
+  }
+};
+
+std::vector<frame_t>
+parse(std::vector<unsigned char> const &stream,
+      unsigned int max_partitions,
+      std::size_t chunk_size,
+      std::string &avcc) {
+  mpeg4::p10::avc_es_parser_c parser;
+  std::vector<frame_t> frames;
+
+  parser.ignore_nalu_size_length_errors();
+  parser.set_max_partitions(max_partitions);
+
+  auto get_frames = [&parser, &frames]() {
+    while (parser.frame_available()) {
+      auto frame = parser.get_frame();
+      frames.emplace_back(std::string(reinterpret_cast<char const *>(frame.m_data->get_buffer()), frame.m_data->get_size()),
+                          frame.m_start, frame.m_end, frame.m_ref1, frame.m_ref2, frame.m_position, frame.m_keyframe, frame.m_type);
+    }
+  };
+
+  for (auto pos = std::size_t{}; pos < stream.size(); pos += chunk_size) {
+    auto buffer = memory_c::clone(stream.data() + pos, std::min(chunk_size, stream.size() - pos));
+    parser.add_bytes(buffer->get_buffer(), buffer->get_size());
+    get_frames();
+  }
+
+  parser.flush();
+  get_frames();
+
+  auto avcc_data = parser.get_avcc();
+  avcc           = std::string(reinterpret_cast<char const *>(avcc_data->get_buffer()), avcc_data->get_size());
+
+  return frames;
+}
+
+TEST(AvcEsParser, PartitionedParsingMatchesSerialParsing) {
+  stream_generator_c generator;
+
+  // Slices preceding the first SPS & PPS are kept until they're known.
+  generator.add_slice(NALU_TYPE_NON_IDR_SLICE, 2, AVC_SLICE_TYPE2_P, 1, 4, 0, 0);
+
+  generator.add_sps(2);
+  generator.add_pps();
+
+  auto idr_pic_id = 0u;
+
+  while (generator.get_stream().size() < 5 * 1024 * 1024) {
+    // Repeated parameter sets don't change anything.
+    if (!(idr_pic_id % 3)) {
+      generator.add_sps(2);
+      generator.add_pps();
+    }
+
+    generator.add_gop(10 + idr_pic_id % 7, idr_pic_id % 256);
+    ++idr_pic_id;
+  }
+
+  // Changed parameter sets in the middle of the stream.
+  generator.add_sps(3);
+  generator.add_pps();
+
+  while (generator.get_stream().size() < 10 * 1024 * 1024) {
+    generator.add_gop(10 + idr_pic_id % 5, idr_pic_id % 256);
+    ++idr_pic_id;
+
+    if (!(idr_pic_id % 11)) {
+      generator.add_sps(2 + idr_pic_id % 2);
+      generator.add_pps();
+    }
+  }
+
+  auto const &stream = generator.get_stream();
+  auto serial_avcc   = std::string{};
+  auto serial        = parse(stream, 1, 1024 * 1024, serial_avcc);
+
+  ASSERT_LT(1000u, serial.size());
+
+  for (auto const &parameters : std::vector<std::pair<unsigned int, std::size_t>>{ { 2, 2 * 1024 * 1024 }, { 3, 3 * 1024 * 1024 + 123 }, { 7, stream.size() }, { 16, stream.size() } }) {
+    auto partitioned_avcc = std::string{};
+    auto partitioned      = parse(stream, parameters.first, parameters.second, partitioned_avcc);
+
+    EXPECT_EQ(serial_avcc, partitioned_avcc);
+    ASSERT_EQ(serial.size(), partitioned.size()) << parameters.first;
+
+    for (auto idx = 0u; idx < serial.size(); ++idx)
+      if (serial[idx] != partitioned[idx]) {
+        ADD_FAILURE() << "frame " << idx << " differs with " << parameters.first << " partitions";
+        break;
+      }
+  }
+}
+
+}
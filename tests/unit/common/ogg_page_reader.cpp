@@ -0,0 +1,136 @@
+#include "common/common_pch.h"
+
+#include "common/bswap.h"
+#include "common/checksums/crc.h"
+#include "common/endian.h"
+#include "common/mm_io.h"
+#include "common/ogg_page_reader.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<unsigned char>
+create_page(unsigned int sequence_number,
+            std::size_t body_size) {
+  std::vector<unsigned char> page{ 'O', 'g', 'g', 'S', 0x00, 0x00 };
+
+  page.resize(26);
+  put_uint32_le(&page[18], sequence_number);
+
+  auto num_segments = body_size / 255 + 1;
+  page.push_back(num_segments);
+
+  for (auto idx = 1u; idx < num_segments; ++idx)
+    page.push_back(255);
+  page.push_back(body_size % 255);
+
+  for (auto idx = 0u; idx < body_size; ++idx)
+    page.push_back(static_cast<unsigned char>(sequence_number + idx));
+
+  mtx::checksum::crc32_ieee_c crc;
+  crc.add(page.data(), page.size());
+  put_uint32_le(&page[22], mtx::bswap_32(static_cast<uint32_t>(crc.get_result_as_uint())));
+
+  return page;
+}
+
+void
+append(std::vector<unsigned char> &file,
+       std::vector<unsigned char> const &data) {
+  file.insert(file.end(), data.begin(), data.end());
+}
+
+std::vector<unsigned int>
+read_sequence_numbers(std::vector<unsigned char> const &file,
+                      bool &lost_sync) {
+  mm_mem_io_c in{file.data(), file.size()};
+  ogg_page_reader_c reader{in};
+  ogg_page_reader_c::page_t page;
+  std::vector<unsigned int> sequence_numbers;
+
+  lost_sync = false;
+
+  while (reader.read_next_page(page)) {
+    EXPECT_EQ(0, std::memcmp(page.m_header, "OggS", 4));
+    EXPECT_EQ(page.m_header + page.m_header_len, page.m_body);
+
+    lost_sync |= reader.lost_sync();
+    sequence_numbers.push_back(get_uint32_le(&page.m_header[18]));
+  }
+
+  return sequence_numbers;
+}
+
+TEST(OggPageReader, ValidPages) {
+  std::vector<unsigned char> file;
+  auto lost_sync = false;
+
+  // Large pages make the reader fill its buffer several times with
+  // pages spanning the buffer boundaries.
+  for (auto idx = 0u; idx < 40; ++idx)
+    append(file, create_page(idx, (idx * 7919) % (255 * 255)));
+
+  auto sequence_numbers = read_sequence_numbers(file, lost_sync);
+
+  ASSERT_EQ(40u, sequence_numbers.size());
+  for (auto idx = 0u; idx < 40; ++idx)
+    EXPECT_EQ(idx, sequence_numbers[idx]);
+  EXPECT_FALSE(lost_sync);
+}
+
+TEST(OggPageReader, Resynchronization) {
+  std::vector<unsigned char> file;
+  auto lost_sync = false;
+
+  append(file, create_page(0, 100));
+  append(file, { 'O', 'g', 'x', 'O', 0x12, 0x34 });
+  append(file, create_page(1, 1000));
+
+  auto damaged = create_page(2, 500);
+  damaged[27 + 2 + 10] ^= 0xff;
+  append(file, damaged);
+
+  append(file, create_page(3, 0));
+
+  auto sequence_numbers = read_sequence_numbers(file, lost_sync);
+
+  EXPECT_EQ((std::vector<unsigned int>{ 0, 1, 3 }), sequence_numbers);
+  EXPECT_TRUE(lost_sync);
+}
+
+TEST(OggPageReader, TruncatedPage) {
+  std::vector<unsigned char> file;
+  auto lost_sync = false;
+
+  append(file, create_page(0, 300));
+  auto truncated = create_page(1, 300);
+  truncated.resize(truncated.size() - 1);
+  append(file, truncated);
+
+  EXPECT_EQ(std::vector<unsigned int>{ 0 }, read_sequence_numbers(file, lost_sync));
+}
+
+TEST(OggPageReader, Reset) {
+  std::vector<unsigned char> file;
+
+  append(file, create_page(0, 10));
+  append(file, create_page(1, 20));
+
+  mm_mem_io_c in{file.data(), file.size()};
+  ogg_page_reader_c reader{in};
+  ogg_page_reader_c::page_t page;
+
+  ASSERT_TRUE(reader.read_next_page(page));
+  ASSERT_TRUE(reader.read_next_page(page));
+  EXPECT_EQ(20u, page.m_body_len);
+  EXPECT_FALSE(reader.read_next_page(page));
+
+  in.setFilePointer(0);
+  reader.reset();
+
+  ASSERT_TRUE(reader.read_next_page(page));
+  EXPECT_EQ(10u, page.m_body_len);
+}
+
+}
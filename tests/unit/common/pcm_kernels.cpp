@@ -0,0 +1,131 @@
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/bswap.h"
+#include "common/dts.h"
+#include "common/pcm.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<unsigned char>
+create_data(std::size_t size) {
+  std::vector<unsigned char> data(size);
+
+  for (auto idx = 0u; idx < size; ++idx)
+    data[idx] = static_cast<unsigned char>(idx * 13 + 7);
+
+  return data;
+}
+
+std::vector<mtx::bswap_kernel_e>
+available_kernels() {
+  std::vector<mtx::bswap_kernel_e> kernels{ mtx::bswap_kernel_e::scalar };
+
+  if (mtx::best_bswap_kernel() != mtx::bswap_kernel_e::scalar)
+    kernels.push_back(mtx::bswap_kernel_e::ssse3);
+  if (mtx::best_bswap_kernel() == mtx::bswap_kernel_e::avx2)
+    kernels.push_back(mtx::bswap_kernel_e::avx2);
+
+  return kernels;
+}
+
+TEST(PcmKernels, ByteSwapping) {
+  for (auto kernel : available_kernels())
+    for (auto word_length : std::vector<std::size_t>{ 1, 2, 3, 4, 5, 8 })
+      for (auto num_words = 0u; num_words < 70; ++num_words) {
+        auto size   = num_words * word_length;
+        auto source = create_data(size);
+
+        std::vector<unsigned char> expected(size);
+        for (auto idx = 0u; idx < size; ++idx)
+          expected[idx] = source[(idx / word_length) * word_length + word_length - 1 - idx % word_length];
+
+        std::vector<unsigned char> destination(size);
+        mtx::bswap_buffer(source.data(), destination.data(), size, word_length, kernel);
+        EXPECT_EQ(expected, destination) << static_cast<int>(kernel) << " " << word_length << " " << num_words;
+
+        mtx::bswap_buffer(source.data(), source.data(), size, word_length, kernel);
+        EXPECT_EQ(expected, source) << static_cast<int>(kernel) << " " << word_length << " " << num_words << " in place";
+      }
+
+  unsigned char buffer[3];
+  EXPECT_THROW(mtx::bswap_buffer(buffer, buffer, 3, 2), std::invalid_argument);
+}
+
+TEST(PcmKernels, ChannelRemoval) {
+  for (auto bytes_per_channel : std::vector<std::size_t>{ 2, 3, 4 })
+    for (auto num_output_channels : std::vector<std::size_t>{ 1, 2, 3, 5, 7 })
+      for (auto num_input_channels : std::vector<std::size_t>{ num_output_channels + 1, num_output_channels + 2 }) {
+        auto input_frame_size  = bytes_per_channel * num_input_channels;
+        auto output_frame_size = bytes_per_channel * num_output_channels;
+        auto data              = create_data(input_frame_size * 50 + 1);
+
+        std::vector<unsigned char> expected;
+        for (auto frame = 0u; frame < 50; ++frame)
+          expected.insert(expected.end(), &data[frame * input_frame_size], &data[frame * input_frame_size + output_frame_size]);
+
+        auto new_size = mtx::pcm::remove_trailing_channels(data.data(), data.size(), bytes_per_channel, num_input_channels, num_output_channels);
+
+        ASSERT_EQ(expected.size(), new_size);
+        data.resize(new_size);
+        EXPECT_EQ(expected, data) << bytes_per_channel << " " << num_input_channels << " " << num_output_channels;
+      }
+}
+
+// The original scalar implementation.
+std::vector<unsigned char>
+convert_14_to_16_bits_reference(std::vector<unsigned char> const &src) {
+  std::vector<unsigned char> dst;
+
+  for (auto block = 0u; block < (src.size() / 16); ++block) {
+    unsigned int words[8];
+    for (auto idx = 0u; idx < 8; ++idx)
+      words[idx] = (src[block * 16 + idx * 2] << 8) | src[block * 16 + idx * 2 + 1];
+
+    for (auto idx = 0u; idx < 7; ++idx) {
+      auto word = ((words[idx] << (2 * idx + 2)) | ((words[idx + 1] & 0x3fff) >> (12 - 2 * idx))) & 0xffff;
+      dst.push_back(word >> 8);
+      dst.push_back(word & 0xff);
+    }
+  }
+
+  return dst;
+}
+
+TEST(PcmKernels, Dts14To16Bits) {
+  for (auto num_blocks = 0u; num_blocks < 10; ++num_blocks) {
+    auto source   = create_data(num_blocks * 16);
+    auto expected = convert_14_to_16_bits_reference(source);
+
+    std::vector<unsigned char> destination(num_blocks * 14);
+    convert_14_to_16_bits(reinterpret_cast<unsigned short const *>(source.data()), num_blocks * 8, reinterpret_cast<unsigned short *>(destination.data()));
+    EXPECT_EQ(expected, destination) << num_blocks;
+
+    convert_14_to_16_bits(reinterpret_cast<unsigned short const *>(source.data()), num_blocks * 8, reinterpret_cast<unsigned short *>(source.data()));
+    source.resize(num_blocks * 14);
+    EXPECT_EQ(expected, source) << num_blocks << " in place";
+  }
+}
+
+// Not run by default. Use --gtest_also_run_disabled_tests to compare
+// the throughput of the byte swapping kernels.
+TEST(PcmKernels, DISABLED_ByteSwappingThroughput) {
+  auto data = create_data(48 * 1024 * 1024);
+
+  for (auto kernel : available_kernels())
+    for (auto word_length : std::vector<std::size_t>{ 2, 3, 4, 8 }) {
+      auto start = std::chrono::steady_clock::now();
+
+      for (auto idx = 0; idx < 10; ++idx)
+        mtx::bswap_buffer(data.data(), data.data(), data.size(), word_length, kernel);
+
+      auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+      std::cout << "kernel " << static_cast<int>(kernel) << " word length " << word_length << ": " << duration << " ms\n";
+    }
+}
+
+}
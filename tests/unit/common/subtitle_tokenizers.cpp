@@ -0,0 +1,172 @@
+#include "common/common_pch.h"
+
+#include <chrono>
+
+#include "common/strings/parsing.h"
+#include "common/subtitle_tokenizers.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using namespace mtx::subtitles;
+
+// The regular expressions the tokenizers replace. The tests compare
+// the results of both for a variety of lines.
+#define SRT_RE_VALUE         "\\s*(-?)\\s*(\\d+)"
+#define SRT_RE_TIMECODE      SRT_RE_VALUE ":" SRT_RE_VALUE ":" SRT_RE_VALUE "[,\\.:]" SRT_RE_VALUE
+#define SRT_RE_TIMECODE_LINE "^" SRT_RE_TIMECODE "\\s*[\\-\\s]+>\\s*" SRT_RE_TIMECODE "\\s*"
+#define SRT_RE_COORDINATES   "([XY]\\d+:\\d+\\s*){4}\\s*$"
+#define WEBVTT_RE_TIMESTAMP  "(\\d{2}:\\d{2}:\\d{2}\\.\\d{3})"
+
+std::vector<std::string> const s_srt_lines{
+  "00:00:01,000 --> 00:00:02,500",
+  "00:00:01.000 --> 00:00:02.5",
+  "0:0:1:1 -> 0:0:2:123456789012",
+  "  -00 : -00:01,200 - - > 00:00:02,000  X1:2 Y3:4 X5:6  Y7:8  ",
+  "00:00:01,000-->00:00:02,000 X1:2 Y3:4 X5:6",
+  "00:00:01,000 --> 00:00:02,000 X1:2 Y3:4 X5:6 Y7:8 trailing",
+  "00:00:01,000 > 00:00:02,000",
+  "00:00:01,000 --> ",
+  "00:00:01 --> 00:00:02,000",
+  "1",
+  "",
+  "12a",
+  "99999999999:00:01,000 --> 00:00:02,000",
+};
+
+int64_t
+srt_timestamp_from_matches(boost::smatch const &matches,
+                           int first_idx) {
+  int h = 0, min = 0, sec = 0;
+  parse_number(matches[first_idx + 1].str(), h);
+  parse_number(matches[first_idx + 3].str(), min);
+  parse_number(matches[first_idx + 5].str(), sec);
+
+  int64_t neg = 1;
+  for (auto idx = first_idx; idx <= (first_idx + 6); idx += 2)
+    neg *= matches[idx].str() == "-" ? -1 : 1;
+
+  auto rest = matches[first_idx + 7].str();
+  rest.resize(9, '0');
+
+  return ((int64_t)h * 60 * 60 + min * 60 + sec) * 1000000000ll * neg + atol(rest.c_str());
+}
+
+TEST(SubtitleTokenizers, SrtTimestampLines) {
+  boost::regex timecode_re(SRT_RE_TIMECODE_LINE, boost::regex::perl);
+
+  for (auto const &line : s_srt_lines) {
+    boost::smatch matches;
+    int64_t start = 0, end = 0;
+    auto expected = boost::regex_search(line, matches, timecode_re);
+
+    ASSERT_EQ(expected, parse_srt_timestamp_line(line, start, end)) << line;
+
+    if (expected) {
+      EXPECT_EQ(srt_timestamp_from_matches(matches, 1), start) << line;
+      EXPECT_EQ(srt_timestamp_from_matches(matches, 9), end)   << line;
+    }
+  }
+
+  int64_t start = 0, end = 0;
+  ASSERT_TRUE(parse_srt_timestamp_line("00:01:02,5 --> -00:00:03,040", start, end));
+  EXPECT_EQ(62500000000ll, start);
+  EXPECT_EQ(-2960000000ll, end);
+}
+
+TEST(SubtitleTokenizers, SrtNumbersAndCoordinates) {
+  boost::regex number_re("^\\d+$", boost::regex::perl);
+  boost::regex coordinates_re(SRT_RE_COORDINATES, boost::regex::perl);
+
+  for (auto const &line : s_srt_lines) {
+    EXPECT_EQ(boost::regex_match(line, number_re),       is_srt_number_line(line))  << line;
+    EXPECT_EQ(boost::regex_search(line, coordinates_re), has_srt_coordinates(line)) << line;
+  }
+}
+
+TEST(SubtitleTokenizers, SsaLines) {
+  boost::regex script_info_re("^\\s*\\[script\\s+info\\]",   boost::regex::perl | boost::regex::icase);
+  boost::regex styles_re(     "^\\s*\\[V4\\+?\\s+Styles\\]", boost::regex::perl | boost::regex::icase);
+  boost::regex comment_re(    "^\\s*$|^\\s*[!;]",            boost::regex::perl | boost::regex::icase);
+
+  std::vector<std::string> const lines{ "[Script Info]", " \t[script  INFO] x", "[ScriptInfo]", "[Script Info", "[V4+ Styles]", "[v4 styles]", "[V4++ Styles]", "[V4+Styles]",
+                                        "", "  ", " ; comment", "!comment", "a ; b", "[Events]" };
+
+  for (auto const &line : lines) {
+    EXPECT_EQ(boost::regex_search(line, script_info_re), is_ssa_section_line(line, "Script Info"))                                      << line;
+    EXPECT_EQ(boost::regex_search(line, styles_re),      is_ssa_section_line(line, "V4+ Styles") || is_ssa_section_line(line, "V4 Styles")) << line;
+    EXPECT_EQ(boost::regex_search(line, comment_re),     is_ssa_comment_line(line))                                                       << line;
+  }
+}
+
+TEST(SubtitleTokenizers, WebvttLines) {
+  boost::regex timestamp_line_re{"^" WEBVTT_RE_TIMESTAMP " --> " WEBVTT_RE_TIMESTAMP "(?: ([^\\n]+))?$", boost::regex::perl};
+
+  std::vector<std::string> const lines{ "00:00:01.000 --> 00:00:02.000", "00:00:01.000 --> 00:00:02.000 align:start line:0", "00:00:01.000 --> 00:00:02.000 ",
+                                        "00:00:01.000 --> 00:00:02.0000", "0:00:01.000 --> 00:00:02.000", "00:00:01.000 -> 00:00:02.000", "00:00:01.000  --> 00:00:02.000", "label" };
+
+  for (auto const &line : lines) {
+    boost::smatch matches;
+    std::string start, end, settings;
+    auto expected = boost::regex_search(line, matches, timestamp_line_re);
+
+    ASSERT_EQ(expected, parse_webvtt_timestamp_line(line, start, end, settings)) << line;
+
+    if (expected) {
+      EXPECT_EQ(matches[1].str(), start);
+      EXPECT_EQ(matches[2].str(), end);
+      EXPECT_EQ(matches[3].str(), settings);
+    }
+  }
+
+  EXPECT_EQ(std::string::npos, find_webvtt_embedded_timestamp("no timestamps <b>here</b>", 0));
+  EXPECT_EQ(4u,                find_webvtt_embedded_timestamp("<b> <00:00:01.000>x<00:00:02.000>", 0));
+  EXPECT_EQ(19u,               find_webvtt_embedded_timestamp("<b> <00:00:01.000>x<00:00:02.000>", 5));
+  EXPECT_EQ(std::string::npos, find_webvtt_embedded_timestamp("<00:00:01.00>", 0));
+}
+
+TEST(SubtitleTokenizers, MicroDvdLines) {
+  boost::regex re("^\\{\\d+?\\}\\{\\d+?\\}.+$", boost::regex::perl);
+
+  for (auto const &line : std::vector<std::string>{ "{1}{25}Hello", "{1}{25}", "{1}{}Hello", "{}{25}Hello", "{12}{34}|Two lines", " {1}{25}x", "{1} {25}x" })
+    EXPECT_EQ(boost::regex_match(line, re), is_microdvd_line(line)) << line;
+}
+
+// Not run by default. Use --gtest_also_run_disabled_tests to compare
+// the throughput of the tokenizers with the regular expressions.
+TEST(SubtitleTokenizers, DISABLED_Throughput) {
+  auto const num_iterations = 200000u;
+  boost::regex timecode_re(SRT_RE_TIMECODE_LINE, boost::regex::perl);
+  boost::regex number_re("^\\d+$", boost::regex::perl);
+
+  auto measure = [](std::function<void()> const &worker) {
+    auto start = std::chrono::steady_clock::now();
+    worker();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  auto num_matches_re = 0u, num_matches_tokenizer = 0u;
+
+  auto duration_re = measure([&]() {
+    for (auto idx = 0u; idx < num_iterations; ++idx)
+      for (auto const &line : s_srt_lines) {
+        boost::smatch matches;
+        num_matches_re += boost::regex_search(line, matches, timecode_re) + boost::regex_match(line, number_re);
+      }
+  });
+
+  auto duration_tokenizer = measure([&]() {
+    for (auto idx = 0u; idx < num_iterations; ++idx)
+      for (auto const &line : s_srt_lines) {
+        int64_t start, end;
+        num_matches_tokenizer += parse_srt_timestamp_line(line, start, end) + is_srt_number_line(line);
+      }
+  });
+
+  EXPECT_EQ(num_matches_re, num_matches_tokenizer);
+
+  std::cout << "SRT lines: regular expressions " << duration_re << " ms, tokenizers " << duration_tokenizer << " ms\n";
+}
+
+}
@@ -0,0 +1,156 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <chrono>
+
+#include "extract/xtr_worker.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class test_worker_c: public xtr_worker_c {
+public:
+  test_worker_c(std::size_t max_queued_bytes = 32 * 1024 * 1024)
+    : xtr_worker_c{max_queued_bytes}
+  {
+  }
+
+  std::size_t
+  num_queued_jobs() {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_jobs.size();
+  }
+};
+
+void
+wait_until(std::atomic<bool> const &flag) {
+  while (!flag)
+    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+}
+
+TEST(XtrWorker, RunsJobsInOrder) {
+  std::vector<int> order;
+  xtr_worker_c worker;
+
+  for (auto idx = 0; idx < 100; ++idx)
+    worker.add_job([&order, idx]() { order.push_back(idx); }, 10);
+
+  worker.finish();
+
+  ASSERT_EQ(100u, order.size());
+  for (auto idx = 0; idx < 100; ++idx)
+    EXPECT_EQ(idx, order[idx]);
+}
+
+TEST(XtrWorker, QueueIsBounded) {
+  std::atomic<bool> gate_open{}, third_job_added{};
+  std::vector<int> order;
+  xtr_worker_c worker{100};
+
+  worker.add_job([&gate_open, &order]() { wait_until(gate_open); order.push_back(1); }, 60);
+  worker.add_job([&order]() { order.push_back(2); }, 60);
+
+  // 120 bytes are queued now. Adding more must wait until enough jobs
+  // have been run.
+  std::thread adder{[&worker, &order, &third_job_added]() {
+    worker.add_job([&order]() { order.push_back(3); }, 10);
+    third_job_added = true;
+  }};
+
+  std::this_thread::sleep_for(std::chrono::milliseconds{100});
+  EXPECT_FALSE(third_job_added);
+
+  gate_open = true;
+  adder.join();
+
+  EXPECT_TRUE(third_job_added);
+
+  worker.finish();
+
+  EXPECT_EQ(std::vector<int>({ 1, 2, 3 }), order);
+}
+
+TEST(XtrWorker, LargeJobsAreAcceptedIfTheQueueIsEmpty) {
+  auto ran = false;
+  xtr_worker_c worker{10};
+
+  worker.add_job([&ran]() { ran = true; }, 1000);
+  worker.finish();
+
+  EXPECT_TRUE(ran);
+}
+
+TEST(XtrWorker, ExceptionsArePassedOn) {
+  std::atomic<bool> all_queued{};
+  auto num_run = 0;
+  xtr_worker_c worker;
+
+  worker.add_job([&num_run, &all_queued]() { wait_until(all_queued); ++num_run; }, 10);
+  worker.add_job([]() { throw std::runtime_error{"failed"}; }, 10);
+  for (auto idx = 0; idx < 10; ++idx)
+    worker.add_job([&num_run]() { ++num_run; }, 10);
+
+  all_queued = true;
+
+  EXPECT_THROW(worker.finish(), std::runtime_error);
+
+  // The jobs following the failed one are discarded.
+  EXPECT_EQ(1, num_run);
+}
+
+TEST(XtrWorker, AbortAllDiscardsQueuedJobs) {
+  std::atomic<bool> all_queued{}, first_job_started{};
+  std::atomic<int> num_run{}, num_run_other{};
+  test_worker_c worker, other_worker;
+
+  worker.add_job([&]() {
+    first_job_started = true;
+    wait_until(all_queued);
+
+    // Keep running until abort_all() has discarded the other jobs.
+    while (worker.num_queued_jobs())
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+
+    ++num_run;
+  }, 10);
+
+  for (auto idx = 0; idx < 10; ++idx) {
+    worker.add_job([&num_run]() { ++num_run; }, 10);
+    other_worker.add_job([&num_run_other]() { std::this_thread::sleep_for(std::chrono::milliseconds{10}); ++num_run_other; }, 10);
+  }
+
+  all_queued = true;
+  wait_until(first_job_started);
+
+  xtr_worker_c::abort_all();
+
+  // The running jobs are finished, the queued ones aren't run.
+  EXPECT_EQ(1, num_run);
+  EXPECT_EQ(0u, worker.num_queued_jobs());
+  EXPECT_EQ(0u, other_worker.num_queued_jobs());
+
+  auto num_run_other_after_abort = num_run_other.load();
+
+  worker.finish();
+  other_worker.finish();
+
+  EXPECT_EQ(1, num_run);
+  EXPECT_EQ(num_run_other_after_abort, num_run_other);
+}
+
+TEST(XtrWorkerDeathTest, ErrorsAreReportedByTheMainThread) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+  EXPECT_EXIT({
+    xtr_worker_c worker;
+
+    worker.add_job([]() { mxerror("failed in the worker\n"); }, 10);
+    worker.finish();
+
+    // Not reached: the main thread exits while reporting the error.
+    std::exit(0);
+  }, ::testing::ExitedWithCode(2), "");
+}
+
+}
@@ -18,8 +18,6 @@
 
 #include "gtest/gtest.h"
 
-extern bool g_warning_issued;
-
 namespace mtxut {
 
 class mxerror_x: public std::exception {
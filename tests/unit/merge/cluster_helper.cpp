@@ -0,0 +1,114 @@
+#include "common/common_pch.h"
+
+#include "common/split_arg_parsing.h"
+#include "merge/cluster_helper.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+int64_t
+s(int64_t seconds) {
+  return seconds * 1000000000ll;
+}
+
+std::unique_ptr<cluster_helper_c>
+create_helper(std::vector<split_point_c> const &points) {
+  auto helper = std::make_unique<cluster_helper_c>();
+  for (auto const &point : points)
+    helper->add_split_point(point);
+
+  return helper;
+}
+
+TEST(ClusterHelper, PlanParallelSplitPartsNotSplitting) {
+  auto helper = std::make_unique<cluster_helper_c>();
+
+  EXPECT_TRUE(helper->plan_parallel_split_parts().empty());
+}
+
+TEST(ClusterHelper, PlanParallelSplitPartsUnsupportedModes) {
+  EXPECT_TRUE(create_helper({ split_point_c{s(60),    split_point_c::duration,    false} })->plan_parallel_split_parts().empty());
+  EXPECT_TRUE(create_helper({ split_point_c{1 << 20,  split_point_c::size,        false} })->plan_parallel_split_parts().empty());
+  EXPECT_TRUE(create_helper({ split_point_c{100,      split_point_c::frame_field, true} })->plan_parallel_split_parts().empty());
+  EXPECT_TRUE(create_helper(mtx::args::parse_split_parts("parts-frames:100-200,300-400", true))->plan_parallel_split_parts().empty());
+}
+
+TEST(ClusterHelper, PlanParallelSplitPartsParts) {
+  auto plan = create_helper(mtx::args::parse_split_parts("parts:00:01:00-00:02:00,00:03:00-00:04:00", false))->plan_parallel_split_parts();
+
+  ASSERT_EQ(2u, plan.size());
+
+  ASSERT_EQ(3u,      plan[0].size());
+  EXPECT_EQ(0,       plan[0][0].m_point);
+  EXPECT_TRUE(plan[0][0].m_discard);
+  EXPECT_EQ(s(60),   plan[0][1].m_point);
+  EXPECT_FALSE(plan[0][1].m_discard);
+  EXPECT_EQ(s(120),  plan[0][2].m_point);
+  EXPECT_TRUE(plan[0][2].m_discard);
+
+  ASSERT_EQ(3u,      plan[1].size());
+  EXPECT_EQ(0,       plan[1][0].m_point);
+  EXPECT_TRUE(plan[1][0].m_discard);
+  EXPECT_EQ(s(180),  plan[1][1].m_point);
+  EXPECT_FALSE(plan[1][1].m_discard);
+  EXPECT_EQ(s(240),  plan[1][2].m_point);
+  EXPECT_TRUE(plan[1][2].m_discard);
+}
+
+TEST(ClusterHelper, PlanParallelSplitPartsPartsAppended) {
+  auto plan = create_helper(mtx::args::parse_split_parts("parts:-00:01:00,+00:02:00-00:03:00,00:03:00-", false))->plan_parallel_split_parts();
+
+  ASSERT_EQ(2u,      plan.size());
+
+  ASSERT_EQ(4u,      plan[0].size());
+  EXPECT_EQ(0,       plan[0][0].m_point);
+  EXPECT_FALSE(plan[0][0].m_discard);
+  EXPECT_EQ(s(60),   plan[0][1].m_point);
+  EXPECT_TRUE(plan[0][1].m_discard);
+  EXPECT_EQ(s(120),  plan[0][2].m_point);
+  EXPECT_FALSE(plan[0][2].m_discard);
+  EXPECT_FALSE(plan[0][2].m_create_new_file);
+  EXPECT_EQ(s(180),  plan[0][3].m_point);
+  EXPECT_TRUE(plan[0][3].m_discard);
+
+  ASSERT_EQ(2u,      plan[1].size());
+  EXPECT_EQ(0,       plan[1][0].m_point);
+  EXPECT_TRUE(plan[1][0].m_discard);
+  EXPECT_EQ(s(180),  plan[1][1].m_point);
+  EXPECT_FALSE(plan[1][1].m_discard);
+}
+
+TEST(ClusterHelper, PlanParallelSplitPartsTimestamps) {
+  auto plan = create_helper({ split_point_c{s(60),  split_point_c::timecode, true},
+                              split_point_c{s(120), split_point_c::timecode, true} })->plan_parallel_split_parts();
+
+  ASSERT_EQ(3u,      plan.size());
+
+  ASSERT_EQ(2u,      plan[0].size());
+  EXPECT_EQ(0,       plan[0][0].m_point);
+  EXPECT_FALSE(plan[0][0].m_discard);
+  EXPECT_EQ(s(60),   plan[0][1].m_point);
+  EXPECT_TRUE(plan[0][1].m_discard);
+
+  ASSERT_EQ(3u,      plan[1].size());
+  EXPECT_EQ(s(60),   plan[1][1].m_point);
+  EXPECT_EQ(s(120),  plan[1][2].m_point);
+  EXPECT_TRUE(plan[1][2].m_discard);
+
+  ASSERT_EQ(2u,      plan[2].size());
+  EXPECT_TRUE(plan[2][0].m_discard);
+  EXPECT_EQ(s(120),  plan[2][1].m_point);
+  EXPECT_EQ(split_point_c::parts, plan[2][1].m_type);
+}
+
+TEST(ClusterHelper, DiscardedRangeEnd) {
+  EXPECT_FALSE(std::make_unique<cluster_helper_c>()->get_discarded_range_end().valid());
+  EXPECT_FALSE(create_helper(mtx::args::parse_split_parts("parts:-00:01:00,00:02:00-", false))->get_discarded_range_end().valid());
+  EXPECT_FALSE(create_helper(mtx::args::parse_split_parts("parts:100-200", true))->get_discarded_range_end().valid());
+  EXPECT_FALSE(create_helper({ split_point_c{s(60), split_point_c::timecode, true} })->get_discarded_range_end().valid());
+
+  EXPECT_EQ(timestamp_c::s(60), create_helper(mtx::args::parse_split_parts("parts:00:01:00-00:02:00", false))->get_discarded_range_end());
+}
+
+}
@@ -0,0 +1,143 @@
+#include "common/common_pch.h"
+
+#include "merge/generic_packetizer.h"
+#include "merge/generic_reader.h"
+#include "merge/output_control.h"
+#include "merge/timestamp_factory.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class test_reader_c: public generic_reader_c {
+public:
+  test_reader_c(track_info_c const &ti)
+    : generic_reader_c{ti, mm_io_cptr{new mm_mem_io_c{nullptr, 0, 100}}}
+  {
+    // Keeps the packetizer from looking itself up in g_files for its
+    // track number.
+    m_appending = true;
+  }
+
+  virtual file_type_e get_format_type() const {
+    return FILE_TYPE_IS_UNKNOWN;
+  }
+
+  virtual void read_headers() {
+  }
+
+  virtual file_status_e read(generic_packetizer_c *, bool) {
+    return FILE_STATUS_DONE;
+  }
+
+  virtual void identify() {
+  }
+
+  virtual void create_packetizer(int64_t) {
+  }
+};
+
+class test_packetizer_c: public generic_packetizer_c {
+public:
+  test_packetizer_c(generic_reader_c *reader,
+                    track_info_c &ti,
+                    timestamp_factory_cptr const &factory)
+    : generic_packetizer_c{reader, ti}
+  {
+    m_timestamp_factory                  = factory;
+    m_timestamp_factory_application_mode = TFA_FULL_QUEUEING;
+  }
+
+  virtual int process(packet_cptr) {
+    return FILE_STATUS_MOREDATA;
+  }
+
+  virtual translatable_string_c get_format_name() const {
+    return YT("test");
+  }
+
+  virtual connection_result_e can_connect_to(generic_packetizer_c *, std::string &) {
+    return CAN_CONNECT_NO_FORMAT;
+  }
+
+  // Queues the frames the same way add_packet2() does and returns the
+  // timestamps assigned to them in decode order.
+  std::vector<int64_t>
+  timestamp(std::vector<std::pair<int64_t, char>> const &frames) {
+    std::vector<int64_t> timestamps;
+
+    auto get_packets = [this, &timestamps]() {
+      while (auto packet = get_packet())
+        timestamps.push_back(packet->assigned_timecode);
+    };
+
+    for (auto const &frame : frames) {
+      auto bref   = 'I' == frame.second ? -1 : 0;
+      auto fref   = 'B' == frame.second ? frame.first + 1 : -1;
+      auto packet = packet_cptr{new packet_t{memory_c::alloc(1), frame.first, 1, bref, fref}};
+
+      packet->source                  = this;
+      packet->timecode_before_factory = packet->timecode;
+
+      m_packet_queue.push_back(packet);
+      apply_factory();
+      get_packets();
+    }
+
+    m_has_been_flushed = true;
+    apply_factory();
+    get_packets();
+
+    return timestamps;
+  }
+};
+
+std::vector<int64_t>
+timestamp_with_v2_factory(std::vector<std::pair<int64_t, char>> const &frames,
+                          int64_t latency_target) {
+  std::string text{"# timecode format v2\n0\n50\n80\n130\n160\n210\n240\n"};
+  auto in = mm_io_cptr{new mm_text_io_c{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(text.c_str()), text.length()}}};
+
+  std::string line;
+  in->getline2(line);
+
+  auto factory = std::make_shared<timestamp_factory_v2_c>("test.txt", "test.mkv", 0, 2);
+  factory->parse(in);
+
+  track_info_c ti;
+  test_reader_c reader{ti};
+  test_packetizer_c packetizer{&reader, ti, factory};
+
+  auto previous_latency_target = g_latency_target;
+  g_latency_target             = latency_target;
+  auto timestamps              = packetizer.timestamp(frames);
+  g_latency_target             = previous_latency_target;
+
+  return timestamps;
+}
+
+TEST(GenericPacketizer, FullQueueingInLowLatencyMode) {
+  // I0 P3 B1 B2 P6 B4 B5 in decode order
+  std::vector<std::pair<int64_t, char>> const frames{
+    { 0, 'I' }, { 3, 'P' }, { 1, 'B' }, { 2, 'B' }, { 6, 'P' }, { 4, 'B' }, { 5, 'B' },
+  };
+
+  auto full_queueing = timestamp_with_v2_factory(frames, 0);
+
+  EXPECT_EQ((std::vector<int64_t>{ 0, 130000000, 50000000, 80000000, 240000000, 160000000, 210000000 }), full_queueing);
+  EXPECT_EQ(full_queueing, timestamp_with_v2_factory(frames, 100000000));
+}
+
+TEST(GenericPacketizer, FullQueueingInLowLatencyModeWithPyramidalBFrames) {
+  // I0 P4 B2 b1 b3 in decode order
+  std::vector<std::pair<int64_t, char>> const frames{
+    { 0, 'I' }, { 4, 'P' }, { 2, 'B' }, { 1, 'B' }, { 3, 'B' },
+  };
+
+  auto full_queueing = timestamp_with_v2_factory(frames, 0);
+
+  EXPECT_EQ((std::vector<int64_t>{ 0, 160000000, 80000000, 50000000, 130000000 }), full_queueing);
+  EXPECT_EQ(full_queueing, timestamp_with_v2_factory(frames, 100000000));
+}
+
+}
@@ -0,0 +1,83 @@
+#include "common/common_pch.h"
+
+#include <atomic>
+#include <chrono>
+
+#include "merge/header_parser.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(HeaderParser, FallbackWaitsForAllThreads) {
+  std::atomic<bool> main_thread_parsing{}, overlapped{};
+  std::vector<header_parser_c::job_t> jobs(3);
+
+  for (auto idx = 0u; idx < 2; ++idx)
+    jobs[idx].m_read_headers = [&main_thread_parsing, &overlapped]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds{50});
+      if (main_thread_parsing)
+        overlapped = true;
+    };
+
+  // The third job stands for a reader that cannot parse its headers
+  // concurrently. It isn't handed to the parser.
+  header_parser_c parser{{ &jobs[0], &jobs[1] }, 1};
+
+  parser.wait_for(jobs[2]);
+
+  EXPECT_TRUE(jobs[0].m_done);
+  EXPECT_TRUE(jobs[1].m_done);
+  EXPECT_FALSE(jobs[2].m_done);
+
+  main_thread_parsing = true;
+
+  EXPECT_FALSE(overlapped);
+}
+
+TEST(HeaderParser, WaitsForJobsInOrder) {
+  std::vector<header_parser_c::job_t> jobs(4);
+  std::vector<header_parser_c::job_t *> job_ptrs;
+
+  for (auto &job : jobs) {
+    job.m_read_headers = []() {};
+    job_ptrs.push_back(&job);
+  }
+
+  header_parser_c parser{job_ptrs, 2};
+
+  for (auto &job : jobs) {
+    parser.wait_for(job);
+    EXPECT_TRUE(job.m_done);
+    EXPECT_FALSE(!!job.m_exception);
+  }
+}
+
+TEST(HeaderParser, ExceptionStopsRemainingJobs) {
+  std::vector<header_parser_c::job_t> jobs(4);
+
+  jobs[0].m_read_headers = []() { throw std::runtime_error{"failed"}; };
+  for (auto idx = 1u; idx < jobs.size(); ++idx)
+    jobs[idx].m_read_headers = []() { std::this_thread::sleep_for(std::chrono::milliseconds{100}); };
+
+  header_parser_c parser{{ &jobs[0], &jobs[1], &jobs[2], &jobs[3] }, 1};
+
+  parser.wait_for(jobs[0]);
+
+  ASSERT_TRUE(jobs[0].m_done);
+  EXPECT_THROW(std::rethrow_exception(jobs[0].m_exception), std::runtime_error);
+
+  // Jobs are either done or have to be parsed in the calling thread.
+  for (auto idx = 1u; idx < jobs.size(); ++idx)
+    EXPECT_TRUE(jobs[idx].m_done || !jobs[idx].m_queued);
+
+  EXPECT_FALSE(jobs[3].m_done);
+}
+
+TEST(HeaderParser, NoThreadsForASingleJob) {
+  EXPECT_EQ(0u, header_parser_c::default_num_threads(0));
+  EXPECT_EQ(0u, header_parser_c::default_num_threads(1));
+  EXPECT_LE(2u, header_parser_c::default_num_threads(2));
+}
+
+}
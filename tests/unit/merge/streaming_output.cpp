@@ -0,0 +1,108 @@
+#include "common/common_pch.h"
+
+#include "common/mm_io.h"
+#include "merge/cluster_helper.h"
+#include "merge/output_control.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class StreamingOutput: public ::testing::Test {
+protected:
+  bfs::path m_dir;
+
+  virtual void SetUp() override {
+    m_dir = bfs::temp_directory_path() / bfs::unique_path();
+    bfs::create_directories(m_dir);
+
+    g_streaming_output = true;
+    g_outfile          = (m_dir / "output.mkv").string();
+    g_cluster_helper   = std::make_unique<cluster_helper_c>();
+  }
+
+  virtual void TearDown() override {
+    force_close_output_file();
+
+    g_cluster_helper.reset();
+    g_attachments.clear();
+    g_outfile.clear();
+    g_streaming_output = false;
+    g_file_num         = 1;
+
+    boost::system::error_code ec;
+    bfs::remove_all(m_dir, ec);
+  }
+
+  std::string
+  read_output()
+    const {
+    mm_file_io_c in{g_outfile};
+    std::string content(in.get_size(), '\0');
+
+    in.read(&content[0], content.size());
+
+    return content;
+  }
+};
+
+TEST_F(StreamingOutput, AttachmentsAreNotBufferedWithTheHeaders) {
+  // Larger than the buffer the headers are kept in until the first
+  // cluster is written.
+  auto data_size = 3u * 1024 * 1024 + 17;
+  auto data      = std::string(data_size, '\0');
+
+  for (auto idx = 0u; idx < data_size; ++idx)
+    data[idx] = static_cast<char>((idx * 7 + idx / 251) & 0xff);
+
+  auto source_name = (m_dir / "attachment.bin").string();
+  mm_file_io_c{source_name, MODE_CREATE}.puts(std::string(100, 'x') + data);
+
+  auto attachment            = std::make_shared<attachment_t>();
+  attachment->name           = source_name;
+  attachment->mime_type      = "application/octet-stream";
+  attachment->id             = 1;
+  attachment->data_file_name = source_name;
+  attachment->data_position  = 100;
+  attachment->data_size      = data_size;
+
+  g_attachments.push_back(attachment);
+
+  create_next_output_file();
+
+  auto headers = dynamic_cast<mm_mem_io_c *>(g_cluster_helper->get_output());
+  ASSERT_TRUE(!!headers);
+  EXPECT_LT(headers->get_size(), 64u * 1024);
+
+  write_streaming_output_headers();
+
+  auto out = g_cluster_helper->get_output();
+  ASSERT_TRUE(!!out);
+  EXPECT_FALSE(!!dynamic_cast<mm_mem_io_c *>(out));
+  out->flush();
+
+  auto content  = read_output();
+  auto data_pos = content.find(data);
+
+  ASSERT_NE(std::string::npos, data_pos);
+  EXPECT_EQ(std::string::npos, content.find(data, data_pos + 1));
+
+  // The meta seek element at the front refers to the attachments.
+  auto seek_entry = content.find(std::string{"\x53\xab\x84\x19\x41\xa4\x69\x53\xac", 9});
+  ASSERT_NE(std::string::npos, seek_entry);
+
+  auto position_size     = static_cast<unsigned char>(content[seek_entry + 9]) & 0x7f;
+  auto relative_position = uint64_t{};
+  for (auto idx = 0; idx < position_size; ++idx)
+    relative_position = (relative_position << 8) | static_cast<unsigned char>(content[seek_entry + 10 + idx]);
+
+  // The segment size is always written with eight bytes.
+  auto segment_pos         = content.find(std::string{"\x18\x53\x80\x67", 4});
+  auto attachments_pos     = segment_pos + 4 + 8 + relative_position;
+
+  ASSERT_NE(std::string::npos, segment_pos);
+  ASSERT_LT(attachments_pos, data_pos);
+  EXPECT_EQ(std::string("\x19\x41\xa4\x69", 4), content.substr(attachments_pos, 4));
+}
+
+}
@@ -0,0 +1,79 @@
+#include "common/common_pch.h"
+
+#include "common/binary_timestamps.h"
+#include "merge/packet.h"
+#include "merge/timestamp_factory.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+std::vector<std::pair<int64_t, int64_t>>
+get_timestamps_and_durations(timestamp_factory_c &factory,
+                             std::size_t num_packets) {
+  std::vector<std::pair<int64_t, int64_t>> result;
+
+  for (auto idx = 0u; idx < num_packets; ++idx) {
+    auto packet = packet_cptr{new packet_t};
+    factory.get_next(packet);
+    result.emplace_back(packet->assigned_timecode, packet->duration);
+  }
+
+  return result;
+}
+
+std::vector<std::pair<int64_t, int64_t>> const s_expected{
+  {         0, 40000000 },
+  {  40000000, 40000000 },
+  {  80000000, 20000000 },
+  { 100000000, 40000000 },
+  { 140000000, 40000000 },
+};
+
+TEST(TimestampFactory, V2Text) {
+  std::string text{"# timecode format v2\n0\n# comment\n40\n\n80\n100\n140\n"};
+  auto in = mm_io_cptr{new mm_text_io_c{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(text.c_str()), text.length()}}};
+
+  std::string line;
+  ASSERT_TRUE(in->getline2(line));
+
+  timestamp_factory_v2_c factory{"test.txt", "test.mkv", 0, 2};
+  factory.parse(in);
+
+  EXPECT_EQ(40000000.0, factory.get_default_duration(-1));
+  EXPECT_EQ(s_expected, get_timestamps_and_durations(factory, s_expected.size()));
+}
+
+TEST(TimestampFactory, V2Binary) {
+  auto in = mm_io_cptr{new mm_mem_io_c{nullptr, 0, 1000}};
+  mtx::binary_timestamps::write(*in, { 0, 40000000, 80000000, 100000000, 140000000 }, 40000000);
+
+  timestamp_factory_v2_c factory{"test.bin", "test.mkv", 0, 2, true};
+  factory.parse(in);
+
+  EXPECT_EQ(40000000.0, factory.get_default_duration(-1));
+  EXPECT_EQ(s_expected, get_timestamps_and_durations(factory, s_expected.size()));
+}
+
+TEST(TimestampFactory, V3) {
+  std::string text{"# timecode format v3\nassume 25\n0.08\ngap,1\n0.04\n"};
+  auto in = mm_io_cptr{new mm_text_io_c{new mm_mem_io_c{reinterpret_cast<unsigned char const *>(text.c_str()), text.length()}}};
+
+  std::string line;
+  ASSERT_TRUE(in->getline2(line));
+
+  timestamp_factory_v3_c factory{"test.txt", "test.mkv", 0};
+  factory.parse(in);
+
+  std::vector<std::pair<int64_t, int64_t>> const expected{
+    {          0, 40000000 },
+    {   40000000, 40000000 },
+    { 1080000000, 40000000 },
+    { 1120000000, 40000000 },
+    { 1160000000, 40000000 },
+  };
+
+  EXPECT_EQ(expected, get_timestamps_and_durations(factory, expected.size()));
+}
+
+}
@@ -248,7 +248,7 @@ test_delete(std::string const &spec,
   ASSERT_NO_THROW(at.parse_spec(attachment_target_c::ac_delete, spec, opt));
   ASSERT_NO_THROW(at.validate());
   ASSERT_NO_THROW(at.execute());
-  ASSERT_EQ(g_warning_issued, expect_warning);
+  ASSERT_EQ(g_warning_issued.load(), expect_warning);
   EXPECT_EBML_EQ(*l1_a, *l1_b);
 }
 
@@ -314,7 +314,7 @@ test_replace(std::string const &custom_message,
   ASSERT_NO_THROW(at.parse_spec(attachment_target_c::ac_replace, spec + ":tests/unit/data/text/chunky_bacon.txt", opt)) << message;
   ASSERT_NO_THROW(at.validate())                                                                                        << message;
   ASSERT_NO_THROW(at.execute())                                                                                         << message;
-  ASSERT_EQ(g_warning_issued, expect_warning)                                                                           << message;
+  ASSERT_EQ(g_warning_issued.load(), expect_warning)                                                                    << message;
   EXPECT_EBML_EQ(*l1_a, *l1_b)                                                                                          << message;
 }
 
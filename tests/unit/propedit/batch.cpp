@@ -0,0 +1,49 @@
+#include "common/common_pch.h"
+
+#include "propedit/batch.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Batch, ParseFileList) {
+  auto jobs = parse_batch_jobs("# comment\r\nfirst.mkv\r\n\r\n  \nsecond file.mkv  \n");
+
+  ASSERT_EQ(2u, jobs.size());
+  EXPECT_EQ("first.mkv",       jobs[0].m_file_name);
+  EXPECT_TRUE(jobs[0].m_arguments.empty());
+  EXPECT_EQ("second file.mkv", jobs[1].m_file_name);
+  EXPECT_TRUE(parse_batch_jobs("").empty());
+}
+
+TEST(Batch, ParseJSON) {
+  auto jobs = parse_batch_jobs("\n [ \"a.mkv\", { \"file\": \"b.mkv\", \"arguments\": [ \"--edit\", \"track:a1\", \"--set\", \"language=ger\" ] } ]");
+
+  ASSERT_EQ(2u, jobs.size());
+  EXPECT_EQ("a.mkv", jobs[0].m_file_name);
+  EXPECT_TRUE(jobs[0].m_arguments.empty());
+  EXPECT_EQ("b.mkv", jobs[1].m_file_name);
+  ASSERT_EQ(4u, jobs[1].m_arguments.size());
+  EXPECT_EQ("track:a1",     jobs[1].m_arguments[1]);
+  EXPECT_EQ("language=ger", jobs[1].m_arguments[3]);
+}
+
+TEST(Batch, ParseInvalidJSON) {
+  EXPECT_THROW(parse_batch_jobs("[ \"a.mkv\""),                                  std::invalid_argument);
+  EXPECT_THROW(parse_batch_jobs("[ 42 ]"),                                       std::invalid_argument);
+  EXPECT_THROW(parse_batch_jobs("[ { \"arguments\": [] } ]"),                    std::invalid_argument);
+  EXPECT_THROW(parse_batch_jobs("[ { \"file\": \"a.mkv\", \"arguments\": 1 } ]"), std::invalid_argument);
+  EXPECT_THROW(parse_batch_jobs("[ { \"file\": \"\" } ]"),                       std::invalid_argument);
+}
+
+TEST(Batch, GroupByFile) {
+  auto groups = group_batch_jobs_by_file({ { "a.mkv", { "1" } }, { "b.mkv", {} }, { "./a.mkv", { "2" } } });
+
+  ASSERT_EQ(2u, groups.size());
+  ASSERT_EQ(2u, groups[0].size());
+  EXPECT_EQ("1", groups[0][0].m_arguments[0]);
+  EXPECT_EQ("2", groups[0][1].m_arguments[0]);
+  EXPECT_EQ("b.mkv", groups[1][0].m_file_name);
+}
+
+}